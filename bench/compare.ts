@@ -0,0 +1,74 @@
+#!/usr/bin/env npx tsx
+/**
+ * Benchmark Comparison
+ *
+ * Diffs two bench/run.ts reports result by result and exits non-zero if
+ * any fps dropped by more than the threshold, so it can gate a release.
+ *
+ * Run with: npm run bench:compare -- base.json head.json [--threshold 10]
+ */
+
+import { readFileSync } from 'fs';
+
+import { type BenchmarkReport, resultKey } from './report.js';
+
+function percentChange(base: number, head: number): number {
+  return base > 0 ? ((head - base) / base) * 100 : 0;
+}
+
+function formatChange(change: number): string {
+  return `${change >= 0 ? '+' : ''}${change.toFixed(1)}%`.padStart(8);
+}
+
+function main() {
+  const args = process.argv.slice(2);
+  let threshold = 10;
+  const files: string[] = [];
+  for (let i = 0; i < args.length; i++) {
+    if (args[i] === '--threshold') {
+      threshold = Number(args[++i]);
+    } else {
+      files.push(args[i]);
+    }
+  }
+  if (files.length !== 2) {
+    console.error('Usage: compare.ts base.json head.json [--threshold percent]');
+    process.exit(2);
+  }
+
+  const [base, head] = files.map(file => JSON.parse(readFileSync(file, 'utf-8')) as BenchmarkReport);
+  console.log(`base: ${base.meta.version} ${base.meta.ffmpeg} ${base.meta.date}`);
+  console.log(`head: ${head.meta.version} ${head.meta.ffmpeg} ${head.meta.date}\n`);
+  console.log(`${'result'.padEnd(48)} ${'fps'.padStart(8)} ${'p99'.padStart(8)}`);
+
+  const baseResults = new Map(base.results.map(r => [resultKey(r), r]));
+  const regressions: string[] = [];
+  for (const result of head.results) {
+    const key = resultKey(result);
+    const before = baseResults.get(key);
+    if (!before) {
+      console.log(`${key.padEnd(48)} ${'new'.padStart(8)}`);
+      continue;
+    }
+    baseResults.delete(key);
+    const fps = percentChange(before.fps, result.fps);
+    // p99 is only reported by the native layer; lower is better
+    const p99 = before.p99Ms !== undefined && result.p99Ms !== undefined
+      ? formatChange(percentChange(before.p99Ms, result.p99Ms)) : ''.padStart(8);
+    const flag = fps < -threshold ? '  REGRESSION' : '';
+    console.log(`${key.padEnd(48)} ${formatChange(fps)} ${p99}${flag}`);
+    if (flag) {
+      regressions.push(key);
+    }
+  }
+  for (const key of baseResults.keys()) {
+    console.log(`${key.padEnd(48)} ${'missing'.padStart(8)}`);
+  }
+
+  if (regressions.length > 0) {
+    console.log(`\n${regressions.length} result(s) slower by more than ${threshold}%`);
+    process.exit(1);
+  }
+}
+
+main();
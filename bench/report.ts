@@ -0,0 +1,41 @@
+/**
+ * Benchmark report format, shared by bench/run.ts and bench/compare.ts.
+ */
+
+export interface BenchmarkResult {
+  layer: 'native' | 'node';
+  stage: 'convert' | 'encode' | 'decode';
+  variant: string;  // Codec string, conversion, or fixture name
+  width: number;
+  height: number;
+  frames: number;
+  fps: number;
+  msPerFrame: number;
+  p50Ms?: number;
+  p99Ms?: number;
+  bytes?: number;
+  rssPeakMB?: number;
+  rssDeltaMB?: number;
+  eventLoopLagP99Ms?: number;
+  eventLoopLagMaxMs?: number;
+}
+
+export interface BenchmarkReport {
+  meta: {
+    version: string;
+    node: string;
+    ffmpeg: string;
+    platform: string;
+    arch: string;
+    cpu: string;
+    cores: number;
+    date: string;
+  };
+  results: BenchmarkResult[];
+  skipped: string[];
+}
+
+/** Identity of a result across runs. */
+export function resultKey(r: Pick<BenchmarkResult, 'layer' | 'stage' | 'variant' | 'width' | 'height'>): string {
+  return `${r.layer}/${r.stage}/${r.variant}/${r.width}x${r.height}`;
+}
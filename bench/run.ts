@@ -0,0 +1,275 @@
+#!/usr/bin/env npx tsx
+/**
+ * Benchmark Suite
+ *
+ * Two layers, run over a grid of resolutions (64x64 up to 4K) and codecs:
+ * - native: the addon's benchmark() entry point times conversion, encode
+ *   and decode in a tight C++ loop, without N-API or JS in the way.
+ * - node: the public VideoEncoder/VideoDecoder API end to end, measuring
+ *   fps, ms/frame, peak RSS and event-loop lag the way an application
+ *   would see them. The fixtures corpus is decoded here too.
+ *
+ * Results are written as JSON so runs can be diffed with bench/compare.ts.
+ *
+ * Run with: npm run bench -- [--quick] [--codecs vp8,avc1.640033] [--frames 60] [--out file.json]
+ */
+
+import { createRequire } from 'module';
+import { monitorEventLoopDelay } from 'perf_hooks';
+import { cpus, platform, arch } from 'os';
+import { mkdirSync, readFileSync, writeFileSync } from 'fs';
+import { dirname, join } from 'path';
+import { fileURLToPath } from 'url';
+
+import { EncodedVideoChunk, VideoDecoder, VideoEncoder, VideoFrame } from '../src/index.js';
+import { type BenchmarkReport, type BenchmarkResult, resultKey } from './report.js';
+
+const __dirname = dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+
+interface NativeBenchmarkResult {
+  stage: string;
+  iterations: number;
+  totalMs: number;
+  meanMs: number;
+  p50Ms: number;
+  p99Ms: number;
+  fps: number;
+  bytes: number;
+}
+
+const native: {
+  benchmark: (config: Record<string, unknown>) => NativeBenchmarkResult;
+  getFFmpegVersion: () => string;
+} = require('../build/Release/webcodecs_native.node');
+
+const RESOLUTIONS: Array<[number, number]> = [
+  [64, 64], [320, 240], [640, 360], [1280, 720], [1920, 1080], [3840, 2160],
+];
+// H.264 level 5.1 covers 4K; the others have no level limit here
+const CODECS = ['vp8', 'vp09.00.10.08', 'avc1.640033', 'av01.0.08M.08'];
+const CONVERSIONS: Array<{ variant: string; format: string; outputFormat: string; scale: number }> = [
+  { variant: 'RGBA>I420', format: 'RGBA', outputFormat: 'I420', scale: 1 },
+  { variant: 'I420>RGBA', format: 'I420', outputFormat: 'RGBA', scale: 1 },
+  { variant: 'I420>RGBA@1/4', format: 'I420', outputFormat: 'RGBA', scale: 4 },
+];
+
+function parseArgs(argv: string[]) {
+  const options = { quick: false, codecs: CODECS, frames: 0, out: join(__dirname, 'results', 'latest.json') };
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case '--quick': options.quick = true; break;
+      case '--codecs': options.codecs = argv[++i].split(','); break;
+      case '--frames': options.frames = Number(argv[++i]); break;
+      case '--out': options.out = argv[++i]; break;
+      default: throw new Error(`Unknown option: ${argv[i]}`);
+    }
+  }
+  return options;
+}
+
+/** Fewer frames for large pictures unless --frames says otherwise. */
+function framesFor(width: number, height: number, override: number): number {
+  if (override > 0) {
+    return override;
+  }
+  const pixels = width * height;
+  return pixels > 1920 * 1080 ? 10 : pixels > 1280 * 720 ? 30 : 60;
+}
+
+/** A moving diagonal gradient, like the native benchmark's test pattern. */
+function createI420Frame(width: number, height: number, index: number): Buffer {
+  const ySize = width * height;
+  const cw = width / 2;
+  const ch = height / 2;
+  const buffer = Buffer.alloc(ySize + cw * ch * 2);
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      buffer[y * width + x] = (x + y + index * 4) & 0xff;
+    }
+  }
+  for (let y = 0; y < ch; y++) {
+    for (let x = 0; x < cw; x++) {
+      buffer[ySize + y * cw + x] = 96 + ((x - index) & 63);
+      buffer[ySize + cw * ch + y * cw + x] = 96 + ((y + index) & 63);
+    }
+  }
+  return buffer;
+}
+
+/**
+ * Samples RSS and event-loop delay while `run` executes.
+ */
+async function measure(run: () => Promise<number>) {
+  const lag = monitorEventLoopDelay({ resolution: 1 });
+  const rssBefore = process.memoryUsage.rss();
+  let rssPeak = rssBefore;
+  const sampler = setInterval(() => {
+    rssPeak = Math.max(rssPeak, process.memoryUsage.rss());
+  }, 5);
+  lag.enable();
+  const start = performance.now();
+  const frames = await run();
+  const elapsed = performance.now() - start;
+  lag.disable();
+  clearInterval(sampler);
+  rssPeak = Math.max(rssPeak, process.memoryUsage.rss());
+  return {
+    frames,
+    fps: frames > 0 ? frames * 1000 / elapsed : 0,
+    msPerFrame: frames > 0 ? elapsed / frames : 0,
+    rssPeakMB: rssPeak / (1024 * 1024),
+    rssDeltaMB: (rssPeak - rssBefore) / (1024 * 1024),
+    eventLoopLagP99Ms: lag.percentile(99) / 1e6,
+    eventLoopLagMaxMs: lag.max / 1e6,
+  };
+}
+
+/** Encode through VideoEncoder, pacing on the dequeue event like a real producer. */
+async function encodeWithApi(codec: string, width: number, height: number, count: number, chunks: EncodedVideoChunk[]) {
+  const sources = [createI420Frame(width, height, 0), createI420Frame(width, height, 1)];
+  return measure(async () => {
+    let failure: Error | null = null;
+    const encoder = new VideoEncoder({
+      output: (chunk) => chunks.push(chunk as EncodedVideoChunk),
+      error: (e) => { failure = e; },
+    });
+    encoder.configure({ codec, width, height, bitrate: Math.max(200000, width * height * 2), framerate: 30 });
+    for (let i = 0; i < count; i++) {
+      while (encoder.encodeQueueSize >= 8) {
+        await new Promise(resolve => encoder.addEventListener('dequeue', resolve, { once: true }));
+      }
+      const frame = new VideoFrame(sources[i % 2], {
+        format: 'I420', codedWidth: width, codedHeight: height, timestamp: i * 33333,
+      });
+      encoder.encode(frame, { keyFrame: i === 0 });
+      frame.close();
+    }
+    await encoder.flush();
+    encoder.close();
+    if (failure) {
+      throw failure;
+    }
+    return count;
+  });
+}
+
+async function decodeWithApi(codec: string, chunks: EncodedVideoChunk[], repeat = 1) {
+  return measure(async () => {
+    let frames = 0;
+    let failure: Error | null = null;
+    const decoder = new VideoDecoder({
+      output: (frame) => { frames++; (frame as VideoFrame).close(); },
+      error: (e) => { failure = e; },
+    });
+    decoder.configure({ codec });
+    for (let r = 0; r < repeat; r++) {
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+    }
+    await decoder.flush();
+    decoder.close();
+    if (failure) {
+      throw failure;
+    }
+    return frames;
+  });
+}
+
+/** Frames of an IVF file (32-byte file header, 12-byte frame headers). */
+function readIvfFrames(path: string): Buffer[] {
+  const data = readFileSync(path);
+  const frames: Buffer[] = [];
+  for (let offset = 32; offset + 12 <= data.length;) {
+    const size = data.readUInt32LE(offset);
+    frames.push(data.subarray(offset + 12, offset + 12 + size));
+    offset += 12 + size;
+  }
+  return frames;
+}
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const resolutions = options.quick ? RESOLUTIONS.slice(0, 3) : RESOLUTIONS;
+  const pkg = JSON.parse(readFileSync(join(__dirname, '..', 'package.json'), 'utf-8'));
+  const report: BenchmarkReport = {
+    meta: {
+      version: pkg.version,
+      node: process.version,
+      ffmpeg: native.getFFmpegVersion(),
+      platform: platform(),
+      arch: arch(),
+      cpu: cpus()[0]?.model ?? 'unknown',
+      cores: cpus().length,
+      date: new Date().toISOString(),
+    },
+    results: [],
+    skipped: [],
+  };
+  const record = (result: BenchmarkResult) => {
+    report.results.push(result);
+    console.log(`${resultKey(result).padEnd(48)} ${result.fps.toFixed(1).padStart(9)} fps ${result.msPerFrame.toFixed(3).padStart(9)} ms/frame`);
+  };
+  const fromNative = (stage: BenchmarkResult['stage'], variant: string, width: number, height: number,
+                      r: NativeBenchmarkResult): BenchmarkResult => ({
+    layer: 'native', stage, variant, width, height, frames: r.iterations, fps: r.fps,
+    msPerFrame: r.meanMs, p50Ms: r.p50Ms, p99Ms: r.p99Ms, bytes: r.bytes,
+  });
+
+  for (const [width, height] of resolutions) {
+    const frames = framesFor(width, height, options.frames);
+
+    for (const c of CONVERSIONS) {
+      const r = native.benchmark({
+        stage: 'convert', width, height, frames: frames * 2, format: c.format, outputFormat: c.outputFormat,
+        outputWidth: Math.max(2, Math.round(width / c.scale)), outputHeight: Math.max(2, Math.round(height / c.scale)),
+      });
+      record(fromNative('convert', c.variant, width, height, r));
+    }
+
+    for (const codec of options.codecs) {
+      const key = `${codec}/${width}x${height}`;
+      const support = await VideoEncoder.isConfigSupported({ codec, width, height });
+      if (!support.supported) {
+        report.skipped.push(key);
+        continue;
+      }
+      try {
+        for (const stage of ['encode', 'decode'] as const) {
+          record(fromNative(stage, codec, width, height, native.benchmark({ stage, codec, width, height, frames })));
+        }
+        const chunks: EncodedVideoChunk[] = [];
+        const encoded = await encodeWithApi(codec, width, height, frames, chunks);
+        record({ layer: 'node', stage: 'encode', variant: codec, width, height,
+                 bytes: chunks.reduce((sum, chunk) => sum + chunk.byteLength, 0), ...encoded });
+        record({ layer: 'node', stage: 'decode', variant: codec, width, height, ...(await decodeWithApi(codec, chunks)) });
+      } catch (e) {
+        report.skipped.push(`${key}: ${(e as Error).message}`);
+      }
+    }
+  }
+
+  // The fixtures are single keyframes, so each is decoded many times over
+  const manifest: Record<string, { codec: string; width: number; height: number; file: string }> =
+    JSON.parse(readFileSync(join(__dirname, '..', 'fixtures', 'manifest.json'), 'utf-8'));
+  for (const [name, fixture] of Object.entries(manifest)) {
+    const chunks = readIvfFrames(join(__dirname, '..', 'fixtures', fixture.file)).map((data, i) =>
+      new EncodedVideoChunk({ type: 'key', timestamp: i, data }));
+    const codec = fixture.codec === 'vp9' ? 'vp09.00.10.08' : fixture.codec;
+    record({ layer: 'node', stage: 'decode', variant: name, width: fixture.width, height: fixture.height,
+             ...(await decodeWithApi(codec, chunks, 200)) });
+  }
+
+  mkdirSync(dirname(options.out), { recursive: true });
+  writeFileSync(options.out, JSON.stringify(report, null, 2));
+  console.log(`\n${report.results.length} results written to ${options.out}`);
+  if (report.skipped.length > 0) {
+    console.log(`Skipped: ${report.skipped.join(', ')}`);
+  }
+}
+
+main().catch((e) => {
+  console.error(e);
+  process.exit(1);
+});
@@ -3,7 +3,39 @@
     {
       "target_name": "webcodecs_native",
       "sources": [
-        "src/native/addon.cc"
+        "src/native/adopted_buffer.cc",
+        "src/native/addon.cc",
+        "src/native/addon_data.cc",
+        "src/native/audio_codec_registry.cc",
+        "src/native/audio_decoder.cc",
+        "src/native/audio_encoder.cc",
+        "src/native/audio_format.cc",
+        "src/native/audio_resampler.cc",
+        "src/native/batch_encode.cc",
+        "src/native/benchmark.cc",
+        "src/native/buffer_pool.cc",
+        "src/native/byte_stream.cc",
+        "src/native/codec_capabilities.cc",
+        "src/native/codec_registry.cc",
+        "src/native/codec_scheduler.cc",
+        "src/native/command_queue.cc",
+        "src/native/demuxer.cc",
+        "src/native/external_buffer.cc",
+        "src/native/frame_pool.cc",
+        "src/native/frame_transform.cc",
+        "src/native/hw_device.cc",
+        "src/native/muxer.cc",
+        "src/native/packet_pool.cc",
+        "src/native/pending_flushes.cc",
+        "src/native/pixel_convert.cc",
+        "src/native/pixel_format.cc",
+        "src/native/scaler_cache.cc",
+        "src/native/session_stats.cc",
+        "src/native/video_decoder.cc",
+        "src/native/video_encoder.cc",
+        "src/native/video_frame.cc",
+        "src/native/video_pipeline.cc",
+        "src/native/worker_thread.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -15,11 +47,12 @@
       "cflags_cc!": ["-fno-exceptions"],
       "cflags_cc": [
         "-std=c++17",
+        "-pthread",
         "-fPIC",
-        "<!@(pkg-config --cflags libavcodec libavformat libavutil libswscale)"
+        "<!@(pkg-config --cflags libavcodec libavformat libavutil libswresample libswscale)"
       ],
       "libraries": [
-        "<!@(pkg-config --libs libavcodec libavformat libavutil libswscale)"
+        "<!@(pkg-config --libs libavcodec libavformat libavutil libswresample libswscale)"
       ],
       "defines": [
         "NAPI_VERSION=8",
@@ -28,7 +61,7 @@
       "conditions": [
         ["OS=='linux'", {
           "cflags_cc": ["-fPIC"],
-          "ldflags": ["-Wl,-rpath,'$$ORIGIN'"]
+          "ldflags": ["-pthread", "-Wl,-rpath,'$$ORIGIN'"]
         }]
       ]
     }
@@ -20,29 +20,68 @@ const WebCodecsDOMException = typeof DOMException !== 'undefined'
 
 // Types for WebCodecs API
 type CodecState = 'unconfigured' | 'configured' | 'closed';
+type HardwareAcceleration = 'no-preference' | 'prefer-hardware' | 'prefer-software';
+
+type LatencyMode = 'quality' | 'realtime';
+
+type BitrateMode = 'constant' | 'variable' | 'quantizer';
 
 interface VideoEncoderConfig {
   codec: string;
   width?: number;
   height?: number;
   bitrate?: number;
+  bitrateMode?: BitrateMode;
   framerate?: number;
+  hardwareAcceleration?: HardwareAcceleration;
+  latencyMode?: LatencyMode;
+  /** Only 'L1T1' (one spatial and one temporal layer); other modes are unsupported. */
+  scalabilityMode?: string;
+  /** Non-standard: encoder thread count; by default picked from the frame size. */
+  threads?: number;
+  /**
+   * Non-standard: queue depth past which realtime mode drops frames
+   * (default 16). encode() never blocks; watch encodeQueueSize instead.
+   */
+  maxQueueDepth?: number;
+}
+
+/** Per-frame quantizers, used when bitrateMode is 'quantizer'. */
+interface VideoEncoderEncodeOptions {
+  keyFrame?: boolean;
+  vp8?: { quantizer?: number };
+  vp9?: { quantizer?: number };
+  av1?: { quantizer?: number };
+  avc?: { quantizer?: number };
 }
 
 interface VideoDecoderConfig {
   codec: string;
+  codedWidth?: number;
+  codedHeight?: number;
+  description?: BufferSource;
+  hardwareAcceleration?: HardwareAcceleration;
+  /**
+   * Non-standard: for scrubbing and previews. Delta chunks are dropped
+   * without being decoded and keyframes skip the loop filter.
+   */
+  keyframesOnly?: boolean;
+  /** Non-standard: decode at 1/2^lowres size (0-3), where the codec supports it. */
+  lowres?: number;
 }
 
 interface AudioEncoderConfig {
   codec: string;
   sampleRate?: number;
   numberOfChannels?: number;
+  bitrate?: number;
 }
 
 interface AudioDecoderConfig {
   codec: string;
   sampleRate?: number;
   numberOfChannels?: number;
+  description?: BufferSource;
 }
 
 interface EncoderInit {
@@ -92,15 +131,216 @@ interface AudioDataInit {
 }
 
 // List of supported codecs
-const SUPPORTED_VIDEO_CODECS = ['vp8', 'vp09', 'avc1'];
-const SUPPORTED_AUDIO_CODECS = ['opus', 'mp4a'];
+const SUPPORTED_VIDEO_CODECS = ['vp8', 'vp09', 'av01', 'avc1'];
+const SUPPORTED_AUDIO_CODECS = ['opus', 'mp4a', 'flac'];
 
 // Try to load native addon
 import { createRequire } from 'module';
 import { fileURLToPath } from 'url';
 import { dirname, join } from 'path';
 
+interface NativeEncodedPacket {
+  data: Buffer;
+  isKeyframe: boolean;
+  size: number;
+  timestamp?: number;
+  duration?: number;
+}
+
+/** Per-session buffer pool counters (see src/native/buffer_pool.h). */
+interface NativePoolStats {
+  pooledBytes: number;
+  limit: number;
+  allocations: number;
+  reuses: number;
+  overflows: number;
+}
+
+/** Latency of one pipeline stage; buckets[i] counts samples <= 2^i microseconds. */
+export interface CodecStageStats {
+  count: number;
+  sumUs: number;
+  maxUs: number;
+  p50Us: number;
+  p99Us: number;
+  buckets: number[];
+}
+
+/** Counters of a native codec session, from VideoEncoder/VideoDecoder getStats(). */
+export interface CodecSessionStats {
+  framesIn: number;
+  framesOut: number;
+  bytesIn: number;
+  bytesOut: number;
+  errors: number;
+  droppedFrames: number;
+  queueDepth: number;
+  maxQueueDepth: number;
+  stages: Record<'queue' | 'open' | 'copy' | 'convert' | 'send' | 'receive', CodecStageStats>;
+}
+
+interface NativeVideoFrameHandle {
+  readonly format: string | null;
+  readonly codedWidth: number;
+  readonly codedHeight: number;
+  copyTo(destination: Uint8Array, options?: VideoFrameCopyToOptions): PlaneLayout[];
+  clone(): NativeVideoFrameHandle;
+  hash(algorithm?: string): string[];
+  share(): number;
+  close(): void;
+}
+
+interface NativeVideoEncoderHandle {
+  readonly hardwareAccelerated: boolean;
+  readonly poolStats: NativePoolStats;
+  readonly encodeQueueSize: number;
+  readonly droppedFrames: number;
+  getStats(): CodecSessionStats;
+  encode(data: Buffer | NativeVideoFrameHandle, options: { timestamp: number; duration?: number; keyFrame?: boolean; format?: string; quantizer?: number }): boolean;
+  flush(): Promise<void>;
+  reconfigure(options: { bitrate: number }): void;
+  setMuxer(muxer: NativeMuxerHandle): void;
+  close(): void;
+}
+
+interface NativeMuxerHandle {
+  finish(done?: () => void): void;
+  close(): void;
+}
+
+interface NativeDecodedFrame {
+  frame: NativeVideoFrameHandle;
+  width: number;
+  height: number;
+  format: string | null;
+  timestamp?: number;
+  duration?: number;
+}
+
+interface NativeVideoDecoderHandle {
+  readonly hardwareAccelerated: boolean;
+  readonly lowres: number;
+  readonly poolStats: NativePoolStats;
+  getStats(): CodecSessionStats;
+  decode(data: Buffer, options: { timestamp: number; duration?: number; keyFrame?: boolean }): boolean;
+  flush(): Promise<void>;
+  setPipeline(pipeline: NativeVideoPipelineHandle): void;
+  close(): void;
+}
+
+interface NativeVideoPipelineHandle {
+  encode(frame: NativeVideoFrameHandle, options: { timestamp: number; duration?: number; keyFrame?: boolean }): void;
+}
+
+interface NativeAudioEncoderHandle {
+  readonly sampleRate: number;
+  readonly description: Buffer | undefined;
+  readonly poolStats: NativePoolStats;
+  encode(data: Buffer, options: { format: string; sampleRate: number; numberOfFrames: number; numberOfChannels: number; timestamp: number }): void;
+  flush(): Promise<void>;
+  close(): void;
+}
+
+interface NativeDecodedAudio {
+  data: Buffer;
+  format: AudioDataInit['format'];
+  sampleRate: number;
+  numberOfFrames: number;
+  numberOfChannels: number;
+  timestamp: number;
+}
+
+interface NativeAudioDecoderHandle {
+  readonly poolStats: NativePoolStats;
+  decode(data: Buffer, options: { timestamp: number }): void;
+  flush(): Promise<void>;
+  close(): void;
+}
+
+/** The demuxed video track, as reported before start(). */
+interface NativeDemuxedTrack {
+  codec: string;
+  codedWidth: number;
+  codedHeight: number;
+  description?: Buffer;
+  duration?: number;
+}
+
+interface NativeDemuxedChunk {
+  data: Buffer;
+  type: 'key' | 'delta';
+  timestamp: number;
+  duration?: number;
+}
+
+interface NativeDemuxerHandle {
+  write(data: Uint8Array): void;
+  end(): void;
+  start(decoder?: NativeVideoDecoderHandle): void;
+  close(): void;
+}
+
+interface NativeDemuxerCallbacks {
+  config: (track: NativeDemuxedTrack) => void;
+  chunk: (chunk: NativeDemuxedChunk) => void;
+  end: () => void;
+  error: (error: Error) => void;
+}
+
+/** Thread budget of the pool all native codec sessions share; 0 means one per core. */
+export interface CodecSchedulerOptions {
+  threads?: number;
+  codecThreads?: number;
+}
+
+export interface CodecSchedulerStats {
+  threads: number;
+  codecThreads: number;
+  sessions: number;
+  ready: number;
+  executed: number;
+  steals: number;
+}
+
+interface NativeCodecCallbacks<T> {
+  output: (result: T) => void;
+  error: (error: Error) => void;
+  dequeue: () => void;
+}
+
 let nativeAddon: {
+  NativeAudioDecoder: new (config: { codec: string; sampleRate: number; numberOfChannels: number; description?: Uint8Array; poolMemoryLimit?: number }, callbacks: NativeCodecCallbacks<NativeDecodedAudio>) => NativeAudioDecoderHandle;
+  NativeAudioEncoder: new (config: { codec: string; sampleRate: number; numberOfChannels: number; bitrate?: number; poolMemoryLimit?: number }, callbacks: NativeCodecCallbacks<NativeEncodedPacket>) => NativeAudioEncoderHandle;
+  NativeMuxer: new (target: { format: string; path?: string; fd?: number }, callbacks?: { data: (chunk: Buffer) => void }) => NativeMuxerHandle;
+  NativeDemuxer: new (source: { path?: string }, callbacks: NativeDemuxerCallbacks) => NativeDemuxerHandle;
+  NativeVideoDecoder: new (config: { codec: string; description?: Uint8Array; hardwareAcceleration?: HardwareAcceleration; keyframesOnly?: boolean; lowres?: number; poolMemoryLimit?: number }, callbacks: NativeCodecCallbacks<NativeDecodedFrame>) => NativeVideoDecoderHandle;
+  NativeVideoEncoder: new (config: { codec?: string; width: number; height: number; bitrate?: number; bitrateMode?: BitrateMode; framerate?: number; gopSize?: number; hardwareAcceleration?: HardwareAcceleration; latencyMode?: LatencyMode; threads?: number; maxQueueDepth?: number; poolMemoryLimit?: number }, callbacks: NativeCodecCallbacks<NativeEncodedPacket>) => NativeVideoEncoderHandle;
+  NativeVideoFrame: {
+    new (data: Uint8Array, init: { format: string; codedWidth: number; codedHeight: number; layout?: PlaneLayout[]; adopt?: boolean }): NativeVideoFrameHandle;
+    fromShared(token: number): NativeVideoFrameHandle;
+  };
+  NativeVideoPipeline: new (renditions: Array<{ encoder: NativeVideoEncoderHandle; crop?: VideoFrameRect; rotation?: number }>) => NativeVideoPipelineHandle;
+  convertFrame: (
+    src: Uint8Array, srcInit: { format: string; codedWidth: number; codedHeight: number; layout?: PlaneLayout[] },
+    dest: Uint8Array, destInit: { format: string; layout?: PlaneLayout[] },
+  ) => PlaneLayout[];
+  frameAllocationSize: (format: string, width: number, height: number) => number;
+  validateFrameLayout: (
+    byteLength: number, init: { format: string; codedWidth: number; codedHeight: number; layout?: PlaneLayout[] },
+  ) => void;
+  getScalerCacheStats: () => { hits: number; misses: number; idle: number };
+  isVideoConfigSupported: (
+    config: { codec: string; width?: number; height?: number; hardwareAcceleration?: HardwareAcceleration },
+    direction: 'encoder' | 'decoder',
+  ) => boolean;
+  configureScheduler: (options: CodecSchedulerOptions) => CodecSchedulerStats;
+  getSchedulerStats: () => CodecSchedulerStats;
+  encodeFrame: (data: Buffer, options: { codec: string; width: number; height: number; bitrate?: number; format?: string }) => { data: Buffer; isKeyframe: boolean };
+  decodeFrame: (data: Buffer, options: { codec: string }) => { width: number; height: number; data: Buffer; firstPixelR: number; firstPixelG: number; firstPixelB: number };
+  encodeBatch: (
+    frames: NativeVideoFrameHandle[] | Buffer,
+    config: { codec: string; width: number; height: number; bitrate?: number; framerate?: number; gopSize?: number; latencyMode?: LatencyMode; threads?: number; format?: string; offsets?: number[]; timestamps?: number[] },
+  ) => Promise<{ data: Buffer; index: Float64Array; count: number }>;
   encodeVP8Frame: (data: Buffer, options: { width: number; height: number; bitrate: number; format?: string }) => { data: Buffer; isKeyframe: boolean };
   decodeVP8Frame: (data: Buffer) => { width: number; height: number; data: Buffer; firstPixelR: number; firstPixelG: number; firstPixelB: number };
   getFFmpegVersion: () => string;
@@ -123,18 +363,61 @@ function isCodecSupported(codec: string, supportedPrefixes: string[]): boolean {
   return supportedPrefixes.some(prefix => codecLower.startsWith(prefix));
 }
 
+/**
+ * The memory behind a Buffer the addon allocated (or wrapped from FFmpeg)
+ * for one result alone, taken over without a copy.
+ */
+function adoptNativeBytes(data: Buffer): ArrayBuffer {
+  return data.byteOffset === 0 && data.byteLength === data.buffer.byteLength
+    ? data.buffer as ArrayBuffer
+    : data.buffer.slice(data.byteOffset, data.byteOffset + data.byteLength) as ArrayBuffer;
+}
+
+/** True if `next` only changes the bitrate of `current`, which an open session can take. */
+function isBitrateChange(current: VideoEncoderConfig, next: VideoEncoderConfig): boolean {
+  const keys = new Set([...Object.keys(current), ...Object.keys(next)] as Array<keyof VideoEncoderConfig>);
+  keys.delete('bitrate');
+  return next.bitrate !== undefined && [...keys].every(key => current[key] === next[key]);
+}
+
+/**
+ * Sessions open a single layer, so L1T1 (or no mode) is the only scalability
+ * mode they can honour; L1T2/L1T3 would need temporal layering per codec.
+ */
+function isScalabilityModeSupported(mode: string | undefined): boolean {
+  return mode === undefined || mode === 'L1T1';
+}
+
+/** The quantizer `options` carries for the codec of `codec`, if any. */
+function frameQuantizer(codec: string, options?: VideoEncoderEncodeOptions): number | undefined {
+  const prefix = codec.split('.')[0].toLowerCase();
+  const entry = prefix === 'vp8' ? options?.vp8
+    : prefix === 'vp09' ? options?.vp9
+    : prefix === 'av01' ? options?.av1
+    : prefix === 'avc1' || prefix === 'avc3' ? options?.avc
+    : undefined;
+  return entry?.quantizer;
+}
+
 /**
  * VideoEncoder polyfill for Node.js
  */
-export class VideoEncoder {
+export class VideoEncoder extends EventTarget {
+  ondequeue: ((event: Event) => void) | null = null;
   private _state: CodecState = 'unconfigured';
   private _encodeQueueSize: number = 0;
+  private _dequeueScheduled: boolean = false;
+  private _droppedFrames: number = 0;
   private _output: (chunk: unknown, metadata?: unknown) => void;
   private _error: (error: Error) => void;
   private _config: VideoEncoderConfig | null = null;
-  private _pendingEncodes: Array<{ frameData: Uint8Array; width: number; height: number; timestamp: number; duration: number | null; options?: { keyFrame?: boolean }; copyPromise?: Promise<unknown> }> = [];
+  private _native: NativeVideoEncoderHandle | null = null;
+  private _nativeWidth: number = 0;
+  private _nativeHeight: number = 0;
+  private _pendingFlushes: Array<{ resolve: () => void; reject: (error: Error) => void }> = [];
 
   constructor(init: EncoderInit) {
+    super();
     this._output = init.output;
     this._error = init.error;
   }
@@ -147,9 +430,25 @@ export class VideoEncoder {
     return this._encodeQueueSize;
   }
 
+  /** Non-standard: frames dropped because a realtime encoder fell behind. */
+  get droppedFrames(): number {
+    return this._droppedFrames;
+  }
+
+  /** Non-standard: counters and stage latencies of the native session, or null if none is open. */
+  getStats(): CodecSessionStats | null {
+    return this._native?.getStats() ?? null;
+  }
+
   static async isConfigSupported(config: VideoEncoderConfig): Promise<VideoEncoderSupport> {
-    const supported = isCodecSupported(config.codec, SUPPORTED_VIDEO_CODECS);
-    return { supported, config: supported ? config : undefined };
+    if (!isScalabilityModeSupported(config.scalabilityMode)) {
+      return { supported: false, config: undefined };
+    }
+    // The addon answers from a capability table built once per process
+    const supported = nativeAddon
+      ? nativeAddon.isVideoConfigSupported(config, 'encoder')
+      : isCodecSupported(config.codec, SUPPORTED_VIDEO_CODECS);
+    return { supported, config: supported ? { ...config } : undefined };
   }
 
   configure(config: VideoEncoderConfig): void {
@@ -161,37 +460,71 @@ export class VideoEncoder {
       this._state = 'closed';
       return;
     }
+    if (!isScalabilityModeSupported(config.scalabilityMode)) {
+      this._closeNative();
+      this._error(new WebCodecsDOMException(`Unsupported scalabilityMode: ${config.scalabilityMode}`, 'NotSupportedError'));
+      this._state = 'closed';
+      return;
+    }
+    if (this._native && this._config && isBitrateChange(this._config, config)) {
+      // Applied in order with the frames already queued, without a new
+      // session; quantizer mode has no bitrate to change
+      try {
+        if (config.bitrateMode !== 'quantizer') {
+          this._native.reconfigure({ bitrate: config.bitrate! });
+        }
+        this._config = config;
+      } catch (e) {
+        this._error(e as Error);
+      }
+      return;
+    }
+    this._closeNative();
     this._config = config;
     this._state = 'configured';
+    if (nativeAddon && config.width && config.height) {
+      this._openNative(config.width, config.height);
+    }
   }
 
-  encode(frame: VideoFrame, options?: { keyFrame?: boolean }): void {
+  encode(frame: VideoFrame, options?: VideoEncoderEncodeOptions): void {
     if (this._state !== 'configured') {
       throw new WebCodecsDOMException('Encoder is not configured', 'InvalidStateError');
     }
     
-    // Copy frame data immediately (per WebCodecs spec)
-    const width = frame.codedWidth;
-    const height = frame.codedHeight;
-    const i420Size = frame.allocationSize({ format: 'I420' });
-    const frameData = new Uint8Array(i420Size);
-    
-    // Queue the encode with copied data
-    this._encodeQueueSize++;
+    const native = this._native ?? this._openNative(frame.codedWidth, frame.codedHeight);
+    if (!native) {
+      return;
+    }
     
-    // Handle async copyTo - queue the promise
-    const copyPromise = frame.copyTo(frameData, { format: 'I420' });
+    const encodeOptions = {
+      timestamp: frame.timestamp,
+      duration: frame.duration ?? undefined,
+      keyFrame: options?.keyFrame ?? false,
+      quantizer: this._config?.bitrateMode === 'quantizer' ? frameQuantizer(this._config.codec, options) : undefined,
+    };
     
-    // Store the pending encode with the copy promise
-    this._pendingEncodes.push({ 
-      frameData, 
-      width, 
-      height, 
-      timestamp: frame.timestamp, 
-      duration: frame.duration, 
-      options,
-      copyPromise
-    });
+    try {
+      let queued: boolean;
+      if (frame._native) {
+        // Native frames are handed over by reference; the encoder holds its
+        // own AVFrame ref, so the caller may close the frame right away.
+        queued = native.encode(frame._native, encodeOptions);
+      } else {
+        // Copy frame data immediately (per WebCodecs spec); the native session
+        // takes its own copy and encodes it on the worker thread.
+        const frameData = Buffer.alloc(frame.allocationSize({ format: 'I420' }));
+        frame._copyToSync(frameData, { format: 'I420' });
+        queued = native.encode(frameData, { ...encodeOptions, format: 'I420' });
+      }
+      if (queued) {
+        this._encodeQueueSize++;
+      } else {
+        this._droppedFrames++;
+      }
+    } catch (e) {
+      this._error(e as Error);
+    }
   }
 
   async flush(): Promise<void> {
@@ -204,97 +537,125 @@ export class VideoEncoder {
       return;
     }
     
-    // Process all pending encodes
-    for (const { frameData, width, height, timestamp, duration, copyPromise } of this._pendingEncodes) {
-      // Wait for copy to complete if needed
-      if (copyPromise) {
-        await copyPromise;
-      }
-      try {
-        // Encode using native addon - pass I420 directly
-        const result = nativeAddon.encodeVP8Frame(Buffer.from(frameData), {
-          width,
-          height,
-          bitrate: this._config?.bitrate ?? 500000,
-          format: 'I420',
-        });
-        
-        // Create EncodedVideoChunk from result
-        const chunk = new EncodedVideoChunk({
-          type: result.isKeyframe ? 'key' : 'delta',
-          timestamp: timestamp,
-          duration: duration ?? undefined,
-          data: new Uint8Array(result.data).buffer,
-        });
-        
-        // Call output callback with chunk and metadata
-        const metadata = {
-          decoderConfig: {
-            codec: this._config?.codec ?? 'vp8',
-            codedWidth: width,
-            codedHeight: height,
-          },
-        };
-        
-        this._output(chunk, metadata);
-      } catch (e) {
-        this._error(e as Error);
-      } finally {
-        this._encodeQueueSize--;
-      }
+    const native = this._native;
+    if (!native) {
+      return;
     }
     
-    this._pendingEncodes = [];
+    await new Promise<void>((resolve, reject) => {
+      const pending = { resolve, reject };
+      this._pendingFlushes.push(pending);
+      native.flush().then(() => {
+        this._pendingFlushes = this._pendingFlushes.filter(p => p !== pending);
+        resolve();
+      }, reject);
+    });
   }
 
   reset(): void {
     if (this._state === 'closed') {
       throw new WebCodecsDOMException('Cannot reset a closed encoder', 'InvalidStateError');
     }
+    this._closeNative();
     this._state = 'unconfigured';
-    this._encodeQueueSize = 0;
-    this._pendingEncodes = [];
     this._config = null;
   }
 
   close(): void {
+    this._closeNative();
     this._state = 'closed';
-    this._pendingEncodes = [];
   }
-}
 
-// Helper: Convert I420 (YUV420P) to RGB24
-function i420ToRgb24(i420: Uint8Array, width: number, height: number): Uint8Array {
-  const ySize = width * height;
-  const uvSize = (width / 2) * (height / 2);
-  const rgb = new Uint8Array(width * height * 3);
-  
-  for (let j = 0; j < height; j++) {
-    for (let i = 0; i < width; i++) {
-      const yIndex = j * width + i;
-      const uvIndex = Math.floor(j / 2) * (width / 2) + Math.floor(i / 2);
-      
-      const y = i420[yIndex];
-      const u = i420[ySize + uvIndex];
-      const v = i420[ySize + uvSize + uvIndex];
-      
-      // YUV to RGB conversion
-      const c = y - 16;
-      const d = u - 128;
-      const e = v - 128;
-      
-      const r = Math.max(0, Math.min(255, Math.round((298 * c + 409 * e + 128) >> 8)));
-      const g = Math.max(0, Math.min(255, Math.round((298 * c - 100 * d - 208 * e + 128) >> 8)));
-      const b = Math.max(0, Math.min(255, Math.round((298 * c + 516 * d + 128) >> 8)));
-      
-      const rgbIndex = (j * width + i) * 3;
-      rgb[rgbIndex] = r;
-      rgb[rgbIndex + 1] = g;
-      rgb[rgbIndex + 2] = b;
+  /**
+   * The native session, for VideoMuxer to take packets from directly.
+   * Opens it if the config carries a size.
+   * @internal
+   */
+  _nativeHandle(): NativeVideoEncoderHandle | null {
+    if (this._state !== 'configured') {
+      return null;
     }
+    if (!this._native && this._config?.width && this._config?.height) {
+      this._openNative(this._config.width, this._config.height);
+    }
+    return this._native;
+  }
+
+  private _openNative(width: number, height: number): NativeVideoEncoderHandle | null {
+    // A missing addon is reported once, by flush()
+    if (!nativeAddon) {
+      return null;
+    }
+    try {
+      this._native = new nativeAddon.NativeVideoEncoder({
+        codec: this._config?.codec,
+        width,
+        height,
+        bitrate: this._config?.bitrate ?? 500000,
+        bitrateMode: this._config?.bitrateMode,
+        framerate: this._config?.framerate ?? 30,
+        hardwareAcceleration: this._config?.hardwareAcceleration,
+        latencyMode: this._config?.latencyMode,
+        threads: this._config?.threads,
+        maxQueueDepth: this._config?.maxQueueDepth,
+      }, {
+        output: (packet) => this._emitPacket(packet),
+        error: (error) => this._error(error),
+        dequeue: () => {
+          this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
+          this._scheduleDequeueEvent();
+        },
+      });
+      this._nativeWidth = width;
+      this._nativeHeight = height;
+    } catch (e) {
+      this._error(e as Error);
+      this._native = null;
+    }
+    return this._native;
+  }
+
+  private _closeNative(): void {
+    if (this._native) {
+      this._native.close();
+      this._native = null;
+    }
+    this._encodeQueueSize = 0;
+    const flushes = this._pendingFlushes;
+    this._pendingFlushes = [];
+    for (const { reject } of flushes) {
+      reject(new WebCodecsDOMException('Encoder was reset or closed', 'AbortError'));
+    }
+  }
+
+  /** Fire 'dequeue' once for all queue decreases in the same task, per spec. */
+  private _scheduleDequeueEvent(): void {
+    if (this._dequeueScheduled) {
+      return;
+    }
+    this._dequeueScheduled = true;
+    setImmediate(() => {
+      this._dequeueScheduled = false;
+      const event = new Event('dequeue');
+      this.ondequeue?.(event);
+      this.dispatchEvent(event);
+    });
+  }
+
+  private _emitPacket(packet: NativeEncodedPacket): void {
+    const chunk = EncodedVideoChunk._fromNative(packet);
+    
+    // Call output callback with chunk and metadata
+    const metadata = {
+      decoderConfig: {
+        codec: this._config?.codec ?? 'vp8',
+        codedWidth: this._nativeWidth,
+        codedHeight: this._nativeHeight,
+      },
+    };
+    
+    this._output(chunk, metadata);
   }
-  
-  return rgb;
 }
 
 /**
@@ -306,7 +667,8 @@ export class VideoDecoder {
   private _output: (frame: unknown) => void;
   private _error: (error: Error) => void;
   private _config: VideoDecoderConfig | null = null;
-  private _pendingDecodes: EncodedVideoChunk[] = [];
+  private _native: NativeVideoDecoderHandle | null = null;
+  private _pendingFlushes: Array<{ resolve: () => void; reject: (error: Error) => void }> = [];
 
   constructor(init: DecoderInit) {
     this._output = init.output;
@@ -321,9 +683,21 @@ export class VideoDecoder {
     return this._decodeQueueSize;
   }
 
+  /** Non-standard: counters and stage latencies of the native session, or null if none is open. */
+  getStats(): CodecSessionStats | null {
+    return this._native?.getStats() ?? null;
+  }
+
   static async isConfigSupported(config: VideoDecoderConfig): Promise<VideoDecoderSupport> {
-    const supported = isCodecSupported(config.codec, SUPPORTED_VIDEO_CODECS);
-    return { supported, config: supported ? config : undefined };
+    const supported = nativeAddon
+      ? nativeAddon.isVideoConfigSupported({
+        codec: config.codec,
+        width: config.codedWidth,
+        height: config.codedHeight,
+        hardwareAcceleration: config.hardwareAcceleration,
+      }, 'decoder')
+      : isCodecSupported(config.codec, SUPPORTED_VIDEO_CODECS);
+    return { supported, config: supported ? { ...config } : undefined };
   }
 
   configure(config: VideoDecoderConfig): void {
@@ -335,18 +709,61 @@ export class VideoDecoder {
       this._state = 'closed';
       return;
     }
+    this._closeNative();
     this._config = config;
     this._state = 'configured';
+    if (nativeAddon) {
+      try {
+        const description = config.description === undefined ? undefined
+          : ArrayBuffer.isView(config.description)
+            ? new Uint8Array(config.description.buffer, config.description.byteOffset, config.description.byteLength)
+            : new Uint8Array(config.description);
+        this._native = new nativeAddon.NativeVideoDecoder({
+          codec: config.codec,
+          description,
+          hardwareAcceleration: config.hardwareAcceleration,
+          keyframesOnly: config.keyframesOnly,
+          lowres: config.lowres,
+        }, {
+          output: (result) => this._emitFrame(result),
+          error: (error) => this._error(error),
+          dequeue: () => {
+            this._decodeQueueSize = Math.max(0, this._decodeQueueSize - 1);
+          },
+        });
+      } catch (e) {
+        this._error(e as Error);
+      }
+    }
   }
 
   decode(chunk: EncodedVideoChunk): void {
     if (this._state !== 'configured') {
       throw new WebCodecsDOMException('Decoder is not configured', 'InvalidStateError');
     }
+    if (!this._native) {
+      return;
+    }
+    if (this._config?.keyframesOnly && chunk.type !== 'key') {
+      return;
+    }
+    
+    // The native session copies the chunk before returning
+    const encodedBuffer = Buffer.alloc(chunk.byteLength);
+    chunk.copyTo(encodedBuffer);
     
-    // Queue the decode
-    this._decodeQueueSize++;
-    this._pendingDecodes.push(chunk);
+    try {
+      const queued = this._native.decode(encodedBuffer, {
+        timestamp: chunk.timestamp,
+        duration: chunk.duration ?? undefined,
+        keyFrame: chunk.type === 'key',
+      });
+      if (queued) {
+        this._decodeQueueSize++;
+      }
+    } catch (e) {
+      this._error(e as Error);
+    }
   }
 
   async flush(): Promise<void> {
@@ -359,88 +776,317 @@ export class VideoDecoder {
       return;
     }
     
-    // Process all pending decodes
-    for (const chunk of this._pendingDecodes) {
-      try {
-        // Get encoded data from chunk
-        const encodedBuffer = new Uint8Array(chunk.byteLength);
-        chunk.copyTo(encodedBuffer);
-        
-        // Decode using native addon
-        const result = nativeAddon.decodeVP8Frame(Buffer.from(encodedBuffer));
-        
-        // Convert RGB24 result to I420 for VideoFrame
-        const rgb24 = new Uint8Array(result.data);
-        const i420 = rgb24ToI420(rgb24, result.width, result.height);
-        
-        // Create VideoFrame from decoded data
-        const frame = new VideoFrame(i420.buffer as ArrayBuffer, {
-          format: 'I420',
-          codedWidth: result.width,
-          codedHeight: result.height,
-          timestamp: chunk.timestamp,
-          duration: chunk.duration ?? undefined,
-        });
-        
-        this._output(frame);
-      } catch (e) {
-        this._error(e as Error);
-      } finally {
-        this._decodeQueueSize--;
-      }
+    const native = this._native;
+    if (!native) {
+      return;
     }
     
-    this._pendingDecodes = [];
+    await new Promise<void>((resolve, reject) => {
+      const pending = { resolve, reject };
+      this._pendingFlushes.push(pending);
+      native.flush().then(() => {
+        this._pendingFlushes = this._pendingFlushes.filter(p => p !== pending);
+        resolve();
+      }, reject);
+    });
   }
 
   reset(): void {
     if (this._state === 'closed') {
       throw new WebCodecsDOMException('Cannot reset a closed decoder', 'InvalidStateError');
     }
+    this._closeNative();
     this._state = 'unconfigured';
-    this._decodeQueueSize = 0;
-    this._pendingDecodes = [];
     this._config = null;
   }
 
   close(): void {
+    this._closeNative();
     this._state = 'closed';
-    this._pendingDecodes = [];
-  }
-}
-
-// Helper: Convert RGB24 to I420 (YUV420P)
-function rgb24ToI420(rgb: Uint8Array, width: number, height: number): Uint8Array {
-  const ySize = width * height;
-  const uvSize = (width / 2) * (height / 2);
-  const i420 = new Uint8Array(ySize + uvSize * 2);
-  
-  for (let j = 0; j < height; j++) {
-    for (let i = 0; i < width; i++) {
-      const rgbIndex = (j * width + i) * 3;
-      const r = rgb[rgbIndex];
-      const g = rgb[rgbIndex + 1];
-      const b = rgb[rgbIndex + 2];
-      
-      // RGB to YUV conversion
-      const y = Math.round(0.299 * r + 0.587 * g + 0.114 * b);
-      
-      const yIndex = j * width + i;
-      i420[yIndex] = Math.max(0, Math.min(255, y));
-      
-      // U and V are subsampled 2x2
-      if (j % 2 === 0 && i % 2 === 0) {
-        const u = Math.round(-0.169 * r - 0.331 * g + 0.5 * b + 128);
-        const v = Math.round(0.5 * r - 0.419 * g - 0.081 * b + 128);
-        
-        const uvIndex = (j / 2) * (width / 2) + (i / 2);
-        i420[ySize + uvIndex] = Math.max(0, Math.min(255, u));
-        i420[ySize + uvSize + uvIndex] = Math.max(0, Math.min(255, v));
+  }
+
+  /**
+   * The native session, for VideoDemuxer to queue chunks on directly.
+   * @internal
+   */
+  _nativeHandle(): NativeVideoDecoderHandle | null {
+    return this._state === 'configured' ? this._native : null;
+  }
+
+  private _closeNative(): void {
+    if (this._native) {
+      this._native.close();
+      this._native = null;
+    }
+    this._decodeQueueSize = 0;
+    const flushes = this._pendingFlushes;
+    this._pendingFlushes = [];
+    for (const { reject } of flushes) {
+      reject(new WebCodecsDOMException('Decoder was reset or closed', 'AbortError'));
+    }
+  }
+
+  private _emitFrame(result: NativeDecodedFrame): void {
+    // The frame references the decoder's picture buffers directly
+    const frame = VideoFrame._fromNative(result.frame, {
+      format: result.format ?? 'I420',
+      codedWidth: result.width,
+      codedHeight: result.height,
+      timestamp: result.timestamp ?? 0,
+      duration: result.duration,
+    });
+    
+    this._output(frame);
+  }
+}
+
+interface VideoMuxerInit {
+  format: 'webm' | 'matroska' | 'mkv' | 'mp4' | 'ivf';
+  /** File to write; left open for the caller when given as `fd`. */
+  path?: string;
+  fd?: number;
+  /** Receives the container bytes when neither path nor fd is given. */
+  output?: (data: ArrayBuffer) => void;
+}
+
+/**
+ * Writes the output of one VideoEncoder into a container natively (not
+ * part of WebCodecs). Once attached, the encoder's packets go straight to
+ * the file and its output callback is no longer called.
+ */
+export class VideoMuxer {
+  private _native: NativeMuxerHandle | null;
+
+  constructor(init: VideoMuxerInit) {
+    if (!nativeAddon) {
+      throw new WebCodecsDOMException('Native addon not available', 'NotSupportedError');
+    }
+    const output = init.output;
+    this._native = new nativeAddon.NativeMuxer(
+      { format: init.format, path: init.path, fd: init.fd },
+      output ? { data: (chunk) => output(adoptNativeBytes(chunk)) } : undefined,
+    );
+  }
+
+  /**
+   * Route `encoder`'s packets here. The encoder must be configured with a
+   * width and height; reconfiguring it detaches the muxer.
+   */
+  attach(encoder: VideoEncoder): void {
+    if (!this._native) {
+      throw new WebCodecsDOMException('Muxer is closed', 'InvalidStateError');
+    }
+    const handle = encoder._nativeHandle();
+    if (!handle) {
+      throw new WebCodecsDOMException('Encoder is not configured', 'InvalidStateError');
+    }
+    handle.setMuxer(this._native);
+  }
+
+  /** Write the trailer; flush the encoder first. */
+  finish(): Promise<void> {
+    const native = this._native;
+    if (!native) {
+      throw new WebCodecsDOMException('Muxer is closed', 'InvalidStateError');
+    }
+    this._native = null;
+    return new Promise<void>((resolve) => native.finish(resolve));
+  }
+
+  close(): void {
+    if (this._native) {
+      this._native.close();
+      this._native = null;
+    }
+  }
+}
+
+interface VideoDemuxerInit {
+  /** Container file to read; without it, bytes are passed to write(). */
+  path?: string;
+  output: (chunk: EncodedVideoChunk) => void;
+  error: (error: Error) => void;
+}
+
+/**
+ * Reads the video track of an IVF, WebM or MP4 container (not part of
+ * WebCodecs). `config` resolves with a VideoDecoderConfig for the track;
+ * start() then emits EncodedVideoChunks to output, or with a configured
+ * VideoDecoder queues them on it natively, bypassing JS entirely.
+ */
+export class VideoDemuxer {
+  readonly config: Promise<VideoDecoderConfig>;
+  private _native: NativeDemuxerHandle | null = null;
+  private _output: (chunk: EncodedVideoChunk) => void;
+  private _error: (error: Error) => void;
+  private _done: { resolve: () => void; reject: (error: Error) => void } | null = null;
+
+  constructor(init: VideoDemuxerInit) {
+    this._output = init.output;
+    this._error = init.error;
+    if (!nativeAddon) {
+      throw new WebCodecsDOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    let configured: { resolve: (config: VideoDecoderConfig) => void; reject: (error: Error) => void };
+    this.config = new Promise((resolve, reject) => {
+      configured = { resolve, reject };
+    });
+    // Errors also reach init.error; don't report an unawaited config as unhandled.
+    this.config.catch(() => {});
+
+    this._native = new nativeAddon.NativeDemuxer({ path: init.path }, {
+      config: (track) => configured.resolve({
+        codec: track.codec,
+        codedWidth: track.codedWidth,
+        codedHeight: track.codedHeight,
+        description: track.description ? adoptNativeBytes(track.description) : undefined,
+      }),
+      chunk: (chunk) => this._output(EncodedVideoChunk._fromNative({
+        data: chunk.data,
+        isKeyframe: chunk.type === 'key',
+        size: chunk.data.byteLength,
+        timestamp: chunk.timestamp,
+        duration: chunk.duration,
+      })),
+      end: () => {
+        this._done?.resolve();
+        this._done = null;
+      },
+      error: (error) => {
+        configured.reject(error);
+        this._done?.reject(error);
+        this._done = null;
+        this._error(error);
+      },
+    });
+  }
+
+  /** Append container bytes (only without `path`). */
+  write(data: BufferSource): void {
+    if (!this._native) {
+      throw new WebCodecsDOMException('Demuxer is closed', 'InvalidStateError');
+    }
+    const view = ArrayBuffer.isView(data)
+      ? new Uint8Array(data.buffer, data.byteOffset, data.byteLength)
+      : new Uint8Array(data);
+    this._native.write(view);
+  }
+
+  /** No more bytes follow write(). */
+  end(): void {
+    this._native?.end();
+  }
+
+  /**
+   * Start emitting chunks. Resolves once the last one has been emitted or
+   * queued on `decoder`; flush the decoder to wait for its frames.
+   */
+  start(decoder?: VideoDecoder): Promise<void> {
+    if (!this._native) {
+      throw new WebCodecsDOMException('Demuxer is closed', 'InvalidStateError');
+    }
+    let target: NativeVideoDecoderHandle | undefined;
+    if (decoder) {
+      const handle = decoder._nativeHandle();
+      if (!handle) {
+        throw new WebCodecsDOMException('Decoder is not configured', 'InvalidStateError');
+      }
+      target = handle;
+    }
+    const done = new Promise<void>((resolve, reject) => {
+      this._done = { resolve, reject };
+    });
+    this._native.start(target);
+    return done;
+  }
+
+  close(): void {
+    if (this._native) {
+      this._native.close();
+      this._native = null;
+    }
+    this._done?.reject(new WebCodecsDOMException('Demuxer was closed', 'AbortError'));
+    this._done = null;
+  }
+}
+
+interface VideoPipelineRendition {
+  /** Configured with the rendition's size; frames are scaled to it. */
+  encoder: VideoEncoder;
+  /** Part of the decoded picture to use, before rotation. */
+  crop?: VideoFrameRect;
+  /** Clockwise degrees. */
+  rotation?: 0 | 90 | 180 | 270;
+}
+
+interface VideoPipelineInit {
+  renditions: VideoPipelineRendition[];
+}
+
+/**
+ * Feeds one frame source to several encoders natively (not part of
+ * WebCodecs), cropping, rotating and scaling the frames per rendition on
+ * each encoder's own thread. The source is either an attached decoder,
+ * whose output callback is then no longer called, or encode(). Each
+ * encoder emits its packets as usual.
+ */
+export class VideoPipeline {
+  private _native: NativeVideoPipelineHandle;
+  private _encoders: VideoEncoder[];
+  private _decoder: VideoDecoder | null = null;
+
+  constructor(init: VideoPipelineInit) {
+    if (!nativeAddon) {
+      throw new WebCodecsDOMException('Native addon not available', 'NotSupportedError');
+    }
+    this._encoders = init.renditions.map(r => r.encoder);
+    this._native = new nativeAddon.NativeVideoPipeline(init.renditions.map((rendition) => {
+      const handle = rendition.encoder._nativeHandle();
+      if (!handle) {
+        throw new WebCodecsDOMException('Encoder is not configured with a size', 'InvalidStateError');
       }
+      return { encoder: handle, crop: rendition.crop, rotation: rendition.rotation };
+    }));
+  }
+
+  /** Route `decoder`'s frames through the pipeline from now on. */
+  attach(decoder: VideoDecoder): void {
+    const handle = decoder._nativeHandle();
+    if (!handle) {
+      throw new WebCodecsDOMException('Decoder is not configured', 'InvalidStateError');
     }
+    handle.setPipeline(this._native);
+    this._decoder = decoder;
+  }
+
+  /**
+   * Queue `frame` on every rendition, as one shared reference rather than a
+   * copy per encoder. Never blocks: a realtime encoder that is full drops
+   * the frame unless it is a requested keyframe, the others queue it, so
+   * pace on the encoders' encodeQueueSize. The caller may close the frame
+   * right away.
+   */
+  encode(frame: VideoFrame, options?: { keyFrame?: boolean }): void {
+    if (!frame._native) {
+      throw new WebCodecsDOMException('Frame is closed or has no native buffer', 'InvalidStateError');
+    }
+    this._native.encode(frame._native, {
+      timestamp: frame.timestamp,
+      duration: frame.duration ?? undefined,
+      keyFrame: options?.keyFrame ?? false,
+    });
+  }
+
+  /**
+   * Resolves once every frame decoded or passed to encode() so far has
+   * been encoded and emitted by all renditions.
+   */
+  async flush(): Promise<void> {
+    // The decoder hands over its last frames before its flush resolves
+    await this._decoder?.flush();
+    await Promise.all(this._encoders.map(encoder => encoder.flush()));
   }
-  
-  return i420;
 }
 
 /**
@@ -451,6 +1097,9 @@ export class AudioEncoder {
   private _encodeQueueSize: number = 0;
   private _output: (chunk: unknown, metadata?: unknown) => void;
   private _error: (error: Error) => void;
+  private _config: AudioEncoderConfig | null = null;
+  private _native: NativeAudioEncoderHandle | null = null;
+  private _pendingFlushes: Array<{ resolve: () => void; reject: (error: Error) => void }> = [];
 
   constructor(init: EncoderInit) {
     this._output = init.output;
@@ -479,32 +1128,122 @@ export class AudioEncoder {
       this._state = 'closed';
       return;
     }
+    this._closeNative();
+    this._config = config;
     this._state = 'configured';
+    if (nativeAddon) {
+      try {
+        this._native = new nativeAddon.NativeAudioEncoder({
+          codec: config.codec,
+          sampleRate: config.sampleRate ?? 48000,
+          numberOfChannels: config.numberOfChannels ?? 2,
+          bitrate: config.bitrate,
+        }, {
+          output: (packet) => this._emitPacket(packet),
+          error: (error) => this._error(error),
+          dequeue: () => {
+            this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
+          },
+        });
+      } catch (e) {
+        this._error(e as Error);
+      }
+    }
   }
 
-  encode(_data: unknown): void {
+  encode(data: AudioData): void {
     if (this._state !== 'configured') {
       throw new WebCodecsDOMException('Encoder is not configured', 'InvalidStateError');
     }
+    if (!this._native) {
+      return;
+    }
+
+    // A view of the AudioData's own bytes; the native session copies them
+    // before returning, so the caller may close the AudioData right away.
+    const bytes = data._bytes();
+    try {
+      this._native.encode(Buffer.from(bytes.buffer, bytes.byteOffset, bytes.byteLength), {
+        format: data.format,
+        sampleRate: data.sampleRate,
+        numberOfFrames: data.numberOfFrames,
+        numberOfChannels: data.numberOfChannels,
+        timestamp: data.timestamp,
+      });
+      this._encodeQueueSize++;
+    } catch (e) {
+      this._error(e as Error);
+    }
   }
 
   async flush(): Promise<void> {
     if (this._state !== 'configured') {
       throw new WebCodecsDOMException('Encoder is not configured', 'InvalidStateError');
     }
+
+    if (!nativeAddon) {
+      this._error(new Error('Native addon not available'));
+      return;
+    }
+
+    const native = this._native;
+    if (!native) {
+      return;
+    }
+
+    await new Promise<void>((resolve, reject) => {
+      const pending = { resolve, reject };
+      this._pendingFlushes.push(pending);
+      native.flush().then(() => {
+        this._pendingFlushes = this._pendingFlushes.filter(p => p !== pending);
+        resolve();
+      }, reject);
+    });
   }
 
   reset(): void {
     if (this._state === 'closed') {
       throw new WebCodecsDOMException('Cannot reset a closed encoder', 'InvalidStateError');
     }
+    this._closeNative();
     this._state = 'unconfigured';
-    this._encodeQueueSize = 0;
+    this._config = null;
   }
 
   close(): void {
+    this._closeNative();
     this._state = 'closed';
   }
+
+  private _closeNative(): void {
+    if (this._native) {
+      this._native.close();
+      this._native = null;
+    }
+    this._encodeQueueSize = 0;
+    const flushes = this._pendingFlushes;
+    this._pendingFlushes = [];
+    for (const { reject } of flushes) {
+      reject(new WebCodecsDOMException('Encoder was reset or closed', 'AbortError'));
+    }
+  }
+
+  private _emitPacket(packet: NativeEncodedPacket): void {
+    const chunk = EncodedAudioChunk._fromNative(packet);
+
+    // The encoder may run at a different rate than configured (Opus is
+    // always 48 kHz or below), so report the one the stream really has.
+    const metadata = {
+      decoderConfig: {
+        codec: this._config?.codec ?? 'opus',
+        sampleRate: this._native?.sampleRate ?? this._config?.sampleRate,
+        numberOfChannels: this._config?.numberOfChannels ?? 2,
+        description: this._native?.description,
+      },
+    };
+
+    this._output(chunk, metadata);
+  }
 }
 
 /**
@@ -515,6 +1254,8 @@ export class AudioDecoder {
   private _decodeQueueSize: number = 0;
   private _output: (data: unknown) => void;
   private _error: (error: Error) => void;
+  private _native: NativeAudioDecoderHandle | null = null;
+  private _pendingFlushes: Array<{ resolve: () => void; reject: (error: Error) => void }> = [];
 
   constructor(init: DecoderInit) {
     this._output = init.output;
@@ -543,32 +1284,123 @@ export class AudioDecoder {
       this._state = 'closed';
       return;
     }
+    this._closeNative();
     this._state = 'configured';
+    if (nativeAddon) {
+      try {
+        const description = config.description === undefined ? undefined
+          : ArrayBuffer.isView(config.description)
+            ? new Uint8Array(config.description.buffer, config.description.byteOffset, config.description.byteLength)
+            : new Uint8Array(config.description);
+        this._native = new nativeAddon.NativeAudioDecoder({
+          codec: config.codec,
+          sampleRate: config.sampleRate ?? 48000,
+          numberOfChannels: config.numberOfChannels ?? 2,
+          description,
+        }, {
+          output: (result) => this._output(AudioData._fromNative(result)),
+          error: (error) => this._error(error),
+          dequeue: () => {
+            this._decodeQueueSize = Math.max(0, this._decodeQueueSize - 1);
+          },
+        });
+      } catch (e) {
+        this._error(e as Error);
+      }
+    }
   }
 
-  decode(_chunk: unknown): void {
+  decode(chunk: EncodedAudioChunk): void {
     if (this._state !== 'configured') {
       throw new WebCodecsDOMException('Decoder is not configured', 'InvalidStateError');
     }
+    if (!this._native) {
+      return;
+    }
+
+    // The native session copies the chunk before returning
+    const encodedBuffer = Buffer.alloc(chunk.byteLength);
+    chunk.copyTo(encodedBuffer);
+
+    try {
+      this._native.decode(encodedBuffer, { timestamp: chunk.timestamp });
+      this._decodeQueueSize++;
+    } catch (e) {
+      this._error(e as Error);
+    }
   }
 
   async flush(): Promise<void> {
     if (this._state !== 'configured') {
       throw new WebCodecsDOMException('Decoder is not configured', 'InvalidStateError');
     }
+
+    if (!nativeAddon) {
+      this._error(new Error('Native addon not available'));
+      return;
+    }
+
+    const native = this._native;
+    if (!native) {
+      return;
+    }
+
+    await new Promise<void>((resolve, reject) => {
+      const pending = { resolve, reject };
+      this._pendingFlushes.push(pending);
+      native.flush().then(() => {
+        this._pendingFlushes = this._pendingFlushes.filter(p => p !== pending);
+        resolve();
+      }, reject);
+    });
   }
 
   reset(): void {
     if (this._state === 'closed') {
       throw new WebCodecsDOMException('Cannot reset a closed decoder', 'InvalidStateError');
     }
+    this._closeNative();
     this._state = 'unconfigured';
-    this._decodeQueueSize = 0;
   }
 
   close(): void {
+    this._closeNative();
     this._state = 'closed';
   }
+
+  private _closeNative(): void {
+    if (this._native) {
+      this._native.close();
+      this._native = null;
+    }
+    this._decodeQueueSize = 0;
+    const flushes = this._pendingFlushes;
+    this._pendingFlushes = [];
+    for (const { reject } of flushes) {
+      reject(new WebCodecsDOMException('Decoder was reset or closed', 'AbortError'));
+    }
+  }
+}
+
+interface PlaneLayout {
+  offset: number;
+  stride: number;
+}
+
+interface VideoFrameRect {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
+interface VideoFrameCopyToOptions {
+  format?: string;
+  layout?: PlaneLayout[];
+  rect?: VideoFrameRect;
+  /** Non-standard: scale the copied rect to this size (like createImageBitmap). */
+  resizeWidth?: number;
+  resizeHeight?: number;
 }
 
 interface VideoFrameInit {
@@ -587,6 +1419,89 @@ interface VideoFrameBufferInit {
   codedHeight: number;
   timestamp: number;
   duration?: number;
+  /** Per-plane offset and stride in the source; tightly packed by default. */
+  layout?: PlaneLayout[];
+  /**
+   * Buffers the frame may take over instead of copying. A transferred
+   * ArrayBuffer is detached, as in the spec. A SharedArrayBuffer cannot be
+   * detached, so the frame aliases it: the producer must not overwrite
+   * those bytes until the frame and its clones are closed.
+   */
+  transfer?: Array<ArrayBuffer | SharedArrayBuffer>;
+}
+
+// Copy an image into a native AVFrame, or with `adopt` point the frame at
+// `data` itself. Returns null only when the addon is missing, so the caller
+// keeps the data in JS; a format, size or layout the addon rejects throws
+// the spec's TypeError rather than leaving a frame of garbage.
+function createNativeFrame(data: Uint8Array, init: VideoFrameBufferInit, adopt: boolean): NativeVideoFrameHandle | null {
+  if (!nativeAddon) {
+    return null;
+  }
+  try {
+    return new nativeAddon.NativeVideoFrame(data, {
+      format: init.format,
+      codedWidth: init.codedWidth,
+      codedHeight: init.codedHeight,
+      layout: init.layout,
+      adopt,
+    });
+  } catch (e) {
+    throw new TypeError((e as Error).message);
+  }
+}
+
+/** Throws the TypeError createNativeFrame() would for `init`, without building a frame. */
+function validateFrameLayout(byteLength: number, init: VideoFrameBufferInit): void {
+  try {
+    nativeAddon?.validateFrameLayout(byteLength, {
+      format: init.format,
+      codedWidth: init.codedWidth,
+      codedHeight: init.codedHeight,
+      layout: init.layout,
+    });
+  } catch (e) {
+    throw new TypeError((e as Error).message);
+  }
+}
+
+/**
+ * If `view`'s buffer is in `transfer`, take it over: an ArrayBuffer is
+ * detached from the caller (its memory moves, it is not copied) and a
+ * SharedArrayBuffer is shared as is. Returns the same bytes, now safe to
+ * adopt, or null to copy them.
+ */
+function adoptTransferred(view: Uint8Array, transfer: VideoFrameBufferInit['transfer']): Uint8Array | null {
+  const buffer = view.buffer;
+  if (!transfer?.includes(buffer)) {
+    return null;
+  }
+  if (typeof SharedArrayBuffer !== 'undefined' && buffer instanceof SharedArrayBuffer) {
+    return view;
+  }
+  // Read before the transfer detaches the view
+  const { byteOffset, byteLength } = view;
+  try {
+    const owned = structuredClone(buffer, { transfer: [buffer as ArrayBuffer] });
+    return new Uint8Array(owned, byteOffset, byteLength);
+  } catch {
+    // Not detachable, e.g. WebAssembly memory
+    return null;
+  }
+}
+
+/**
+ * A VideoFrame on its way to another worker_threads Worker: post it as is
+ * and pass it to VideoFrame.fromShared() there. `token` stands for a
+ * reference to the frame's native buffers, so no pixels are copied.
+ */
+export interface SharedVideoFrame {
+  token: number;
+  format: string;
+  codedWidth: number;
+  codedHeight: number;
+  timestamp: number;
+  duration: number | null;
 }
 
 /**
@@ -602,6 +1517,12 @@ export class VideoFrame {
   private _format: string | null;
   private _data: ArrayBuffer | null;
   private _closed: boolean = false;
+  /**
+   * Refcounted native picture, shared by clone() and VideoEncoder.encode().
+   * When set, _data is null.
+   * @internal
+   */
+  _native: NativeVideoFrameHandle | null = null;
 
   constructor(source: BufferSource | null, options?: VideoFrameInit | VideoFrameBufferInit) {
     this._timestamp = options?.timestamp ?? 0;
@@ -616,8 +1537,31 @@ export class VideoFrame {
       this._displayWidth = init.codedWidth;
       this._displayHeight = init.codedHeight;
       
+      let sourceView = source instanceof ArrayBuffer
+        ? new Uint8Array(source)
+        : ArrayBuffer.isView(source)
+          ? new Uint8Array(source.buffer, source.byteOffset, source.byteLength)
+          : null;
+      // A rejected init must not detach the buffer, so check it before the
+      // transfer; a SharedArrayBuffer is never detached and needs no check
+      if (sourceView && sourceView.buffer instanceof ArrayBuffer && init.transfer?.includes(sourceView.buffer)) {
+        validateFrameLayout(sourceView.byteLength, init);
+      }
+      const adopted = sourceView ? adoptTransferred(sourceView, init.transfer) : null;
+      if (adopted) {
+        sourceView = adopted;
+      }
+      this._native = sourceView ? createNativeFrame(sourceView, init, adopted !== null) : null;
+      
       // Copy the data
-      if (source instanceof ArrayBuffer) {
+      if (this._native) {
+        this._data = null;
+      } else if (adopted && adopted.buffer instanceof ArrayBuffer) {
+        // Already ours; no need to copy it again
+        this._data = adopted.byteOffset === 0 && adopted.byteLength === adopted.buffer.byteLength
+          ? adopted.buffer
+          : adopted.slice().buffer;
+      } else if (source instanceof ArrayBuffer) {
         this._data = source.slice(0);
       } else if (ArrayBuffer.isView(source)) {
         const view = source as ArrayBufferView;
@@ -639,6 +1583,69 @@ export class VideoFrame {
     }
   }
 
+  /**
+   * Non-standard: a hex digest of each plane's visible bytes, hashed in
+   * place by FFmpeg's av_hash ('MD5' by default; also 'murmur3', 'CRC32',
+   * 'SHA256', ...). Equal pictures hash equal whatever their strides, so
+   * round trips can be checked bit exact without copying frames out.
+   */
+  hash(algorithm?: string): string[] {
+    if (this._closed) {
+      throw new WebCodecsDOMException('VideoFrame is closed', 'InvalidStateError');
+    }
+    if (!this._native) {
+      throw new WebCodecsDOMException('Only native frames can be hashed', 'NotSupportedError');
+    }
+    return this._native.hash(algorithm);
+  }
+
+  /**
+   * Hand this frame to another worker (non-standard; postMessage() cannot
+   * transfer class instances). The frame itself stays open. Each result
+   * must be passed to fromShared() exactly once, or its buffers are never
+   * freed.
+   */
+  share(): SharedVideoFrame {
+    if (this._closed) {
+      throw new WebCodecsDOMException('VideoFrame is closed', 'InvalidStateError');
+    }
+    if (!this._native) {
+      throw new WebCodecsDOMException('Only native frames can be shared', 'NotSupportedError');
+    }
+    return {
+      token: this._native.share(),
+      format: this._format ?? 'I420',
+      codedWidth: this._codedWidth,
+      codedHeight: this._codedHeight,
+      timestamp: this._timestamp,
+      duration: this._duration,
+    };
+  }
+
+  /** Claim a frame shared by another worker with share(). */
+  static fromShared(shared: SharedVideoFrame): VideoFrame {
+    if (!nativeAddon) {
+      throw new WebCodecsDOMException('Native addon not available', 'NotSupportedError');
+    }
+    return VideoFrame._fromNative(nativeAddon.NativeVideoFrame.fromShared(shared.token), {
+      format: shared.format,
+      codedWidth: shared.codedWidth,
+      codedHeight: shared.codedHeight,
+      timestamp: shared.timestamp,
+      duration: shared.duration ?? undefined,
+    });
+  }
+
+  /**
+   * Wrap a native frame produced by the addon without copying it.
+   * @internal
+   */
+  static _fromNative(handle: NativeVideoFrameHandle, init: VideoFrameBufferInit): VideoFrame {
+    const frame = new VideoFrame(null, init);
+    frame._native = handle;
+    return frame;
+  }
+
   get timestamp(): number {
     return this._timestamp;
   }
@@ -671,10 +1678,16 @@ export class VideoFrame {
     return { x: 0, y: 0, width: this._codedWidth, height: this._codedHeight };
   }
 
-  allocationSize(options?: { format?: string }): number {
+  allocationSize(options?: VideoFrameCopyToOptions): number {
     const format = options?.format ?? this._format;
-    const width = this._codedWidth;
-    const height = this._codedHeight;
+    const { width, height } = this._copySize(options);
+    
+    if (nativeAddon && format) {
+      const size = nativeAddon.frameAllocationSize(format, width, height);
+      if (size > 0) {
+        return size;
+      }
+    }
     
     switch (format) {
       case 'I420':
@@ -684,7 +1697,12 @@ export class VideoFrame {
       case 'RGB':
       case 'RGB24':
         return width * height * 3;
+      case 'NV12':
+        return width * height + (width / 2) * (height / 2) * 2;
       case 'RGBA':
+      case 'RGBX':
+      case 'BGRA':
+      case 'BGRX':
         return width * height * 4;
       default:
         // Default to I420 if format is unknown
@@ -692,7 +1710,25 @@ export class VideoFrame {
     }
   }
 
-  async copyTo(destination: BufferSource, options?: { format?: string }): Promise<Array<{ offset: number; stride: number }>> {
+  async copyTo(destination: BufferSource, options?: VideoFrameCopyToOptions): Promise<PlaneLayout[]> {
+    return this._copyToSync(destination, options);
+  }
+
+  /** Size of the image copyTo() writes: the rect, or the requested resize. */
+  private _copySize(options?: VideoFrameCopyToOptions): { width: number; height: number } {
+    const rect = options?.rect ?? this.visibleRect;
+    return {
+      width: options?.resizeWidth ?? rect.width,
+      height: options?.resizeHeight ?? rect.height,
+    };
+  }
+
+  /**
+   * Synchronous body of copyTo(). VideoEncoder uses it so encode() can hand
+   * the frame to the native session before returning.
+   * @internal
+   */
+  _copyToSync(destination: BufferSource, options?: VideoFrameCopyToOptions): PlaneLayout[] {
     if (this._closed) {
       throw new WebCodecsDOMException('VideoFrame is closed', 'InvalidStateError');
     }
@@ -705,35 +1741,42 @@ export class VideoFrame {
     const width = this._codedWidth;
     const height = this._codedHeight;
     
+    if (this._native) {
+      // Planes are copied as decoded; RGB output is converted natively, on demand
+      return this._native.copyTo(destView, {
+        format: requestedFormat ?? undefined,
+        layout: options?.layout,
+        rect: options?.rect,
+        resizeWidth: options?.resizeWidth,
+        resizeHeight: options?.resizeHeight,
+      });
+    }
+    
     if (!this._data) {
       return [];
     }
     
+    const size = this._copySize(options);
+    if (size.width !== width || size.height !== height || options?.rect?.x || options?.rect?.y) {
+      throw new WebCodecsDOMException('Cropping and scaling need the native addon', 'NotSupportedError');
+    }
+    
     const srcView = new Uint8Array(this._data);
     
-    // If same format, just copy
-    if (requestedFormat === this._format) {
-      destView.set(srcView.subarray(0, Math.min(srcView.length, destView.length)));
-    } else if (this._format === 'I420' && (requestedFormat === 'RGB' || requestedFormat === 'RGB24')) {
-      // Convert I420 to RGB24
-      const rgb = i420ToRgb24(srcView, width, height);
-      destView.set(rgb.subarray(0, Math.min(rgb.length, destView.length)));
-    } else if (this._format === 'I420' && requestedFormat === 'RGBA') {
-      // Convert I420 to RGBA
-      const rgb = i420ToRgb24(srcView, width, height);
-      const rgba = new Uint8Array(width * height * 4);
-      for (let i = 0; i < width * height; i++) {
-        rgba[i * 4] = rgb[i * 3];
-        rgba[i * 4 + 1] = rgb[i * 3 + 1];
-        rgba[i * 4 + 2] = rgb[i * 3 + 2];
-        rgba[i * 4 + 3] = 255;
+    if (requestedFormat !== this._format) {
+      // Pixel format conversion happens natively (libswscale)
+      if (!nativeAddon || !this._format || !requestedFormat) {
+        throw new WebCodecsDOMException(`Cannot convert ${this._format} to ${requestedFormat}`, 'NotSupportedError');
       }
-      destView.set(rgba.subarray(0, Math.min(rgba.length, destView.length)));
-    } else {
-      // Fallback: just copy raw data
-      destView.set(srcView.subarray(0, Math.min(srcView.length, destView.length)));
+      return nativeAddon.convertFrame(
+        srcView, { format: this._format, codedWidth: width, codedHeight: height },
+        destView, { format: requestedFormat, layout: options?.layout },
+      );
     }
     
+    // Same format: just copy
+    destView.set(srcView.subarray(0, Math.min(srcView.length, destView.length)));
+    
     // Return PlaneLayout array based on format
     if (requestedFormat === 'I420' || requestedFormat === 'YUV420P' || this._format === 'I420') {
       const ySize = width * height;
@@ -756,12 +1799,26 @@ export class VideoFrame {
   close(): void {
     this._closed = true;
     this._data = null;
+    if (this._native) {
+      // Drop our AVFrame reference now rather than at GC
+      this._native.close();
+      this._native = null;
+    }
   }
 
   clone(): VideoFrame {
     if (this._closed) {
       throw new WebCodecsDOMException('VideoFrame is closed', 'InvalidStateError');
     }
+    if (this._native) {
+      return VideoFrame._fromNative(this._native.clone(), {
+        format: this._format ?? 'I420',
+        codedWidth: this._codedWidth,
+        codedHeight: this._codedHeight,
+        timestamp: this._timestamp,
+        duration: this._duration ?? undefined,
+      });
+    }
     const cloned = new VideoFrame(this._data, {
       format: this._format ?? undefined,
       codedWidth: this._codedWidth,
@@ -803,6 +1860,28 @@ export class AudioData {
     }
   }
 
+  /**
+   * Adopt samples decoded by the addon. The Buffer was allocated for this
+   * AudioData alone, so its memory is taken over instead of copied.
+   * @internal
+   */
+  static _fromNative(result: NativeDecodedAudio): AudioData {
+    const audio = new AudioData({ ...result, data: new ArrayBuffer(0) });
+    audio._data = adoptNativeBytes(result.data);
+    return audio;
+  }
+
+  /**
+   * The packed samples, for handing to the addon without a copy.
+   * @internal
+   */
+  _bytes(): Uint8Array {
+    if (this._closed) {
+      throw new TypeError('AudioData is closed');
+    }
+    return new Uint8Array(this._data);
+  }
+
   get format(): string {
     return this._format;
   }
@@ -915,6 +1994,23 @@ export class EncodedVideoChunk {
     }
   }
 
+  /**
+   * Wrap a packet from the addon. Its Buffer references the encoder's own
+   * packet memory and belongs to this chunk alone, so it is adopted
+   * instead of copied.
+   * @internal
+   */
+  static _fromNative(packet: NativeEncodedPacket): EncodedVideoChunk {
+    const chunk = new EncodedVideoChunk({
+      type: packet.isKeyframe ? 'key' : 'delta',
+      timestamp: packet.timestamp ?? 0,
+      duration: packet.duration,
+      data: new ArrayBuffer(0),
+    });
+    chunk._data = adoptNativeBytes(packet.data);
+    return chunk;
+  }
+
   get type(): 'key' | 'delta' {
     return this._type;
   }
@@ -965,6 +2061,23 @@ export class EncodedAudioChunk {
     }
   }
 
+  /**
+   * Wrap a packet from the addon. Its Buffer references the encoder's own
+   * packet memory and belongs to this chunk alone, so it is adopted
+   * instead of copied.
+   * @internal
+   */
+  static _fromNative(packet: NativeEncodedPacket): EncodedAudioChunk {
+    const chunk = new EncodedAudioChunk({
+      type: packet.isKeyframe ? 'key' : 'delta',
+      timestamp: packet.timestamp ?? 0,
+      duration: packet.duration,
+      data: new ArrayBuffer(0),
+    });
+    chunk._data = adoptNativeBytes(packet.data);
+    return chunk;
+  }
+
   get type(): 'key' | 'delta' {
     return this._type;
   }
@@ -1001,6 +2114,23 @@ export class ImageDecoder {
   }
 }
 
+/**
+ * Set how many threads run native codec sessions (`threads`) and how many
+ * internal threads an encoder may open when its config has no `threads`
+ * (`codecThreads`). Applies process-wide; sessions already open keep their
+ * codec threads.
+ */
+export function configureCodecScheduler(options: CodecSchedulerOptions): CodecSchedulerStats {
+  if (!nativeAddon) {
+    throw new WebCodecsDOMException('Native addon not available', 'NotSupportedError');
+  }
+  return nativeAddon.configureScheduler(options);
+}
+
+export function getCodecSchedulerStats(): CodecSchedulerStats | null {
+  return nativeAddon ? nativeAddon.getSchedulerStats() : null;
+}
+
 /**
  * Install the WebCodecs polyfill on globalThis
  * This function should be called to make the WebCodecs API available globally
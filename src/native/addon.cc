@@ -7,6 +7,7 @@
 
 #include <napi.h>
 #include <string>
+#include <vector>
 #include <cstdio>
 
 extern "C" {
@@ -17,6 +18,27 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+#include "addon_data.h"
+#include "audio_decoder.h"
+#include "audio_encoder.h"
+#include "batch_encode.h"
+#include "benchmark.h"
+#include "codec_capabilities.h"
+#include "codec_registry.h"
+#include "codec_scheduler.h"
+#include "demuxer.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+#include "hw_device.h"
+#include "muxer.h"
+#include "pixel_convert.h"
+#include "pixel_format.h"
+#include "scaler_cache.h"
+#include "video_decoder.h"
+#include "video_encoder.h"
+#include "video_frame.h"
+#include "video_pipeline.h"
+
 /**
  * Returns FFmpeg version information.
  * Used to verify the addon loaded correctly and FFmpeg is available.
@@ -57,18 +79,19 @@ Napi::Value HasCodec(const Napi::CallbackInfo& info) {
   
   std::string codecName = info[0].As<Napi::String>().Utf8Value();
   
-  const AVCodec* decoder = avcodec_find_decoder_by_name(codecName.c_str());
-  const AVCodec* encoder = avcodec_find_encoder_by_name(codecName.c_str());
+  const CodecCapabilities& capabilities = CodecCapabilities::Shared();
+  const CodecCapabilities::CodecInfo* decoder = capabilities.FindDecoder(codecName);
+  const CodecCapabilities::CodecInfo* encoder = capabilities.FindEncoder(codecName);
   
   Napi::Object result = Napi::Object::New(env);
   result.Set("decoder", Napi::Boolean::New(env, decoder != nullptr));
   result.Set("encoder", Napi::Boolean::New(env, encoder != nullptr));
   
   if (decoder) {
-    result.Set("decoderName", Napi::String::New(env, decoder->long_name ? decoder->long_name : decoder->name));
+    result.Set("decoderName", Napi::String::New(env, decoder->longName.empty() ? decoder->name : decoder->longName));
   }
   if (encoder) {
-    result.Set("encoderName", Napi::String::New(env, encoder->long_name ? encoder->long_name : encoder->name));
+    result.Set("encoderName", Napi::String::New(env, encoder->longName.empty() ? encoder->name : encoder->longName));
   }
   
   return result;
@@ -89,32 +112,18 @@ Napi::Value ListCodecs(const Napi::CallbackInfo& info) {
   Napi::Array result = Napi::Array::New(env);
   uint32_t index = 0;
   
-  void* iter = nullptr;
-  const AVCodec* codec;
-  
-  while ((codec = av_codec_iterate(&iter))) {
-    std::string name(codec->name);
-    
+  for (const CodecCapabilities::CodecInfo& codec : CodecCapabilities::Shared().Codecs()) {
     // Apply filter if provided
-    if (!filter.empty() && name.find(filter) == std::string::npos) {
+    if (!filter.empty() && codec.name.find(filter) == std::string::npos) {
       continue;
     }
     
     Napi::Object codecInfo = Napi::Object::New(env);
-    codecInfo.Set("name", Napi::String::New(env, codec->name));
-    codecInfo.Set("longName", Napi::String::New(env, codec->long_name ? codec->long_name : ""));
-    codecInfo.Set("isEncoder", Napi::Boolean::New(env, av_codec_is_encoder(codec)));
-    codecInfo.Set("isDecoder", Napi::Boolean::New(env, av_codec_is_decoder(codec)));
-    
-    // Codec type
-    const char* type = "unknown";
-    switch (codec->type) {
-      case AVMEDIA_TYPE_VIDEO: type = "video"; break;
-      case AVMEDIA_TYPE_AUDIO: type = "audio"; break;
-      case AVMEDIA_TYPE_SUBTITLE: type = "subtitle"; break;
-      default: break;
-    }
-    codecInfo.Set("type", Napi::String::New(env, type));
+    codecInfo.Set("name", Napi::String::New(env, codec.name));
+    codecInfo.Set("longName", Napi::String::New(env, codec.longName));
+    codecInfo.Set("isEncoder", Napi::Boolean::New(env, codec.isEncoder));
+    codecInfo.Set("isDecoder", Napi::Boolean::New(env, codec.isDecoder));
+    codecInfo.Set("type", Napi::String::New(env, codec.type));
     
     result.Set(index++, codecInfo);
   }
@@ -123,329 +132,510 @@ Napi::Value ListCodecs(const Napi::CallbackInfo& info) {
 }
 
 /**
- * Encode a frame to VP8.
- * 
- * encodeVP8Frame(data: Buffer, options: { width, height, bitrate, format? }) 
- *   => { data: Buffer, isKeyframe: boolean }
- * 
- * format can be 'RGB24' (default) or 'I420'
+ * Answer VideoEncoder/VideoDecoder.isConfigSupported() from the capability
+ * table: codec string, profile, level, size and hardware preference.
+ *
+ * isVideoConfigSupported({ codec, width?, height?, hardwareAcceleration? },
+ *                        'encoder' | 'decoder') -> boolean
  */
-Napi::Value EncodeVP8Frame(const Napi::CallbackInfo& info) {
+Napi::Value IsVideoConfigSupported(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
-  
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsObject()) {
-    Napi::TypeError::New(env, "Expected (Buffer, {width, height, bitrate})").ThrowAsJavaScriptException();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected ({codec, width?, height?, hardwareAcceleration?}, 'encoder' | 'decoder')")
+      .ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
-  Napi::Object options = info[1].As<Napi::Object>();
-  
-  int width = options.Get("width").As<Napi::Number>().Int32Value();
-  int height = options.Get("height").As<Napi::Number>().Int32Value();
-  int bitrate = options.Has("bitrate") ? 
-    options.Get("bitrate").As<Napi::Number>().Int32Value() : 500000;
-  
-  // Check format (default to RGB24 for backward compatibility)
-  std::string format = "RGB24";
-  if (options.Has("format") && options.Get("format").IsString()) {
-    format = options.Get("format").As<Napi::String>().Utf8Value();
+  Napi::Object config = info[0].As<Napi::Object>();
+  std::string direction = info[1].As<Napi::String>().Utf8Value();
+  if (direction != "encoder" && direction != "decoder") {
+    Napi::TypeError::New(env, "Expected 'encoder' or 'decoder'").ThrowAsJavaScriptException();
+    return env.Undefined();
   }
-  
-  bool isI420 = (format == "I420" || format == "YUV420P");
-  
-  uint8_t* inputData = inputBuffer.Data();
-  size_t expectedSize = isI420 
-    ? static_cast<size_t>(width * height + (width / 2) * (height / 2) * 2)  // I420
-    : static_cast<size_t>(width * height * 3);  // RGB24
-  
-  if (inputBuffer.Length() != expectedSize) {
-    Napi::TypeError::New(env, isI420 ? "I420 buffer size mismatch" : "RGB24 buffer size mismatch").ThrowAsJavaScriptException();
+
+  std::string error;
+  VideoCodecSpec spec;
+  HardwarePreference hardware = HardwarePreference::kNoPreference;
+  if (!config.Get("codec").IsString() ||
+      !ParseVideoCodec(config.Get("codec").As<Napi::String>().Utf8Value(), &spec, &error) ||
+      (config.Get("hardwareAcceleration").IsString() &&
+       !ParseHardwarePreference(config.Get("hardwareAcceleration").As<Napi::String>().Utf8Value(), &hardware))) {
+    return Napi::Boolean::New(env, false);
+  }
+  int width = config.Get("width").IsNumber() ? config.Get("width").As<Napi::Number>().Int32Value() : 0;
+  int height = config.Get("height").IsNumber() ? config.Get("height").As<Napi::Number>().Int32Value() : 0;
+
+  bool supported = CodecCapabilities::Shared().IsVideoConfigSupported(
+    spec, direction == "encoder" ? CodecCapabilities::Direction::kEncode : CodecCapabilities::Direction::kDecode,
+    width, height, hardware);
+  return Napi::Boolean::New(env, supported);
+}
+
+/**
+ * Encode a single image as a keyframe with any registry codec.
+ *
+ * encodeFrame(data: Buffer, { codec, width, height, bitrate?, format? })
+ *   => { data: Buffer, isKeyframe: boolean, size }
+ *
+ * format is any supported pixel format and defaults to 'RGB24'.
+ */
+Napi::Value EncodeImage(Napi::Env env, Napi::Buffer<uint8_t> inputBuffer, Napi::Object options,
+                        const std::string& codecString) {
+  std::string error;
+  VideoCodecSpec spec;
+  if (!ParseVideoCodec(codecString, &spec, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Find VP8 encoder (libvpx)
-  const AVCodec* codec = avcodec_find_encoder_by_name("libvpx");
-  if (!codec) {
-    // Fallback to codec ID
-    codec = avcodec_find_encoder(AV_CODEC_ID_VP8);
-  }
-  if (!codec) {
-    Napi::Error::New(env, "VP8 encoder (libvpx) not found").ThrowAsJavaScriptException();
+  if (!options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Expected numeric width and height").ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Allocate codec context
-  AVCodecContext* ctx = avcodec_alloc_context3(codec);
-  if (!ctx) {
-    Napi::Error::New(env, "Failed to allocate encoder context").ThrowAsJavaScriptException();
+
+  VideoEncoderSettings settings;
+  settings.hardware = HardwarePreference::kPreferSoftware;
+  settings.width = options.Get("width").As<Napi::Number>().Int32Value();
+  settings.height = options.Get("height").As<Napi::Number>().Int32Value();
+  if (options.Get("bitrate").IsNumber()) {
+    settings.bitrate = options.Get("bitrate").As<Napi::Number>().Int64Value();
+  }
+
+  // RGB24 is the default for backward compatibility
+  std::string format = "RGB24";
+  if (options.Get("format").IsString()) {
+    format = options.Get("format").As<Napi::String>().Utf8Value();
+  }
+  AVPixelFormat pixelFormat = PixelFormatFromString(format);
+  if (pixelFormat == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported frame format: " + format).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Configure encoder
-  ctx->bit_rate = bitrate;
-  ctx->width = width;
-  ctx->height = height;
-  ctx->time_base = {1, 30};
-  ctx->framerate = {30, 1};
-  ctx->gop_size = 30;
-  ctx->max_b_frames = 0;
-  ctx->pix_fmt = AV_PIX_FMT_YUV420P;
-  
-  // Open encoder
-  if (avcodec_open2(ctx, codec, nullptr) < 0) {
-    avcodec_free_context(&ctx);
-    Napi::Error::New(env, "Failed to open VP8 encoder").ThrowAsJavaScriptException();
+  std::vector<PlaneLayout> planes;
+  if (inputBuffer.Length() != PackedLayout(pixelFormat, settings.width, settings.height, &planes)) {
+    Napi::TypeError::New(env, format + " buffer size mismatch").ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Allocate frame for YUV420P
-  AVFrame* frame = av_frame_alloc();
-  frame->format = ctx->pix_fmt;
-  frame->width = width;
-  frame->height = height;
-  
-  if (av_frame_get_buffer(frame, 0) < 0) {
+
+  AVFrame* frame = NativeVideoFrame::CopyFromBuffer(inputBuffer.Data(), inputBuffer.Length(),
+                                                    pixelFormat, settings.width, settings.height, &error);
+  if (!frame) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  AVCodecContext* ctx = OpenVideoEncoder(spec, settings, &error);
+  if (!ctx) {
     av_frame_free(&frame);
-    avcodec_free_context(&ctx);
-    Napi::Error::New(env, "Failed to allocate frame buffer").ThrowAsJavaScriptException();
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Make frame writable
-  av_frame_make_writable(frame);
-  
-  SwsContext* swsCtx = nullptr;
-  
-  if (isI420) {
-    // Input is already I420/YUV420P - copy directly to frame
-    int ySize = width * height;
-    int uvStride = width / 2;
-    int uvHeight = height / 2;
-    
-    // Copy Y plane
-    for (int y = 0; y < height; y++) {
-      memcpy(frame->data[0] + y * frame->linesize[0], inputData + y * width, width);
-    }
-    // Copy U plane
-    for (int y = 0; y < uvHeight; y++) {
-      memcpy(frame->data[1] + y * frame->linesize[1], inputData + ySize + y * uvStride, uvStride);
-    }
-    // Copy V plane
-    for (int y = 0; y < uvHeight; y++) {
-      memcpy(frame->data[2] + y * frame->linesize[2], inputData + ySize + uvStride * uvHeight + y * uvStride, uvStride);
+
+  AVPixelFormat inputFormat = EncoderInputFormat(ctx);
+  if (frame->format != inputFormat) {
+    AVFrame* converted = ConvertFrameFormat(frame, inputFormat, &error);
+    av_frame_free(&frame);
+    if (!converted) {
+      avcodec_free_context(&ctx);
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
     }
-  } else {
-    // Convert RGB24 to YUV420P
-    swsCtx = sws_getContext(
-      width, height, AV_PIX_FMT_RGB24,
-      width, height, AV_PIX_FMT_YUV420P,
-      SWS_BILINEAR, nullptr, nullptr, nullptr
-    );
-    
-    if (!swsCtx) {
-      av_frame_free(&frame);
+    frame = converted;
+  }
+  if (ctx->hw_frames_ctx) {
+    AVFrame* uploaded = UploadFrame(ctx->hw_frames_ctx, frame, &error);
+    av_frame_free(&frame);
+    if (!uploaded) {
       avcodec_free_context(&ctx);
-      Napi::Error::New(env, "Failed to create swscale context").ThrowAsJavaScriptException();
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    
-    uint8_t* srcSlice[1] = { inputData };
-    int srcStride[1] = { width * 3 };
-    
-    sws_scale(swsCtx, srcSlice, srcStride, 0, height, frame->data, frame->linesize);
+    frame = uploaded;
   }
-  
-  // Set PTS (first frame)
+
   frame->pts = 0;
   frame->pict_type = AV_PICTURE_TYPE_I;  // Force keyframe for single-frame encode
-  
-  // Allocate packet
+
   AVPacket* pkt = av_packet_alloc();
-  
-  // Send frame to encoder
+
+  // Send the frame, then drain so encoders with lookahead emit it too
   int ret = avcodec_send_frame(ctx, frame);
-  if (ret < 0) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    av_packet_free(&pkt);
-    sws_freeContext(swsCtx);
-    av_frame_free(&frame);
-    avcodec_free_context(&ctx);
-    Napi::Error::New(env, std::string("Failed to send frame: ") + errbuf).ThrowAsJavaScriptException();
-    return env.Undefined();
+  if (ret >= 0) {
+    ret = avcodec_send_frame(ctx, nullptr);
   }
-  
-  // Flush encoder (send NULL to get all pending frames)
-  avcodec_send_frame(ctx, nullptr);
-  
-  // Receive encoded packet
-  ret = avcodec_receive_packet(ctx, pkt);
+  if (ret >= 0) {
+    ret = avcodec_receive_packet(ctx, pkt);
+  }
+  av_frame_free(&frame);
   if (ret < 0) {
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
     av_packet_free(&pkt);
-    sws_freeContext(swsCtx);
-    av_frame_free(&frame);
     avcodec_free_context(&ctx);
-    Napi::Error::New(env, std::string("Failed to receive packet: ") + errbuf).ThrowAsJavaScriptException();
+    Napi::Error::New(env, "Failed to encode frame: " + AvErrorString(ret)).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Copy encoded data to JS buffer
-  Napi::Buffer<uint8_t> outputBuffer = Napi::Buffer<uint8_t>::Copy(env, pkt->data, pkt->size);
-  
-  bool isKeyframe = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
-  
-  // Build result
+
   Napi::Object result = Napi::Object::New(env);
-  result.Set("data", outputBuffer);
-  result.Set("isKeyframe", Napi::Boolean::New(env, isKeyframe));
+  result.Set("isKeyframe", Napi::Boolean::New(env, (pkt->flags & AV_PKT_FLAG_KEY) != 0));
   result.Set("size", Napi::Number::New(env, pkt->size));
-  
-  // Cleanup
-  av_packet_unref(pkt);
+  result.Set("data", PacketToBuffer(env, pkt));
+
   av_packet_free(&pkt);
-  sws_freeContext(swsCtx);
-  av_frame_free(&frame);
   avcodec_free_context(&ctx);
-  
   return result;
 }
 
 /**
- * Decode a VP8 frame from raw IVF frame data.
+ * Decode a single keyframe with any registry codec and return it as RGB24.
  * This is a synchronous decode for testing purposes.
- * 
- * decodeVP8Frame(frameData: Buffer) => { width, height, format, data: Buffer }
+ *
+ * decodeFrame(data: Buffer, { codec }) => { width, height, format, data: Buffer }
  */
-Napi::Value DecodeVP8Frame(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-  
-  if (info.Length() < 1 || !info[0].IsBuffer()) {
-    Napi::TypeError::New(env, "Expected Buffer with VP8 frame data").ThrowAsJavaScriptException();
+Napi::Value DecodeImage(Napi::Env env, Napi::Buffer<uint8_t> inputBuffer, const std::string& codecString) {
+  std::string error;
+  VideoCodecSpec spec;
+  if (!ParseVideoCodec(codecString, &spec, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
-  uint8_t* frameData = inputBuffer.Data();
-  size_t frameSize = inputBuffer.Length();
-  
-  // Find VP8 decoder
-  const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_VP8);
-  if (!codec) {
-    Napi::Error::New(env, "VP8 decoder not found").ThrowAsJavaScriptException();
-    return env.Undefined();
-  }
-  
-  // Allocate codec context
-  AVCodecContext* ctx = avcodec_alloc_context3(codec);
+
+  AVCodecContext* ctx = OpenVideoDecoder(spec, nullptr, 0, HardwarePreference::kPreferSoftware, &error);
   if (!ctx) {
-    Napi::Error::New(env, "Failed to allocate codec context").ThrowAsJavaScriptException();
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Open codec
-  if (avcodec_open2(ctx, codec, nullptr) < 0) {
+
+  // Copy into a padded packet; decoders may read past the end of the data.
+  AVPacket* pkt = av_packet_alloc();
+  if (!pkt || av_new_packet(pkt, static_cast<int>(inputBuffer.Length())) < 0) {
+    av_packet_free(&pkt);
     avcodec_free_context(&ctx);
-    Napi::Error::New(env, "Failed to open codec").ThrowAsJavaScriptException();
+    Napi::Error::New(env, "Failed to allocate packet").ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Create packet
-  AVPacket* pkt = av_packet_alloc();
-  pkt->data = frameData;
-  pkt->size = static_cast<int>(frameSize);
-  
-  // Create frame
+  memcpy(pkt->data, inputBuffer.Data(), inputBuffer.Length());
+
+  // Drain after the packet so frame-threaded decoders return it as well
   AVFrame* frame = av_frame_alloc();
-  
-  // Send packet
   int ret = avcodec_send_packet(ctx, pkt);
-  if (ret < 0) {
-    av_frame_free(&frame);
-    av_packet_free(&pkt);
-    avcodec_free_context(&ctx);
-    
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    Napi::Error::New(env, std::string("Failed to send packet: ") + errbuf).ThrowAsJavaScriptException();
-    return env.Undefined();
+  if (ret >= 0) {
+    ret = avcodec_send_packet(ctx, nullptr);
   }
-  
-  // Receive frame
-  ret = avcodec_receive_frame(ctx, frame);
+  if (ret >= 0) {
+    ret = avcodec_receive_frame(ctx, frame);
+  }
+  av_packet_free(&pkt);
   if (ret < 0) {
     av_frame_free(&frame);
-    av_packet_free(&pkt);
     avcodec_free_context(&ctx);
-    
-    char errbuf[256];
-    av_strerror(ret, errbuf, sizeof(errbuf));
-    Napi::Error::New(env, std::string("Failed to receive frame: ") + errbuf).ThrowAsJavaScriptException();
+    Napi::Error::New(env, "Failed to decode frame: " + AvErrorString(ret)).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
+
   // Convert to RGB24 for easy verification
   int width = frame->width;
   int height = frame->height;
-  size_t rgbSize = width * height * 3;
-  
-  SwsContext* swsCtx = sws_getContext(
-    width, height, static_cast<AVPixelFormat>(frame->format),
-    width, height, AV_PIX_FMT_RGB24,
-    SWS_BILINEAR, nullptr, nullptr, nullptr
-  );
-  
-  if (!swsCtx) {
-    av_frame_free(&frame);
-    av_packet_free(&pkt);
-    avcodec_free_context(&ctx);
-    Napi::Error::New(env, "Failed to create swscale context").ThrowAsJavaScriptException();
+  Napi::Buffer<uint8_t> rgbBuffer = Napi::Buffer<uint8_t>::New(env, static_cast<size_t>(width) * height * 3);
+  uint8_t* rgbData = rgbBuffer.Data();
+
+  uint8_t* dstSlice[4] = { rgbData, nullptr, nullptr, nullptr };
+  int dstStride[4] = { width * 3, 0, 0, 0 };
+  bool converted = ConvertImage(frame->data, frame->linesize, static_cast<AVPixelFormat>(frame->format),
+                                dstSlice, dstStride, AV_PIX_FMT_RGB24, width, height, &error);
+  av_frame_free(&frame);
+  avcodec_free_context(&ctx);
+  if (!converted) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return env.Undefined();
   }
-  
-  // Allocate RGB buffer
-  Napi::Buffer<uint8_t> rgbBuffer = Napi::Buffer<uint8_t>::New(env, rgbSize);
-  uint8_t* rgbData = rgbBuffer.Data();
-  
-  uint8_t* dstSlice[1] = { rgbData };
-  int dstStride[1] = { width * 3 };
-  
-  sws_scale(swsCtx, frame->data, frame->linesize, 0, height, dstSlice, dstStride);
-  
-  // Build result
+
   Napi::Object result = Napi::Object::New(env);
   result.Set("width", Napi::Number::New(env, width));
   result.Set("height", Napi::Number::New(env, height));
   result.Set("format", Napi::String::New(env, "rgb24"));
   result.Set("data", rgbBuffer);
-  
+
   // First pixel for quick verification
   result.Set("firstPixelR", Napi::Number::New(env, rgbData[0]));
   result.Set("firstPixelG", Napi::Number::New(env, rgbData[1]));
   result.Set("firstPixelB", Napi::Number::New(env, rgbData[2]));
-  
-  // Cleanup
-  sws_freeContext(swsCtx);
-  av_frame_free(&frame);
-  av_packet_free(&pkt);
-  avcodec_free_context(&ctx);
-  
   return result;
 }
 
+Napi::Value EncodeFrame(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsObject() ||
+      !info[1].As<Napi::Object>().Get("codec").IsString()) {
+    Napi::TypeError::New(env, "Expected (Buffer, {codec, width, height, bitrate?, format?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+  return EncodeImage(env, info[0].As<Napi::Buffer<uint8_t>>(), options,
+                     options.Get("codec").As<Napi::String>().Utf8Value());
+}
+
+Napi::Value DecodeFrame(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsObject() ||
+      !info[1].As<Napi::Object>().Get("codec").IsString()) {
+    Napi::TypeError::New(env, "Expected (Buffer, {codec})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return DecodeImage(env, info[0].As<Napi::Buffer<uint8_t>>(),
+                     info[1].As<Napi::Object>().Get("codec").As<Napi::String>().Utf8Value());
+}
+
+/**
+ * encodeVP8Frame(data, { width, height, bitrate, format? }): encodeFrame() with codec 'vp8'.
+ */
+Napi::Value EncodeVP8Frame(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected (Buffer, {width, height, bitrate})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return EncodeImage(env, info[0].As<Napi::Buffer<uint8_t>>(), info[1].As<Napi::Object>(), "vp8");
+}
+
+/**
+ * decodeVP8Frame(data): decodeFrame() with codec 'vp8'.
+ */
+Napi::Value DecodeVP8Frame(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "Expected Buffer with VP8 frame data").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return DecodeImage(env, info[0].As<Napi::Buffer<uint8_t>>(), "vp8");
+}
+
+/**
+ * Convert a raw image between pixel formats (I420, NV12, RGBA, BGRA, RGB24, ...).
+ * Used by VideoFrame.copyTo() for frames whose pixels live in JS memory.
+ *
+ * convertFrame(src: Uint8Array, { format, codedWidth, codedHeight, layout? },
+ *              dest: Uint8Array, { format, layout? }) -> [{ offset, stride }, ...]
+ */
+Napi::Value ConvertFrame(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 4 || !info[0].IsTypedArray() || !info[1].IsObject() ||
+      !info[2].IsTypedArray() || !info[3].IsObject()) {
+    Napi::TypeError::New(env, "Expected (src, {format, codedWidth, codedHeight, layout?}, dest, {format, layout?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Uint8Array src = info[0].As<Napi::Uint8Array>();
+  Napi::Object srcInit = info[1].As<Napi::Object>();
+  Napi::Uint8Array dest = info[2].As<Napi::Uint8Array>();
+  Napi::Object destInit = info[3].As<Napi::Object>();
+
+  if (!srcInit.Get("format").IsString() || !destInit.Get("format").IsString() ||
+      !srcInit.Get("codedWidth").IsNumber() || !srcInit.Get("codedHeight").IsNumber()) {
+    Napi::TypeError::New(env, "convertFrame requires formats, codedWidth and codedHeight").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  AVPixelFormat srcFormat = PixelFormatFromString(srcInit.Get("format").As<Napi::String>().Utf8Value());
+  AVPixelFormat dstFormat = PixelFormatFromString(destInit.Get("format").As<Napi::String>().Utf8Value());
+  if (srcFormat == AV_PIX_FMT_NONE || dstFormat == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported pixel format").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int width = srcInit.Get("codedWidth").As<Napi::Number>().Int32Value();
+  int height = srcInit.Get("codedHeight").As<Napi::Number>().Int32Value();
+
+  std::string error;
+  std::vector<PlaneLayout> srcPlanes;
+  std::vector<PlaneLayout> dstPlanes;
+  if (!ResolveLayout(srcInit.Get("layout"), srcFormat, width, height, src.ByteLength(), &srcPlanes, &error) ||
+      !ResolveLayout(destInit.Get("layout"), dstFormat, width, height, dest.ByteLength(), &dstPlanes, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  uint8_t* srcData[4];
+  int srcStride[4];
+  uint8_t* dstData[4];
+  int dstStride[4];
+  ApplyLayout(src.Data(), srcPlanes, srcData, srcStride);
+  ApplyLayout(dest.Data(), dstPlanes, dstData, dstStride);
+
+  if (!ConvertImage(srcData, srcStride, srcFormat, dstData, dstStride, dstFormat, width, height, &error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return LayoutToArray(env, dstPlanes);
+}
+
+/**
+ * Bytes needed for a tightly packed image of the given format and size,
+ * or 0 if the format is not supported.
+ *
+ * frameAllocationSize(format: string, width: number, height: number) -> number
+ */
+Napi::Value FrameAllocationSize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 3 || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Expected (format, width, height)").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  AVPixelFormat format = PixelFormatFromString(info[0].As<Napi::String>().Utf8Value());
+  std::vector<PlaneLayout> planes;
+  size_t size = format == AV_PIX_FMT_NONE ? 0 : PackedLayout(
+    format, info[1].As<Napi::Number>().Int32Value(), info[2].As<Napi::Number>().Int32Value(), &planes);
+  return Napi::Number::New(env, static_cast<double>(size));
+}
+
+/**
+ * Checks a VideoFrame buffer init the way the NativeVideoFrame constructor
+ * does, without building a frame: the format, the size and the plane
+ * layout against `byteLength`. Throws a TypeError if they don't fit.
+ *
+ * validateFrameLayout(byteLength: number, {format, codedWidth, codedHeight, layout?}) -> undefined
+ */
+Napi::Value ValidateFrameLayout(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected (byteLength, {format, codedWidth, codedHeight, layout?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object init = info[1].As<Napi::Object>();
+  if (!init.Get("format").IsString() || !init.Get("codedWidth").IsNumber() ||
+      !init.Get("codedHeight").IsNumber()) {
+    Napi::TypeError::New(env, "Frame init requires format, codedWidth and codedHeight").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  AVPixelFormat format = PixelFormatFromString(init.Get("format").As<Napi::String>().Utf8Value());
+  if (format == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported frame format").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int width = init.Get("codedWidth").As<Napi::Number>().Int32Value();
+  int height = init.Get("codedHeight").As<Napi::Number>().Int32Value();
+  if (width <= 0 || height <= 0) {
+    Napi::TypeError::New(env, "Unsupported frame format or size").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::string error;
+  std::vector<PlaneLayout> planes;
+  size_t byteLength = static_cast<size_t>(info[0].As<Napi::Number>().DoubleValue());
+  if (!ResolveLayout(init.Get("layout"), format, width, height, byteLength, &planes, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+/**
+ * Hit/miss counters of the shared SwsContext cache.
+ *
+ * getScalerCacheStats() -> { hits, misses, idle }
+ */
+Napi::Value GetScalerCacheStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  ScalerCache::Stats stats = ScalerCache::Shared().GetStats();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+  result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+  result.Set("idle", Napi::Number::New(env, static_cast<double>(stats.idle)));
+  return result;
+}
+
+Napi::Object SchedulerStatsToObject(Napi::Env env, const CodecScheduler::Stats& stats) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("threads", Napi::Number::New(env, static_cast<double>(stats.threads)));
+  result.Set("codecThreads", Napi::Number::New(env, static_cast<double>(stats.codecThreads)));
+  result.Set("sessions", Napi::Number::New(env, static_cast<double>(stats.sessions)));
+  result.Set("ready", Napi::Number::New(env, static_cast<double>(stats.ready)));
+  result.Set("executed", Napi::Number::New(env, static_cast<double>(stats.executed)));
+  result.Set("steals", Napi::Number::New(env, static_cast<double>(stats.steals)));
+  return result;
+}
+
+/**
+ * Resize the thread pool all codec sessions share. Omitted keys keep their
+ * current value; 0 means one per core.
+ *
+ * configureScheduler({ threads?, codecThreads? }) -> stats
+ */
+Napi::Value ConfigureScheduler(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  CodecScheduler::Stats current = CodecScheduler::Shared().GetStats();
+  size_t values[2] = {current.threads, current.codecThreads};
+  const char* keys[2] = {"threads", "codecThreads"};
+  for (int i = 0; i < 2; i++) {
+    if (!options.Has(keys[i]) || options.Get(keys[i]).IsUndefined()) {
+      continue;
+    }
+    Napi::Value value = options.Get(keys[i]);
+    if (!value.IsNumber() || value.As<Napi::Number>().Int64Value() < 0) {
+      Napi::RangeError::New(env, std::string(keys[i]) + " must be a non-negative number")
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    values[i] = static_cast<size_t>(value.As<Napi::Number>().Int64Value());
+  }
+
+  CodecScheduler::Shared().Configure(values[0], values[1]);
+  return SchedulerStatsToObject(env, CodecScheduler::Shared().GetStats());
+}
+
+/**
+ * Counters of the shared codec thread pool.
+ *
+ * getSchedulerStats() -> { threads, codecThreads, sessions, ready, executed, steals }
+ */
+Napi::Value GetSchedulerStats(const Napi::CallbackInfo& info) {
+  return SchedulerStatsToObject(info.Env(), CodecScheduler::Shared().GetStats());
+}
+
 /**
  * Module initialization
  */
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  // Once per environment: the main thread and each worker_threads Worker
+  AddonData::Create(env);
+
   exports.Set("hello", Napi::Function::New(env, Hello));
   exports.Set("getFFmpegVersion", Napi::Function::New(env, GetFFmpegVersion));
   exports.Set("hasCodec", Napi::Function::New(env, HasCodec));
   exports.Set("listCodecs", Napi::Function::New(env, ListCodecs));
+  exports.Set("isVideoConfigSupported", Napi::Function::New(env, IsVideoConfigSupported));
+  exports.Set("encodeFrame", Napi::Function::New(env, EncodeFrame));
+  exports.Set("decodeFrame", Napi::Function::New(env, DecodeFrame));
+  exports.Set("encodeBatch", Napi::Function::New(env, EncodeBatch));
+  exports.Set("benchmark", Napi::Function::New(env, RunBenchmark));
   exports.Set("encodeVP8Frame", Napi::Function::New(env, EncodeVP8Frame));
   exports.Set("decodeVP8Frame", Napi::Function::New(env, DecodeVP8Frame));
+  exports.Set("convertFrame", Napi::Function::New(env, ConvertFrame));
+  exports.Set("frameAllocationSize", Napi::Function::New(env, FrameAllocationSize));
+  exports.Set("validateFrameLayout", Napi::Function::New(env, ValidateFrameLayout));
+  exports.Set("getScalerCacheStats", Napi::Function::New(env, GetScalerCacheStats));
+  exports.Set("configureScheduler", Napi::Function::New(env, ConfigureScheduler));
+  exports.Set("getSchedulerStats", Napi::Function::New(env, GetSchedulerStats));
+
+  NativeAudioDecoder::Init(env, exports);
+  NativeAudioEncoder::Init(env, exports);
+  NativeDemuxer::Init(env, exports);
+  NativeMuxer::Init(env, exports);
+  NativeVideoDecoder::Init(env, exports);
+  NativeVideoEncoder::Init(env, exports);
+  NativeVideoFrame::Init(env, exports);
+  NativeVideoPipeline::Init(env, exports);
   
   return exports;
 }
@@ -0,0 +1,19 @@
+/**
+ * AddonData implementation.
+ */
+
+#include "addon_data.h"
+
+#include "adopted_buffer.h"
+
+AddonData* AddonData::Create(Napi::Env env) {
+  AddonData* data = new AddonData();
+  data->releaser = std::make_shared<OwnerReleaser>(env);
+  env.SetInstanceData(data);
+  return data;
+}
+
+AddonData::~AddonData() {
+  // Buffers still in use elsewhere may outlive the environment
+  releaser->Shutdown();
+}
@@ -0,0 +1,42 @@
+/**
+ * AddonData
+ *
+ * Per-environment state of the addon, stored as napi instance data. Node
+ * runs Init() once for the main thread and once more for every
+ * worker_threads Worker that loads the addon; each environment gets its own
+ * class constructors and JS-thread helpers, so no JS handle crosses into
+ * another environment.
+ *
+ * Everything else is process-wide and thread-safe: the codec scheduler,
+ * the scaler cache, hardware devices and the shared frame registry.
+ */
+
+#ifndef WEBCODECS_NATIVE_ADDON_DATA_H_
+#define WEBCODECS_NATIVE_ADDON_DATA_H_
+
+#include <napi.h>
+#include <memory>
+
+class OwnerReleaser;
+
+struct AddonData {
+  /**
+   * Create this environment's AddonData; freed when the environment is.
+   */
+  static AddonData* Create(Napi::Env env);
+
+  static AddonData* Get(Napi::Env env) { return env.GetInstanceData<AddonData>(); }
+
+  ~AddonData();
+
+  Napi::FunctionReference muxer;
+  Napi::FunctionReference videoDecoder;
+  Napi::FunctionReference videoEncoder;
+  Napi::FunctionReference videoFrame;
+  Napi::FunctionReference videoPipeline;
+
+  // Drops references to JS memory adopted by AVFrames; see adopted_buffer.h.
+  std::shared_ptr<OwnerReleaser> releaser;
+};
+
+#endif  // WEBCODECS_NATIVE_ADDON_DATA_H_
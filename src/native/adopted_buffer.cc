@@ -0,0 +1,61 @@
+/**
+ * Adopted buffer implementation.
+ */
+
+#include "adopted_buffer.h"
+
+#include <memory>
+
+#include "addon_data.h"
+
+namespace {
+
+struct Adopted {
+  Napi::ObjectReference* owner;
+  std::shared_ptr<OwnerReleaser> releaser;
+};
+
+void ReleaseAdopted(void* opaque, uint8_t*) {
+  Adopted* adopted = static_cast<Adopted*>(opaque);
+  adopted->releaser->Release(adopted->owner);
+  delete adopted;
+}
+
+}  // namespace
+
+OwnerReleaser::OwnerReleaser(Napi::Env env) {
+  tsfn_ = Napi::ThreadSafeFunction::New(
+    env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}), "OwnerReleaser", 0, 1);
+  // Never keep the event loop alive just for this
+  tsfn_.Unref(env);
+}
+
+void OwnerReleaser::Release(Napi::ObjectReference* owner) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!alive_) {
+    return;
+  }
+  napi_status status = tsfn_.NonBlockingCall(owner,
+    [](Napi::Env, Napi::Function, Napi::ObjectReference* ref) { delete ref; });
+  // A failed call means the environment is closing and takes the reference with it
+  (void)status;
+}
+
+void OwnerReleaser::Shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (alive_) {
+    alive_ = false;
+    tsfn_.Release();
+  }
+}
+
+AVBufferRef* AdoptBuffer(Napi::Env env, Napi::Object owner, uint8_t* data, size_t size) {
+  Adopted* adopted = new Adopted{new Napi::ObjectReference(Napi::Persistent(owner)),
+                                 AddonData::Get(env)->releaser};
+  AVBufferRef* buffer = av_buffer_create(data, size, ReleaseAdopted, adopted, AV_BUFFER_FLAG_READONLY);
+  if (!buffer) {
+    delete adopted->owner;
+    delete adopted;
+  }
+  return buffer;
+}
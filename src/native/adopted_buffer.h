@@ -0,0 +1,52 @@
+/**
+ * Adopted buffers
+ *
+ * The reverse of external_buffer.h: wrap JS-owned memory (an ArrayBuffer
+ * handed over with VideoFrame's `transfer`, or a SharedArrayBuffer) in an
+ * AVBufferRef, so an AVFrame can point at it without a copy. The buffer
+ * keeps a reference to the JS object that owns the memory.
+ *
+ * The last av_buffer_unref() may happen on any thread, e.g. an encoder's
+ * worker or another worker_threads environment. The JS reference is then
+ * dropped on its own environment's JS thread by that environment's
+ * OwnerReleaser.
+ */
+
+#ifndef WEBCODECS_NATIVE_ADOPTED_BUFFER_H_
+#define WEBCODECS_NATIVE_ADOPTED_BUFFER_H_
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+extern "C" {
+#include <libavutil/buffer.h>
+}
+
+class OwnerReleaser {
+ public:
+  explicit OwnerReleaser(Napi::Env env);
+
+  /**
+   * Delete `owner` on the JS thread. Any thread; once the environment has
+   * shut down the reference is leaked, since it can no longer be deleted.
+   */
+  void Release(Napi::ObjectReference* owner);
+
+  // Environment teardown, on the JS thread.
+  void Shutdown();
+
+ private:
+  std::mutex mutex_;
+  Napi::ThreadSafeFunction tsfn_;
+  bool alive_ = true;
+};
+
+/**
+ * A read-only AVBufferRef over `size` bytes at `data`, which `owner` must
+ * keep alive. Returns nullptr if it cannot be allocated. JS thread only.
+ */
+AVBufferRef* AdoptBuffer(Napi::Env env, Napi::Object owner, uint8_t* data, size_t size);
+
+#endif  // WEBCODECS_NATIVE_ADOPTED_BUFFER_H_
@@ -0,0 +1,230 @@
+/**
+ * Audio codec registry implementation.
+ */
+
+#include "audio_codec_registry.h"
+
+#include <cctype>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+#include "ffmpeg_utils.h"
+#include "packet_pool.h"
+
+namespace {
+
+struct CodecEntry {
+  AVCodecID id;
+  const char* name;
+  // Tried in order; the first one built into FFmpeg wins.
+  const char* encoders[2];
+  const char* decoders[2];
+};
+
+const CodecEntry kCodecs[] = {
+  {AV_CODEC_ID_OPUS, "Opus", {"libopus", "opus"}, {"opus", "libopus"}},
+  {AV_CODEC_ID_AAC, "AAC", {"aac", "libfdk_aac"}, {"aac", "libfdk_aac"}},
+  {AV_CODEC_ID_FLAC, "FLAC", {"flac", nullptr}, {"flac", nullptr}},
+};
+
+// Preferred encoder sample formats; the codec's own list decides otherwise.
+constexpr AVSampleFormat kPreferredSampleFormats[] = {
+  AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S16,
+};
+
+const CodecEntry* FindEntry(AVCodecID id) {
+  for (const CodecEntry& entry : kCodecs) {
+    if (entry.id == id) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+const AVCodec* FindByName(const char* const* names, size_t count, bool encoder) {
+  for (size_t i = 0; i < count && names[i]; i++) {
+    const AVCodec* codec = encoder ? avcodec_find_encoder_by_name(names[i])
+                                   : avcodec_find_decoder_by_name(names[i]);
+    if (codec) {
+      return codec;
+    }
+  }
+  return nullptr;
+}
+
+// The requested rate if supported, else the next higher one, else the highest.
+int ChooseSampleRate(const AVCodec* codec, int requested) {
+  if (!codec->supported_samplerates) {
+    return requested;
+  }
+  int above = 0;
+  int highest = 0;
+  for (const int* rate = codec->supported_samplerates; *rate; rate++) {
+    if (*rate == requested) {
+      return requested;
+    }
+    if (*rate > requested && (above == 0 || *rate < above)) {
+      above = *rate;
+    }
+    if (*rate > highest) {
+      highest = *rate;
+    }
+  }
+  return above ? above : highest;
+}
+
+AVSampleFormat ChooseSampleFormat(const AVCodec* codec) {
+  if (!codec->sample_fmts) {
+    return AV_SAMPLE_FMT_FLTP;
+  }
+  for (AVSampleFormat preferred : kPreferredSampleFormats) {
+    for (const AVSampleFormat* format = codec->sample_fmts; *format != AV_SAMPLE_FMT_NONE; format++) {
+      if (*format == preferred) {
+        return preferred;
+      }
+    }
+  }
+  return codec->sample_fmts[0];
+}
+
+}  // namespace
+
+bool ParseAudioCodec(const std::string& codec, AudioCodecSpec* spec, std::string* error) {
+  std::string lower = codec;
+  for (char& c : lower) {
+    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+  }
+
+  *spec = AudioCodecSpec();
+  if (lower == "opus") {
+    spec->id = AV_CODEC_ID_OPUS;
+  } else if (lower == "mp4a.40.2" || lower == "mp4a.40.02") {
+    spec->id = AV_CODEC_ID_AAC;
+  } else if (lower.compare(0, 5, "mp4a.") == 0) {
+    *error = "Only AAC-LC (mp4a.40.2) is supported";
+    return false;
+  } else if (lower == "flac") {
+    spec->id = AV_CODEC_ID_FLAC;
+  } else {
+    *error = "Unsupported codec: " + codec;
+    return false;
+  }
+
+  spec->name = FindEntry(spec->id)->name;
+  return true;
+}
+
+const AVCodec* FindAudioEncoder(AVCodecID id) {
+  const CodecEntry* entry = FindEntry(id);
+  const AVCodec* codec = entry ? FindByName(entry->encoders, 2, true) : nullptr;
+  return codec ? codec : avcodec_find_encoder(id);
+}
+
+const AVCodec* FindAudioDecoder(AVCodecID id) {
+  const CodecEntry* entry = FindEntry(id);
+  const AVCodec* codec = entry ? FindByName(entry->decoders, 2, false) : nullptr;
+  return codec ? codec : avcodec_find_decoder(id);
+}
+
+AVCodecContext* OpenAudioEncoder(const AudioCodecSpec& spec, const AudioEncoderSettings& settings,
+                                 std::string* error) {
+  const AVCodec* codec = FindAudioEncoder(spec.id);
+  if (!codec) {
+    *error = std::string(spec.name) + " encoder not found";
+    return nullptr;
+  }
+  AVCodecContext* ctx = avcodec_alloc_context3(codec);
+  if (!ctx) {
+    *error = "Failed to allocate encoder context";
+    return nullptr;
+  }
+
+  ctx->sample_rate = ChooseSampleRate(codec, settings.sampleRate);
+  ctx->sample_fmt = ChooseSampleFormat(codec);
+  av_channel_layout_default(&ctx->ch_layout, settings.channels);
+  ctx->time_base = {1, ctx->sample_rate};
+  if (settings.bitrate > 0) {
+    ctx->bit_rate = settings.bitrate;
+  }
+  // Out-of-band headers, so AAC produces an AudioSpecificConfig description
+  ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  if (codec->capabilities & AV_CODEC_CAP_EXPERIMENTAL) {
+    ctx->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+  }
+  if (settings.packets) {
+    settings.packets->Attach(ctx);
+  }
+
+  int ret = avcodec_open2(ctx, codec, nullptr);
+  if (ret < 0) {
+    avcodec_free_context(&ctx);
+    *error = std::string("Failed to open ") + spec.name + " encoder (" + codec->name + "): " + AvErrorString(ret);
+    return nullptr;
+  }
+  return ctx;
+}
+
+AVCodecContext* OpenAudioDecoder(const AudioCodecSpec& spec, int sampleRate, int channels,
+                                 const uint8_t* extradata, size_t extradataSize,
+                                 std::string* error) {
+  const AVCodec* codec = FindAudioDecoder(spec.id);
+  if (!codec) {
+    *error = std::string(spec.name) + " decoder not found";
+    return nullptr;
+  }
+  AVCodecContext* ctx = avcodec_alloc_context3(codec);
+  if (!ctx) {
+    *error = "Failed to allocate codec context";
+    return nullptr;
+  }
+
+  // Used by decoders whose bitstream does not carry them (Opus without OpusHead)
+  ctx->sample_rate = sampleRate;
+  if (channels > 0) {
+    av_channel_layout_default(&ctx->ch_layout, channels);
+  }
+  ctx->pkt_timebase = {1, 1000000};
+
+  if (extradata && extradataSize > 0) {
+    ctx->extradata = static_cast<uint8_t*>(av_mallocz(extradataSize + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!ctx->extradata) {
+      avcodec_free_context(&ctx);
+      *error = "Failed to allocate codec description";
+      return nullptr;
+    }
+    memcpy(ctx->extradata, extradata, extradataSize);
+    ctx->extradata_size = static_cast<int>(extradataSize);
+  }
+
+  int ret = avcodec_open2(ctx, codec, nullptr);
+  if (ret < 0) {
+    avcodec_free_context(&ctx);
+    *error = std::string("Failed to open ") + spec.name + " decoder: " + AvErrorString(ret);
+    return nullptr;
+  }
+  return ctx;
+}
+
+std::vector<uint8_t> EncoderDescription(const AVCodecContext* ctx) {
+  std::vector<uint8_t> description;
+  if (!ctx->extradata || ctx->extradata_size <= 0) {
+    return description;
+  }
+  if (ctx->codec_id == AV_CODEC_ID_FLAC) {
+    // FFmpeg keeps the bare STREAMINFO body; WebCodecs wants a FLAC stream
+    // header with STREAMINFO as its only (last) metadata block.
+    const uint8_t header[] = {
+      'f', 'L', 'a', 'C', 0x80,
+      static_cast<uint8_t>(ctx->extradata_size >> 16),
+      static_cast<uint8_t>(ctx->extradata_size >> 8),
+      static_cast<uint8_t>(ctx->extradata_size),
+    };
+    description.assign(header, header + sizeof(header));
+  }
+  description.insert(description.end(), ctx->extradata, ctx->extradata + ctx->extradata_size);
+  return description;
+}
@@ -0,0 +1,72 @@
+/**
+ * Audio codec registry.
+ *
+ * The audio counterpart of codec_registry.h: maps WebCodecs codec strings
+ * ("opus", "mp4a.40.2", "flac") to FFmpeg codecs and opens encoder/decoder
+ * contexts for NativeAudioEncoder and NativeAudioDecoder.
+ */
+
+#ifndef WEBCODECS_NATIVE_AUDIO_CODEC_REGISTRY_H_
+#define WEBCODECS_NATIVE_AUDIO_CODEC_REGISTRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+class PacketPool;
+
+struct AudioCodecSpec {
+  AVCodecID id = AV_CODEC_ID_NONE;
+  const char* name = "";  // Human-readable, for error messages
+};
+
+struct AudioEncoderSettings {
+  int sampleRate = 48000;
+  int channels = 2;
+  int64_t bitrate = 0;  // 0 keeps the encoder's default
+  PacketPool* packets = nullptr;  // Optional destination for encoded packets
+};
+
+/**
+ * Parse a WebCodecs audio codec string. AAC is limited to AAC-LC.
+ */
+bool ParseAudioCodec(const std::string& codec, AudioCodecSpec* spec, std::string* error);
+
+/**
+ * Preferred FFmpeg implementation for a codec, or nullptr if none is built in.
+ */
+const AVCodec* FindAudioEncoder(AVCodecID id);
+const AVCodec* FindAudioDecoder(AVCodecID id);
+
+/**
+ * Allocate and open an encoder context for `spec`. The context runs at the
+ * supported sample rate closest to the requested one (Opus only takes
+ * 8-48 kHz) in the codec's preferred sample format; callers resample into
+ * ctx->sample_rate / ctx->sample_fmt. Returns nullptr and fills `error` on
+ * failure.
+ */
+AVCodecContext* OpenAudioEncoder(const AudioCodecSpec& spec, const AudioEncoderSettings& settings,
+                                 std::string* error);
+
+/**
+ * Allocate and open a decoder context for `spec`. `extradata` is the
+ * WebCodecs `description` (OpusHead, AudioSpecificConfig or FLAC
+ * STREAMINFO) and may be null. Packet timestamps are expected in
+ * microseconds.
+ */
+AVCodecContext* OpenAudioDecoder(const AudioCodecSpec& spec, int sampleRate, int channels,
+                                 const uint8_t* extradata, size_t extradataSize,
+                                 std::string* error);
+
+/**
+ * The WebCodecs `decoderConfig.description` for an opened encoder: its
+ * extradata, with the "fLaC" stream marker and block header FLAC expects.
+ */
+std::vector<uint8_t> EncoderDescription(const AVCodecContext* ctx);
+
+#endif  // WEBCODECS_NATIVE_AUDIO_CODEC_REGISTRY_H_
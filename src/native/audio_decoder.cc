@@ -0,0 +1,444 @@
+/**
+ * NativeAudioDecoder implementation.
+ *
+ * new NativeAudioDecoder({ codec, sampleRate, numberOfChannels, description?,
+ *                          poolMemoryLimit? },
+ *                        { output(data), error(err), dequeue() })
+ *   poolStats -> input packet pool counters, as on NativeVideoEncoder
+ *   decode(data: Buffer, { timestamp })
+ *   flush(done?: () => void) -> Promise<void> when no callback is given
+ *   close()
+ *
+ * codec is 'opus', 'mp4a.40.2' or 'flac'. description is the codec
+ * extradata; AAC without one must be ADTS.
+ * data is { data: Buffer, format, sampleRate, numberOfFrames,
+ * numberOfChannels, timestamp }, packed the way AudioData stores it.
+ * dequeue() fires once per decode() after the worker has consumed it.
+ */
+
+#include "audio_decoder.h"
+
+#include <cstring>
+
+#include "audio_format.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+#include "packet_pool.h"
+
+namespace {
+
+// Encoded chunks the worker queue is sized for. decode() never waits for
+// room; decodeQueueSize and dequeue carry the backpressure.
+constexpr size_t kDecodeQueueCapacity = 64;
+
+// Pooled input packet buffer; larger chunks are allocated individually.
+constexpr size_t kPacketBufferSize = 16 * 1024;
+
+// Whether `frame` holds its `size` packed bytes in one run inside buf[0],
+// as interleaved and mono frames do.
+bool ContiguousInBuffer(const AVFrame* frame, size_t size) {
+  bool onePlane = !av_sample_fmt_is_planar(static_cast<AVSampleFormat>(frame->format)) ||
+                  frame->ch_layout.nb_channels == 1;
+  const AVBufferRef* buffer = frame->buf[0];
+  return onePlane && buffer && frame->data[0] >= buffer->data &&
+         frame->data[0] + size <= buffer->data + buffer->size;
+}
+
+}  // namespace
+
+Napi::Object NativeAudioDecoder::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeAudioDecoder", {
+    InstanceMethod("decode", &NativeAudioDecoder::Decode),
+    InstanceAccessor("poolStats", &NativeAudioDecoder::GetPoolStats, nullptr),
+    InstanceMethod("flush", &NativeAudioDecoder::Flush),
+    InstanceMethod("close", &NativeAudioDecoder::Close),
+  });
+
+  exports.Set("NativeAudioDecoder", func);
+  return exports;
+}
+
+NativeAudioDecoder::NativeAudioDecoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeAudioDecoder>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected ({codec, sampleRate, numberOfChannels, description?}, {output, error, dequeue})").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  Napi::Object callbacks = info[1].As<Napi::Object>();
+  if (!callbacks.Get("output").IsFunction() || !callbacks.Get("error").IsFunction() ||
+      !callbacks.Get("dequeue").IsFunction()) {
+    Napi::TypeError::New(env, "Decoder callbacks require output, error and dequeue functions").ThrowAsJavaScriptException();
+    return;
+  }
+  if (!config.Get("codec").IsString() || !config.Get("sampleRate").IsNumber() ||
+      !config.Get("numberOfChannels").IsNumber()) {
+    Napi::TypeError::New(env, "Decoder config requires codec, sampleRate and numberOfChannels").ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string error;
+  if (!ParseAudioCodec(config.Get("codec").As<Napi::String>().Utf8Value(), &codec_, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  sampleRate_ = config.Get("sampleRate").As<Napi::Number>().Int32Value();
+  channels_ = config.Get("numberOfChannels").As<Napi::Number>().Int32Value();
+
+  Napi::Value description = config.Get("description");
+  if (description.IsTypedArray()) {
+    Napi::TypedArray view = description.As<Napi::TypedArray>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(view.ArrayBuffer().Data()) + view.ByteOffset();
+    description_.assign(bytes, bytes + view.ByteLength());
+  } else if (description.IsArrayBuffer()) {
+    Napi::ArrayBuffer buffer = description.As<Napi::ArrayBuffer>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer.Data());
+    description_.assign(bytes, bytes + buffer.ByteLength());
+  }
+
+  size_t poolLimit = 0;
+  if (!PoolLimitFromConfig(config, &poolLimit, &error)) {
+    Napi::RangeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  budget_ = std::make_shared<PoolBudget>(poolLimit);
+  packets_ = std::make_unique<PacketPool>(kPacketBufferSize, budget_);
+
+  if (!OpenCodec(&error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  errorCallback_ = Napi::Persistent(callbacks.Get("error").As<Napi::Function>());
+  dequeueCallback_ = Napi::Persistent(callbacks.Get("dequeue").As<Napi::Function>());
+
+  // Same lifetime scheme as NativeVideoEncoder: self-referenced until the
+  // TSFN finalizer runs, and the event loop is only held while busy.
+  Ref();
+  tsfn_ = Napi::ThreadSafeFunction::New(
+    env, callbacks.Get("output").As<Napi::Function>(), "NativeAudioDecoder", 0, 1,
+    [this](Napi::Env) { Unref(); });
+  tsfn_.Unref(env);
+
+  worker_ = std::make_unique<WorkerThread>(kDecodeQueueCapacity);
+  worker_->Start([this](Command& cmd) { HandleCommand(cmd); });
+}
+
+NativeAudioDecoder::~NativeAudioDecoder() {
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+}
+
+bool NativeAudioDecoder::OpenCodec(std::string* error) {
+  ctx_ = OpenAudioDecoder(codec_, sampleRate_, channels_, description_.data(), description_.size(), error);
+  if (!ctx_) {
+    return false;
+  }
+
+  frame_ = av_frame_alloc();
+  if (!frame_) {
+    ReleaseCodec();
+    *error = "Failed to allocate frame";
+    return false;
+  }
+  return true;
+}
+
+void NativeAudioDecoder::ReleaseCodec() {
+  resampler_.reset();
+  av_frame_free(&frame_);
+  avcodec_free_context(&ctx_);
+}
+
+// ---------------------------------------------------------------------------
+// JS thread
+// ---------------------------------------------------------------------------
+
+Napi::Value NativeAudioDecoder::Decode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "Expected (Buffer, {timestamp})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+  Napi::Object options = (info.Length() >= 2 && info[1].IsObject())
+    ? info[1].As<Napi::Object>()
+    : Napi::Object::New(env);
+
+  Command cmd;
+  cmd.type = CommandType::kDecode;
+  if (options.Get("timestamp").IsNumber()) {
+    cmd.timestamp = options.Get("timestamp").As<Napi::Number>().Int64Value();
+  }
+
+  // Copy the chunk into a pooled packet the worker can own.
+  AVPacket* packet = packets_->Acquire(static_cast<int>(inputBuffer.Length()));
+  if (!packet) {
+    Napi::Error::New(env, "Failed to allocate packet").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  memcpy(packet->data, inputBuffer.Data(), inputBuffer.Length());
+  packet->pts = cmd.timestamp;
+  packet->dts = AV_NOPTS_VALUE;
+  cmd.packet = packet;
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    UntrackCommand(env);
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+Napi::Value NativeAudioDecoder::GetPoolStats(const Napi::CallbackInfo& info) {
+  return PoolStatsToObject(info.Env(), budget_->GetStats());
+}
+
+/**
+ * Queue a drain. Once every sample produced by earlier decode() calls has
+ * been delivered to output(), `done` runs on the JS thread or, without a
+ * callback, the returned promise resolves. close() rejects the promise.
+ */
+Napi::Value NativeAudioDecoder::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Value done = info.Length() >= 1 ? info[0] : env.Undefined();
+  if (!done.IsFunction() && !done.IsUndefined()) {
+    Napi::TypeError::New(env, "Expected flush completion callback").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Command cmd;
+  cmd.type = CommandType::kFlush;
+  Napi::Value result;
+  cmd.flushId = flushes_.Add(env, done, &result);
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    flushes_.Remove(cmd.flushId);
+    UntrackCommand(env);
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return result;
+}
+
+void NativeAudioDecoder::Close(const Napi::CallbackInfo& info) {
+  if (!closed_) {
+    flushes_.Abort(info.Env(), "Decoder is closed");
+  }
+  Shutdown();
+}
+
+void NativeAudioDecoder::Shutdown() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+  inFlight_ = 0;
+  tsfn_.Release();
+}
+
+void NativeAudioDecoder::TrackCommand(Napi::Env env) {
+  if (inFlight_++ == 0) {
+    tsfn_.Ref(env);
+  }
+}
+
+void NativeAudioDecoder::UntrackCommand(Napi::Env env) {
+  if (inFlight_ > 0 && --inFlight_ == 0) {
+    tsfn_.Unref(env);
+  }
+}
+
+void NativeAudioDecoder::DeliverEvent(Napi::Env env, Napi::Function output, Event* event) {
+  if (!closed_) {
+    switch (event->kind) {
+      case Event::Kind::kData: {
+        const AVFrame* frame = event->frame;
+        AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+        int channels = frame->ch_layout.nb_channels;
+        // Interleaved or mono samples are already packed the AudioData way,
+        // so the Buffer can reference the decoder's frame. Otherwise one
+        // memcpy per plane straight into the Buffer AudioData adopts.
+        size_t size = PackedAudioSize(format, channels, frame->nb_samples);
+        Napi::Buffer<uint8_t> data;
+        if (ContiguousInBuffer(frame, size)) {
+          data = BufferRefToBuffer(env, frame->buf[0], frame->data[0], size);
+        } else {
+          data = Napi::Buffer<uint8_t>::New(env, size);
+          CopyAudioToBuffer(frame, data.Data());
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("data", data);
+        result.Set("format", Napi::String::New(env, SampleFormatName(format)));
+        result.Set("sampleRate", Napi::Number::New(env, frame->sample_rate));
+        result.Set("numberOfFrames", Napi::Number::New(env, frame->nb_samples));
+        result.Set("numberOfChannels", Napi::Number::New(env, channels));
+        result.Set("timestamp", Napi::Number::New(env, static_cast<double>(event->timestamp)));
+        output.Call({result});
+        break;
+      }
+      case Event::Kind::kError:
+        errorCallback_.Call({Napi::Error::New(env, event->message).Value()});
+        break;
+      case Event::Kind::kDequeue:
+        UntrackCommand(env);
+        dequeueCallback_.Call({});
+        break;
+      case Event::Kind::kFlushed: {
+        UntrackCommand(env);
+        flushes_.Complete(env, event->flushId);
+        break;
+      }
+    }
+  }
+
+  av_frame_free(&event->frame);
+  delete event;
+}
+
+// ---------------------------------------------------------------------------
+// Worker thread
+// ---------------------------------------------------------------------------
+
+void NativeAudioDecoder::Post(Event* event) {
+  napi_status status = tsfn_.BlockingCall(event,
+    [this](Napi::Env env, Napi::Function output, Event* ev) { DeliverEvent(env, output, ev); });
+  if (status != napi_ok) {
+    av_frame_free(&event->frame);
+    delete event;
+  }
+}
+
+void NativeAudioDecoder::PostError(const std::string& message) {
+  Event* event = new Event();
+  event->kind = Event::Kind::kError;
+  event->message = message;
+  Post(event);
+}
+
+void NativeAudioDecoder::HandleCommand(Command& cmd) {
+  switch (cmd.type) {
+    case CommandType::kDecode: {
+      DecodePacket(cmd);
+      packets_->Release(cmd.packet);
+      cmd.packet = nullptr;
+      Event* event = new Event();
+      event->kind = Event::Kind::kDequeue;
+      Post(event);
+      break;
+    }
+    case CommandType::kFlush: {
+      DrainDecoder();
+      Event* event = new Event();
+      event->kind = Event::Kind::kFlushed;
+      event->flushId = cmd.flushId;
+      Post(event);
+      break;
+    }
+    case CommandType::kEncode:
+    case CommandType::kReconfigure:
+      break;
+  }
+}
+
+void NativeAudioDecoder::DecodePacket(Command& cmd) {
+  int ret = avcodec_send_packet(ctx_, cmd.packet);
+  if (ret < 0) {
+    PostError("Failed to send packet: " + AvErrorString(ret));
+    return;
+  }
+
+  std::string error;
+  if (!ReceiveFrames(&error)) {
+    PostError(error);
+  }
+}
+
+/**
+ * Drain the decoder, then reset the codec buffers so decoding can resume.
+ */
+void NativeAudioDecoder::DrainDecoder() {
+  int ret = avcodec_send_packet(ctx_, nullptr);
+  if (ret < 0 && ret != AVERROR_EOF) {
+    PostError("Failed to flush decoder: " + AvErrorString(ret));
+  } else {
+    std::string error;
+    if (!ReceiveFrames(&error)) {
+      PostError(error);
+    }
+  }
+  avcodec_flush_buffers(ctx_);
+}
+
+/**
+ * Pull every frame the decoder has ready and post it to JS, converted to
+ * f32-planar if WebCodecs has no name for its sample format.
+ */
+bool NativeAudioDecoder::ReceiveFrames(std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_frame(ctx_, frame_);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive frame: " + AvErrorString(ret);
+      return false;
+    }
+
+    Event* event = new Event();
+    event->kind = Event::Kind::kData;
+    if (SampleFormatName(static_cast<AVSampleFormat>(frame_->format))) {
+      event->frame = av_frame_alloc();
+      if (event->frame) {
+        av_frame_move_ref(event->frame, frame_);
+      }
+    } else {
+      AudioResampler::Format target = {AV_SAMPLE_FMT_FLTP, frame_->sample_rate, frame_->ch_layout.nb_channels};
+      if (!resampler_ || resampler_->output() != target) {
+        resampler_ = std::make_unique<AudioResampler>(target);
+      }
+      event->frame = resampler_->ConvertFrame(frame_, error);
+      av_frame_unref(frame_);
+    }
+    if (!event->frame) {
+      av_frame_unref(frame_);
+      delete event;
+      if (error->empty()) {
+        *error = "Failed to allocate frame";
+      }
+      return false;
+    }
+
+    int64_t timestamp = event->frame->best_effort_timestamp;
+    if (timestamp == AV_NOPTS_VALUE) {
+      timestamp = event->frame->pts;
+    }
+    if (timestamp != AV_NOPTS_VALUE) {
+      event->timestamp = timestamp;
+    }
+
+    Post(event);
+  }
+}
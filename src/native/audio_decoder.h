@@ -0,0 +1,95 @@
+/**
+ * NativeAudioDecoder
+ *
+ * A long-lived decoder session for the codecs in the audio codec registry
+ * (Opus, AAC-LC, FLAC). Decoded samples keep the decoder's own sample
+ * format when WebCodecs has a name for it (f32-planar for Opus and AAC,
+ * s16/s32 for FLAC); anything else is converted to f32-planar by an
+ * AudioResampler.
+ *
+ * Decoding runs on a per-session WorkerThread, like NativeVideoDecoder.
+ * decode() and flush() only enqueue commands; audio data, errors and queue
+ * progress come back to JS through a ThreadSafeFunction.
+ */
+
+#ifndef WEBCODECS_NATIVE_AUDIO_DECODER_H_
+#define WEBCODECS_NATIVE_AUDIO_DECODER_H_
+
+#include <napi.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "audio_codec_registry.h"
+#include "audio_resampler.h"
+#include "buffer_pool.h"
+#include "packet_pool.h"
+#include "pending_flushes.h"
+#include "worker_thread.h"
+
+class NativeAudioDecoder : public Napi::ObjectWrap<NativeAudioDecoder> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeAudioDecoder(const Napi::CallbackInfo& info);
+  ~NativeAudioDecoder() override;
+
+ private:
+  // Worker -> JS notification, delivered through tsfn_.
+  struct Event {
+    enum class Kind { kData, kError, kDequeue, kFlushed };
+    Kind kind;
+    AVFrame* frame = nullptr;  // Owned decoded samples
+    int64_t timestamp = 0;
+    std::string message;
+    uint32_t flushId = 0;
+  };
+
+  // JS thread
+  Napi::Value Decode(const Napi::CallbackInfo& info);
+  Napi::Value GetPoolStats(const Napi::CallbackInfo& info);
+  Napi::Value Flush(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  void DeliverEvent(Napi::Env env, Napi::Function output, Event* event);
+  void TrackCommand(Napi::Env env);
+  void UntrackCommand(Napi::Env env);
+  void Shutdown();
+
+  // Worker thread
+  void HandleCommand(Command& cmd);
+  void DecodePacket(Command& cmd);
+  void DrainDecoder();
+  bool ReceiveFrames(std::string* error);
+  void Post(Event* event);
+  void PostError(const std::string& message);
+
+  bool OpenCodec(std::string* error);
+  void ReleaseCodec();
+
+  AVCodecContext* ctx_ = nullptr;
+  AVFrame* frame_ = nullptr;
+  AudioCodecSpec codec_;
+  int sampleRate_ = 0;
+  int channels_ = 0;
+  std::vector<uint8_t> description_;  // Codec extradata
+  std::unique_ptr<AudioResampler> resampler_;  // Only for formats WebCodecs cannot name
+
+  // Input packets; shells come back after each decode.
+  std::shared_ptr<PoolBudget> budget_;
+  std::unique_ptr<PacketPool> packets_;
+
+  std::unique_ptr<WorkerThread> worker_;
+  Napi::ThreadSafeFunction tsfn_;
+  Napi::FunctionReference errorCallback_;
+  Napi::FunctionReference dequeueCallback_;
+  PendingFlushes flushes_;
+  uint32_t inFlight_ = 0;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_AUDIO_DECODER_H_
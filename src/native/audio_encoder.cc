@@ -0,0 +1,535 @@
+/**
+ * NativeAudioEncoder implementation.
+ *
+ * new NativeAudioEncoder({ codec, sampleRate, numberOfChannels, bitrate?,
+ *                          poolMemoryLimit? },
+ *                        { output(packet), error(err), dequeue() })
+ *   sampleRate -> rate the encoder runs at (may differ from the config)
+ *   description -> Buffer with the codec description, or undefined
+ *   poolStats -> codec frame and packet pool counters, as on NativeVideoEncoder
+ *   encode(data: Buffer, { format, sampleRate, numberOfFrames, numberOfChannels, timestamp })
+ *   flush(done?: () => void) -> Promise<void> when no callback is given
+ *   close()
+ *
+ * codec is 'opus', 'mp4a.40.2' or 'flac'.
+ * data is packed like AudioData: interleaved, or '-planar' formats with one
+ * plane per channel back to back.
+ * packet is { data: Buffer, isKeyframe, size, timestamp, duration? }.
+ * Samples are encoded as one continuous stream; packet timestamps count
+ * from the first encode() after construction or a flush.
+ * dequeue() fires once per encode() after the worker has consumed it.
+ */
+
+#include "audio_encoder.h"
+
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+}
+
+#include "audio_format.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+#include "packet_pool.h"
+
+namespace {
+
+// Raw AudioData the worker queue is sized for. encode() never waits for
+// room; encodeQueueSize and dequeue carry the backpressure.
+constexpr size_t kEncodeQueueCapacity = 32;
+
+// Samples per frame for encoders that accept any frame size.
+constexpr int kVariableFrameSize = 1024;
+
+// Pooled packet buffer. Opus and AAC packets are a few hundred bytes; FLAC
+// frames of 16-bit stereo stay below this too. Larger ones are allocated.
+constexpr size_t kPacketBufferSize = 32 * 1024;
+
+}  // namespace
+
+Napi::Object NativeAudioEncoder::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeAudioEncoder", {
+    InstanceMethod("encode", &NativeAudioEncoder::Encode),
+    InstanceAccessor("sampleRate", &NativeAudioEncoder::GetSampleRate, nullptr),
+    InstanceAccessor("description", &NativeAudioEncoder::GetDescription, nullptr),
+    InstanceAccessor("poolStats", &NativeAudioEncoder::GetPoolStats, nullptr),
+    InstanceMethod("flush", &NativeAudioEncoder::Flush),
+    InstanceMethod("close", &NativeAudioEncoder::Close),
+  });
+
+  exports.Set("NativeAudioEncoder", func);
+  return exports;
+}
+
+NativeAudioEncoder::NativeAudioEncoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeAudioEncoder>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected ({codec, sampleRate, numberOfChannels, bitrate?}, {output, error, dequeue})").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  Napi::Object callbacks = info[1].As<Napi::Object>();
+  if (!callbacks.Get("output").IsFunction() || !callbacks.Get("error").IsFunction() ||
+      !callbacks.Get("dequeue").IsFunction()) {
+    Napi::TypeError::New(env, "Encoder callbacks require output, error and dequeue functions").ThrowAsJavaScriptException();
+    return;
+  }
+  if (!config.Get("codec").IsString() || !config.Get("sampleRate").IsNumber() ||
+      !config.Get("numberOfChannels").IsNumber()) {
+    Napi::TypeError::New(env, "Encoder config requires codec, sampleRate and numberOfChannels").ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string error;
+  if (!ParseAudioCodec(config.Get("codec").As<Napi::String>().Utf8Value(), &codec_, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  settings_.sampleRate = config.Get("sampleRate").As<Napi::Number>().Int32Value();
+  settings_.channels = config.Get("numberOfChannels").As<Napi::Number>().Int32Value();
+  if (settings_.sampleRate <= 0 || settings_.channels <= 0) {
+    Napi::RangeError::New(env, "Encoder sampleRate and numberOfChannels must be positive").ThrowAsJavaScriptException();
+    return;
+  }
+  if (config.Get("bitrate").IsNumber()) {
+    settings_.bitrate = config.Get("bitrate").As<Napi::Number>().Int64Value();
+  }
+  size_t poolLimit = 0;
+  if (!PoolLimitFromConfig(config, &poolLimit, &error)) {
+    Napi::RangeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  budget_ = std::make_shared<PoolBudget>(poolLimit);
+  packets_ = std::make_unique<PacketPool>(kPacketBufferSize, budget_);
+  settings_.packets = packets_.get();
+
+  if (!OpenCodec(&error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  sampleRate_ = ctx_->sample_rate;
+  description_ = EncoderDescription(ctx_);
+  // Reopened contexts keep the same format, so one pool serves the session.
+  framePool_ = std::make_unique<FramePool>(
+    ctx_->sample_fmt, ctx_->sample_rate, ctx_->ch_layout,
+    ctx_->frame_size > 0 ? ctx_->frame_size : kVariableFrameSize, budget_);
+
+  errorCallback_ = Napi::Persistent(callbacks.Get("error").As<Napi::Function>());
+  dequeueCallback_ = Napi::Persistent(callbacks.Get("dequeue").As<Napi::Function>());
+
+  // Same lifetime scheme as NativeVideoEncoder: self-referenced until the
+  // TSFN finalizer runs, and the event loop is only held while busy.
+  Ref();
+  tsfn_ = Napi::ThreadSafeFunction::New(
+    env, callbacks.Get("output").As<Napi::Function>(), "NativeAudioEncoder", 0, 1,
+    [this](Napi::Env) { Unref(); });
+  tsfn_.Unref(env);
+
+  worker_ = std::make_unique<WorkerThread>(kEncodeQueueCapacity);
+  worker_->Start([this](Command& cmd) { HandleCommand(cmd); });
+}
+
+NativeAudioEncoder::~NativeAudioEncoder() {
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+}
+
+/**
+ * Open the encoder context and its sample FIFO. Called from the constructor
+ * and again after a flush, because encoders cannot accept new samples once
+ * they have been drained.
+ */
+bool NativeAudioEncoder::OpenCodec(std::string* error) {
+  ctx_ = OpenAudioEncoder(codec_, settings_, error);
+  if (!ctx_) {
+    return false;
+  }
+
+  int channels = ctx_->ch_layout.nb_channels;
+  int frameSize = ctx_->frame_size > 0 ? ctx_->frame_size : kVariableFrameSize;
+  packet_ = av_packet_alloc();
+  fifo_ = av_audio_fifo_alloc(ctx_->sample_fmt, channels, frameSize * 2);
+  if (!packet_ || !fifo_) {
+    ReleaseCodec();
+    *error = "Failed to allocate audio buffers";
+    return false;
+  }
+  resampler_ = std::make_unique<AudioResampler>(
+    AudioResampler::Format{ctx_->sample_fmt, ctx_->sample_rate, channels});
+
+  nextPts_ = 0;
+  hasStartTimestamp_ = false;
+  return true;
+}
+
+void NativeAudioEncoder::ReleaseCodec() {
+  resampler_.reset();
+  if (fifo_) {
+    av_audio_fifo_free(fifo_);
+    fifo_ = nullptr;
+  }
+  av_packet_free(&packet_);
+  avcodec_free_context(&ctx_);
+}
+
+// ---------------------------------------------------------------------------
+// JS thread
+// ---------------------------------------------------------------------------
+
+Napi::Value NativeAudioEncoder::Encode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 2 || !info[0].IsBuffer() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected (Buffer, {format, sampleRate, numberOfFrames, numberOfChannels, timestamp})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+  Napi::Object options = info[1].As<Napi::Object>();
+  if (!options.Get("format").IsString() || !options.Get("sampleRate").IsNumber() ||
+      !options.Get("numberOfFrames").IsNumber() || !options.Get("numberOfChannels").IsNumber()) {
+    Napi::TypeError::New(env, "Audio data requires format, sampleRate, numberOfFrames and numberOfChannels").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::string format = options.Get("format").As<Napi::String>().Utf8Value();
+  AVSampleFormat sampleFormat = SampleFormatFromString(format);
+  if (sampleFormat == AV_SAMPLE_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported audio format: " + format).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Command cmd;
+  cmd.type = CommandType::kEncode;
+  if (options.Get("timestamp").IsNumber()) {
+    cmd.timestamp = options.Get("timestamp").As<Napi::Number>().Int64Value();
+  }
+
+  // The JS buffer cannot be read from the worker, so copy it here; all
+  // conversion happens on the worker.
+  std::string error;
+  cmd.frame = CopyAudioFromBuffer(inputBuffer.Data(), inputBuffer.Length(), sampleFormat,
+                                  options.Get("sampleRate").As<Napi::Number>().Int32Value(),
+                                  options.Get("numberOfChannels").As<Napi::Number>().Int32Value(),
+                                  options.Get("numberOfFrames").As<Napi::Number>().Int32Value(), &error);
+  if (!cmd.frame) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    UntrackCommand(env);
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+Napi::Value NativeAudioEncoder::GetSampleRate(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), sampleRate_);
+}
+
+Napi::Value NativeAudioEncoder::GetDescription(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (description_.empty()) {
+    return env.Undefined();
+  }
+  return Napi::Buffer<uint8_t>::Copy(env, description_.data(), description_.size());
+}
+
+Napi::Value NativeAudioEncoder::GetPoolStats(const Napi::CallbackInfo& info) {
+  return PoolStatsToObject(info.Env(), budget_->GetStats());
+}
+
+/**
+ * Queue a drain. Once every packet produced by earlier encode() calls has
+ * been delivered to output(), `done` runs on the JS thread or, without a
+ * callback, the returned promise resolves. close() rejects the promise.
+ */
+Napi::Value NativeAudioEncoder::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Value done = info.Length() >= 1 ? info[0] : env.Undefined();
+  if (!done.IsFunction() && !done.IsUndefined()) {
+    Napi::TypeError::New(env, "Expected flush completion callback").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Command cmd;
+  cmd.type = CommandType::kFlush;
+  Napi::Value result;
+  cmd.flushId = flushes_.Add(env, done, &result);
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    flushes_.Remove(cmd.flushId);
+    UntrackCommand(env);
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return result;
+}
+
+void NativeAudioEncoder::Close(const Napi::CallbackInfo& info) {
+  if (!closed_) {
+    flushes_.Abort(info.Env(), "Encoder is closed");
+  }
+  Shutdown();
+}
+
+void NativeAudioEncoder::Shutdown() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+  inFlight_ = 0;
+  tsfn_.Release();
+}
+
+void NativeAudioEncoder::TrackCommand(Napi::Env env) {
+  if (inFlight_++ == 0) {
+    tsfn_.Ref(env);
+  }
+}
+
+void NativeAudioEncoder::UntrackCommand(Napi::Env env) {
+  if (inFlight_ > 0 && --inFlight_ == 0) {
+    tsfn_.Unref(env);
+  }
+}
+
+void NativeAudioEncoder::DeliverEvent(Napi::Env env, Napi::Function output, Event* event) {
+  if (!closed_) {
+    switch (event->kind) {
+      case Event::Kind::kPacket: {
+        Napi::Object chunk = Napi::Object::New(env);
+        chunk.Set("isKeyframe", Napi::Boolean::New(env, (event->packet->flags & AV_PKT_FLAG_KEY) != 0));
+        chunk.Set("size", Napi::Number::New(env, event->packet->size));
+        // Zero-copy: the Buffer keeps the packet's payload alive
+        chunk.Set("data", PacketToBuffer(env, event->packet));
+        chunk.Set("timestamp", Napi::Number::New(env, static_cast<double>(event->timestamp)));
+        if (event->hasDuration) {
+          chunk.Set("duration", Napi::Number::New(env, static_cast<double>(event->duration)));
+        }
+        output.Call({chunk});
+        break;
+      }
+      case Event::Kind::kError:
+        errorCallback_.Call({Napi::Error::New(env, event->message).Value()});
+        break;
+      case Event::Kind::kDequeue:
+        UntrackCommand(env);
+        dequeueCallback_.Call({});
+        break;
+      case Event::Kind::kFlushed: {
+        UntrackCommand(env);
+        flushes_.Complete(env, event->flushId);
+        break;
+      }
+    }
+  }
+
+  packets_->Release(event->packet);
+  delete event;
+}
+
+// ---------------------------------------------------------------------------
+// Worker thread
+// ---------------------------------------------------------------------------
+
+void NativeAudioEncoder::Post(Event* event) {
+  napi_status status = tsfn_.BlockingCall(event,
+    [this](Napi::Env env, Napi::Function output, Event* ev) { DeliverEvent(env, output, ev); });
+  if (status != napi_ok) {
+    packets_->Release(event->packet);
+    delete event;
+  }
+}
+
+void NativeAudioEncoder::PostError(const std::string& message) {
+  Event* event = new Event();
+  event->kind = Event::Kind::kError;
+  event->message = message;
+  Post(event);
+}
+
+void NativeAudioEncoder::HandleCommand(Command& cmd) {
+  switch (cmd.type) {
+    case CommandType::kEncode: {
+      EncodeSamples(cmd);
+      Event* event = new Event();
+      event->kind = Event::Kind::kDequeue;
+      Post(event);
+      break;
+    }
+    case CommandType::kFlush: {
+      DrainEncoder();
+      Event* event = new Event();
+      event->kind = Event::Kind::kFlushed;
+      event->flushId = cmd.flushId;
+      Post(event);
+      break;
+    }
+    case CommandType::kDecode:
+    case CommandType::kReconfigure:
+      break;
+  }
+}
+
+void NativeAudioEncoder::EncodeSamples(Command& cmd) {
+  std::string error;
+  if (!ctx_ && !OpenCodec(&error)) {
+    PostError(error);
+    return;
+  }
+  if (!hasStartTimestamp_) {
+    startTimestamp_ = cmd.timestamp;
+    hasStartTimestamp_ = true;
+  }
+
+  const AVFrame* frame = cmd.frame;
+  AudioResampler::Format input = {static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
+                                  frame->ch_layout.nb_channels};
+  if (!resampler_->Write(input, frame->extended_data, frame->nb_samples, fifo_, &error) ||
+      !SendBufferedSamples(false, &error)) {
+    PostError(error);
+  }
+}
+
+/**
+ * Feed whole codec frames from the FIFO to the encoder. With `final`, the
+ * remainder is sent too, padded with silence for codecs that cannot take a
+ * short last frame.
+ */
+bool NativeAudioEncoder::SendBufferedSamples(bool final, std::string* error) {
+  int frameSize = ctx_->frame_size > 0 ? ctx_->frame_size : kVariableFrameSize;
+  int channels = ctx_->ch_layout.nb_channels;
+  bool shortLastFrame = (ctx_->codec->capabilities &
+                         (AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_VARIABLE_FRAME_SIZE)) != 0;
+
+  while (av_audio_fifo_size(fifo_) >= frameSize || (final && av_audio_fifo_size(fifo_) > 0)) {
+    int samples = std::min(av_audio_fifo_size(fifo_), frameSize);
+    int frameSamples = shortLastFrame ? samples : frameSize;
+
+    // Full frames come from the pool; only a short last frame is allocated.
+    AVFrame* frame = nullptr;
+    if (frameSamples == frameSize) {
+      frame = framePool_->Acquire(error);
+      if (!frame) {
+        return false;
+      }
+    } else {
+      frame = av_frame_alloc();
+      if (!frame) {
+        *error = "Failed to allocate frame";
+        return false;
+      }
+      frame->format = ctx_->sample_fmt;
+      frame->sample_rate = ctx_->sample_rate;
+      frame->nb_samples = frameSamples;
+      av_channel_layout_copy(&frame->ch_layout, &ctx_->ch_layout);
+      int ret = av_frame_get_buffer(frame, 0);
+      if (ret < 0) {
+        av_frame_free(&frame);
+        *error = "Failed to allocate frame buffer: " + AvErrorString(ret);
+        return false;
+      }
+    }
+    av_audio_fifo_read(fifo_, reinterpret_cast<void**>(frame->extended_data), samples);
+    if (frame->nb_samples > samples) {
+      av_samples_set_silence(frame->extended_data, samples, frame->nb_samples - samples,
+                             channels, ctx_->sample_fmt);
+    }
+
+    frame->pts = nextPts_;
+    nextPts_ += samples;
+    int ret = avcodec_send_frame(ctx_, frame);
+    framePool_->Release(frame);
+    if (ret < 0) {
+      *error = "Failed to send frame: " + AvErrorString(ret);
+      return false;
+    }
+    if (!ReceivePackets(error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Flush the resampler and FIFO, then drain the encoder. The context is
+ * released afterwards and reopened on the next encode().
+ */
+void NativeAudioEncoder::DrainEncoder() {
+  if (!ctx_) {
+    return;
+  }
+
+  std::string error;
+  if (!resampler_->Drain(fifo_, &error) || !SendBufferedSamples(true, &error)) {
+    PostError(error);
+  }
+
+  int ret = avcodec_send_frame(ctx_, nullptr);
+  if (ret < 0 && ret != AVERROR_EOF) {
+    PostError("Failed to flush encoder: " + AvErrorString(ret));
+  } else if (!ReceivePackets(&error)) {
+    PostError(error);
+  }
+  ReleaseCodec();
+}
+
+/**
+ * Pull every packet the encoder has ready and post it to JS.
+ */
+bool NativeAudioEncoder::ReceivePackets(std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_packet(ctx_, packet_);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive packet: " + AvErrorString(ret);
+      return false;
+    }
+
+    Event* event = new Event();
+    event->kind = Event::Kind::kPacket;
+    event->packet = packets_->Acquire();
+    if (!event->packet) {
+      delete event;
+      *error = "Failed to allocate packet";
+      return false;
+    }
+    av_packet_move_ref(event->packet, packet_);
+
+    // Packet PTS is in samples (1/sample_rate)
+    event->timestamp = startTimestamp_ + av_rescale_q(event->packet->pts, ctx_->time_base, {1, 1000000});
+    if (event->packet->duration > 0) {
+      event->duration = av_rescale_q(event->packet->duration, ctx_->time_base, {1, 1000000});
+      event->hasDuration = true;
+    }
+
+    Post(event);
+  }
+}
@@ -0,0 +1,113 @@
+/**
+ * NativeAudioEncoder
+ *
+ * A long-lived encoder session for the codecs in the audio codec registry
+ * (Opus, AAC-LC, FLAC). Input samples in any AudioData format, rate and
+ * channel count are converted to what the encoder takes by an
+ * AudioResampler and collected in an AVAudioFifo, which cuts them into the
+ * fixed frame size the codec requires (960 for Opus, 1024 for AAC, ...).
+ *
+ * Encoding runs on a per-session WorkerThread, like NativeVideoEncoder.
+ * encode() and flush() only enqueue commands; packets, errors and queue
+ * progress come back to JS through a ThreadSafeFunction.
+ */
+
+#ifndef WEBCODECS_NATIVE_AUDIO_ENCODER_H_
+#define WEBCODECS_NATIVE_AUDIO_ENCODER_H_
+
+#include <napi.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/audio_fifo.h>
+}
+
+#include "audio_codec_registry.h"
+#include "audio_resampler.h"
+#include "buffer_pool.h"
+#include "frame_pool.h"
+#include "packet_pool.h"
+#include "pending_flushes.h"
+#include "worker_thread.h"
+
+class NativeAudioEncoder : public Napi::ObjectWrap<NativeAudioEncoder> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeAudioEncoder(const Napi::CallbackInfo& info);
+  ~NativeAudioEncoder() override;
+
+ private:
+  // Worker -> JS notification, delivered through tsfn_.
+  struct Event {
+    enum class Kind { kPacket, kError, kDequeue, kFlushed };
+    Kind kind;
+    AVPacket* packet = nullptr;
+    int64_t timestamp = 0;
+    int64_t duration = 0;
+    bool hasDuration = false;
+    std::string message;
+    uint32_t flushId = 0;
+  };
+
+  // JS thread
+  Napi::Value Encode(const Napi::CallbackInfo& info);
+  Napi::Value GetSampleRate(const Napi::CallbackInfo& info);
+  Napi::Value GetDescription(const Napi::CallbackInfo& info);
+  Napi::Value GetPoolStats(const Napi::CallbackInfo& info);
+  Napi::Value Flush(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  void DeliverEvent(Napi::Env env, Napi::Function output, Event* event);
+  void TrackCommand(Napi::Env env);
+  void UntrackCommand(Napi::Env env);
+  void Shutdown();
+
+  // Worker thread
+  void HandleCommand(Command& cmd);
+  void EncodeSamples(Command& cmd);
+  void DrainEncoder();
+  bool SendBufferedSamples(bool final, std::string* error);
+  bool ReceivePackets(std::string* error);
+  void Post(Event* event);
+  void PostError(const std::string& message);
+
+  bool OpenCodec(std::string* error);
+  void ReleaseCodec();
+
+  AVCodecContext* ctx_ = nullptr;
+  AVPacket* packet_ = nullptr;
+  AVAudioFifo* fifo_ = nullptr;
+  std::unique_ptr<AudioResampler> resampler_;
+  AudioCodecSpec codec_;
+  AudioEncoderSettings settings_;
+
+  // Fixed by the first open; reported to JS for decoderConfig.
+  int sampleRate_ = 0;
+  std::vector<uint8_t> description_;
+
+  // PTS counts samples since the codec was opened; packets are timestamped
+  // relative to the first input after that.
+  int64_t nextPts_ = 0;
+  int64_t startTimestamp_ = 0;
+  bool hasStartTimestamp_ = false;
+
+  // Codec-sized input frames and output packets, kept for the whole
+  // session because queued events still hold packets after close().
+  std::shared_ptr<PoolBudget> budget_;
+  std::unique_ptr<FramePool> framePool_;
+  std::unique_ptr<PacketPool> packets_;
+
+  std::unique_ptr<WorkerThread> worker_;
+  Napi::ThreadSafeFunction tsfn_;
+  Napi::FunctionReference errorCallback_;
+  Napi::FunctionReference dequeueCallback_;
+  PendingFlushes flushes_;
+  uint32_t inFlight_ = 0;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_AUDIO_ENCODER_H_
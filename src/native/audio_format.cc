@@ -0,0 +1,113 @@
+/**
+ * Audio sample format helpers.
+ */
+
+#include "audio_format.h"
+
+#include <cstring>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+#include "ffmpeg_utils.h"
+
+namespace {
+
+struct FormatName {
+  const char* name;
+  AVSampleFormat format;
+};
+
+constexpr FormatName kFormatNames[] = {
+  {"u8", AV_SAMPLE_FMT_U8},
+  {"s16", AV_SAMPLE_FMT_S16},
+  {"s32", AV_SAMPLE_FMT_S32},
+  {"f32", AV_SAMPLE_FMT_FLT},
+  {"u8-planar", AV_SAMPLE_FMT_U8P},
+  {"s16-planar", AV_SAMPLE_FMT_S16P},
+  {"s32-planar", AV_SAMPLE_FMT_S32P},
+  {"f32-planar", AV_SAMPLE_FMT_FLTP},
+};
+
+// Bytes of one packed plane: all channels when interleaved, one otherwise.
+size_t PlaneBytes(AVSampleFormat format, int channels, int frames) {
+  size_t samples = static_cast<size_t>(frames);
+  if (!av_sample_fmt_is_planar(format)) {
+    samples *= channels;
+  }
+  return samples * av_get_bytes_per_sample(format);
+}
+
+}  // namespace
+
+AVSampleFormat SampleFormatFromString(const std::string& name) {
+  for (const FormatName& entry : kFormatNames) {
+    if (name == entry.name) {
+      return entry.format;
+    }
+  }
+  return AV_SAMPLE_FMT_NONE;
+}
+
+const char* SampleFormatName(AVSampleFormat format) {
+  for (const FormatName& entry : kFormatNames) {
+    if (entry.format == format) {
+      return entry.name;
+    }
+  }
+  return nullptr;
+}
+
+size_t PackedAudioSize(AVSampleFormat format, int channels, int frames) {
+  if (format == AV_SAMPLE_FMT_NONE || channels <= 0 || frames < 0) {
+    return 0;
+  }
+  return static_cast<size_t>(channels) * frames * av_get_bytes_per_sample(format);
+}
+
+AVFrame* CopyAudioFromBuffer(const uint8_t* data, size_t size, AVSampleFormat format,
+                             int sampleRate, int channels, int frames, std::string* error) {
+  size_t required = PackedAudioSize(format, channels, frames);
+  if (required == 0 || sampleRate <= 0) {
+    *error = "Unsupported audio format or size";
+    return nullptr;
+  }
+  if (size < required) {
+    *error = "Audio buffer is too small for its format and size";
+    return nullptr;
+  }
+
+  AVFrame* frame = av_frame_alloc();
+  if (!frame) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+  frame->format = format;
+  frame->sample_rate = sampleRate;
+  frame->nb_samples = frames;
+  av_channel_layout_default(&frame->ch_layout, channels);
+  int ret = av_frame_get_buffer(frame, 0);
+  if (ret < 0) {
+    av_frame_free(&frame);
+    *error = "Failed to allocate frame buffer: " + AvErrorString(ret);
+    return nullptr;
+  }
+
+  size_t planeBytes = PlaneBytes(format, channels, frames);
+  int planes = av_sample_fmt_is_planar(format) ? channels : 1;
+  for (int i = 0; i < planes; i++) {
+    memcpy(frame->extended_data[i], data + i * planeBytes, planeBytes);
+  }
+  return frame;
+}
+
+void CopyAudioToBuffer(const AVFrame* frame, uint8_t* dest) {
+  AVSampleFormat format = static_cast<AVSampleFormat>(frame->format);
+  int channels = frame->ch_layout.nb_channels;
+  size_t planeBytes = PlaneBytes(format, channels, frame->nb_samples);
+  int planes = av_sample_fmt_is_planar(format) ? channels : 1;
+  for (int i = 0; i < planes; i++) {
+    memcpy(dest + i * planeBytes, frame->extended_data[i], planeBytes);
+  }
+}
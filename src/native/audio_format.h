@@ -0,0 +1,47 @@
+/**
+ * Mapping between WebCodecs AudioSampleFormat names and FFmpeg sample
+ * formats, plus copies between AVFrames and the packed buffers AudioData
+ * uses (interleaved, or one plane per channel back to back).
+ */
+
+#ifndef WEBCODECS_NATIVE_AUDIO_FORMAT_H_
+#define WEBCODECS_NATIVE_AUDIO_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
+/**
+ * 'u8', 's16', 's32', 'f32' and their '-planar' variants -> AV_SAMPLE_FMT_*.
+ * Returns AV_SAMPLE_FMT_NONE for unknown names.
+ */
+AVSampleFormat SampleFormatFromString(const std::string& name);
+
+/**
+ * AV_SAMPLE_FMT_* -> WebCodecs name, or nullptr if WebCodecs has no name for it.
+ */
+const char* SampleFormatName(AVSampleFormat format);
+
+/**
+ * Size in bytes of `frames` samples of `channels` channels, packed.
+ */
+size_t PackedAudioSize(AVSampleFormat format, int channels, int frames);
+
+/**
+ * Copy a packed buffer into a newly allocated audio AVFrame. Returns
+ * nullptr and fills `error` on failure.
+ */
+AVFrame* CopyAudioFromBuffer(const uint8_t* data, size_t size, AVSampleFormat format,
+                             int sampleRate, int channels, int frames, std::string* error);
+
+/**
+ * Copy an audio AVFrame into `dest`, which holds PackedAudioSize() bytes.
+ */
+void CopyAudioToBuffer(const AVFrame* frame, uint8_t* dest);
+
+#endif  // WEBCODECS_NATIVE_AUDIO_FORMAT_H_
@@ -0,0 +1,155 @@
+/**
+ * AudioResampler implementation.
+ */
+
+#include "audio_resampler.h"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+#include "ffmpeg_utils.h"
+
+bool AudioResampler::Format::operator==(const Format& other) const {
+  return format == other.format && sampleRate == other.sampleRate && channels == other.channels;
+}
+
+AudioResampler::AudioResampler(const Format& output) : output_(output) {}
+
+AudioResampler::~AudioResampler() {
+  Reset();
+  if (!scratch_.empty()) {
+    av_freep(&scratch_[0]);
+  }
+}
+
+void AudioResampler::Reset() {
+  swr_free(&swr_);
+  input_ = {AV_SAMPLE_FMT_NONE, 0, 0};
+}
+
+bool AudioResampler::Configure(const Format& input, std::string* error) {
+  if (input == input_) {
+    return true;
+  }
+  Reset();
+  if (input.format == AV_SAMPLE_FMT_NONE || input.sampleRate <= 0 || input.channels <= 0) {
+    *error = "Unsupported audio input format";
+    return false;
+  }
+  input_ = input;
+  if (input == output_) {
+    return true;
+  }
+
+  AVChannelLayout inLayout;
+  AVChannelLayout outLayout;
+  av_channel_layout_default(&inLayout, input.channels);
+  av_channel_layout_default(&outLayout, output_.channels);
+  int ret = swr_alloc_set_opts2(&swr_, &outLayout, output_.format, output_.sampleRate,
+                                &inLayout, input.format, input.sampleRate, 0, nullptr);
+  av_channel_layout_uninit(&inLayout);
+  av_channel_layout_uninit(&outLayout);
+  if (ret >= 0) {
+    ret = swr_init(swr_);
+  }
+  if (ret < 0) {
+    Reset();
+    *error = "Failed to create resampler: " + AvErrorString(ret);
+    return false;
+  }
+  return true;
+}
+
+bool AudioResampler::Write(const Format& input, const uint8_t* const* data, int samples,
+                           AVAudioFifo* fifo, std::string* error) {
+  if (input != input_ && !Drain(fifo, error)) {
+    return false;
+  }
+  if (!Configure(input, error)) {
+    return false;
+  }
+  if (!swr_) {
+    if (av_audio_fifo_write(fifo, reinterpret_cast<void* const*>(const_cast<uint8_t* const*>(data)), samples) < samples) {
+      *error = "Failed to buffer audio samples";
+      return false;
+    }
+    return true;
+  }
+  return Convert(data, samples, fifo, error);
+}
+
+bool AudioResampler::Drain(AVAudioFifo* fifo, std::string* error) {
+  if (!swr_) {
+    return true;
+  }
+  return Convert(nullptr, 0, fifo, error);
+}
+
+bool AudioResampler::Convert(const uint8_t* const* data, int samples, AVAudioFifo* fifo,
+                             std::string* error) {
+  int capacity = swr_get_out_samples(swr_, samples);
+  if (capacity <= 0) {
+    return true;
+  }
+  if (capacity > scratchSamples_) {
+    if (!scratch_.empty()) {
+      av_freep(&scratch_[0]);
+    }
+    scratch_.assign(output_.channels, nullptr);
+    if (av_samples_alloc(scratch_.data(), nullptr, output_.channels, capacity, output_.format, 0) < 0) {
+      scratch_.clear();
+      scratchSamples_ = 0;
+      *error = "Failed to allocate resampler buffer";
+      return false;
+    }
+    scratchSamples_ = capacity;
+  }
+
+  int converted = swr_convert(swr_, scratch_.data(), capacity, data, samples);
+  if (converted < 0) {
+    *error = "Failed to resample audio: " + AvErrorString(converted);
+    return false;
+  }
+  if (converted > 0 &&
+      av_audio_fifo_write(fifo, reinterpret_cast<void* const*>(scratch_.data()), converted) < converted) {
+    *error = "Failed to buffer audio samples";
+    return false;
+  }
+  return true;
+}
+
+AVFrame* AudioResampler::ConvertFrame(const AVFrame* frame, std::string* error) {
+  Format input = {static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
+                  frame->ch_layout.nb_channels};
+  if (!Configure(input, error)) {
+    return nullptr;
+  }
+  if (!swr_) {
+    AVFrame* copy = av_frame_clone(frame);
+    if (!copy) {
+      *error = "Failed to reference frame";
+    }
+    return copy;
+  }
+
+  AVFrame* converted = av_frame_alloc();
+  if (!converted) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+  converted->format = output_.format;
+  converted->sample_rate = output_.sampleRate;
+  av_channel_layout_default(&converted->ch_layout, output_.channels);
+  int ret = swr_convert_frame(swr_, converted, frame);
+  if (ret >= 0) {
+    ret = av_frame_copy_props(converted, frame);
+  }
+  if (ret < 0) {
+    av_frame_free(&converted);
+    *error = "Failed to convert audio: " + AvErrorString(ret);
+    return nullptr;
+  }
+  return converted;
+}
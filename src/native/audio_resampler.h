@@ -0,0 +1,77 @@
+/**
+ * AudioResampler
+ *
+ * Sample format, sample rate and channel count conversion through
+ * libswresample. Each codec session owns one: an SwrContext carries
+ * filter history between calls, so it cannot be shared or pooled the way
+ * SwsContexts are.
+ *
+ * The output format is fixed when the resampler is created. The SwrContext
+ * is built lazily for whatever input arrives and rebuilt when the input
+ * format changes; input that already matches the output bypasses it.
+ */
+
+#ifndef WEBCODECS_NATIVE_AUDIO_RESAMPLER_H_
+#define WEBCODECS_NATIVE_AUDIO_RESAMPLER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/audio_fifo.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+class AudioResampler {
+ public:
+  struct Format {
+    AVSampleFormat format;
+    int sampleRate;
+    int channels;
+
+    bool operator==(const Format& other) const;
+    bool operator!=(const Format& other) const { return !(*this == other); }
+  };
+
+  explicit AudioResampler(const Format& output);
+  ~AudioResampler();
+  AudioResampler(const AudioResampler&) = delete;
+  AudioResampler& operator=(const AudioResampler&) = delete;
+
+  const Format& output() const { return output_; }
+
+  /**
+   * Convert `samples` samples of `input` and append the result to `fifo`.
+   */
+  bool Write(const Format& input, const uint8_t* const* data, int samples, AVAudioFifo* fifo,
+             std::string* error);
+
+  /**
+   * Flush the samples still buffered by the rate converter into `fifo`.
+   */
+  bool Drain(AVAudioFifo* fifo, std::string* error);
+
+  /**
+   * Convert a whole frame into a newly allocated frame in the output format.
+   * Meant for format-only conversion, where nothing is held back.
+   */
+  AVFrame* ConvertFrame(const AVFrame* frame, std::string* error);
+
+  // Forget the current input and buffered samples.
+  void Reset();
+
+ private:
+  bool Configure(const Format& input, std::string* error);
+  bool Convert(const uint8_t* const* data, int samples, AVAudioFifo* fifo, std::string* error);
+
+  Format output_;
+  Format input_ = {AV_SAMPLE_FMT_NONE, 0, 0};
+  SwrContext* swr_ = nullptr;  // Null while the input matches the output
+  std::vector<uint8_t*> scratch_;  // Planes of one av_samples_alloc() buffer
+  int scratchSamples_ = 0;
+};
+
+#endif  // WEBCODECS_NATIVE_AUDIO_RESAMPLER_H_
@@ -0,0 +1,434 @@
+/**
+ * Batch encoding implementation.
+ *
+ * encodeBatch(frames, {
+ *   codec, width, height, bitrate?, framerate?, gopSize?,
+ *   latencyMode?, threads?,  // as for NativeVideoEncoder
+ *   format?,      // pixel format of a Buffer input, default 'I420'
+ *   offsets?,     // byte offset of each frame in a Buffer input; default back to back
+ *   timestamps?,  // per-frame timestamps; default i * 1e6 / framerate
+ * }) -> Promise<{ data: Buffer, index: Float64Array, count }>
+ *
+ * `frames` is an array of NativeVideoFrames or one Buffer holding tightly
+ * packed images. Arguments are checked synchronously; the encode itself
+ * runs on the codec scheduler and the promise resolves with the packets,
+ * so the event loop never waits for it. Buffer frames are referenced in
+ * place through a read-only buffer that keeps the Buffer alive; the caller
+ * must not write to it until the promise settles. NativeVideoFrames may be
+ * closed right away. Frames the encoder cannot take as they are (other
+ * pixel formats, GPU frames) are converted once each. `index` holds
+ * kIndexStride numbers per packet:
+ * [offset into data, size, timestamp, 1 if keyframe else 0].
+ */
+
+#include "batch_encode.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+}
+
+#include "adopted_buffer.h"
+#include "codec_registry.h"
+#include "command_queue.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+#include "hw_device.h"
+#include "pixel_convert.h"
+#include "pixel_format.h"
+#include "video_frame.h"
+#include "worker_thread.h"
+
+namespace {
+
+constexpr size_t kIndexStride = 4;
+
+// Commands are all queued up front without waiting, so this is only the
+// queue's nominal size.
+constexpr size_t kBatchQueueCapacity = 16;
+
+struct BatchOutput {
+  std::vector<uint8_t> data;
+  std::vector<double> index;
+  std::map<int64_t, int64_t> timestamps;  // pts -> caller timestamp
+};
+
+bool ReceivePackets(AVCodecContext* ctx, AVPacket* packet, BatchOutput* out, std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_packet(ctx, packet);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive packet: " + AvErrorString(ret);
+      return false;
+    }
+
+    int64_t timestamp = packet->pts;
+    auto it = out->timestamps.find(packet->pts);
+    if (it != out->timestamps.end()) {
+      timestamp = it->second;
+      out->timestamps.erase(it);
+    }
+    out->index.push_back(static_cast<double>(out->data.size()));
+    out->index.push_back(packet->size);
+    out->index.push_back(static_cast<double>(timestamp));
+    out->index.push_back((packet->flags & AV_PKT_FLAG_KEY) ? 1 : 0);
+    out->data.insert(out->data.end(), packet->data, packet->data + packet->size);
+    av_packet_unref(packet);
+  }
+}
+
+/**
+ * Bring `frame` into the encoder's input format and send it. Conversions
+ * reuse `scratch` across the batch instead of allocating per frame.
+ */
+bool EncodeOne(AVCodecContext* ctx, AVFrame* frame, int64_t pts, int64_t timestamp,
+               AVFrame** scratch, AVPacket* packet, BatchOutput* out, std::string* error) {
+  AVFrame* downloaded = nullptr;
+  AVFrame* uploaded = nullptr;
+  if (frame->hw_frames_ctx) {
+    downloaded = DownloadFrame(frame, error);
+    if (!downloaded) {
+      return false;
+    }
+    frame = downloaded;
+  }
+
+  AVPixelFormat inputFormat = EncoderInputFormat(ctx);
+  if (frame->format != inputFormat) {
+    if (!*scratch) {
+      *scratch = av_frame_alloc();
+      if (*scratch) {
+        (*scratch)->format = inputFormat;
+        (*scratch)->width = ctx->width;
+        (*scratch)->height = ctx->height;
+      }
+      if (!*scratch || av_frame_get_buffer(*scratch, 0) < 0) {
+        av_frame_free(&downloaded);
+        *error = "Failed to allocate frame buffer";
+        return false;
+      }
+    } else if (av_frame_make_writable(*scratch) < 0) {
+      // The encoder still references the previous picture
+      av_frame_free(&downloaded);
+      *error = "Failed to allocate frame buffer";
+      return false;
+    }
+
+    bool converted = ConvertImage(frame->data, frame->linesize, static_cast<AVPixelFormat>(frame->format),
+                                  (*scratch)->data, (*scratch)->linesize, inputFormat,
+                                  ctx->width, ctx->height, error);
+    av_frame_free(&downloaded);
+    if (!converted) {
+      return false;
+    }
+    frame = *scratch;
+  }
+
+  if (ctx->hw_frames_ctx) {
+    uploaded = UploadFrame(ctx->hw_frames_ctx, frame, error);
+    av_frame_free(&downloaded);
+    if (!uploaded) {
+      return false;
+    }
+    frame = uploaded;
+  }
+
+  frame->pts = pts;
+  frame->pict_type = AV_PICTURE_TYPE_NONE;
+  out->timestamps[pts] = timestamp;
+
+  int ret = avcodec_send_frame(ctx, frame);
+  av_frame_free(&downloaded);
+  av_frame_free(&uploaded);
+  if (ret < 0) {
+    *error = "Failed to send frame: " + AvErrorString(ret);
+    return false;
+  }
+  return ReceivePackets(ctx, packet, out, error);
+}
+
+/**
+ * One encodeBatch() call in flight. Its lane on the codec scheduler runs a
+ * kEncode command per frame, one per turn like any session, then a kFlush
+ * that drains the codec and settles the promise on the JS thread, where
+ * the job is deleted.
+ */
+class BatchJob {
+ public:
+  BatchJob(Napi::Env env, const VideoCodecSpec& spec, const VideoEncoderSettings& settings)
+      : deferred(Napi::Promise::Deferred::New(env)),
+        worker(std::make_unique<WorkerThread>(kBatchQueueCapacity)),
+        spec_(spec),
+        settings_(settings) {
+    tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}), "encodeBatch", 0, 1);
+  }
+
+  ~BatchJob() {
+    av_frame_free(&scratch_);
+    av_packet_free(&packet_);
+    avcodec_free_context(&ctx_);
+  }
+
+  // Worker thread
+  void Handle(Command& cmd) {
+    if (cmd.type == CommandType::kEncode) {
+      if (error_.empty() && (ctx_ || Open())) {
+        EncodeOne(ctx_, cmd.frame, next_, cmd.timestamp, &scratch_, packet_, &out_, &error_);
+      }
+      next_++;
+      return;
+    }
+    if (error_.empty() && (ctx_ || Open())) {
+      int ret = avcodec_send_frame(ctx_, nullptr);
+      if (ret < 0 && ret != AVERROR_EOF) {
+        error_ = "Failed to flush encoder: " + AvErrorString(ret);
+      } else {
+        ReceivePackets(ctx_, packet_, &out_, &error_);
+      }
+    }
+    napi_status status = tsfn_.NonBlockingCall(this, [](Napi::Env env, Napi::Function, BatchJob* job) {
+      job->Settle(env);
+    });
+    // A failed call means the environment is closing; the job is leaked with it
+    (void)status;
+  }
+
+  Napi::Promise::Deferred deferred;
+  std::unique_ptr<WorkerThread> worker;
+
+ private:
+  bool Open() {
+    ctx_ = OpenVideoEncoder(spec_, settings_, &error_);
+    packet_ = av_packet_alloc();
+    if (ctx_ && !packet_) {
+      error_ = "Failed to allocate packet";
+    }
+    return error_.empty();
+  }
+
+  // JS thread
+  void Settle(Napi::Env env) {
+    worker->Stop();
+    tsfn_.Release();
+    if (!error_.empty()) {
+      deferred.Reject(Napi::Error::New(env, error_).Value());
+      delete this;
+      return;
+    }
+    size_t packetCount = out_.index.size() / kIndexStride;
+    Napi::Float64Array index = Napi::Float64Array::New(env, out_.index.size());
+    if (!out_.index.empty()) {
+      memcpy(index.Data(), out_.index.data(), out_.index.size() * sizeof(double));
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("data", VectorToBuffer(env, std::move(out_.data)));
+    result.Set("index", index);
+    result.Set("count", Napi::Number::New(env, static_cast<double>(packetCount)));
+    deferred.Resolve(result);
+    delete this;
+  }
+
+  Napi::ThreadSafeFunction tsfn_;
+  VideoCodecSpec spec_;
+  VideoEncoderSettings settings_;
+
+  // Worker thread
+  AVCodecContext* ctx_ = nullptr;
+  AVPacket* packet_ = nullptr;
+  AVFrame* scratch_ = nullptr;
+  int64_t next_ = 0;
+  BatchOutput out_;
+  std::string error_;
+};
+
+}  // namespace
+
+Napi::Value EncodeBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !(info[0].IsArray() || info[0].IsBuffer()) || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected (NativeVideoFrame[] | Buffer, {codec, width, height, ...})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object config = info[1].As<Napi::Object>();
+  if (!config.Get("codec").IsString() || !config.Get("width").IsNumber() || !config.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "encodeBatch config requires codec, width and height").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::string error;
+  VideoCodecSpec spec;
+  if (!ParseVideoCodec(config.Get("codec").As<Napi::String>().Utf8Value(), &spec, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  VideoEncoderSettings settings;
+  settings.width = config.Get("width").As<Napi::Number>().Int32Value();
+  settings.height = config.Get("height").As<Napi::Number>().Int32Value();
+  if (settings.width <= 0 || settings.height <= 0) {
+    Napi::RangeError::New(env, "Encoder width and height must be positive").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (config.Get("bitrate").IsNumber()) {
+    settings.bitrate = config.Get("bitrate").As<Napi::Number>().Int64Value();
+  }
+  if (config.Get("framerate").IsNumber()) {
+    double fps = config.Get("framerate").As<Napi::Number>().DoubleValue();
+    if (fps > 0) {
+      settings.framerate = av_d2q(fps, 1001000);
+    }
+  }
+  if (config.Get("gopSize").IsNumber()) {
+    settings.gopSize = config.Get("gopSize").As<Napi::Number>().Int32Value();
+  }
+  if (config.Get("latencyMode").IsString() &&
+      !ParseLatencyMode(config.Get("latencyMode").As<Napi::String>().Utf8Value(), &settings.latencyMode)) {
+    Napi::TypeError::New(env, "Invalid latencyMode").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (config.Get("threads").IsNumber()) {
+    settings.threads = config.Get("threads").As<Napi::Number>().Int32Value();
+    if (settings.threads < 0) {
+      Napi::RangeError::New(env, "Encoder threads must not be negative").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  // Resolve every input up front so a bad entry fails before any encoding.
+  std::vector<const AVFrame*> handles;
+  std::vector<size_t> offsets;
+  const uint8_t* base = nullptr;
+  AVPixelFormat bufferFormat = AV_PIX_FMT_YUV420P;
+  if (info[0].IsArray()) {
+    Napi::Array frames = info[0].As<Napi::Array>();
+    for (uint32_t i = 0; i < frames.Length(); i++) {
+      const AVFrame* frame = NativeVideoFrame::FrameFromValue(frames.Get(i));
+      if (!frame) {
+        Napi::TypeError::New(env, "encodeBatch frames must be open NativeVideoFrames").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      if (frame->width != settings.width || frame->height != settings.height) {
+        Napi::TypeError::New(env, "Frame size does not match encoder configuration").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      handles.push_back(frame);
+    }
+  } else {
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    std::string format = "I420";
+    if (config.Get("format").IsString()) {
+      format = config.Get("format").As<Napi::String>().Utf8Value();
+    }
+    bufferFormat = PixelFormatFromString(format);
+    if (bufferFormat == AV_PIX_FMT_NONE) {
+      Napi::TypeError::New(env, "Unsupported frame format: " + format).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    std::vector<PlaneLayout> planes;
+    size_t frameSize = PackedLayout(bufferFormat, settings.width, settings.height, &planes);
+    base = buffer.Data();
+    if (config.Get("offsets").IsArray()) {
+      Napi::Array list = config.Get("offsets").As<Napi::Array>();
+      for (uint32_t i = 0; i < list.Length(); i++) {
+        int64_t offset = list.Get(i).ToNumber().Int64Value();
+        if (offset < 0 || static_cast<size_t>(offset) + frameSize > buffer.Length()) {
+          Napi::RangeError::New(env, "Frame offset is outside the buffer").ThrowAsJavaScriptException();
+          return env.Undefined();
+        }
+        offsets.push_back(static_cast<size_t>(offset));
+      }
+    } else {
+      if (frameSize == 0 || buffer.Length() % frameSize != 0) {
+        Napi::TypeError::New(env, format + " buffer is not a whole number of frames").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      for (size_t offset = 0; offset < buffer.Length(); offset += frameSize) {
+        offsets.push_back(offset);
+      }
+    }
+  }
+
+  size_t count = handles.empty() ? offsets.size() : handles.size();
+  Napi::Value timestampsValue = config.Get("timestamps");
+  if (timestampsValue.IsArray() && timestampsValue.As<Napi::Array>().Length() != count) {
+    Napi::RangeError::New(env, "timestamps must have one entry per frame").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::vector<int64_t> timestamps(count);
+  for (size_t i = 0; i < count; i++) {
+    timestamps[i] = timestampsValue.IsArray()
+      ? timestampsValue.As<Napi::Array>().Get(static_cast<uint32_t>(i)).ToNumber().Int64Value()
+      : av_rescale_q(static_cast<int64_t>(i), av_inv_q(settings.framerate), {1, 1000000});
+  }
+
+  // Every input becomes a frame the job owns: a new reference to each
+  // NativeVideoFrame, or a view whose read-only buffer keeps the input
+  // Buffer alive, so the encoder references the pixels instead of copying
+  // them and the caller is free as soon as this returns.
+  std::vector<AVFrame*> inputs;
+  AVBufferRef* adopted = nullptr;
+  if (handles.empty() && count > 0) {
+    Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    adopted = AdoptBuffer(env, buffer, buffer.Data(), buffer.Length());
+    if (!adopted) {
+      Napi::Error::New(env, "Failed to allocate frame buffer").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+  bool ok = true;
+  for (size_t i = 0; ok && i < count; i++) {
+    AVFrame* frame = nullptr;
+    if (!handles.empty()) {
+      frame = av_frame_clone(handles[i]);
+    } else if ((frame = av_frame_alloc())) {
+      frame->format = bufferFormat;
+      frame->width = settings.width;
+      frame->height = settings.height;
+      frame->buf[0] = av_buffer_ref(adopted);
+      av_image_fill_arrays(frame->data, frame->linesize, base + offsets[i],
+                           bufferFormat, settings.width, settings.height, 1);
+      if (!frame->buf[0]) {
+        av_frame_free(&frame);
+      }
+    }
+    ok = frame != nullptr;
+    if (ok) {
+      inputs.push_back(frame);
+    } else {
+      error = "Failed to reference frame";
+    }
+  }
+  av_buffer_unref(&adopted);
+  if (!ok) {
+    for (AVFrame*& frame : inputs) {
+      av_frame_free(&frame);
+    }
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  BatchJob* job = new BatchJob(env, spec, settings);
+  job->worker->Start([job](Command& cmd) { job->Handle(cmd); });
+  for (size_t i = 0; i < count; i++) {
+    Command cmd;
+    cmd.type = CommandType::kEncode;
+    cmd.frame = inputs[i];
+    cmd.timestamp = timestamps[i];
+    job->worker->EnqueueNow(cmd);
+  }
+  Command drain;
+  drain.type = CommandType::kFlush;
+  job->worker->EnqueueNow(drain);
+  return job->deferred.Promise();
+}
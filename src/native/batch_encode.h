@@ -0,0 +1,21 @@
+/**
+ * Batch encoding.
+ *
+ * encodeBatch() encodes a whole sequence of frames with one codec context
+ * in a single N-API call and resolves with every packet in one packed
+ * buffer, instead of one call, one options object and one Buffer per frame.
+ * It is meant for short jobs (sprites, animations) made of many small
+ * frames. The encode runs on the codec scheduler, not the JS thread.
+ */
+
+#ifndef WEBCODECS_NATIVE_BATCH_ENCODE_H_
+#define WEBCODECS_NATIVE_BATCH_ENCODE_H_
+
+#include <napi.h>
+
+/**
+ * encodeBatch(frames: NativeVideoFrame[] | Buffer, config) -> Promise<{ data, index, count }>
+ */
+Napi::Value EncodeBatch(const Napi::CallbackInfo& info);
+
+#endif  // WEBCODECS_NATIVE_BATCH_ENCODE_H_
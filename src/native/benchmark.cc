@@ -0,0 +1,406 @@
+/**
+ * Native benchmarks implementation.
+ *
+ * benchmark({
+ *   stage,          // 'convert' | 'encode' | 'decode'
+ *   width, height,  // source picture size
+ *   frames?,        // timed iterations, default 60
+ *   // convert
+ *   format?,        // source pixel format, default 'RGBA'
+ *   outputFormat?,  // default 'I420'
+ *   outputWidth?, outputHeight?,  // default the source size; otherwise scaled
+ *   // encode / decode
+ *   codec?,         // WebCodecs codec string, default 'vp8'
+ *   bitrate?, latencyMode?, threads?,  // as for NativeVideoEncoder
+ * }) -> { stage, width, height, iterations, totalMs, meanMs, minMs, p50Ms,
+ *         p99Ms, maxMs, fps, bytes }
+ *
+ * Each iteration is one frame: one conversion, one send/receive round on
+ * the encoder, or one packet through the decoder. Drawing the moving test
+ * pattern is not timed. totalMs also includes the final encoder/decoder
+ * drain, so fps reflects the whole stream. bytes is the encoded output for
+ * 'encode', the encoded input for 'decode' and the converted output for
+ * 'convert'.
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+}
+
+#include "codec_registry.h"
+#include "ffmpeg_utils.h"
+#include "hw_device.h"
+#include "pixel_convert.h"
+#include "pixel_format.h"
+
+namespace {
+
+constexpr int kDefaultFrames = 60;
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Samples {
+  std::vector<double> ms;  // One per iteration
+  double tailMs = 0;       // Drain after the last iteration
+  uint64_t bytes = 0;
+};
+
+AVFrame* AllocFrame(AVPixelFormat format, int width, int height) {
+  AVFrame* frame = av_frame_alloc();
+  if (!frame) {
+    return nullptr;
+  }
+  frame->format = format;
+  frame->width = width;
+  frame->height = height;
+  if (av_frame_get_buffer(frame, 0) < 0) {
+    av_frame_free(&frame);
+  }
+  return frame;
+}
+
+/**
+ * Diagonal gradients that move with `index`, so encoders see motion
+ * rather than a static picture they can skip.
+ */
+void FillPattern(AVFrame* frame, int index) {
+  for (int y = 0; y < frame->height; y++) {
+    uint8_t* row = frame->data[0] + y * frame->linesize[0];
+    for (int x = 0; x < frame->width; x++) {
+      row[x] = static_cast<uint8_t>(x + y + index * 4);
+    }
+  }
+  for (int y = 0; y < (frame->height + 1) / 2; y++) {
+    uint8_t* u = frame->data[1] + y * frame->linesize[1];
+    uint8_t* v = frame->data[2] + y * frame->linesize[2];
+    for (int x = 0; x < (frame->width + 1) / 2; x++) {
+      u[x] = static_cast<uint8_t>(96 + ((x - index) & 63));
+      v[x] = static_cast<uint8_t>(96 + ((y + index) & 63));
+    }
+  }
+}
+
+bool BenchmarkConvert(Napi::Object config, int width, int height, int frames,
+                      Samples* samples, std::string* error) {
+  std::string format = config.Get("format").IsString() ? config.Get("format").As<Napi::String>().Utf8Value() : "RGBA";
+  std::string outputFormat = config.Get("outputFormat").IsString()
+    ? config.Get("outputFormat").As<Napi::String>().Utf8Value() : "I420";
+  AVPixelFormat srcFormat = PixelFormatFromString(format);
+  AVPixelFormat dstFormat = PixelFormatFromString(outputFormat);
+  if (srcFormat == AV_PIX_FMT_NONE || dstFormat == AV_PIX_FMT_NONE) {
+    *error = "Unsupported frame format: " + (srcFormat == AV_PIX_FMT_NONE ? format : outputFormat);
+    return false;
+  }
+  int dstWidth = config.Get("outputWidth").IsNumber() ? config.Get("outputWidth").As<Napi::Number>().Int32Value() : width;
+  int dstHeight = config.Get("outputHeight").IsNumber() ? config.Get("outputHeight").As<Napi::Number>().Int32Value() : height;
+  if (dstWidth <= 0 || dstHeight <= 0) {
+    *error = "outputWidth and outputHeight must be positive";
+    return false;
+  }
+
+  AVFrame* pattern = AllocFrame(AV_PIX_FMT_YUV420P, width, height);
+  AVFrame* src = AllocFrame(srcFormat, width, height);
+  AVFrame* dst = AllocFrame(dstFormat, dstWidth, dstHeight);
+  bool ok = pattern && src && dst;
+  if (!ok) {
+    *error = "Failed to allocate frame buffer";
+  }
+  int dstBytes = av_image_get_buffer_size(dstFormat, dstWidth, dstHeight, 1);
+
+  // One untimed pass leases the scaler context from the cache
+  for (int i = -1; ok && i < frames; i++) {
+    FillPattern(pattern, i);
+    ok = ConvertImage(pattern->data, pattern->linesize, AV_PIX_FMT_YUV420P,
+                      src->data, src->linesize, srcFormat, width, height, error);
+    if (!ok) {
+      break;
+    }
+    Clock::time_point start = Clock::now();
+    // Same-size conversions take ConvertImage()'s copy shortcut, as frames do
+    ok = dstWidth == width && dstHeight == height
+      ? ConvertImage(src->data, src->linesize, srcFormat, dst->data, dst->linesize, dstFormat,
+                     width, height, error)
+      : ScaleImage(src->data, src->linesize, srcFormat, width, height,
+                   dst->data, dst->linesize, dstFormat, dstWidth, dstHeight, error);
+    if (ok && i >= 0) {
+      samples->ms.push_back(ElapsedMs(start));
+      samples->bytes += dstBytes > 0 ? static_cast<uint64_t>(dstBytes) : 0;
+    }
+  }
+
+  av_frame_free(&dst);
+  av_frame_free(&src);
+  av_frame_free(&pattern);
+  return ok;
+}
+
+bool ReceiveAll(AVCodecContext* ctx, AVPacket* packet, Samples* samples,
+                std::vector<AVPacket*>* keep, std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_packet(ctx, packet);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive packet: " + AvErrorString(ret);
+      return false;
+    }
+    samples->bytes += static_cast<uint64_t>(packet->size);
+    if (keep) {
+      keep->push_back(av_packet_clone(packet));
+    }
+    av_packet_unref(packet);
+  }
+}
+
+/**
+ * Encode `frames` pattern frames, timing each send/receive round including
+ * the conversion to the encoder's input format. Packets are kept in `keep`
+ * when it is given.
+ */
+bool EncodePattern(const VideoCodecSpec& spec, const VideoEncoderSettings& settings, int frames,
+                   Samples* samples, std::vector<AVPacket*>* keep, std::string* error) {
+  AVCodecContext* ctx = OpenVideoEncoder(spec, settings, error);
+  if (!ctx) {
+    return false;
+  }
+  AVFrame* pattern = AllocFrame(AV_PIX_FMT_YUV420P, settings.width, settings.height);
+  AVPacket* packet = av_packet_alloc();
+  bool ok = pattern && packet;
+  if (!ok) {
+    *error = "Failed to allocate frame buffer";
+  }
+  AVPixelFormat inputFormat = EncoderInputFormat(ctx);
+
+  for (int i = 0; ok && i < frames; i++) {
+    if (av_frame_make_writable(pattern) < 0) {
+      *error = "Failed to allocate frame buffer";
+      ok = false;
+      break;
+    }
+    FillPattern(pattern, i);
+    pattern->pts = i;
+
+    Clock::time_point start = Clock::now();
+    AVFrame* staged = nullptr;
+    AVFrame* input = pattern;
+    if (inputFormat != AV_PIX_FMT_YUV420P) {
+      staged = ConvertFrameFormat(pattern, inputFormat, error);
+      input = staged;
+    }
+    if (input && ctx->hw_frames_ctx) {
+      AVFrame* uploaded = UploadFrame(ctx->hw_frames_ctx, input, error);
+      av_frame_free(&staged);
+      staged = input = uploaded;
+    }
+    if (!input) {
+      ok = false;
+      break;
+    }
+    input->pts = i;
+    int ret = avcodec_send_frame(ctx, input);
+    av_frame_free(&staged);
+    if (ret < 0) {
+      *error = "Failed to send frame: " + AvErrorString(ret);
+      ok = false;
+      break;
+    }
+    ok = ReceiveAll(ctx, packet, samples, keep, error);
+    samples->ms.push_back(ElapsedMs(start));
+  }
+
+  if (ok) {
+    Clock::time_point start = Clock::now();
+    int ret = avcodec_send_frame(ctx, nullptr);
+    if (ret < 0 && ret != AVERROR_EOF) {
+      *error = "Failed to flush encoder: " + AvErrorString(ret);
+      ok = false;
+    } else {
+      ok = ReceiveAll(ctx, packet, samples, keep, error);
+    }
+    samples->tailMs = ElapsedMs(start);
+  }
+
+  av_packet_free(&packet);
+  av_frame_free(&pattern);
+  avcodec_free_context(&ctx);
+  return ok;
+}
+
+bool ReceiveFrames(AVCodecContext* ctx, AVFrame* frame, std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_frame(ctx, frame);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive frame: " + AvErrorString(ret);
+      return false;
+    }
+    av_frame_unref(frame);
+  }
+}
+
+bool BenchmarkDecode(const VideoCodecSpec& spec, const VideoEncoderSettings& settings, int frames,
+                     Samples* samples, std::string* error) {
+  // The stream to decode is encoded first, untimed
+  Samples encoded;
+  std::vector<AVPacket*> packets;
+  bool ok = EncodePattern(spec, settings, frames, &encoded, &packets, error);
+
+  AVCodecContext* ctx = ok ? OpenVideoDecoder(spec, nullptr, 0, settings.hardware, error) : nullptr;
+  AVFrame* frame = av_frame_alloc();
+  ok = ctx && frame;
+  if (ctx && !frame) {
+    *error = "Failed to allocate frame";
+  }
+
+  for (size_t i = 0; ok && i < packets.size(); i++) {
+    packets[i]->pts = av_rescale_q(static_cast<int64_t>(i), av_inv_q(settings.framerate), {1, 1000000});
+    packets[i]->dts = AV_NOPTS_VALUE;
+    Clock::time_point start = Clock::now();
+    int ret = avcodec_send_packet(ctx, packets[i]);
+    if (ret < 0) {
+      *error = "Failed to send packet: " + AvErrorString(ret);
+      ok = false;
+      break;
+    }
+    ok = ReceiveFrames(ctx, frame, error);
+    samples->ms.push_back(ElapsedMs(start));
+    samples->bytes += static_cast<uint64_t>(packets[i]->size);
+  }
+
+  if (ok) {
+    Clock::time_point start = Clock::now();
+    int ret = avcodec_send_packet(ctx, nullptr);
+    if (ret < 0 && ret != AVERROR_EOF) {
+      *error = "Failed to flush decoder: " + AvErrorString(ret);
+      ok = false;
+    } else {
+      ok = ReceiveFrames(ctx, frame, error);
+    }
+    samples->tailMs = ElapsedMs(start);
+  }
+
+  for (AVPacket*& packet : packets) {
+    av_packet_free(&packet);
+  }
+  av_frame_free(&frame);
+  avcodec_free_context(&ctx);
+  return ok;
+}
+
+// Nearest-rank percentile of sorted samples.
+double Percentile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = static_cast<size_t>(q * static_cast<double>(sorted.size()) + 0.999999);
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+}  // namespace
+
+Napi::Value RunBenchmark(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected ({stage, width, height, ...})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object config = info[0].As<Napi::Object>();
+  if (!config.Get("stage").IsString() || !config.Get("width").IsNumber() || !config.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "benchmark config requires stage, width and height").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::string stage = config.Get("stage").As<Napi::String>().Utf8Value();
+  int width = config.Get("width").As<Napi::Number>().Int32Value();
+  int height = config.Get("height").As<Napi::Number>().Int32Value();
+  int frames = config.Get("frames").IsNumber() ? config.Get("frames").As<Napi::Number>().Int32Value() : kDefaultFrames;
+  if (width <= 0 || height <= 0) {
+    Napi::RangeError::New(env, "Benchmark width and height must be positive").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (frames < 1) {
+    Napi::RangeError::New(env, "frames must be at least 1").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::string error;
+  Samples samples;
+  bool ok;
+  if (stage == "convert") {
+    ok = BenchmarkConvert(config, width, height, frames, &samples, &error);
+  } else if (stage == "encode" || stage == "decode") {
+    std::string codec = config.Get("codec").IsString() ? config.Get("codec").As<Napi::String>().Utf8Value() : "vp8";
+    VideoCodecSpec spec;
+    if (!ParseVideoCodec(codec, &spec, &error)) {
+      Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    VideoEncoderSettings settings;
+    settings.width = width;
+    settings.height = height;
+    if (config.Get("bitrate").IsNumber()) {
+      settings.bitrate = config.Get("bitrate").As<Napi::Number>().Int64Value();
+    }
+    if (config.Get("latencyMode").IsString() &&
+        !ParseLatencyMode(config.Get("latencyMode").As<Napi::String>().Utf8Value(), &settings.latencyMode)) {
+      Napi::TypeError::New(env, "Invalid latencyMode").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (config.Get("threads").IsNumber()) {
+      settings.threads = config.Get("threads").As<Napi::Number>().Int32Value();
+      if (settings.threads < 0) {
+        Napi::RangeError::New(env, "Encoder threads must not be negative").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+    ok = stage == "encode"
+      ? EncodePattern(spec, settings, frames, &samples, nullptr, &error)
+      : BenchmarkDecode(spec, settings, frames, &samples, &error);
+  } else {
+    Napi::TypeError::New(env, "Unknown benchmark stage: " + stage).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!ok) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<double> sorted = samples.ms;
+  std::sort(sorted.begin(), sorted.end());
+  double totalMs = samples.tailMs;
+  for (double ms : sorted) {
+    totalMs += ms;
+  }
+  double count = static_cast<double>(sorted.size());
+
+  auto number = [env](double value) { return Napi::Number::New(env, value); };
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("stage", Napi::String::New(env, stage));
+  result.Set("width", number(width));
+  result.Set("height", number(height));
+  result.Set("iterations", number(count));
+  result.Set("totalMs", number(totalMs));
+  result.Set("meanMs", number(count > 0 ? totalMs / count : 0));
+  result.Set("minMs", number(sorted.empty() ? 0 : sorted.front()));
+  result.Set("p50Ms", number(Percentile(sorted, 0.5)));
+  result.Set("p99Ms", number(Percentile(sorted, 0.99)));
+  result.Set("maxMs", number(sorted.empty() ? 0 : sorted.back()));
+  result.Set("fps", number(totalMs > 0 ? count * 1000 / totalMs : 0));
+  result.Set("bytes", number(static_cast<double>(samples.bytes)));
+  return result;
+}
@@ -0,0 +1,20 @@
+/**
+ * Native benchmarks.
+ *
+ * benchmark() times the addon's hot paths (pixel conversion, scaling,
+ * encoding, decoding) in a tight native loop on synthetic frames, so the
+ * numbers exclude N-API calls, JS allocation and scheduler hops. It backs
+ * the `npm run bench` harness, which measures the JS-facing API separately.
+ */
+
+#ifndef WEBCODECS_NATIVE_BENCHMARK_H_
+#define WEBCODECS_NATIVE_BENCHMARK_H_
+
+#include <napi.h>
+
+/**
+ * benchmark({ stage, width, height, ... }) -> { stage, iterations, totalMs, ... }
+ */
+Napi::Value RunBenchmark(const Napi::CallbackInfo& info);
+
+#endif  // WEBCODECS_NATIVE_BENCHMARK_H_
@@ -0,0 +1,124 @@
+/**
+ * BufferPool implementation.
+ */
+
+#include "buffer_pool.h"
+
+#include <utility>
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+bool PoolBudget::Reserve(size_t bytes) {
+  size_t current = pooledBytes_.load();
+  do {
+    if (limit_ != 0 && current + bytes > limit_) {
+      return false;
+    }
+  } while (!pooledBytes_.compare_exchange_weak(current, current + bytes));
+  allocations_++;
+  return true;
+}
+
+void PoolBudget::Release(size_t bytes) {
+  pooledBytes_ -= bytes;
+}
+
+PoolBudget::Stats PoolBudget::GetStats() const {
+  Stats stats;
+  stats.pooledBytes = pooledBytes_.load();
+  stats.limit = limit_;
+  stats.allocations = allocations_.load();
+  stats.overflows = overflows_.load();
+  // Every Get() either reused a pooled buffer, grew the pool or overflowed.
+  uint64_t acquires = acquires_.load();
+  uint64_t fresh = stats.allocations + stats.overflows;
+  stats.reuses = acquires > fresh ? acquires - fresh : 0;
+  return stats;
+}
+
+Napi::Object PoolStatsToObject(Napi::Env env, const PoolBudget::Stats& stats) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("pooledBytes", Napi::Number::New(env, static_cast<double>(stats.pooledBytes)));
+  result.Set("limit", Napi::Number::New(env, static_cast<double>(stats.limit)));
+  result.Set("allocations", Napi::Number::New(env, static_cast<double>(stats.allocations)));
+  result.Set("reuses", Napi::Number::New(env, static_cast<double>(stats.reuses)));
+  result.Set("overflows", Napi::Number::New(env, static_cast<double>(stats.overflows)));
+  return result;
+}
+
+bool PoolLimitFromConfig(Napi::Object config, size_t* limit, std::string* error) {
+  *limit = 0;
+  if (!config.Get("poolMemoryLimit").IsNumber()) {
+    return true;
+  }
+  int64_t value = config.Get("poolMemoryLimit").As<Napi::Number>().Int64Value();
+  if (value < 0) {
+    *error = "poolMemoryLimit must not be negative";
+    return false;
+  }
+  *limit = static_cast<size_t>(value);
+  return true;
+}
+
+BufferPool::BufferPool(size_t bufferSize, std::shared_ptr<PoolBudget> budget)
+    : bufferSize_(bufferSize),
+      shared_(new Shared{std::move(budget), bufferSize}),
+      pool_(av_buffer_pool_init2(bufferSize, shared_, Allocate, FreePool)) {
+  if (!pool_) {
+    delete shared_;
+    shared_ = nullptr;
+  }
+}
+
+BufferPool::~BufferPool() {
+  // Outstanding buffers keep the pool (and shared_) alive until they are
+  // unreferenced; FreePool deletes shared_ then.
+  if (pool_) {
+    av_buffer_pool_uninit(&pool_);
+  }
+}
+
+AVBufferRef* BufferPool::Get() {
+  if (!pool_) {
+    return av_buffer_alloc(bufferSize_);
+  }
+  shared_->budget->CountAcquire();
+  AVBufferRef* buffer = av_buffer_pool_get(pool_);
+  if (!buffer) {
+    // Over the budget (or the pool could not grow): hand out a buffer that
+    // is freed rather than retained once the caller is done with it.
+    shared_->budget->CountOverflow();
+    buffer = av_buffer_alloc(bufferSize_);
+  }
+  return buffer;
+}
+
+AVBufferRef* BufferPool::Allocate(void* opaque, size_t size) {
+  Shared* shared = static_cast<Shared*>(opaque);
+  if (!shared->budget->Reserve(size)) {
+    return nullptr;
+  }
+  uint8_t* data = static_cast<uint8_t*>(av_malloc(size));
+  if (!data) {
+    shared->budget->Release(size);
+    return nullptr;
+  }
+  AVBufferRef* buffer = av_buffer_create(data, size, FreeBuffer, shared, 0);
+  if (!buffer) {
+    av_free(data);
+    shared->budget->Release(size);
+  }
+  return buffer;
+}
+
+void BufferPool::FreeBuffer(void* opaque, uint8_t* data) {
+  Shared* shared = static_cast<Shared*>(opaque);
+  av_free(data);
+  shared->budget->Release(shared->bufferSize);
+}
+
+void BufferPool::FreePool(void* opaque) {
+  delete static_cast<Shared*>(opaque);
+}
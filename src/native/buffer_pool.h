@@ -0,0 +1,97 @@
+/**
+ * BufferPool
+ *
+ * Fixed-size AVBufferRefs recycled through an AVBufferPool, so steady-state
+ * codec sessions stop going through malloc for every multi-megabyte frame
+ * or packet payload. Buffers return to the pool when their last reference
+ * is dropped, on whichever thread that happens.
+ *
+ * All pools of a session draw on one PoolBudget. Once the budget's limit is
+ * reached, Get() hands out plain unpooled buffers instead of growing the
+ * pool, so a limit caps retained memory without ever failing an encode.
+ */
+
+#ifndef WEBCODECS_NATIVE_BUFFER_POOL_H_
+#define WEBCODECS_NATIVE_BUFFER_POOL_H_
+
+#include <napi.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <libavutil/buffer.h>
+}
+
+class PoolBudget {
+ public:
+  struct Stats {
+    size_t pooledBytes;    // Memory currently owned by the pools
+    size_t limit;          // 0 = unlimited
+    uint64_t allocations;  // Buffers added to a pool
+    uint64_t reuses;       // Buffers served from a pool without allocating
+    uint64_t overflows;    // Unpooled buffers handed out because of the limit
+  };
+
+  explicit PoolBudget(size_t limit) : limit_(limit) {}
+
+  // Claim `bytes` for a new pooled buffer; false if that would pass the limit.
+  bool Reserve(size_t bytes);
+  void Release(size_t bytes);
+
+  void CountAcquire() { acquires_++; }
+  void CountOverflow() { overflows_++; }
+
+  Stats GetStats() const;
+
+ private:
+  const size_t limit_;
+  std::atomic<size_t> pooledBytes_{0};
+  std::atomic<uint64_t> allocations_{0};
+  std::atomic<uint64_t> acquires_{0};
+  std::atomic<uint64_t> overflows_{0};
+};
+
+/**
+ * PoolBudget::Stats as { pooledBytes, limit, allocations, reuses, overflows }.
+ */
+Napi::Object PoolStatsToObject(Napi::Env env, const PoolBudget::Stats& stats);
+
+/**
+ * Read a session config's optional `poolMemoryLimit` (bytes, 0 = unlimited).
+ * Returns false and fills `error` if it is negative.
+ */
+bool PoolLimitFromConfig(Napi::Object config, size_t* limit, std::string* error);
+
+class BufferPool {
+ public:
+  BufferPool(size_t bufferSize, std::shared_ptr<PoolBudget> budget);
+  ~BufferPool();
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  size_t bufferSize() const { return bufferSize_; }
+
+  // A buffer of bufferSize() bytes, or nullptr if out of memory.
+  AVBufferRef* Get();
+
+ private:
+  // Pool callback state. Owned by the AVBufferPool, which frees it only
+  // after the last outstanding buffer has come back.
+  struct Shared {
+    std::shared_ptr<PoolBudget> budget;
+    size_t bufferSize;
+  };
+
+  static AVBufferRef* Allocate(void* opaque, size_t size);
+  static void FreeBuffer(void* opaque, uint8_t* data);
+  static void FreePool(void* opaque);
+
+  size_t bufferSize_;
+  Shared* shared_;
+  AVBufferPool* pool_;
+};
+
+#endif  // WEBCODECS_NATIVE_BUFFER_POOL_H_
@@ -0,0 +1,75 @@
+/**
+ * ByteStream implementation.
+ */
+
+#include "byte_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+bool ByteStream::Write(const uint8_t* data, size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ended_ || aborted_) {
+      return false;
+    }
+    if (size == 0) {
+      return true;
+    }
+    chunks_.emplace_back(data, data + size);
+  }
+  readable_.notify_one();
+  return true;
+}
+
+void ByteStream::End() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ended_ = true;
+  }
+  readable_.notify_all();
+}
+
+void ByteStream::Abort() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborted_ = true;
+    chunks_.clear();
+    offset_ = 0;
+  }
+  readable_.notify_all();
+}
+
+int ByteStream::Read(uint8_t* buf, int size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  readable_.wait(lock, [this] { return aborted_ || ended_ || !chunks_.empty(); });
+  if (aborted_) {
+    return AVERROR_EXIT;
+  }
+  if (chunks_.empty()) {
+    return AVERROR_EOF;
+  }
+
+  // Fill as much of `buf` as the queued chunks allow without waiting again
+  int total = 0;
+  while (total < size && !chunks_.empty()) {
+    const std::vector<uint8_t>& front = chunks_.front();
+    size_t count = std::min(static_cast<size_t>(size - total), front.size() - offset_);
+    memcpy(buf + total, front.data() + offset_, count);
+    total += static_cast<int>(count);
+    offset_ += count;
+    if (offset_ == front.size()) {
+      chunks_.pop_front();
+      offset_ = 0;
+    }
+  }
+  return total;
+}
+
+int ByteStream::ReadPacket(void* opaque, uint8_t* buf, int size) {
+  return static_cast<ByteStream*>(opaque)->Read(buf, size);
+}
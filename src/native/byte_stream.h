@@ -0,0 +1,46 @@
+/**
+ * ByteStream
+ *
+ * Thread-safe byte queue between JS writes and a libavformat read callback.
+ * The JS thread appends container bytes as they arrive (from a socket,
+ * a fetch body, ...); the demux thread reads them through ReadPacket(),
+ * blocking until more bytes are written or the stream ends.
+ */
+
+#ifndef WEBCODECS_NATIVE_BYTE_STREAM_H_
+#define WEBCODECS_NATIVE_BYTE_STREAM_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class ByteStream {
+ public:
+  // Append a copy of `data`. Returns false once End() or Abort() was called.
+  bool Write(const uint8_t* data, size_t size);
+
+  // No more bytes follow; reads drain what is left, then report EOF.
+  void End();
+
+  // Fail pending and future reads with AVERROR_EXIT.
+  void Abort();
+
+  // Up to `size` bytes into `buf`: the count read, AVERROR_EOF or AVERROR_EXIT.
+  int Read(uint8_t* buf, int size);
+
+  // AVIOContext read_packet callback; `opaque` is the ByteStream.
+  static int ReadPacket(void* opaque, uint8_t* buf, int size);
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable readable_;
+  std::deque<std::vector<uint8_t>> chunks_;
+  size_t offset_ = 0;  // Bytes of chunks_.front() already read
+  bool ended_ = false;
+  bool aborted_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_BYTE_STREAM_H_
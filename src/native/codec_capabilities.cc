@@ -0,0 +1,207 @@
+/**
+ * CodecCapabilities implementation.
+ */
+
+#include "codec_capabilities.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+}
+
+namespace {
+
+// Largest picture each bitstream can describe.
+void MaxPictureSize(AVCodecID id, int* width, int* height) {
+  switch (id) {
+    case AV_CODEC_ID_VP8:
+      *width = *height = 16383;
+      break;
+    case AV_CODEC_ID_VP9:
+    case AV_CODEC_ID_AV1:
+      *width = *height = 65536;
+      break;
+    default:
+      // H.264 is bounded by its level; see MaxH264FrameMacroblocks()
+      *width = *height = 16880;
+      break;
+  }
+}
+
+/**
+ * MaxFS (frame size in 16x16 macroblocks) of an H.264 level_idc, from
+ * Table A-1 of the spec. 0 for an unknown level.
+ */
+int MaxH264FrameMacroblocks(int levelIdc) {
+  switch (levelIdc) {
+    case 9: case 10: return 99;
+    case 11: case 12: case 13: case 20: return 396;
+    case 21: return 792;
+    case 22: case 30: return 1620;
+    case 31: return 3600;
+    case 32: return 5120;
+    case 40: case 41: return 8192;
+    case 42: return 8704;
+    case 50: return 22080;
+    case 51: case 52: return 36864;
+    case 60: case 61: case 62: return 139264;
+    default: return 0;
+  }
+}
+
+bool FitsH264Level(int levelIdc, int width, int height) {
+  int maxFs = MaxH264FrameMacroblocks(levelIdc);
+  if (maxFs == 0) {
+    return false;
+  }
+  int mbWidth = (width + 15) / 16;
+  int mbHeight = (height + 15) / 16;
+  // Each dimension is also capped at sqrt(8 * MaxFS) macroblocks
+  int maxSide = static_cast<int>(std::sqrt(8.0 * maxFs));
+  return mbWidth * mbHeight <= maxFs && mbWidth <= maxSide && mbHeight <= maxSide;
+}
+
+std::vector<int> ProfileList(const AVCodec* codec) {
+  std::vector<int> profiles;
+  // AVProfile lists end with AV_PROFILE_UNKNOWN, the same -99 as kCodecUnspecified
+  for (const AVProfile* p = codec ? codec->profiles : nullptr; p && p->profile != kCodecUnspecified; p++) {
+    profiles.push_back(p->profile);
+  }
+  return profiles;
+}
+
+bool HasProfile(const std::vector<int>& profiles, int profile) {
+  return profile == kCodecUnspecified || profiles.empty() ||
+         std::find(profiles.begin(), profiles.end(), profile) != profiles.end();
+}
+
+// True if one of the codec's hardware configurations has a device here.
+bool HasHardwareDevice(const AVCodec* codec, int methods) {
+  for (AVHWDeviceType type : PlatformDeviceTypes()) {
+    for (int i = 0;; i++) {
+      const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+      if (!config) {
+        break;
+      }
+      if (config->device_type != type || !(config->methods & methods)) {
+        continue;
+      }
+      AVBufferRef* device = AcquireHwDevice(type);
+      if (device) {
+        av_buffer_unref(&device);
+        return true;
+      }
+      break;
+    }
+  }
+  return false;
+}
+
+const char* MediaTypeName(AVMediaType type) {
+  switch (type) {
+    case AVMEDIA_TYPE_VIDEO: return "video";
+    case AVMEDIA_TYPE_AUDIO: return "audio";
+    case AVMEDIA_TYPE_SUBTITLE: return "subtitle";
+    default: return "unknown";
+  }
+}
+
+}  // namespace
+
+const CodecCapabilities& CodecCapabilities::Shared() {
+  static const CodecCapabilities capabilities;
+  return capabilities;
+}
+
+CodecCapabilities::CodecCapabilities() {
+  void* iter = nullptr;
+  while (const AVCodec* codec = av_codec_iterate(&iter)) {
+    bool isEncoder = av_codec_is_encoder(codec) != 0;
+    codecs_.push_back({codec->name, codec->long_name ? codec->long_name : "", MediaTypeName(codec->type),
+                       isEncoder, av_codec_is_decoder(codec) != 0});
+    // First registration wins, like avcodec_find_*_by_name()
+    (isEncoder ? encoders_ : decoders_).emplace(codec->name, codecs_.size() - 1);
+  }
+
+  for (AVCodecID id : RegistryVideoCodecs()) {
+    VideoCodec video;
+    video.id = id;
+    video.encoder = FindVideoEncoder(id);
+    video.decoder = FindVideoDecoder(id);
+    for (const AVCodec* codec : FindHardwareVideoEncoders(id)) {
+      // Encoders without a hardware config (e.g. VideoToolbox) open their
+      // own device, so only the build can be checked for them.
+      if (!avcodec_get_hw_config(codec, 0) ||
+          HasHardwareDevice(codec, AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX |
+                                   AV_CODEC_HW_CONFIG_METHOD_HW_FRAMES_CTX)) {
+        video.hardwareEncoders.push_back(codec);
+      }
+    }
+    // Hardware decoding goes through FFmpeg's own decoder, as in OpenVideoDecoder()
+    const AVCodec* native = avcodec_find_decoder(id);
+    video.hardwareDecoder = native && HasHardwareDevice(native, AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX);
+    video.encoderProfiles = ProfileList(video.encoder);
+    video.decoderProfiles = ProfileList(video.decoder);
+    if (video.encoder && video.encoder->pix_fmts) {
+      for (const AVPixelFormat* fmt = video.encoder->pix_fmts; *fmt != AV_PIX_FMT_NONE; fmt++) {
+        video.encoderFormats.push_back(*fmt);
+      }
+    }
+    MaxPictureSize(id, &video.maxWidth, &video.maxHeight);
+    video_.push_back(std::move(video));
+  }
+}
+
+const CodecCapabilities::CodecInfo* CodecCapabilities::FindEncoder(const std::string& name) const {
+  auto it = encoders_.find(name);
+  return it == encoders_.end() ? nullptr : &codecs_[it->second];
+}
+
+const CodecCapabilities::CodecInfo* CodecCapabilities::FindDecoder(const std::string& name) const {
+  auto it = decoders_.find(name);
+  return it == decoders_.end() ? nullptr : &codecs_[it->second];
+}
+
+const CodecCapabilities::VideoCodec* CodecCapabilities::FindVideo(AVCodecID id) const {
+  for (const VideoCodec& video : video_) {
+    if (video.id == id) {
+      return &video;
+    }
+  }
+  return nullptr;
+}
+
+bool CodecCapabilities::IsVideoConfigSupported(const VideoCodecSpec& spec, Direction direction,
+                                               int width, int height, HardwarePreference hardware) const {
+  const VideoCodec* video = FindVideo(spec.id);
+  if (!video || width < 0 || height < 0) {
+    return false;
+  }
+
+  bool encode = direction == Direction::kEncode;
+  const AVCodec* software = encode ? video->encoder : video->decoder;
+  bool hasHardware = encode ? !video->hardwareEncoders.empty() : video->hardwareDecoder;
+  if (hardware == HardwarePreference::kPreferHardware ? !hasHardware : !software && !hasHardware) {
+    return false;
+  }
+  // Hardware implementations do not list profiles; the software one stands in
+  if (software && !HasProfile(encode ? video->encoderProfiles : video->decoderProfiles, spec.profile)) {
+    return false;
+  }
+  // Software encoder sessions are opened for I420 input
+  if (encode && software && !video->encoderFormats.empty() &&
+      std::find(video->encoderFormats.begin(), video->encoderFormats.end(), AV_PIX_FMT_YUV420P) ==
+        video->encoderFormats.end()) {
+    return false;
+  }
+
+  if (width > video->maxWidth || height > video->maxHeight) {
+    return false;
+  }
+  if (spec.id == AV_CODEC_ID_H264 && spec.level != kCodecUnspecified && width > 0 && height > 0) {
+    return FitsH264Level(spec.level, width, height);
+  }
+  return true;
+}
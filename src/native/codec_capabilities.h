@@ -0,0 +1,83 @@
+/**
+ * CodecCapabilities
+ *
+ * What this FFmpeg build can do, worked out once per process: every codec
+ * av_codec_iterate() knows (for hasCodec()/listCodecs()), and for each
+ * registry video codec the implementations that would be opened, their
+ * profiles and input formats, the largest picture they take and whether a
+ * hardware implementation is usable on this machine.
+ *
+ * The table is built on first use and read-only afterwards, so
+ * isConfigSupported() is a codec string parse plus a few comparisons.
+ */
+
+#ifndef WEBCODECS_NATIVE_CODEC_CAPABILITIES_H_
+#define WEBCODECS_NATIVE_CODEC_CAPABILITIES_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "codec_registry.h"
+#include "hw_device.h"
+
+class CodecCapabilities {
+ public:
+  struct CodecInfo {
+    std::string name;
+    std::string longName;
+    const char* type;  // "video", "audio", "subtitle" or "unknown"
+    bool isEncoder;
+    bool isDecoder;
+  };
+
+  struct VideoCodec {
+    AVCodecID id = AV_CODEC_ID_NONE;
+    const AVCodec* encoder = nullptr;  // Software choice, as FindVideoEncoder()
+    const AVCodec* decoder = nullptr;  // As FindVideoDecoder()
+    // Hardware encoders whose device opens on this machine
+    std::vector<const AVCodec*> hardwareEncoders;
+    bool hardwareDecoder = false;
+    // AVProfile values the implementation lists; empty means it does not say
+    std::vector<int> encoderProfiles;
+    std::vector<int> decoderProfiles;
+    std::vector<AVPixelFormat> encoderFormats;
+    int maxWidth = 0;
+    int maxHeight = 0;
+  };
+
+  enum class Direction { kEncode, kDecode };
+
+  static const CodecCapabilities& Shared();
+
+  const std::vector<CodecInfo>& Codecs() const { return codecs_; }
+
+  // By FFmpeg name; nullptr if the build has no such encoder/decoder.
+  const CodecInfo* FindEncoder(const std::string& name) const;
+  const CodecInfo* FindDecoder(const std::string& name) const;
+
+  // nullptr for codecs outside the registry.
+  const VideoCodec* FindVideo(AVCodecID id) const;
+
+  /**
+   * Whether a session opened with this configuration would work. width and
+   * height may be 0 when the config does not give them. 'prefer-hardware'
+   * requires a usable hardware implementation.
+   */
+  bool IsVideoConfigSupported(const VideoCodecSpec& spec, Direction direction, int width, int height,
+                              HardwarePreference hardware) const;
+
+ private:
+  CodecCapabilities();
+
+  std::vector<CodecInfo> codecs_;
+  std::unordered_map<std::string, size_t> encoders_;
+  std::unordered_map<std::string, size_t> decoders_;
+  std::vector<VideoCodec> video_;
+};
+
+#endif  // WEBCODECS_NATIVE_CODEC_CAPABILITIES_H_
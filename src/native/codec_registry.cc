@@ -0,0 +1,663 @@
+/**
+ * Video codec registry implementation.
+ */
+
+#include "codec_registry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <libavutil/dict.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/mem.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include "codec_scheduler.h"
+#include "ffmpeg_utils.h"
+#include "packet_pool.h"
+
+namespace {
+
+struct CodecEntry {
+  AVCodecID id;
+  const char* name;
+  // Tried in order; the first one built into FFmpeg wins.
+  const char* encoders[3];
+  const char* decoders[3];
+  // Hardware encoders, tried in order for 'prefer-hardware'. Hardware
+  // decoding uses FFmpeg's own decoder with a device instead.
+  const char* hardwareEncoders[4];
+};
+
+// Implementations per codec, fastest/most complete first.
+const CodecEntry kCodecs[] = {
+  {AV_CODEC_ID_VP8, "VP8", {"libvpx", nullptr, nullptr}, {"vp8", "libvpx", nullptr},
+   {"vp8_vaapi", nullptr, nullptr, nullptr}},
+  {AV_CODEC_ID_VP9, "VP9", {"libvpx-vp9", nullptr, nullptr}, {"vp9", "libvpx-vp9", nullptr},
+   {"vp9_vaapi", "vp9_qsv", nullptr, nullptr}},
+  {AV_CODEC_ID_AV1, "AV1", {"libaom-av1", "libsvtav1", "librav1e"}, {"libdav1d", "libaom-av1", "av1"},
+   {"av1_nvenc", "av1_vaapi", "av1_qsv", nullptr}},
+  {AV_CODEC_ID_H264, "H.264", {"libx264", "libopenh264", nullptr}, {"h264", nullptr, nullptr},
+   {"h264_nvenc", "h264_videotoolbox", "h264_vaapi", "h264_qsv"}},
+};
+
+// Surfaces in the upload pool of encoders that take hardware frames.
+constexpr int kEncoderSurfacePoolSize = 16;
+
+const CodecEntry* FindEntry(AVCodecID id) {
+  for (const CodecEntry& entry : kCodecs) {
+    if (entry.id == id) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<std::string> SplitCodecString(const std::string& codec) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (true) {
+    size_t dot = codec.find('.', start);
+    parts.push_back(codec.substr(start, dot == std::string::npos ? std::string::npos : dot - start));
+    if (dot == std::string::npos) {
+      return parts;
+    }
+    start = dot + 1;
+  }
+}
+
+// Parse a decimal field, or -1 if it is not purely numeric.
+int ParseDecimal(const std::string& field) {
+  if (field.empty() || field.size() > 4) {
+    return -1;
+  }
+  for (char c : field) {
+    if (!isdigit(static_cast<unsigned char>(c))) {
+      return -1;
+    }
+  }
+  return atoi(field.c_str());
+}
+
+// vp09.PP.LL.DD[...]
+bool ParseVp9(const std::vector<std::string>& parts, VideoCodecSpec* spec, std::string* error) {
+  if (parts.size() == 1) {
+    return true;
+  }
+  if (parts.size() < 4) {
+    *error = "VP9 codec string must be vp09.PP.LL.DD";
+    return false;
+  }
+  int profile = ParseDecimal(parts[1]);
+  int bitDepth = ParseDecimal(parts[3]);
+  if (profile != 0 || bitDepth != 8) {
+    *error = "Only 8-bit 4:2:0 VP9 (profile 0) is supported";
+    return false;
+  }
+  spec->profile = profile;
+  return true;
+}
+
+// av01.P.LLT.DD[...]
+bool ParseAv1(const std::vector<std::string>& parts, VideoCodecSpec* spec, std::string* error) {
+  if (parts.size() == 1) {
+    return true;
+  }
+  if (parts.size() < 4 || parts[2].size() != 3) {
+    *error = "AV1 codec string must be av01.P.LLT.DD";
+    return false;
+  }
+  int profile = ParseDecimal(parts[1]);
+  int level = ParseDecimal(parts[2].substr(0, 2));
+  int bitDepth = ParseDecimal(parts[3]);
+  if (profile != 0 || bitDepth != 8) {
+    *error = "Only 8-bit 4:2:0 AV1 (Main profile) is supported";
+    return false;
+  }
+  spec->profile = profile;
+  spec->level = level;
+  return true;
+}
+
+// avc1.PPCCLL: profile_idc, constraint flags and level_idc in hex.
+bool ParseAvc(const std::vector<std::string>& parts, VideoCodecSpec* spec, std::string* error) {
+  if (parts.size() == 1) {
+    return true;
+  }
+  if (parts.size() != 2 || parts[1].size() != 6) {
+    *error = "H.264 codec string must be avc1.PPCCLL";
+    return false;
+  }
+  char* end = nullptr;
+  long value = strtol(parts[1].c_str(), &end, 16);
+  if (*end != '\0') {
+    *error = "H.264 codec string must be avc1.PPCCLL";
+    return false;
+  }
+  int profileIdc = static_cast<int>((value >> 16) & 0xff);
+  int levelIdc = static_cast<int>(value & 0xff);
+  // Baseline, Main, Extended and High are 8-bit 4:2:0; High 10/4:2:2/4:4:4 are not.
+  if (profileIdc != 66 && profileIdc != 77 && profileIdc != 88 && profileIdc != 100) {
+    *error = "Only 8-bit 4:2:0 H.264 profiles are supported";
+    return false;
+  }
+  spec->profile = profileIdc;
+  spec->level = levelIdc;
+  return true;
+}
+
+/**
+ * Private options per encoder implementation. The library defaults target
+ * offline quality and are far too slow for a streaming session, so even
+ * 'quality' uses the faster end of each encoder's good-quality presets;
+ * 'realtime' switches to the real-time modes and drops any lookahead.
+ */
+void SetEncoderOptions(const AVCodec* codec, LatencyMode latencyMode, AVDictionary** options) {
+  const char* name = codec->name;
+  bool realtime = latencyMode == LatencyMode::kRealtime;
+  if (strcmp(name, "libvpx") == 0) {
+    av_dict_set(options, "deadline", realtime ? "realtime" : "good", 0);
+    av_dict_set(options, "cpu-used", realtime ? "8" : "2", 0);
+    if (realtime) {
+      av_dict_set(options, "lag-in-frames", "0", 0);
+    }
+  } else if (strcmp(name, "libvpx-vp9") == 0) {
+    av_dict_set(options, "row-mt", "1", 0);
+    av_dict_set(options, "deadline", realtime ? "realtime" : "good", 0);
+    av_dict_set(options, "cpu-used", realtime ? "8" : "4", 0);
+    if (realtime) {
+      av_dict_set(options, "lag-in-frames", "0", 0);
+    }
+  } else if (strcmp(name, "libaom-av1") == 0) {
+    av_dict_set(options, "row-mt", "1", 0);
+    av_dict_set(options, "usage", realtime ? "realtime" : "good", 0);
+    av_dict_set(options, "cpu-used", realtime ? "8" : "6", 0);
+    if (realtime) {
+      av_dict_set(options, "lag-in-frames", "0", 0);
+    }
+  } else if (strcmp(name, "libsvtav1") == 0) {
+    av_dict_set(options, "preset", realtime ? "10" : "8", 0);
+    if (realtime) {
+      av_dict_set(options, "svtav1-params", "pred-struct=1", 0);
+    }
+  } else if (strcmp(name, "librav1e") == 0) {
+    av_dict_set(options, "speed", realtime ? "10" : "8", 0);
+    if (realtime) {
+      av_dict_set(options, "rav1e-params", "low_latency=true", 0);
+    }
+  } else if (strcmp(name, "libx264") == 0) {
+    av_dict_set(options, "preset", realtime ? "superfast" : "veryfast", 0);
+    if (realtime) {
+      av_dict_set(options, "tune", "zerolatency", 0);
+    }
+  }
+}
+
+/**
+ * Threads for an encoder that was not given a count: one per 128 rows of
+ * picture, which is about where row and tile threading stop paying off,
+ * capped by the scheduler's codec thread budget.
+ */
+int DefaultEncoderThreads(int height) {
+  int cap = static_cast<int>(CodecScheduler::Shared().CodecThreadCap());
+  return std::max(1, std::min(cap, height / 128));
+}
+
+bool SupportsPixelFormat(const AVCodec* codec, AVPixelFormat format) {
+  if (!codec->pix_fmts) {
+    return true;
+  }
+  for (const AVPixelFormat* fmt = codec->pix_fmts; *fmt != AV_PIX_FMT_NONE; fmt++) {
+    if (*fmt == format) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Give an encoder that only accepts hardware surfaces (VA-API, QSV) a frames
+ * context to upload into. Encoders that take system memory (NVENC,
+ * VideoToolbox) need nothing.
+ */
+bool SetupHardwareFrames(const AVCodec* codec, AVCodecContext* ctx, std::string* error) {
+  for (int i = 0;; i++) {
+    const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+    if (!config) {
+      *error = std::string(codec->name) + " has no usable hardware configuration";
+      return false;
+    }
+    if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_FRAMES_CTX)) {
+      continue;
+    }
+
+    AVBufferRef* device = AcquireHwDevice(config->device_type);
+    if (!device) {
+      continue;
+    }
+    AVBufferRef* frames = av_hwframe_ctx_alloc(device);
+    av_buffer_unref(&device);
+    if (!frames) {
+      *error = "Failed to allocate hardware frames context";
+      return false;
+    }
+
+    AVHWFramesContext* framesCtx = reinterpret_cast<AVHWFramesContext*>(frames->data);
+    framesCtx->format = config->pix_fmt;
+    framesCtx->sw_format = AV_PIX_FMT_NV12;
+    framesCtx->width = ctx->width;
+    framesCtx->height = ctx->height;
+    framesCtx->initial_pool_size = kEncoderSurfacePoolSize;
+    int ret = av_hwframe_ctx_init(frames);
+    if (ret < 0) {
+      av_buffer_unref(&frames);
+      *error = "Failed to initialize hardware frames: " + AvErrorString(ret);
+      return false;
+    }
+
+    ctx->pix_fmt = config->pix_fmt;
+    ctx->hw_frames_ctx = frames;
+    return true;
+  }
+}
+
+bool IsLibx264(const AVCodec* codec) {
+  return strcmp(codec->name, "libx264") == 0;
+}
+
+/**
+ * Map a bitrate mode onto the generic context fields. FFmpeg's libvpx and
+ * libaom wrappers switch to CBR when min, max and target rate are equal;
+ * libx264 and the hardware encoders enforce it through the VBV buffer,
+ * sized here to one second. A fixed quantizer pins qmin and qmax, except
+ * for libx264, which takes it as its constant QP.
+ */
+void SetRateControl(AVCodecContext* ctx, BitrateMode mode, int64_t bitrate, int quantizer) {
+  switch (mode) {
+    case BitrateMode::kConstant:
+      ctx->bit_rate = bitrate;
+      ctx->rc_min_rate = bitrate;
+      ctx->rc_max_rate = bitrate;
+      ctx->rc_buffer_size = static_cast<int>(std::min<int64_t>(bitrate, INT_MAX));
+      break;
+    case BitrateMode::kVariable:
+      ctx->bit_rate = bitrate;
+      break;
+    case BitrateMode::kQuantizer:
+      ctx->bit_rate = 0;
+      if (quantizer < 0) {
+        break;
+      }
+      if (IsLibx264(ctx->codec)) {
+        av_opt_set_int(ctx->priv_data, "qp", quantizer, 0);
+      } else {
+        ctx->qmin = quantizer;
+        ctx->qmax = quantizer;
+      }
+      break;
+  }
+}
+
+/**
+ * Encoders whose FFmpeg wrapper compares the rate-control fields with its
+ * own configuration on every frame and reconfigures itself in place.
+ */
+bool ReadsRateControlPerFrame(const AVCodec* codec) {
+  const char* name = codec->name;
+  size_t length = strlen(name);
+  auto endsWith = [name, length](const char* suffix) {
+    size_t n = strlen(suffix);
+    return length > n && strcmp(name + length - n, suffix) == 0;
+  };
+  return IsLibx264(codec) || endsWith("_nvenc") || endsWith("_qsv");
+}
+
+AVCodecContext* OpenEncoderWith(const AVCodec* codec, const VideoCodecSpec& spec,
+                                const VideoEncoderSettings& settings, std::string* error) {
+  AVCodecContext* ctx = avcodec_alloc_context3(codec);
+  if (!ctx) {
+    *error = "Failed to allocate encoder context";
+    return nullptr;
+  }
+
+  SetRateControl(ctx, settings.bitrateMode, settings.bitrate, settings.quantizer);
+  ctx->width = settings.width;
+  ctx->height = settings.height;
+  ctx->time_base = settings.timeBase.num > 0 ? settings.timeBase : av_inv_q(settings.framerate);
+  ctx->framerate = settings.framerate;
+  ctx->gop_size = settings.gopSize;
+  ctx->max_b_frames = 0;
+  ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+  ctx->thread_count = settings.threads > 0 ? settings.threads : DefaultEncoderThreads(settings.height);
+  // Frame threading queues up a frame per thread before the first packet
+  ctx->thread_type = settings.latencyMode == LatencyMode::kRealtime
+    ? FF_THREAD_SLICE : FF_THREAD_FRAME | FF_THREAD_SLICE;
+  if (spec.profile != kCodecUnspecified) {
+    ctx->profile = spec.profile;
+  }
+  if (spec.level != kCodecUnspecified) {
+    ctx->level = spec.level;
+  }
+
+  if (!SupportsPixelFormat(codec, AV_PIX_FMT_YUV420P) && !SetupHardwareFrames(codec, ctx, error)) {
+    avcodec_free_context(&ctx);
+    return nullptr;
+  }
+
+  if (settings.packets) {
+    settings.packets->Attach(ctx);
+  }
+
+  AVDictionary* options = nullptr;
+  SetEncoderOptions(codec, settings.latencyMode, &options);
+  int ret = avcodec_open2(ctx, codec, &options);
+  av_dict_free(&options);
+  if (ret < 0) {
+    avcodec_free_context(&ctx);
+    *error = std::string("Failed to open ") + spec.name + " encoder (" + codec->name + "): " + AvErrorString(ret);
+    return nullptr;
+  }
+  return ctx;
+}
+
+// Pick the hardware surface format chosen in AttachHardwareDevice(), or the
+// first software format if the hwaccel cannot handle this stream.
+AVPixelFormat SelectHardwareFormat(AVCodecContext* ctx, const AVPixelFormat* formats) {
+  AVPixelFormat wanted = static_cast<AVPixelFormat>(reinterpret_cast<intptr_t>(ctx->opaque));
+  for (const AVPixelFormat* fmt = formats; *fmt != AV_PIX_FMT_NONE; fmt++) {
+    if (*fmt == wanted) {
+      return *fmt;
+    }
+  }
+  return avcodec_default_get_format(ctx, formats);
+}
+
+/**
+ * Give a decoder the first platform device it has a hwaccel for.
+ */
+bool AttachHardwareDevice(const AVCodec* codec, AVCodecContext* ctx) {
+  for (AVHWDeviceType type : PlatformDeviceTypes()) {
+    for (int i = 0;; i++) {
+      const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+      if (!config) {
+        break;
+      }
+      if (config->device_type != type || !(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)) {
+        continue;
+      }
+      AVBufferRef* device = AcquireHwDevice(type);
+      if (!device) {
+        break;
+      }
+      ctx->hw_device_ctx = device;
+      ctx->opaque = reinterpret_cast<void*>(static_cast<intptr_t>(config->pix_fmt));
+      ctx->get_format = SelectHardwareFormat;
+      ctx->extra_hw_frames = kExtraHardwareFrames;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ParseVideoCodec(const std::string& codec, VideoCodecSpec* spec, std::string* error) {
+  std::vector<std::string> parts = SplitCodecString(codec);
+  std::string fourcc = parts[0];
+  for (char& c : fourcc) {
+    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+  }
+
+  *spec = VideoCodecSpec();
+  bool ok = false;
+  if (fourcc == "vp8" && parts.size() == 1) {
+    spec->id = AV_CODEC_ID_VP8;
+    ok = true;
+  } else if (fourcc == "vp09") {
+    spec->id = AV_CODEC_ID_VP9;
+    ok = ParseVp9(parts, spec, error);
+  } else if (fourcc == "av01") {
+    spec->id = AV_CODEC_ID_AV1;
+    ok = ParseAv1(parts, spec, error);
+  } else if (fourcc == "avc1" || fourcc == "avc3") {
+    spec->id = AV_CODEC_ID_H264;
+    ok = ParseAvc(parts, spec, error);
+  } else {
+    *error = "Unsupported codec: " + codec;
+    return false;
+  }
+
+  const CodecEntry* entry = FindEntry(spec->id);
+  spec->name = entry->name;
+  return ok;
+}
+
+bool ParseLatencyMode(const std::string& value, LatencyMode* mode) {
+  if (value == "quality") {
+    *mode = LatencyMode::kQuality;
+  } else if (value == "realtime") {
+    *mode = LatencyMode::kRealtime;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ParseBitrateMode(const std::string& value, BitrateMode* mode) {
+  if (value == "variable") {
+    *mode = BitrateMode::kVariable;
+  } else if (value == "constant") {
+    *mode = BitrateMode::kConstant;
+  } else if (value == "quantizer") {
+    *mode = BitrateMode::kQuantizer;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+int MaxQuantizer(AVCodecID id) {
+  return id == AV_CODEC_ID_H264 ? 51 : 63;
+}
+
+std::string CodecStringFromParameters(const AVCodecParameters* par) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(par->format));
+  int bitDepth = desc ? desc->comp[0].depth : 8;
+  int profile = par->profile >= 0 ? par->profile : 0;
+  char codec[32];
+
+  switch (par->codec_id) {
+    case AV_CODEC_ID_VP8:
+      return "vp8";
+    case AV_CODEC_ID_VP9:
+      // Level 1.0 when the container does not say
+      snprintf(codec, sizeof(codec), "vp09.%02d.%02d.%02d", profile,
+               par->level > 0 ? par->level : 10, bitDepth);
+      return codec;
+    case AV_CODEC_ID_AV1:
+      snprintf(codec, sizeof(codec), "av01.%d.%02dM.%02d", profile,
+               par->level >= 0 ? par->level : 0, bitDepth);
+      return codec;
+    case AV_CODEC_ID_H264:
+      // An avcC record carries the exact profile, constraint and level bytes
+      if (par->extradata_size >= 4 && par->extradata[0] == 1) {
+        snprintf(codec, sizeof(codec), "avc1.%02x%02x%02x", par->extradata[1],
+                 par->extradata[2], par->extradata[3]);
+      } else {
+        snprintf(codec, sizeof(codec), "avc1.%02x00%02x", profile & 0xff,
+                 par->level > 0 ? par->level : 0);
+      }
+      return codec;
+    default:
+      return "";
+  }
+}
+
+std::vector<AVCodecID> RegistryVideoCodecs() {
+  std::vector<AVCodecID> ids;
+  for (const CodecEntry& entry : kCodecs) {
+    ids.push_back(entry.id);
+  }
+  return ids;
+}
+
+const AVCodec* FindVideoEncoder(AVCodecID id) {
+  const CodecEntry* entry = FindEntry(id);
+  if (entry) {
+    for (const char* name : entry->encoders) {
+      if (!name) {
+        break;
+      }
+      if (const AVCodec* codec = avcodec_find_encoder_by_name(name)) {
+        return codec;
+      }
+    }
+  }
+  return avcodec_find_encoder(id);
+}
+
+const AVCodec* FindVideoDecoder(AVCodecID id) {
+  const CodecEntry* entry = FindEntry(id);
+  if (entry) {
+    for (const char* name : entry->decoders) {
+      if (!name) {
+        break;
+      }
+      if (const AVCodec* codec = avcodec_find_decoder_by_name(name)) {
+        return codec;
+      }
+    }
+  }
+  return avcodec_find_decoder(id);
+}
+
+std::vector<const AVCodec*> FindHardwareVideoEncoders(AVCodecID id) {
+  std::vector<const AVCodec*> hardware;
+  const CodecEntry* entry = FindEntry(id);
+  if (entry) {
+    for (const char* name : entry->hardwareEncoders) {
+      if (!name) {
+        break;
+      }
+      if (const AVCodec* codec = avcodec_find_encoder_by_name(name)) {
+        hardware.push_back(codec);
+      }
+    }
+  }
+  return hardware;
+}
+
+AVCodecContext* OpenVideoEncoder(const VideoCodecSpec& spec, const VideoEncoderSettings& settings,
+                                 std::string* error) {
+  std::vector<const AVCodec*> candidates;
+  if (const AVCodec* software = FindVideoEncoder(spec.id)) {
+    candidates.push_back(software);
+  }
+  // Otherwise hardware is only reached when there is no software encoder
+  auto position = settings.hardware == HardwarePreference::kPreferHardware
+    ? candidates.begin() : candidates.end();
+  std::vector<const AVCodec*> hardware = FindHardwareVideoEncoders(spec.id);
+  candidates.insert(position, hardware.begin(), hardware.end());
+
+  if (candidates.empty()) {
+    *error = std::string(spec.name) + " encoder not found";
+    return nullptr;
+  }
+  // Hardware encoders fail to open on machines without the device; keep going.
+  for (const AVCodec* codec : candidates) {
+    AVCodecContext* ctx = OpenEncoderWith(codec, spec, settings, error);
+    if (ctx) {
+      return ctx;
+    }
+  }
+  return nullptr;
+}
+
+bool UpdateRateControl(AVCodecContext* ctx, BitrateMode mode, int64_t bitrate, int quantizer) {
+  bool live = mode == BitrateMode::kQuantizer ? SupportsLiveQuantizer(ctx) : ReadsRateControlPerFrame(ctx->codec);
+  if (!live) {
+    return false;
+  }
+  SetRateControl(ctx, mode, bitrate, quantizer);
+  return true;
+}
+
+bool SupportsLiveQuantizer(const AVCodecContext* ctx) {
+  return IsLibx264(ctx->codec);
+}
+
+AVCodecContext* OpenVideoDecoder(const VideoCodecSpec& spec, const uint8_t* extradata,
+                                 size_t extradataSize, HardwarePreference hardware,
+                                 std::string* error, const FastDecodeOptions& fast) {
+  // Hardware decoding goes through FFmpeg's native decoder, which carries
+  // the hwaccels; fall back to the usual software choice without a device.
+  const AVCodec* codec = nullptr;
+  AVCodecContext* ctx = nullptr;
+  if (hardware == HardwarePreference::kPreferHardware) {
+    codec = avcodec_find_decoder(spec.id);
+    ctx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (ctx && !AttachHardwareDevice(codec, ctx)) {
+      avcodec_free_context(&ctx);
+    }
+  }
+  if (!ctx) {
+    codec = FindVideoDecoder(spec.id);
+    if (!codec) {
+      *error = std::string(spec.name) + " decoder not found";
+      return nullptr;
+    }
+    ctx = avcodec_alloc_context3(codec);
+  }
+  if (!ctx) {
+    *error = "Failed to allocate codec context";
+    return nullptr;
+  }
+
+  // Chunk timestamps are microseconds and pass through the decoder as PTS.
+  ctx->pkt_timebase = {1, 1000000};
+
+  if (extradata && extradataSize > 0) {
+    ctx->extradata = static_cast<uint8_t*>(av_mallocz(extradataSize + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!ctx->extradata) {
+      avcodec_free_context(&ctx);
+      *error = "Failed to allocate codec description";
+      return nullptr;
+    }
+    memcpy(ctx->extradata, extradata, extradataSize);
+    ctx->extradata_size = static_cast<int>(extradataSize);
+  }
+
+  if (fast.keyframesOnly) {
+    ctx->skip_frame = AVDISCARD_NONKEY;
+    ctx->skip_loop_filter = AVDISCARD_ALL;
+  }
+  ctx->lowres = std::min(std::max(fast.lowres, 0), static_cast<int>(codec->max_lowres));
+
+  int ret = avcodec_open2(ctx, codec, nullptr);
+  if (ret < 0) {
+    avcodec_free_context(&ctx);
+    *error = std::string("Failed to open ") + spec.name + " decoder: " + AvErrorString(ret);
+    return nullptr;
+  }
+  return ctx;
+}
+
+AVPixelFormat EncoderInputFormat(const AVCodecContext* ctx) {
+  if (ctx->hw_frames_ctx) {
+    return reinterpret_cast<AVHWFramesContext*>(ctx->hw_frames_ctx->data)->sw_format;
+  }
+  return ctx->pix_fmt;
+}
+
+bool IsHardwareContext(const AVCodecContext* ctx) {
+  return ctx->hw_device_ctx || ctx->hw_frames_ctx ||
+         (ctx->codec->capabilities & AV_CODEC_CAP_HARDWARE);
+}
@@ -0,0 +1,160 @@
+/**
+ * Video codec registry.
+ *
+ * Maps WebCodecs codec strings ("vp8", "vp09.*", "av01.*", "avc1.*") to
+ * FFmpeg codecs and opens encoder/decoder contexts with the per-codec
+ * options this addon relies on, including the hardware implementations
+ * selected by `hardwareAcceleration`. NativeVideoEncoder, NativeVideoDecoder
+ * and the one-shot encodeFrame()/decodeFrame() helpers all go through here,
+ * so adding a codec only touches this file.
+ */
+
+#ifndef WEBCODECS_NATIVE_CODEC_REGISTRY_H_
+#define WEBCODECS_NATIVE_CODEC_REGISTRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "hw_device.h"
+
+class PacketPool;
+
+// Profile/level value meaning "let the encoder choose".
+constexpr int kCodecUnspecified = -99;
+
+// Surfaces a hardware decoder keeps on top of what it needs itself, for
+// frames JS still holds or a pipeline has lent to surface encoders.
+constexpr int kExtraHardwareFrames = 8;
+
+struct VideoCodecSpec {
+  AVCodecID id = AV_CODEC_ID_NONE;
+  const char* name = "";  // Human-readable, for error messages
+  int profile = kCodecUnspecified;
+  int level = kCodecUnspecified;
+};
+
+// WebCodecs `latencyMode`.
+enum class LatencyMode { kQuality, kRealtime };
+
+// WebCodecs `bitrateMode`.
+enum class BitrateMode { kVariable, kConstant, kQuantizer };
+
+struct VideoEncoderSettings {
+  int width = 0;
+  int height = 0;
+  int64_t bitrate = 500000;
+  BitrateMode bitrateMode = BitrateMode::kVariable;
+  int quantizer = -1;  // kQuantizer only; -1 leaves the codec's default
+  AVRational framerate = {30, 1};
+  AVRational timeBase = {0, 1};  // Units of frame PTS; {0, 1} means 1/framerate
+  int gopSize = 30;
+  HardwarePreference hardware = HardwarePreference::kNoPreference;
+  LatencyMode latencyMode = LatencyMode::kQuality;
+  int threads = 0;  // Encoder threads; 0 picks from the frame size and core count
+  PacketPool* packets = nullptr;  // Optional destination for encoded packets
+};
+
+// Non-standard decoder shortcuts for scrubbing and preview generation.
+struct FastDecodeOptions {
+  bool keyframesOnly = false;  // Discard non-key frames and skip the loop filter
+  int lowres = 0;              // Decode at 1/2^lowres size where the decoder can
+};
+
+/**
+ * Parse 'quality' | 'realtime'.
+ */
+bool ParseLatencyMode(const std::string& value, LatencyMode* mode);
+
+/**
+ * Parse 'variable' | 'constant' | 'quantizer'.
+ */
+bool ParseBitrateMode(const std::string& value, BitrateMode* mode);
+
+/**
+ * Largest per-frame quantizer of a codec in 'quantizer' mode, as in the
+ * WebCodecs codec registrations: 51 for H.264, 63 for VP8, VP9 and AV1.
+ */
+int MaxQuantizer(AVCodecID id);
+
+/**
+ * Parse a WebCodecs codec string. Only 8-bit 4:2:0 profiles are accepted,
+ * because every session feeds the codec yuv420p.
+ */
+bool ParseVideoCodec(const std::string& codec, VideoCodecSpec* spec, std::string* error);
+
+/**
+ * The WebCodecs codec string for a demuxed stream, e.g. "vp09.00.10.08" or
+ * "avc1.64001f". Empty if the codec is not in the registry.
+ */
+std::string CodecStringFromParameters(const AVCodecParameters* par);
+
+/**
+ * Codecs in the registry, in registry order.
+ */
+std::vector<AVCodecID> RegistryVideoCodecs();
+
+/**
+ * Preferred FFmpeg implementation for a codec, or nullptr if none is built in.
+ */
+const AVCodec* FindVideoEncoder(AVCodecID id);
+const AVCodec* FindVideoDecoder(AVCodecID id);
+
+/**
+ * Hardware encoders built into FFmpeg for a codec, in the order
+ * 'prefer-hardware' tries them. Their devices may still be missing.
+ */
+std::vector<const AVCodec*> FindHardwareVideoEncoders(AVCodecID id);
+
+/**
+ * Allocate and open an encoder context for `spec`. 'prefer-hardware' tries
+ * the platform's hardware encoders first and falls back to software;
+ * otherwise hardware is only used when no software encoder is built in.
+ * Returns nullptr and fills `error` on failure.
+ */
+AVCodecContext* OpenVideoEncoder(const VideoCodecSpec& spec, const VideoEncoderSettings& settings,
+                                 std::string* error);
+
+/**
+ * Change the rate control of an open encoder between two frames. Returns
+ * false, leaving `ctx` untouched, for encoders that only read it when they
+ * are opened; the caller then has to drain and reopen them.
+ */
+bool UpdateRateControl(AVCodecContext* ctx, BitrateMode mode, int64_t bitrate, int quantizer);
+
+/**
+ * True if UpdateRateControl() takes a new quantizer on this open encoder.
+ * Only libx264 does, by re-reading its constant QP before every frame.
+ */
+bool SupportsLiveQuantizer(const AVCodecContext* ctx);
+
+/**
+ * Allocate and open a decoder context for `spec`. `extradata` is the
+ * WebCodecs `description` (e.g. an avcC record) and may be null.
+ * With 'prefer-hardware' the decoder gets a hardware device when one is
+ * available and outputs frames in GPU memory.
+ * `fast.lowres` is clamped to what the chosen decoder supports (most only
+ * support 0); read the effective value back from ctx->lowres.
+ * Packet timestamps are expected in microseconds.
+ */
+AVCodecContext* OpenVideoDecoder(const VideoCodecSpec& spec, const uint8_t* extradata,
+                                 size_t extradataSize, HardwarePreference hardware,
+                                 std::string* error, const FastDecodeOptions& fast = {});
+
+/**
+ * Software pixel format the encoder's input must be converted to before it
+ * is sent (or uploaded, for encoders that take hardware surfaces).
+ */
+AVPixelFormat EncoderInputFormat(const AVCodecContext* ctx);
+
+/**
+ * True if the context encodes or decodes on dedicated hardware.
+ */
+bool IsHardwareContext(const AVCodecContext* ctx);
+
+#endif  // WEBCODECS_NATIVE_CODEC_REGISTRY_H_
@@ -0,0 +1,247 @@
+/**
+ * CodecScheduler implementation.
+ */
+
+#include "codec_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "worker_thread.h"
+
+namespace {
+
+constexpr size_t kNoAffinity = std::numeric_limits<size_t>::max();
+
+size_t DefaultThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Serializes Configure(), which joins threads outside mutex_.
+std::mutex configureMutex;
+
+}  // namespace
+
+CodecScheduler& CodecScheduler::Shared() {
+  // Intentionally leaked: pool threads are still parked on it while static
+  // destructors run at process exit.
+  static CodecScheduler* scheduler = new CodecScheduler();
+  return *scheduler;
+}
+
+CodecScheduler::CodecScheduler()
+    : threads_(DefaultThreads()), codecThreads_(DefaultThreads()) {}
+
+void CodecScheduler::Configure(size_t threads, size_t codecThreads) {
+  std::lock_guard<std::mutex> serialize(configureMutex);
+  std::vector<Worker*> removed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    codecThreads_ = codecThreads > 0 ? codecThreads : DefaultThreads();
+    threads_ = threads > 0 ? threads : DefaultThreads();
+    // Threads are only started with the first session
+    if (workers_.empty()) {
+      return;
+    }
+    if (workers_.size() < threads_) {
+      SpawnLocked(threads_ - workers_.size());
+      return;
+    }
+    for (size_t i = threads_; i < workers_.size(); i++) {
+      workers_[i]->exiting = true;
+      removed.push_back(workers_[i].get());
+    }
+    workAvailable_.notify_all();
+  }
+
+  for (Worker* worker : removed) {
+    worker->thread.join();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  workers_.resize(threads_);
+}
+
+size_t CodecScheduler::CodecThreadCap() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return codecThreads_;
+}
+
+CodecScheduler::Stats CodecScheduler::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {threads_, codecThreads_, sessions_, ready_, executed_, steals_};
+}
+
+void CodecScheduler::Register(WorkerThread* lane) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lane->registered_ = true;
+  lane->affinity_ = kNoAffinity;
+  sessions_++;
+  if (workers_.empty()) {
+    SpawnLocked(threads_);
+  }
+}
+
+void CodecScheduler::Unregister(WorkerThread* lane) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!lane->registered_ || lane->stopped_) {
+    return;
+  }
+  lane->stopped_ = true;
+  if (lane->queued_ && !lane->running_) {
+    for (auto& worker : workers_) {
+      auto it = std::find(worker->ready.begin(), worker->ready.end(), lane);
+      if (it != worker->ready.end()) {
+        worker->ready.erase(it);
+        ready_--;
+        break;
+      }
+    }
+  }
+  if (lane->parked_) {
+    parked_.erase(std::find(parked_.begin(), parked_.end(), lane));
+    lane->parked_ = false;
+  }
+  laneIdle_.wait(lock, [lane] { return !lane->running_; });
+  lane->queued_ = false;
+  sessions_--;
+  // A closed queue has room again, which may open a parked lane's gate
+  ReleaseParkedLocked();
+}
+
+void CodecScheduler::Schedule(WorkerThread* lane) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A queued lane is picked up again by the thread running it
+  if (!lane->registered_ || lane->stopped_ || lane->queued_) {
+    return;
+  }
+  lane->queued_ = true;
+  Place(lane, lane->affinity_);
+}
+
+void CodecScheduler::SetGate(WorkerThread* lane, std::function<bool()> gate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lane->gate_ = std::move(gate);
+  ReleaseParkedLocked();
+}
+
+// Called with mutex_ held.
+void CodecScheduler::Place(WorkerThread* lane, size_t preferred) {
+  size_t target = preferred < threads_ ? preferred : nextWorker_++ % threads_;
+  workers_[target]->ready.push_back(lane);
+  ready_++;
+  workAvailable_.notify_one();
+}
+
+// Called with mutex_ held. A gate reads queues that other lanes pop before
+// they take mutex_ again, so a lane parked on a full queue is always
+// checked again after that queue has drained.
+void CodecScheduler::ReleaseParkedLocked() {
+  for (auto it = parked_.begin(); it != parked_.end();) {
+    WorkerThread* lane = *it;
+    if (lane->gate_ && !lane->gate_()) {
+      ++it;
+      continue;
+    }
+    it = parked_.erase(it);
+    lane->parked_ = false;
+    Place(lane, lane->affinity_);
+  }
+}
+
+// Called with mutex_ held.
+void CodecScheduler::SpawnLocked(size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    size_t index = workers_.size();
+    workers_.push_back(std::make_unique<Worker>());
+    Worker* worker = workers_.back().get();
+    worker->thread = std::thread(&CodecScheduler::Run, this, worker, index);
+  }
+}
+
+// Called with mutex_ held.
+WorkerThread* CodecScheduler::TakeLane(size_t index) {
+  std::deque<WorkerThread*>& own = workers_[index]->ready;
+  if (!own.empty()) {
+    WorkerThread* lane = own.front();
+    own.pop_front();
+    ready_--;
+    return lane;
+  }
+
+  Worker* victim = nullptr;
+  for (size_t i = 0; i < workers_.size(); i++) {
+    if (i != index && !workers_[i]->ready.empty() &&
+        (!victim || workers_[i]->ready.size() > victim->ready.size())) {
+      victim = workers_[i].get();
+    }
+  }
+  if (!victim) {
+    return nullptr;
+  }
+  WorkerThread* lane = victim->ready.back();
+  victim->ready.pop_back();
+  ready_--;
+  steals_++;
+  return lane;
+}
+
+void CodecScheduler::Run(Worker* self, size_t index) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (self->exiting) {
+      // Hand this thread's lanes to the ones that stay
+      for (WorkerThread* lane : self->ready) {
+        ready_--;
+        Place(lane, kNoAffinity);
+      }
+      self->ready.clear();
+      return;
+    }
+
+    WorkerThread* lane = TakeLane(index);
+    if (!lane) {
+      workAvailable_.wait(lock);
+      continue;
+    }
+    if (lane->gate_ && !lane->gate_()) {
+      lane->parked_ = true;
+      parked_.push_back(lane);
+      continue;
+    }
+
+    lane->running_ = true;
+    lane->affinity_ = index;
+    lock.unlock();
+
+    // One command per turn
+    Command cmd;
+    bool ran = lane->queue_.Pop(&cmd);
+    if (ran) {
+      lane->handler_(cmd);
+      ReleaseCommand(&cmd);
+    }
+
+    lock.lock();
+    if (ran) {
+      executed_++;
+      // That command may have made room for a parked lane
+      if (!parked_.empty()) {
+        ReleaseParkedLocked();
+      }
+    }
+    lane->running_ = false;
+    if (lane->stopped_) {
+      lane->queued_ = false;
+      laneIdle_.notify_all();
+    } else if (lane->queue_.Size() > 0) {
+      // Back of the line; wake a thread to steal if others are waiting here
+      self->ready.push_back(lane);
+      ready_++;
+      if (self->ready.size() > 1) {
+        workAvailable_.notify_one();
+      }
+    } else {
+      lane->queued_ = false;
+    }
+  }
+}
@@ -0,0 +1,103 @@
+/**
+ * CodecScheduler
+ *
+ * Process-wide pool of threads that every codec session runs on, so a
+ * process with hundreds of sessions uses a fixed number of threads.
+ *
+ * Each session is a WorkerThread lane with its own command queue. A lane
+ * with work is placed on one pool thread's ready deque (the thread that
+ * ran it last, to keep its codec state in cache) and runs one command per
+ * turn before going to the back, so a busy session cannot starve the rest.
+ * An idle pool thread steals from the back of the longest other deque.
+ * One lane never runs on two threads at once, which keeps each codec
+ * context single-threaded as before.
+ *
+ * A lane with a closed gate (see WorkerThread::SetGate) is parked instead
+ * of run, without holding a pool thread, and goes back on a deque once a
+ * command finishing elsewhere opens it.
+ *
+ * codecThreads caps the internal threads a codec opens when the session
+ * does not ask for a count (libvpx row threads, x264 slices, ...). Setting
+ * it to 1 packs many low-resolution streams onto the pool alone.
+ */
+
+#ifndef WEBCODECS_NATIVE_CODEC_SCHEDULER_H_
+#define WEBCODECS_NATIVE_CODEC_SCHEDULER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerThread;
+
+class CodecScheduler {
+ public:
+  struct Stats {
+    size_t threads;
+    size_t codecThreads;
+    size_t sessions;
+    size_t ready;        // Lanes waiting for a pool thread
+    uint64_t executed;   // Commands run
+    uint64_t steals;     // Lanes taken from another thread's deque
+  };
+
+  static CodecScheduler& Shared();
+
+  /**
+   * Resize the pool and the codec thread cap; 0 means one per core.
+   * Shrinking waits for the removed threads to finish their current command.
+   */
+  void Configure(size_t threads, size_t codecThreads);
+
+  /**
+   * Internal thread count for a codec whose session did not ask for one.
+   */
+  size_t CodecThreadCap() const;
+
+  Stats GetStats() const;
+
+ private:
+  friend class WorkerThread;
+
+  struct Worker {
+    std::deque<WorkerThread*> ready;
+    std::thread thread;
+    bool exiting = false;
+  };
+
+  CodecScheduler();
+
+  void Register(WorkerThread* lane);
+  // Blocks until `lane` is not running; it is never scheduled again.
+  void Unregister(WorkerThread* lane);
+  // `lane` has commands queued.
+  void Schedule(WorkerThread* lane);
+  void SetGate(WorkerThread* lane, std::function<bool()> gate);
+
+  void Run(Worker* self, size_t index);
+  WorkerThread* TakeLane(size_t index);
+  void Place(WorkerThread* lane, size_t preferred);
+  void ReleaseParkedLocked();
+  void SpawnLocked(size_t count);
+
+  mutable std::mutex mutex_;
+  std::condition_variable workAvailable_;
+  std::condition_variable laneIdle_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<WorkerThread*> parked_;
+  size_t threads_;
+  size_t codecThreads_;
+  size_t sessions_ = 0;
+  size_t ready_ = 0;
+  size_t nextWorker_ = 0;
+  uint64_t executed_ = 0;
+  uint64_t steals_ = 0;
+};
+
+#endif  // WEBCODECS_NATIVE_CODEC_SCHEDULER_H_
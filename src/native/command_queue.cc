@@ -0,0 +1,65 @@
+/**
+ * CommandQueue implementation.
+ */
+
+#include "command_queue.h"
+
+void ReleaseCommand(Command* cmd) {
+  av_frame_free(&cmd->frame);
+  av_packet_free(&cmd->packet);
+}
+
+CommandQueue::CommandQueue(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1) {}
+
+CommandQueue::~CommandQueue() {
+  Close();
+}
+
+bool CommandQueue::Push(Command& cmd) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  notFull_.wait(lock, [this] { return closed_ || commands_.size() < capacity_; });
+  if (closed_) {
+    return false;
+  }
+  commands_.push_back(cmd);
+  cmd = Command();
+  return true;
+}
+
+bool CommandQueue::PushNow(Command& cmd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return false;
+  }
+  commands_.push_back(cmd);
+  cmd = Command();
+  return true;
+}
+
+bool CommandQueue::Pop(Command* cmd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_ || commands_.empty()) {
+    return false;
+  }
+  *cmd = commands_.front();
+  commands_.pop_front();
+  // Wake every blocked Push(); the first to lock takes the slot
+  notFull_.notify_all();
+  return true;
+}
+
+void CommandQueue::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  for (Command& cmd : commands_) {
+    ReleaseCommand(&cmd);
+  }
+  commands_.clear();
+  notFull_.notify_all();
+}
+
+size_t CommandQueue::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return commands_.size();
+}
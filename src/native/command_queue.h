@@ -0,0 +1,87 @@
+/**
+ * CommandQueue
+ *
+ * Bounded, thread-safe FIFO of work items for a codec session's lane.
+ * The JS thread pushes ENCODE/DECODE/FLUSH commands; the scheduler pops
+ * them in order. Push blocks while the queue is full, which is the backpressure
+ * for native producers such as the demuxer thread. The JS thread uses
+ * PushNow and leaves pacing to the caller, as WebCodecs does.
+ */
+
+#ifndef WEBCODECS_NATIVE_COMMAND_QUEUE_H_
+#define WEBCODECS_NATIVE_COMMAND_QUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "frame_transform.h"
+
+enum class CommandType {
+  kEncode,  // Encode `frame`
+  kDecode,  // Decode `packet`
+  kFlush,   // Drain the codec, then report `flushId` as done
+  kReconfigure,  // Switch the encoder to `bitrate` from the next frame on
+};
+
+struct Command {
+  CommandType type = CommandType::kFlush;
+  AVFrame* frame = nullptr;    // Owned; kEncode only
+  AVPacket* packet = nullptr;  // Owned; kDecode only
+  bool keyFrame = false;
+  int64_t timestamp = 0;
+  int64_t duration = 0;
+  bool hasDuration = false;
+  bool reportDequeue = true;  // Post a dequeue event once consumed
+  // kEncode from a NativeVideoPipeline: apply `transform` and scale the
+  // frame to the encoder's size, whatever size it arrives in.
+  bool transformInput = false;
+  FrameTransform transform;
+  int64_t bitrate = 0;  // kReconfigure only
+  int quantizer = -1;   // kEncode in 'quantizer' mode; -1 keeps the current one
+  uint32_t flushId = 0;
+  std::chrono::steady_clock::time_point enqueued;  // Set by WorkerThread::Enqueue()
+};
+
+/**
+ * Free the AVFrame/AVPacket a command owns.
+ */
+void ReleaseCommand(Command* cmd);
+
+class CommandQueue {
+ public:
+  explicit CommandQueue(size_t capacity);
+  ~CommandQueue();
+
+  // Blocks while full. Returns false (and leaves `cmd` untouched) once closed.
+  bool Push(Command& cmd);
+
+  // Push without waiting, past the capacity if need be. For producers that
+  // must not block: the JS thread, which paces itself with the session's
+  // queue size, and the scheduler pool.
+  bool PushNow(Command& cmd);
+
+  // The oldest command, or false if the queue is empty or closed.
+  bool Pop(Command* cmd);
+
+  // Wake all waiters and refuse further work. Pending commands are released.
+  void Close();
+
+  size_t Size() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable notFull_;
+  std::deque<Command> commands_;
+  size_t capacity_;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_COMMAND_QUEUE_H_
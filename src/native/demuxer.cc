@@ -0,0 +1,441 @@
+/**
+ * NativeDemuxer implementation.
+ *
+ * new NativeDemuxer({ path? }, { config(track), chunk(chunk), end(), error(err) })
+ *   write(data: Buffer)   container bytes, when constructed without a path
+ *   end()                 no more bytes follow
+ *   start(decoder?: NativeVideoDecoder)
+ *   close()
+ *
+ * track is { codec, codedWidth, codedHeight, description?, duration? },
+ * ready to configure a decoder with; duration is in microseconds.
+ * chunk is { data: Buffer, type: 'key' | 'delta', timestamp, duration? }.
+ * With a decoder, chunks are queued on that session instead and only the
+ * decoder's output() sees the result; end() fires once the last packet
+ * has been queued (flush the decoder to wait for its frames).
+ */
+
+#include "demuxer.h"
+
+#include "codec_registry.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+#include "video_decoder.h"
+
+extern "C" {
+#include <libavutil/mathematics.h>
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+// Events waiting for the JS thread. The demux thread blocks once this many
+// are queued, so a slow consumer throttles reading.
+constexpr size_t kEventQueueCapacity = 64;
+
+// AVIO read buffer for written input.
+constexpr int kIoBufferSize = 64 * 1024;
+
+constexpr AVRational kMicroseconds = {1, 1000000};
+
+}  // namespace
+
+Napi::Object NativeDemuxer::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeDemuxer", {
+    InstanceMethod("write", &NativeDemuxer::Write),
+    InstanceMethod("end", &NativeDemuxer::End),
+    InstanceMethod("start", &NativeDemuxer::Start),
+    InstanceMethod("close", &NativeDemuxer::Close),
+  });
+
+  exports.Set("NativeDemuxer", func);
+  return exports;
+}
+
+NativeDemuxer::NativeDemuxer(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeDemuxer>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected ({path?}, {config, chunk, end, error})").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object source = info[0].As<Napi::Object>();
+  Napi::Object callbacks = info[1].As<Napi::Object>();
+  if (!callbacks.Get("config").IsFunction() || !callbacks.Get("chunk").IsFunction() ||
+      !callbacks.Get("end").IsFunction() || !callbacks.Get("error").IsFunction()) {
+    Napi::TypeError::New(env, "Demuxer callbacks require config, chunk, end and error functions").ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (source.Get("path").IsString()) {
+    path_ = source.Get("path").As<Napi::String>().Utf8Value();
+  } else {
+    stream_ = std::make_unique<ByteStream>();
+  }
+
+  configCallback_ = Napi::Persistent(callbacks.Get("config").As<Napi::Function>());
+  endCallback_ = Napi::Persistent(callbacks.Get("end").As<Napi::Function>());
+  errorCallback_ = Napi::Persistent(callbacks.Get("error").As<Napi::Function>());
+
+  // The demux thread owns tsfn_ and releases it when it exits; the
+  // finalizer then joins the thread and drops the self-reference. The
+  // event loop is held until the config arrives and again after start().
+  Ref();
+  tsfn_ = Napi::ThreadSafeFunction::New(
+    env, callbacks.Get("chunk").As<Napi::Function>(), "NativeDemuxer", kEventQueueCapacity, 1,
+    [this](Napi::Env) {
+      // During environment teardown the thread may still be waiting.
+      stopping_ = true;
+      startCondition_.notify_all();
+      if (stream_) {
+        stream_->Abort();
+      }
+      if (thread_.joinable()) {
+        thread_.join();
+      }
+      targetRef_.Reset();
+      Unref();
+    });
+
+  thread_ = std::thread([this] { Run(); });
+}
+
+NativeDemuxer::~NativeDemuxer() {
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// JS thread
+// ---------------------------------------------------------------------------
+
+Napi::Value NativeDemuxer::Write(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Demuxer is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!stream_) {
+    Napi::Error::New(env, "Demuxer reads from a file").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsTypedArray()) {
+    Napi::TypeError::New(env, "Expected a Buffer").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::TypedArray view = info[0].As<Napi::TypedArray>();
+  const uint8_t* bytes = static_cast<const uint8_t*>(view.ArrayBuffer().Data()) + view.ByteOffset();
+  if (!stream_->Write(bytes, view.ByteLength())) {
+    Napi::Error::New(env, "Demuxer input has ended").ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+Napi::Value NativeDemuxer::End(const Napi::CallbackInfo& info) {
+  if (stream_) {
+    stream_->End();
+  }
+  return info.Env().Undefined();
+}
+
+/**
+ * Begin reading packets. With a NativeVideoDecoder argument they are
+ * queued on that decoder; otherwise each one is passed to chunk().
+ */
+Napi::Value NativeDemuxer::Start(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_ || finished_) {
+    Napi::Error::New(env, closed_ ? "Demuxer is closed" : "Demuxer has finished").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (started_) {
+    Napi::Error::New(env, "Demuxer is already started").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  NativeVideoDecoder* target = nullptr;
+  if (info.Length() >= 1 && !info[0].IsUndefined() && !info[0].IsNull()) {
+    target = NativeVideoDecoder::FromValue(info[0]);
+    if (!target) {
+      Napi::TypeError::New(env, "Expected a NativeVideoDecoder").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    targetRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    target_ = target;
+    startRequested_ = true;
+  }
+  startCondition_.notify_one();
+  started_ = true;
+  SetActive(env, true);
+  return env.Undefined();
+}
+
+void NativeDemuxer::Close(const Napi::CallbackInfo& info) {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  startCondition_.notify_one();
+  if (stream_) {
+    stream_->Abort();
+  }
+  // Once end or error was delivered tsfn_ may already be finalized.
+  if (!finished_) {
+    SetActive(info.Env(), false);
+  }
+}
+
+void NativeDemuxer::SetActive(Napi::Env env, bool active) {
+  if (active_ == active) {
+    return;
+  }
+  active_ = active;
+  if (active) {
+    tsfn_.Ref(env);
+  } else {
+    tsfn_.Unref(env);
+  }
+}
+
+void NativeDemuxer::DeliverEvent(Napi::Env env, Napi::Function chunk, Event* event) {
+  if (event->kind == Event::Kind::kEnd || event->kind == Event::Kind::kError) {
+    finished_ = true;
+  }
+
+  if (!closed_) {
+    switch (event->kind) {
+      case Event::Kind::kConfig: {
+        Napi::Object track = Napi::Object::New(env);
+        track.Set("codec", Napi::String::New(env, track_.codec));
+        track.Set("codedWidth", Napi::Number::New(env, track_.width));
+        track.Set("codedHeight", Napi::Number::New(env, track_.height));
+        if (!track_.description.empty()) {
+          track.Set("description", Napi::Buffer<uint8_t>::Copy(env, track_.description.data(),
+                                                               track_.description.size()));
+        }
+        if (track_.duration > 0) {
+          track.Set("duration", Napi::Number::New(env, static_cast<double>(track_.duration)));
+        }
+        // Nothing more arrives until start(); don't keep the process alive for it.
+        if (!started_) {
+          SetActive(env, false);
+        }
+        configCallback_.Call({track});
+        break;
+      }
+      case Event::Kind::kChunk: {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("type", Napi::String::New(env, (event->packet->flags & AV_PKT_FLAG_KEY) ? "key" : "delta"));
+        result.Set("timestamp", Napi::Number::New(env, static_cast<double>(event->timestamp)));
+        if (event->hasDuration) {
+          result.Set("duration", Napi::Number::New(env, static_cast<double>(event->duration)));
+        }
+        result.Set("data", PacketToBuffer(env, event->packet));
+        chunk.Call({result});
+        break;
+      }
+      case Event::Kind::kEnd:
+        endCallback_.Call({});
+        break;
+      case Event::Kind::kError:
+        errorCallback_.Call({Napi::Error::New(env, event->message).Value()});
+        break;
+    }
+  }
+
+  av_packet_free(&event->packet);
+  delete event;
+}
+
+// ---------------------------------------------------------------------------
+// Demux thread
+// ---------------------------------------------------------------------------
+
+void NativeDemuxer::Run() {
+  std::string error;
+  if (!Open(&error)) {
+    if (!stopping_) {
+      PostError(error);
+    }
+  } else {
+    Event* event = new Event();
+    event->kind = Event::Kind::kConfig;
+    Post(event);
+    if (WaitForStart()) {
+      ReadPackets();
+    }
+  }
+  CloseInput();
+  tsfn_.Release();
+}
+
+bool NativeDemuxer::Open(std::string* error) {
+  const char* url = nullptr;
+  if (stream_) {
+    format_ = avformat_alloc_context();
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kIoBufferSize));
+    if (buffer) {
+      io_ = avio_alloc_context(buffer, kIoBufferSize, 0, stream_.get(), ByteStream::ReadPacket,
+                               nullptr, nullptr);
+      if (!io_) {
+        av_free(buffer);
+      }
+    }
+    if (!format_ || !io_) {
+      *error = "Failed to allocate demuxer input";
+      return false;
+    }
+    format_->pb = io_;
+    format_->flags |= AVFMT_FLAG_CUSTOM_IO;
+  } else {
+    url = path_.c_str();
+  }
+
+  // Frees format_ on failure
+  int ret = avformat_open_input(&format_, url, nullptr, nullptr);
+  if (ret < 0) {
+    *error = "Failed to open input: " + AvErrorString(ret);
+    return false;
+  }
+
+  ret = avformat_find_stream_info(format_, nullptr);
+  if (ret < 0) {
+    *error = "Failed to read stream info: " + AvErrorString(ret);
+    return false;
+  }
+
+  streamIndex_ = av_find_best_stream(format_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+  if (streamIndex_ < 0) {
+    *error = "Input has no video track";
+    return false;
+  }
+
+  AVStream* stream = format_->streams[streamIndex_];
+  const AVCodecParameters* par = stream->codecpar;
+  track_.codec = CodecStringFromParameters(par);
+  if (track_.codec.empty()) {
+    *error = std::string("Unsupported codec in container: ") + avcodec_get_name(par->codec_id);
+    return false;
+  }
+  track_.width = par->width;
+  track_.height = par->height;
+  if (par->extradata && par->extradata_size > 0) {
+    track_.description.assign(par->extradata, par->extradata + par->extradata_size);
+  }
+
+  timeBase_ = stream->time_base;
+  if (stream->duration != AV_NOPTS_VALUE) {
+    track_.duration = av_rescale_q(stream->duration, timeBase_, kMicroseconds);
+  } else if (format_->duration != AV_NOPTS_VALUE) {
+    track_.duration = av_rescale_q(format_->duration, AV_TIME_BASE_Q, kMicroseconds);
+  }
+
+  return true;
+}
+
+bool NativeDemuxer::WaitForStart() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  startCondition_.wait(lock, [this] { return startRequested_ || stopping_; });
+  return !stopping_;
+}
+
+void NativeDemuxer::ReadPackets() {
+  AVPacket* packet = nullptr;
+  while (!stopping_) {
+    if (!packet) {
+      packet = av_packet_alloc();
+      if (!packet) {
+        PostError("Failed to allocate packet");
+        return;
+      }
+    }
+
+    int ret = av_read_frame(format_, packet);
+    if (ret == AVERROR_EOF) {
+      break;
+    }
+    if (ret < 0) {
+      av_packet_free(&packet);
+      if (!stopping_) {
+        PostError("Failed to read packet: " + AvErrorString(ret));
+      }
+      return;
+    }
+    if (packet->stream_index != streamIndex_) {
+      av_packet_unref(packet);
+      continue;
+    }
+
+    // Chunks carry presentation timestamps in microseconds, like WebCodecs.
+    int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+    int64_t timestamp = pts != AV_NOPTS_VALUE ? av_rescale_q(pts, timeBase_, kMicroseconds) : 0;
+    bool hasDuration = packet->duration > 0;
+    int64_t duration = hasDuration ? av_rescale_q(packet->duration, timeBase_, kMicroseconds) : 0;
+    packet->pts = timestamp;
+    packet->dts = AV_NOPTS_VALUE;
+    packet->duration = duration;
+
+    if (target_) {
+      if (!target_->EnqueuePacket(packet, duration, hasDuration)) {
+        PostError("Decoder is closed");
+        return;
+      }
+      packet = nullptr;
+      continue;
+    }
+
+    Event* event = new Event();
+    event->kind = Event::Kind::kChunk;
+    event->packet = packet;
+    event->timestamp = timestamp;
+    event->duration = duration;
+    event->hasDuration = hasDuration;
+    packet = nullptr;
+    Post(event);
+  }
+  av_packet_free(&packet);
+
+  if (!stopping_) {
+    Event* event = new Event();
+    event->kind = Event::Kind::kEnd;
+    Post(event);
+  }
+}
+
+void NativeDemuxer::CloseInput() {
+  avformat_close_input(&format_);
+  if (io_) {
+    av_freep(&io_->buffer);
+    avio_context_free(&io_);
+  }
+}
+
+void NativeDemuxer::Post(Event* event) {
+  napi_status status = tsfn_.BlockingCall(event,
+    [this](Napi::Env env, Napi::Function chunk, Event* ev) { DeliverEvent(env, chunk, ev); });
+  if (status != napi_ok) {
+    av_packet_free(&event->packet);
+    delete event;
+  }
+}
+
+void NativeDemuxer::PostError(const std::string& message) {
+  Event* event = new Event();
+  event->kind = Event::Kind::kError;
+  event->message = message;
+  Post(event);
+}
@@ -0,0 +1,107 @@
+/**
+ * NativeDemuxer
+ *
+ * Reads IVF, WebM/Matroska or MP4 through libavformat and yields the
+ * packets of the container's video track as chunks, either from a file
+ * path or from container bytes written as they arrive. Written MP4 input
+ * must have its moov box up front (faststart), since it cannot be seeked.
+ *
+ * Demuxing runs on its own thread. The track's decoder config is reported
+ * first; after start() chunks flow to JS, or with start(decoder) straight
+ * into a NativeVideoDecoder session without surfacing in JS at all.
+ */
+
+#ifndef WEBCODECS_NATIVE_DEMUXER_H_
+#define WEBCODECS_NATIVE_DEMUXER_H_
+
+#include <napi.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include "byte_stream.h"
+
+class NativeVideoDecoder;
+
+class NativeDemuxer : public Napi::ObjectWrap<NativeDemuxer> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeDemuxer(const Napi::CallbackInfo& info);
+  ~NativeDemuxer() override;
+
+ private:
+  // Demux thread -> JS notification, delivered through tsfn_.
+  struct Event {
+    enum class Kind { kConfig, kChunk, kEnd, kError };
+    Kind kind;
+    AVPacket* packet = nullptr;
+    int64_t timestamp = 0;
+    int64_t duration = 0;
+    bool hasDuration = false;
+    std::string message;
+  };
+
+  // Filled in by Open() before the kConfig event is posted.
+  struct Track {
+    std::string codec;
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> description;
+    int64_t duration = 0;  // Microseconds, 0 if unknown
+  };
+
+  // JS thread
+  Napi::Value Write(const Napi::CallbackInfo& info);
+  Napi::Value End(const Napi::CallbackInfo& info);
+  Napi::Value Start(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  void DeliverEvent(Napi::Env env, Napi::Function chunk, Event* event);
+  void SetActive(Napi::Env env, bool active);
+
+  // Demux thread
+  void Run();
+  bool Open(std::string* error);
+  bool WaitForStart();
+  void ReadPackets();
+  void CloseInput();
+  void Post(Event* event);
+  void PostError(const std::string& message);
+
+  std::string path_;
+  std::unique_ptr<ByteStream> stream_;  // Null when reading a file
+  AVFormatContext* format_ = nullptr;
+  AVIOContext* io_ = nullptr;
+  int streamIndex_ = -1;
+  AVRational timeBase_ = {1, 1000000};
+  Track track_;
+
+  // start() hands the demux thread its target; close() sets stopping_.
+  std::mutex mutex_;
+  std::condition_variable startCondition_;
+  bool startRequested_ = false;
+  NativeVideoDecoder* target_ = nullptr;
+  std::atomic<bool> stopping_{false};
+
+  std::thread thread_;
+  Napi::ThreadSafeFunction tsfn_;
+  Napi::FunctionReference configCallback_;
+  Napi::FunctionReference endCallback_;
+  Napi::FunctionReference errorCallback_;
+  Napi::ObjectReference targetRef_;  // Keeps the target decoder alive
+  bool active_ = true;  // Whether tsfn_ holds the event loop open
+  bool started_ = false;
+  bool finished_ = false;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_DEMUXER_H_
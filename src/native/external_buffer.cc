@@ -0,0 +1,70 @@
+/**
+ * External buffer implementation.
+ */
+
+#include "external_buffer.h"
+
+#include <utility>
+
+namespace {
+
+// Whether `size` bytes of `ref` are worth its allocation staying alive.
+bool WorthWrapping(const AVBufferRef* ref, size_t size) {
+  return size >= kMinExternalSize && ref->size - size <= size / kMaxExternalSlack;
+}
+
+// Wrap `data` in a Buffer that keeps `ref` alive, charging the whole
+// referenced allocation to V8. NewOrCopy runs the finalizer right away if
+// it has to copy, which undoes both.
+Napi::Buffer<uint8_t> WrapRef(Napi::Env env, AVBufferRef* ref, uint8_t* data, size_t size) {
+  Napi::MemoryManagement::AdjustExternalMemory(env, static_cast<int64_t>(ref->size));
+  return Napi::Buffer<uint8_t>::NewOrCopy(
+    env, data, size,
+    [](Napi::Env env, uint8_t*, AVBufferRef* hint) {
+      Napi::MemoryManagement::AdjustExternalMemory(env, -static_cast<int64_t>(hint->size));
+      av_buffer_unref(&hint);
+    },
+    ref);
+}
+
+}  // namespace
+
+Napi::Buffer<uint8_t> PacketToBuffer(Napi::Env env, AVPacket* packet) {
+  if (!packet->buf || !WorthWrapping(packet->buf, static_cast<size_t>(packet->size))) {
+    Napi::Buffer<uint8_t> copy = Napi::Buffer<uint8_t>::Copy(env, packet->data, packet->size);
+    av_packet_unref(packet);
+    return copy;
+  }
+
+  AVBufferRef* ref = packet->buf;
+  uint8_t* data = packet->data;
+  size_t size = static_cast<size_t>(packet->size);
+  packet->buf = nullptr;
+  av_packet_unref(packet);
+  return WrapRef(env, ref, data, size);
+}
+
+Napi::Buffer<uint8_t> BufferRefToBuffer(Napi::Env env, AVBufferRef* buffer,
+                                        uint8_t* data, size_t size) {
+  AVBufferRef* ref = WorthWrapping(buffer, size) ? av_buffer_ref(buffer) : nullptr;
+  if (!ref) {
+    return Napi::Buffer<uint8_t>::Copy(env, data, size);
+  }
+  return WrapRef(env, ref, data, size);
+}
+
+Napi::Buffer<uint8_t> VectorToBuffer(Napi::Env env, std::vector<uint8_t>&& bytes) {
+  if (bytes.size() < kMinExternalSize) {
+    return Napi::Buffer<uint8_t>::Copy(env, bytes.data(), bytes.size());
+  }
+
+  auto* owned = new std::vector<uint8_t>(std::move(bytes));
+  Napi::MemoryManagement::AdjustExternalMemory(env, static_cast<int64_t>(owned->capacity()));
+  return Napi::Buffer<uint8_t>::NewOrCopy(
+    env, owned->data(), owned->size(),
+    [](Napi::Env env, uint8_t*, std::vector<uint8_t>* hint) {
+      Napi::MemoryManagement::AdjustExternalMemory(env, -static_cast<int64_t>(hint->capacity()));
+      delete hint;
+    },
+    owned);
+}
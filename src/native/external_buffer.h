@@ -0,0 +1,50 @@
+/**
+ * External buffers
+ *
+ * Hand FFmpeg-owned memory to JS without copying it. Each Buffer holds its
+ * own reference to the underlying AVBufferRef (or vector), dropped by a
+ * finalizer when V8 collects the Buffer, and reports that memory to V8 so
+ * the GC accounts for it.
+ *
+ * Payloads under kMinExternalSize are copied: a memcpy of a few KB is
+ * cheaper than a finalizer. So is any payload on runtimes that forbid
+ * external buffers (Buffer::NewOrCopy falls back on its own), and any that
+ * fills less than 1 - 1/kMaxExternalSlack of its allocation: a pooled
+ * packet slot is sized for the largest frame, and a small chunk kept alive
+ * by JS would pin all of it and keep it out of the pool.
+ */
+
+#ifndef WEBCODECS_NATIVE_EXTERNAL_BUFFER_H_
+#define WEBCODECS_NATIVE_EXTERNAL_BUFFER_H_
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+constexpr size_t kMinExternalSize = 4096;
+constexpr size_t kMaxExternalSlack = 4;
+
+/**
+ * A Buffer over `packet`'s payload. Takes over the packet's data reference
+ * and unreferences the rest, leaving `packet` blank for reuse.
+ */
+Napi::Buffer<uint8_t> PacketToBuffer(Napi::Env env, AVPacket* packet);
+
+/**
+ * A Buffer over `size` bytes at `data`, which must lie inside `buffer`.
+ * Adds a reference to `buffer`; the caller keeps its own.
+ */
+Napi::Buffer<uint8_t> BufferRefToBuffer(Napi::Env env, AVBufferRef* buffer,
+                                        uint8_t* data, size_t size);
+
+/**
+ * A Buffer that takes over `bytes`' storage.
+ */
+Napi::Buffer<uint8_t> VectorToBuffer(Napi::Env env, std::vector<uint8_t>&& bytes);
+
+#endif  // WEBCODECS_NATIVE_EXTERNAL_BUFFER_H_
@@ -0,0 +1,23 @@
+/**
+ * Small FFmpeg helpers shared by the native codec classes.
+ */
+
+#ifndef WEBCODECS_NATIVE_FFMPEG_UTILS_H_
+#define WEBCODECS_NATIVE_FFMPEG_UTILS_H_
+
+#include <string>
+
+extern "C" {
+#include <libavutil/error.h>
+}
+
+/**
+ * Convert an FFmpeg error code into a human-readable message.
+ */
+inline std::string AvErrorString(int err) {
+  char errbuf[AV_ERROR_MAX_STRING_SIZE];
+  av_strerror(err, errbuf, sizeof(errbuf));
+  return std::string(errbuf);
+}
+
+#endif  // WEBCODECS_NATIVE_FFMPEG_UTILS_H_
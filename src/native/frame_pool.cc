@@ -0,0 +1,162 @@
+/**
+ * FramePool implementation.
+ */
+
+#include "frame_pool.h"
+
+#include <utility>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/macros.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include "ffmpeg_utils.h"
+
+namespace {
+
+// Row and buffer alignment, matching what av_frame_get_buffer() picks for
+// the widest SIMD kernels the encoders and swscale use.
+constexpr int kLineAlign = 64;
+
+// av_frame_get_buffer() rounds plane heights up to this, and some codecs
+// rely on reading the extra rows.
+constexpr int kHeightAlign = 32;
+
+// Idle AVFrame shells kept per pool; more than a session's queue depth
+// would only hold memory.
+constexpr size_t kMaxIdleShells = 16;
+
+}  // namespace
+
+FramePool::FramePool(AVPixelFormat format, int width, int height, std::shared_ptr<PoolBudget> budget)
+    : type_(AVMEDIA_TYPE_VIDEO), format_(format), width_(width), height_(height) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+  if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL)) ||
+      av_image_check_size(width, height) < 0 ||
+      av_image_fill_linesizes(linesize_, format, width) < 0) {
+    return;
+  }
+  for (int& linesize : linesize_) {
+    linesize = FFALIGN(linesize, kLineAlign);
+  }
+
+  uint8_t* data[4];
+  int size = av_image_fill_pointers(data, format, FFALIGN(height, kHeightAlign), nullptr, linesize_);
+  if (size < 0) {
+    return;
+  }
+  // Same tail padding as av_frame_get_buffer(), for SIMD over-reads
+  buffers_ = std::make_unique<BufferPool>(size + 16 + kLineAlign - 1, std::move(budget));
+}
+
+FramePool::FramePool(AVSampleFormat format, int sampleRate, const AVChannelLayout& layout,
+                     int samples, std::shared_ptr<PoolBudget> budget)
+    : type_(AVMEDIA_TYPE_AUDIO), format_(format), sampleRate_(sampleRate), samples_(samples) {
+  if (av_channel_layout_copy(&layout_, &layout) < 0) {
+    return;
+  }
+  int channels = layout_.nb_channels;
+  // Beyond AV_NUM_DATA_POINTERS planes the frame needs a separately
+  // allocated extended_data array; leave those to av_frame_get_buffer().
+  if (av_sample_fmt_is_planar(format) && channels > AV_NUM_DATA_POINTERS) {
+    return;
+  }
+  int size = av_samples_get_buffer_size(&linesize_[0], channels, samples, format, 0);
+  if (size < 0) {
+    return;
+  }
+  buffers_ = std::make_unique<BufferPool>(size, std::move(budget));
+}
+
+FramePool::~FramePool() {
+  for (AVFrame* shell : shells_) {
+    av_frame_free(&shell);
+  }
+  av_channel_layout_uninit(&layout_);
+}
+
+bool FramePool::Matches(AVPixelFormat format, int width, int height) const {
+  return type_ == AVMEDIA_TYPE_VIDEO && format_ == format && width_ == width && height_ == height;
+}
+
+AVFrame* FramePool::TakeShell() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!shells_.empty()) {
+      AVFrame* shell = shells_.back();
+      shells_.pop_back();
+      return shell;
+    }
+  }
+  return av_frame_alloc();
+}
+
+AVFrame* FramePool::Acquire(std::string* error) {
+  AVFrame* frame = TakeShell();
+  if (!frame) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+
+  frame->format = format_;
+  if (type_ == AVMEDIA_TYPE_VIDEO) {
+    frame->width = width_;
+    frame->height = height_;
+  } else {
+    frame->sample_rate = sampleRate_;
+    frame->nb_samples = samples_;
+    if (av_channel_layout_copy(&frame->ch_layout, &layout_) < 0) {
+      Release(frame);
+      *error = "Failed to copy channel layout";
+      return nullptr;
+    }
+  }
+
+  if (!buffers_) {
+    int ret = av_frame_get_buffer(frame, 0);
+    if (ret < 0) {
+      Release(frame);
+      *error = "Failed to allocate frame buffer: " + AvErrorString(ret);
+      return nullptr;
+    }
+    return frame;
+  }
+
+  frame->buf[0] = buffers_->Get();
+  if (!frame->buf[0]) {
+    Release(frame);
+    *error = "Failed to allocate frame buffer";
+    return nullptr;
+  }
+  if (type_ == AVMEDIA_TYPE_VIDEO) {
+    uint8_t* base = reinterpret_cast<uint8_t*>(
+        FFALIGN(reinterpret_cast<uintptr_t>(frame->buf[0]->data), kLineAlign));
+    av_image_fill_pointers(frame->data, static_cast<AVPixelFormat>(format_),
+                           FFALIGN(height_, kHeightAlign), base, linesize_);
+    for (int i = 0; i < 4; i++) {
+      frame->linesize[i] = linesize_[i];
+    }
+  } else {
+    av_samples_fill_arrays(frame->data, &frame->linesize[0], frame->buf[0]->data,
+                           layout_.nb_channels, samples_, static_cast<AVSampleFormat>(format_), 0);
+  }
+  frame->extended_data = frame->data;
+  return frame;
+}
+
+void FramePool::Release(AVFrame* frame) {
+  if (!frame) {
+    return;
+  }
+  av_frame_unref(frame);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shells_.size() < kMaxIdleShells) {
+      shells_.push_back(frame);
+      return;
+    }
+  }
+  av_frame_free(&frame);
+}
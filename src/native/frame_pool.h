@@ -0,0 +1,70 @@
+/**
+ * FramePool
+ *
+ * Hands out writable AVFrames of one fixed shape (a pixel format and size,
+ * or a sample format, rate, layout and sample count) backed by a
+ * BufferPool, replacing av_frame_alloc() + av_frame_get_buffer() on
+ * per-frame paths. Frames given back through Release() also keep their
+ * AVFrame shell for the next Acquire().
+ *
+ * Frames are ordinary refcounted AVFrames: they can be passed to
+ * avcodec_send_frame(), referenced, or freed with av_frame_free(). Release()
+ * accepts any frame, pooled or not. Acquire() and Release() may be called
+ * from any thread.
+ */
+
+#ifndef WEBCODECS_NATIVE_FRAME_POOL_H_
+#define WEBCODECS_NATIVE_FRAME_POOL_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libavutil/samplefmt.h>
+}
+
+#include "buffer_pool.h"
+
+class FramePool {
+ public:
+  FramePool(AVPixelFormat format, int width, int height, std::shared_ptr<PoolBudget> budget);
+  FramePool(AVSampleFormat format, int sampleRate, const AVChannelLayout& layout, int samples,
+            std::shared_ptr<PoolBudget> budget);
+  ~FramePool();
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  bool Matches(AVPixelFormat format, int width, int height) const;
+
+  // A writable frame of the pool's shape, or nullptr with `error` set.
+  AVFrame* Acquire(std::string* error);
+
+  // Unreference `frame` and keep its shell. Null is ignored.
+  void Release(AVFrame* frame);
+
+ private:
+  AVFrame* TakeShell();
+
+  AVMediaType type_;
+  int format_;
+  int width_ = 0;
+  int height_ = 0;
+  int sampleRate_ = 0;
+  int samples_ = 0;
+  AVChannelLayout layout_ = {};
+  int linesize_[4] = {0, 0, 0, 0};
+
+  // Null if the shape cannot be laid out in one buffer; Acquire() then
+  // falls back to av_frame_get_buffer().
+  std::unique_ptr<BufferPool> buffers_;
+
+  std::mutex mutex_;
+  std::vector<AVFrame*> shells_;
+};
+
+#endif  // WEBCODECS_NATIVE_FRAME_POOL_H_
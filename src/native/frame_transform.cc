@@ -0,0 +1,151 @@
+/**
+ * FrameTransform implementation.
+ */
+
+#include "frame_transform.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "frame_pool.h"
+#include "pixel_convert.h"
+
+namespace {
+
+AVFrame* AllocFrame(AVPixelFormat format, int width, int height, FramePool* pool, std::string* error) {
+  if (pool && pool->Matches(format, width, height)) {
+    return pool->Acquire(error);
+  }
+  AVFrame* frame = av_frame_alloc();
+  if (!frame) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+  frame->format = format;
+  frame->width = width;
+  frame->height = height;
+  if (av_frame_get_buffer(frame, 0) < 0) {
+    av_frame_free(&frame);
+    *error = "Failed to allocate frame buffer";
+  }
+  return frame;
+}
+
+// Destination tile edge: a 64x64 block of source rows stays in L1 while
+// the quarter turns write it out row by row
+constexpr int kRotateTile = 64;
+
+/**
+ * Fill the width x height `dst` with dst(x, y) = origin[x * xStep + y * yStep],
+ * one tile at a time so strided source reads hit lines already cached.
+ */
+void CopyStepped(const uint8_t* origin, ptrdiff_t xStep, ptrdiff_t yStep,
+                 uint8_t* dst, int dstStride, int width, int height) {
+  for (int ty = 0; ty < height; ty += kRotateTile) {
+    int yEnd = std::min(ty + kRotateTile, height);
+    for (int tx = 0; tx < width; tx += kRotateTile) {
+      int xEnd = std::min(tx + kRotateTile, width);
+      for (int y = ty; y < yEnd; y++) {
+        const uint8_t* in = origin + y * yStep;
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+        for (int x = tx; x < xEnd; x++) {
+          out[x] = in[x * xStep];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Write `src` turned clockwise by `rotation` into the width x height `dst`.
+ * The source is height x width for a quarter turn and width x height
+ * otherwise, so every index is in bounds.
+ */
+void RotatePlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                 int width, int height, int rotation) {
+  ptrdiff_t stride = srcStride;
+  switch (rotation) {
+    case 90:
+      CopyStepped(src + (width - 1) * stride, -stride, 1, dst, dstStride, width, height);
+      break;
+    case 180:
+      CopyStepped(src + (height - 1) * stride + width - 1, -1, -stride, dst, dstStride, width, height);
+      break;
+    default:  // 270
+      CopyStepped(src + height - 1, stride, -1, dst, dstStride, width, height);
+      break;
+  }
+}
+
+// Both frames are yuv420p, `src` already sized for the turn.
+void RotateI420(const AVFrame* src, AVFrame* dst, int rotation) {
+  for (int i = 0; i < 3; i++) {
+    int shift = i == 0 ? 0 : 1;
+    RotatePlane(src->data[i], src->linesize[i], dst->data[i], dst->linesize[i],
+                (dst->width + shift) >> shift, (dst->height + shift) >> shift, rotation);
+  }
+}
+
+}  // namespace
+
+AVFrame* TransformFrame(const AVFrame* source, const FrameTransform& transform,
+                        AVPixelFormat format, int width, int height,
+                        FramePool* pool, std::string* error) {
+  AVPixelFormat sourceFormat = static_cast<AVPixelFormat>(source->format);
+  int x = 0;
+  int y = 0;
+  int regionWidth = source->width;
+  int regionHeight = source->height;
+  if (transform.crop) {
+    if (transform.cropX < 0 || transform.cropY < 0 || transform.cropWidth <= 0 || transform.cropHeight <= 0 ||
+        transform.cropX + transform.cropWidth > source->width ||
+        transform.cropY + transform.cropHeight > source->height) {
+      *error = "crop is outside the frame";
+      return nullptr;
+    }
+    x = transform.cropX;
+    y = transform.cropY;
+    regionWidth = transform.cropWidth;
+    regionHeight = transform.cropHeight;
+  }
+  const uint8_t* planes[4];
+  if (!CropPlanes(source->data, source->linesize, sourceFormat, x, y, planes, error)) {
+    return nullptr;
+  }
+
+  AVFrame* output = AllocFrame(format, width, height, pool, error);
+  if (!output) {
+    return nullptr;
+  }
+  if (transform.rotation == 0) {
+    if (!ScaleImage(planes, source->linesize, sourceFormat, regionWidth, regionHeight,
+                    output->data, output->linesize, format, width, height, error)) {
+      av_frame_free(&output);
+    }
+    return output;
+  }
+
+  // Scale to the size before turning, then rotate into I420
+  bool quarter = transform.rotation == 90 || transform.rotation == 270;
+  AVFrame* scaled = AllocFrame(AV_PIX_FMT_YUV420P, quarter ? height : width, quarter ? width : height,
+                               nullptr, error);
+  AVFrame* rotated = format == AV_PIX_FMT_YUV420P ? output : AllocFrame(AV_PIX_FMT_YUV420P, width, height, nullptr, error);
+  bool ok = scaled && rotated &&
+            ScaleImage(planes, source->linesize, sourceFormat, regionWidth, regionHeight,
+                       scaled->data, scaled->linesize, AV_PIX_FMT_YUV420P, scaled->width, scaled->height, error);
+  if (ok) {
+    RotateI420(scaled, rotated, transform.rotation);
+    if (rotated != output) {
+      ok = ConvertImage(rotated->data, rotated->linesize, AV_PIX_FMT_YUV420P,
+                        output->data, output->linesize, format, width, height, error);
+    }
+  }
+  if (rotated != output) {
+    av_frame_free(&rotated);
+  }
+  av_frame_free(&scaled);
+  if (!ok) {
+    av_frame_free(&output);
+  }
+  return output;
+}
@@ -0,0 +1,43 @@
+/**
+ * FrameTransform
+ *
+ * The per-rendition stage between a decoded picture and an encoder in a
+ * NativeVideoPipeline: crop, rotate by a multiple of 90 degrees, scale to
+ * the encoder's size and convert to its pixel format.
+ *
+ * Without rotation all of it is one sws_scale() pass reading the cropped
+ * planes in place. Rotation scales into I420 first and then turns the
+ * planes, since swscale cannot rotate.
+ */
+
+#ifndef WEBCODECS_NATIVE_FRAME_TRANSFORM_H_
+#define WEBCODECS_NATIVE_FRAME_TRANSFORM_H_
+
+#include <string>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+class FramePool;
+
+struct FrameTransform {
+  bool crop = false;  // Use only the crop rectangle of the source
+  int cropX = 0;
+  int cropY = 0;
+  int cropWidth = 0;
+  int cropHeight = 0;
+  int rotation = 0;  // Clockwise degrees: 0, 90, 180 or 270
+};
+
+/**
+ * Apply `transform` to a system-memory `source`, producing a new
+ * width x height frame of `format`, taken from `pool` when it has that
+ * shape. Returns nullptr and fills `error` on failure.
+ */
+AVFrame* TransformFrame(const AVFrame* source, const FrameTransform& transform,
+                        AVPixelFormat format, int width, int height,
+                        FramePool* pool, std::string* error);
+
+#endif  // WEBCODECS_NATIVE_FRAME_TRANSFORM_H_
@@ -0,0 +1,133 @@
+/**
+ * Hardware device support implementation.
+ */
+
+#include "hw_device.h"
+
+#include <map>
+#include <mutex>
+
+#include "ffmpeg_utils.h"
+
+bool ParseHardwarePreference(const std::string& value, HardwarePreference* preference) {
+  if (value == "no-preference") {
+    *preference = HardwarePreference::kNoPreference;
+  } else if (value == "prefer-hardware") {
+    *preference = HardwarePreference::kPreferHardware;
+  } else if (value == "prefer-software") {
+    *preference = HardwarePreference::kPreferSoftware;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const std::vector<AVHWDeviceType>& PlatformDeviceTypes() {
+  static const std::vector<AVHWDeviceType> types = {
+#if defined(__APPLE__)
+    AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#elif defined(_WIN32)
+    AV_HWDEVICE_TYPE_CUDA,
+    AV_HWDEVICE_TYPE_D3D11VA,
+    AV_HWDEVICE_TYPE_QSV,
+#else
+    AV_HWDEVICE_TYPE_CUDA,
+    AV_HWDEVICE_TYPE_VAAPI,
+    AV_HWDEVICE_TYPE_QSV,
+#endif
+  };
+  return types;
+}
+
+AVBufferRef* AcquireHwDevice(AVHWDeviceType type) {
+  // Intentionally leaked, like ScalerCache::Shared(): frames still in use at
+  // exit may reference the devices.
+  static std::mutex* mutex = new std::mutex();
+  static std::map<AVHWDeviceType, AVBufferRef*>* devices = new std::map<AVHWDeviceType, AVBufferRef*>();
+
+  std::lock_guard<std::mutex> lock(*mutex);
+  auto it = devices->find(type);
+  if (it == devices->end()) {
+    AVBufferRef* device = nullptr;
+    if (av_hwdevice_ctx_create(&device, type, nullptr, nullptr, 0) < 0) {
+      device = nullptr;
+    }
+    it = devices->emplace(type, device).first;
+  }
+  return it->second ? av_buffer_ref(it->second) : nullptr;
+}
+
+AVPixelFormat SoftwareFormat(const AVFrame* frame) {
+  if (frame->hw_frames_ctx) {
+    return reinterpret_cast<AVHWFramesContext*>(frame->hw_frames_ctx->data)->sw_format;
+  }
+  return static_cast<AVPixelFormat>(frame->format);
+}
+
+AVFrame* DownloadFrame(const AVFrame* frame, std::string* error) {
+  AVFrame* downloaded = av_frame_alloc();
+  if (!downloaded) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+  int ret = av_hwframe_transfer_data(downloaded, frame, 0);
+  if (ret >= 0) {
+    ret = av_frame_copy_props(downloaded, frame);
+  }
+  if (ret < 0) {
+    av_frame_free(&downloaded);
+    *error = "Failed to download hardware frame: " + AvErrorString(ret);
+    return nullptr;
+  }
+  return downloaded;
+}
+
+AVFrame* UploadFrame(AVBufferRef* framesCtx, const AVFrame* frame, std::string* error) {
+  AVFrame* uploaded = av_frame_alloc();
+  if (!uploaded) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+  int ret = av_hwframe_get_buffer(framesCtx, uploaded, 0);
+  if (ret >= 0) {
+    ret = av_hwframe_transfer_data(uploaded, frame, 0);
+  }
+  if (ret >= 0) {
+    ret = av_frame_copy_props(uploaded, frame);
+  }
+  if (ret < 0) {
+    av_frame_free(&uploaded);
+    *error = "Failed to upload frame to hardware: " + AvErrorString(ret);
+    return nullptr;
+  }
+  return uploaded;
+}
+
+AVFrame* MapFrame(AVBufferRef* framesCtx, const AVFrame* frame) {
+  const AVHWFramesContext* source = reinterpret_cast<AVHWFramesContext*>(frame->hw_frames_ctx->data);
+  const AVHWFramesContext* target = reinterpret_cast<AVHWFramesContext*>(framesCtx->data);
+  if (frame->width != target->width || frame->height != target->height ||
+      source->sw_format != target->sw_format) {
+    return nullptr;
+  }
+  AVFrame* mapped = av_frame_alloc();
+  if (!mapped) {
+    return nullptr;
+  }
+  int ret;
+  if (source->device_ref->data == target->device_ref->data && frame->format == target->format) {
+    ret = av_frame_ref(mapped, frame);
+  } else {
+    mapped->format = target->format;
+    mapped->hw_frames_ctx = av_buffer_ref(framesCtx);
+    ret = mapped->hw_frames_ctx ? av_hwframe_map(mapped, frame, AV_HWFRAME_MAP_READ) : AVERROR(ENOMEM);
+    if (ret >= 0) {
+      ret = av_frame_copy_props(mapped, frame);
+    }
+  }
+  if (ret < 0) {
+    av_frame_free(&mapped);
+    return nullptr;
+  }
+  return mapped;
+}
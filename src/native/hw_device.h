@@ -0,0 +1,68 @@
+/**
+ * Hardware device support.
+ *
+ * Device contexts (CUDA, VA-API, VideoToolbox, ...) are expensive to create,
+ * so one per device type is opened lazily and shared by every session.
+ * Decoded hardware frames stay in GPU memory; DownloadFrame() is only
+ * called when their pixels are actually read (copyTo(), software encode).
+ * Hardware encoders take them through MapFrame() instead.
+ */
+
+#ifndef WEBCODECS_NATIVE_HW_DEVICE_H_
+#define WEBCODECS_NATIVE_HW_DEVICE_H_
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixfmt.h>
+}
+
+// WebCodecs `hardwareAcceleration`.
+enum class HardwarePreference { kNoPreference, kPreferHardware, kPreferSoftware };
+
+/**
+ * Parse 'no-preference' | 'prefer-hardware' | 'prefer-software'.
+ */
+bool ParseHardwarePreference(const std::string& value, HardwarePreference* preference);
+
+/**
+ * Device types worth trying on this platform, best first.
+ */
+const std::vector<AVHWDeviceType>& PlatformDeviceTypes();
+
+/**
+ * A new reference to the shared device context of `type`, or nullptr if the
+ * device cannot be opened. Failures are remembered so absent hardware is
+ * only probed once per process.
+ */
+AVBufferRef* AcquireHwDevice(AVHWDeviceType type);
+
+/**
+ * The format the pixels are in: sw_format for hardware frames.
+ */
+AVPixelFormat SoftwareFormat(const AVFrame* frame);
+
+/**
+ * Copy a hardware frame into a new system-memory frame with the same props.
+ */
+AVFrame* DownloadFrame(const AVFrame* frame, std::string* error);
+
+/**
+ * Copy a system-memory frame into a new surface from `framesCtx`.
+ */
+AVFrame* UploadFrame(AVBufferRef* framesCtx, const AVFrame* frame, std::string* error);
+
+/**
+ * A hardware frame as a surface of `framesCtx`, without leaving the GPU: a
+ * new reference when it comes from the same device in the same formats, or
+ * an av_hwframe_map() mapping from another device (VA-API into QSV, ...).
+ * nullptr if the size or software format differ or the mapping fails; the
+ * caller then goes through system memory.
+ */
+AVFrame* MapFrame(AVBufferRef* framesCtx, const AVFrame* frame);
+
+#endif  // WEBCODECS_NATIVE_HW_DEVICE_H_
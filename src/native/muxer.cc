@@ -0,0 +1,330 @@
+/**
+ * NativeMuxer implementation.
+ *
+ * new NativeMuxer({ format, path?, fd? }, { data(chunk: Buffer) }?)
+ *   finish(done?: () => void)
+ *   close()
+ * encoder.setMuxer(muxer)   (NativeVideoEncoder)
+ *
+ * format is 'webm', 'matroska' (or 'mkv'), 'mp4' or 'ivf'. Output goes to
+ * `path`, to `fd` (left open for the caller), or else to data().
+ * finish() writes the trailer once the encoder has been flushed; done runs
+ * after the last data() call (right away for a path or fd). close() drops
+ * the output without a trailer.
+ */
+
+#include "muxer.h"
+
+#include <cstring>
+#include <utility>
+
+extern "C" {
+#include <libavutil/dict.h>
+#include <libavutil/mem.h>
+}
+
+#include "addon_data.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+
+namespace {
+
+// AVIO buffer for output bound for JS: each data() call carries up to this much.
+constexpr int kIoBufferSize = 256 * 1024;
+
+constexpr AVRational kMicroseconds = {1, 1000000};
+
+}  // namespace
+
+Napi::Object NativeMuxer::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeMuxer", {
+    InstanceMethod("finish", &NativeMuxer::Finish),
+    InstanceMethod("close", &NativeMuxer::Close),
+  });
+
+  AddonData::Get(env)->muxer = Napi::Persistent(func);
+
+  exports.Set("NativeMuxer", func);
+  return exports;
+}
+
+NativeMuxer* NativeMuxer::FromValue(Napi::Value value) {
+  if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(AddonData::Get(value.Env())->muxer.Value())) {
+    return nullptr;
+  }
+  return Unwrap(value.As<Napi::Object>());
+}
+
+NativeMuxer::NativeMuxer(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeMuxer>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject() || !info[0].As<Napi::Object>().Get("format").IsString()) {
+    Napi::TypeError::New(env, "Expected ({format, path?, fd?}, {data}?)").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object target = info[0].As<Napi::Object>();
+  std::string format = target.Get("format").As<Napi::String>().Utf8Value();
+  if (format == "mkv") {
+    format = "matroska";
+  }
+  if (format != "webm" && format != "matroska" && format != "mp4" && format != "ivf") {
+    Napi::TypeError::New(env, "Unsupported container format: " + format).ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Value data = (info.Length() >= 2 && info[1].IsObject())
+    ? info[1].As<Napi::Object>().Get("data")
+    : env.Undefined();
+  std::string url;
+  if (target.Get("path").IsString()) {
+    url = target.Get("path").As<Napi::String>().Utf8Value();
+  } else if (target.Get("fd").IsNumber()) {
+    url = "pipe:" + std::to_string(target.Get("fd").As<Napi::Number>().Int32Value());
+  } else if (!data.IsFunction()) {
+    Napi::TypeError::New(env, "Muxer output requires a path, an fd or a data callback").ThrowAsJavaScriptException();
+    return;
+  }
+
+  int ret = avformat_alloc_output_context2(&format_, nullptr, format.c_str(), nullptr);
+  if (ret < 0 || !format_) {
+    Napi::Error::New(env, "Failed to create muxer: " + AvErrorString(ret)).ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (!url.empty()) {
+    ret = avio_open(&format_->pb, url.c_str(), AVIO_FLAG_WRITE);
+    if (ret < 0) {
+      FreeContext();
+      Napi::Error::New(env, "Failed to open output: " + AvErrorString(ret)).ThrowAsJavaScriptException();
+      return;
+    }
+  } else {
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kIoBufferSize));
+    io_ = buffer ? avio_alloc_context(buffer, kIoBufferSize, 1, this, nullptr, WriteData, nullptr) : nullptr;
+    if (!io_) {
+      av_free(buffer);
+      FreeContext();
+      Napi::Error::New(env, "Failed to allocate muxer output").ThrowAsJavaScriptException();
+      return;
+    }
+    format_->pb = io_;
+  }
+
+  stream_ = avformat_new_stream(format_, nullptr);
+  if (!stream_) {
+    FreeContext();
+    Napi::Error::New(env, "Failed to create muxer track").ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (io_) {
+    // Same lifetime scheme as the codec sessions: self-referenced until the
+    // TSFN finalizer runs; the event loop is only held by a pending finish().
+    Ref();
+    tsfn_ = Napi::ThreadSafeFunction::New(env, data.As<Napi::Function>(), "NativeMuxer", 0, 1,
+                                          [this](Napi::Env) { Unref(); });
+    tsfn_.Unref(env);
+  }
+}
+
+NativeMuxer::~NativeMuxer() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FreeContext();
+}
+
+bool NativeMuxer::AttachTrack(std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (finished_ || !format_) {
+    *error = "Muxer is finished";
+    return false;
+  }
+  if (attached_) {
+    *error = "Muxer already has an encoder attached";
+    return false;
+  }
+  attached_ = true;
+  return true;
+}
+
+bool NativeMuxer::WritePacket(const AVCodecContext* codec, AVPacket* packet, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (finished_ || !format_) {
+    *error = "Muxer is finished";
+    return false;
+  }
+  if (!headerWritten_ && !WriteHeader(codec, error)) {
+    return false;
+  }
+
+  packet->stream_index = stream_->index;
+  av_packet_rescale_ts(packet, kMicroseconds, stream_->time_base);
+  int ret = av_write_frame(format_, packet);
+  if (ret < 0) {
+    *error = "Failed to write packet: " + AvErrorString(ret);
+    return false;
+  }
+  return true;
+}
+
+// Called with mutex_ held.
+bool NativeMuxer::WriteHeader(const AVCodecContext* codec, std::string* error) {
+  int ret = avcodec_parameters_from_context(stream_->codecpar, codec);
+  if (ret < 0) {
+    *error = "Failed to copy codec parameters: " + AvErrorString(ret);
+    return false;
+  }
+  // A hint; the muxer settles on its own time base (1/1000 for WebM).
+  stream_->time_base = kMicroseconds;
+
+  AVDictionary* options = nullptr;
+  if (!(format_->pb->seekable & AVIO_SEEKABLE_NORMAL) && strcmp(format_->oformat->name, "mp4") == 0) {
+    av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+  }
+  ret = avformat_write_header(format_, &options);
+  av_dict_free(&options);
+  if (ret < 0) {
+    *error = "Failed to write header: " + AvErrorString(ret);
+    return false;
+  }
+  headerWritten_ = true;
+  return true;
+}
+
+// Called with mutex_ held, or from the constructor and destructor.
+void NativeMuxer::FreeContext() {
+  if (!format_) {
+    return;
+  }
+  if (io_) {
+    av_freep(&io_->buffer);
+    avio_context_free(&io_);
+    format_->pb = nullptr;
+  } else {
+    avio_closep(&format_->pb);
+  }
+  avformat_free_context(format_);
+  format_ = nullptr;
+  stream_ = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// JS thread
+// ---------------------------------------------------------------------------
+
+/**
+ * Write the trailer and close the output. Encoders attached to the muxer
+ * should be flushed first; packets arriving later fail with an error.
+ */
+Napi::Value NativeMuxer::Finish(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Muxer is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  int ret = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+      Napi::Error::New(env, "Muxer is already finished").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    finished_ = true;
+    if (headerWritten_) {
+      ret = av_write_trailer(format_);
+    }
+    // Push what is left in the AVIO buffer through WriteData()
+    avio_flush(format_->pb);
+    FreeContext();
+  }
+
+  Napi::Function done = (info.Length() >= 1 && info[0].IsFunction())
+    ? info[0].As<Napi::Function>()
+    : Napi::Function();
+  if (tsfn_) {
+    // Runs after the data() calls queued ahead of it
+    if (!done.IsEmpty()) {
+      finishCallback_ = Napi::Persistent(done);
+    }
+    tsfn_.Ref(env);
+    Event* event = new Event();
+    event->kind = Event::Kind::kFinished;
+    Post(event);
+  }
+
+  if (ret < 0) {
+    Napi::Error::New(env, "Failed to write trailer: " + AvErrorString(ret)).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!tsfn_ && !done.IsEmpty()) {
+    done.Call({});
+  }
+  return env.Undefined();
+}
+
+void NativeMuxer::Close(const Napi::CallbackInfo& info) {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+
+  bool finishing;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finishing = finished_;
+    finished_ = true;
+    FreeContext();
+  }
+  // A finish() in progress releases tsfn_ once its event arrives.
+  if (tsfn_ && !finishing) {
+    tsfn_.Release();
+  }
+}
+
+void NativeMuxer::DeliverEvent(Napi::Env env, Napi::Function data, Event* event) {
+  switch (event->kind) {
+    case Event::Kind::kData:
+      if (!closed_) {
+        data.Call({VectorToBuffer(env, std::move(event->data))});
+      }
+      break;
+    case Event::Kind::kFinished: {
+      Napi::FunctionReference done = std::move(finishCallback_);
+      tsfn_.Release();
+      if (!closed_ && !done.IsEmpty()) {
+        done.Call({});
+      }
+      break;
+    }
+  }
+  delete event;
+}
+
+void NativeMuxer::Post(Event* event) {
+  // The queue is unbounded, so this never blocks, even on the JS thread.
+  napi_status status = tsfn_.BlockingCall(event,
+    [this](Napi::Env env, Napi::Function data, Event* ev) { DeliverEvent(env, data, ev); });
+  if (status != napi_ok) {
+    delete event;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Any thread, with mutex_ held
+// ---------------------------------------------------------------------------
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+int NativeMuxer::WriteData(void* opaque, const uint8_t* buf, int size) {
+#else
+int NativeMuxer::WriteData(void* opaque, uint8_t* buf, int size) {
+#endif
+  NativeMuxer* self = static_cast<NativeMuxer*>(opaque);
+  Event* event = new Event();
+  event->kind = Event::Kind::kData;
+  event->data.assign(buf, buf + size);
+  self->Post(event);
+  return size;
+}
@@ -0,0 +1,89 @@
+/**
+ * NativeMuxer
+ *
+ * Writes one encoded video track to WebM, Matroska, MP4 or IVF through
+ * libavformat. Output goes to a file path, an open file descriptor, or JS
+ * as Buffers; writes are batched through an AVIO buffer either way.
+ *
+ * A NativeVideoEncoder attached with setMuxer() hands its packets to
+ * WritePacket() on its worker thread, so they never surface in JS. The
+ * header is written with the first packet, from the encoder's codec
+ * parameters. Output that cannot be seeked (a pipe, JS) gets fragmented
+ * MP4, since the moov box cannot be patched in afterwards.
+ */
+
+#ifndef WEBCODECS_NATIVE_MUXER_H_
+#define WEBCODECS_NATIVE_MUXER_H_
+
+#include <napi.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+class NativeMuxer : public Napi::ObjectWrap<NativeMuxer> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeMuxer(const Napi::CallbackInfo& info);
+  ~NativeMuxer() override;
+
+  /**
+   * The muxer behind `value` if it is a NativeMuxer, else nullptr.
+   */
+  static NativeMuxer* FromValue(Napi::Value value);
+
+  /**
+   * Claim the muxer's track for an encoder. JS thread; fails if another
+   * encoder has it or the muxer is finished.
+   */
+  bool AttachTrack(std::string* error);
+
+  /**
+   * Write a packet from `codec`, with pts, dts and duration in
+   * microseconds. Any thread; the packet is left for the caller to unref.
+   */
+  bool WritePacket(const AVCodecContext* codec, AVPacket* packet, std::string* error);
+
+ private:
+  // Output bound for JS, or the end of it, delivered through tsfn_.
+  struct Event {
+    enum class Kind { kData, kFinished };
+    Kind kind;
+    std::vector<uint8_t> data;
+  };
+
+  // JS thread
+  Napi::Value Finish(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  void DeliverEvent(Napi::Env env, Napi::Function data, Event* event);
+
+  bool WriteHeader(const AVCodecContext* codec, std::string* error);
+  void FreeContext();
+  void Post(Event* event);
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+  static int WriteData(void* opaque, const uint8_t* buf, int size);
+#else
+  static int WriteData(void* opaque, uint8_t* buf, int size);
+#endif
+
+  // Guards everything the encoder worker touches.
+  std::mutex mutex_;
+  AVFormatContext* format_ = nullptr;
+  AVStream* stream_ = nullptr;
+  AVIOContext* io_ = nullptr;  // Set when writing to JS
+  bool attached_ = false;
+  bool headerWritten_ = false;
+  bool finished_ = false;
+
+  Napi::ThreadSafeFunction tsfn_;  // Only when writing to JS
+  Napi::FunctionReference finishCallback_;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_MUXER_H_
@@ -0,0 +1,101 @@
+/**
+ * PacketPool implementation.
+ */
+
+#include "packet_pool.h"
+
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Idle AVPacket shells kept per pool; enough for a full command queue of
+// in-flight packets.
+constexpr size_t kMaxIdleShells = 64;
+
+}  // namespace
+
+PacketPool::PacketPool(size_t bufferSize, std::shared_ptr<PoolBudget> budget)
+    : buffers_(bufferSize, std::move(budget)) {}
+
+PacketPool::~PacketPool() {
+  for (AVPacket* shell : shells_) {
+    av_packet_free(&shell);
+  }
+}
+
+AVPacket* PacketPool::Acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!shells_.empty()) {
+      AVPacket* shell = shells_.back();
+      shells_.pop_back();
+      return shell;
+    }
+  }
+  return av_packet_alloc();
+}
+
+AVPacket* PacketPool::Acquire(int size) {
+  AVPacket* packet = Acquire();
+  if (!packet) {
+    return nullptr;
+  }
+  packet->buf = GetBuffer(size);
+  if (!packet->buf) {
+    Release(packet);
+    return nullptr;
+  }
+  packet->data = packet->buf->data;
+  packet->size = size;
+  memset(packet->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+  return packet;
+}
+
+void PacketPool::Release(AVPacket* packet) {
+  if (!packet) {
+    return;
+  }
+  av_packet_unref(packet);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shells_.size() < kMaxIdleShells) {
+      shells_.push_back(packet);
+      return;
+    }
+  }
+  av_packet_free(&packet);
+}
+
+void PacketPool::Attach(AVCodecContext* ctx) {
+  if (ctx->codec && (ctx->codec->capabilities & AV_CODEC_CAP_DR1)) {
+    ctx->opaque = this;
+    ctx->get_encode_buffer = GetEncodeBuffer;
+  }
+}
+
+AVBufferRef* PacketPool::GetBuffer(int size) {
+  if (size < 0) {
+    return nullptr;
+  }
+  size_t needed = static_cast<size_t>(size) + AV_INPUT_BUFFER_PADDING_SIZE;
+  if (needed > buffers_.bufferSize()) {
+    return av_buffer_alloc(needed);
+  }
+  return buffers_.Get();
+}
+
+int PacketPool::GetEncodeBuffer(AVCodecContext* ctx, AVPacket* packet, int flags) {
+  PacketPool* pool = static_cast<PacketPool*>(ctx->opaque);
+  size_t needed = static_cast<size_t>(packet->size) + AV_INPUT_BUFFER_PADDING_SIZE;
+  if (needed > pool->buffers_.bufferSize()) {
+    return avcodec_default_get_encode_buffer(ctx, packet, flags);
+  }
+  packet->buf = pool->buffers_.Get();
+  if (!packet->buf) {
+    return AVERROR(ENOMEM);
+  }
+  packet->data = packet->buf->data;
+  memset(packet->data + packet->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+  return 0;
+}
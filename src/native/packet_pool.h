@@ -0,0 +1,56 @@
+/**
+ * PacketPool
+ *
+ * Recycles AVPacket shells and, for payloads up to a fixed bucket size,
+ * their data buffers. Encoders with AV_CODEC_CAP_DR1 write packets straight
+ * into pooled buffers once Attach()ed; decoders take their input packets
+ * from Acquire(size). Larger payloads fall back to av_new_packet() and
+ * avcodec_default_get_encode_buffer().
+ *
+ * Acquire() and Release() may be called from any thread.
+ */
+
+#ifndef WEBCODECS_NATIVE_PACKET_POOL_H_
+#define WEBCODECS_NATIVE_PACKET_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "buffer_pool.h"
+
+class PacketPool {
+ public:
+  PacketPool(size_t bufferSize, std::shared_ptr<PoolBudget> budget);
+  ~PacketPool();
+  PacketPool(const PacketPool&) = delete;
+  PacketPool& operator=(const PacketPool&) = delete;
+
+  // An empty packet, or nullptr if out of memory.
+  AVPacket* Acquire();
+
+  // A packet with `size` bytes of payload and zeroed input padding.
+  AVPacket* Acquire(int size);
+
+  // Unreference `packet` and keep its shell. Null is ignored.
+  void Release(AVPacket* packet);
+
+  // Route `ctx`'s packet allocation through this pool. Must be called
+  // before avcodec_open2(); the pool must outlive the context.
+  void Attach(AVCodecContext* ctx);
+
+ private:
+  AVBufferRef* GetBuffer(int size);
+  static int GetEncodeBuffer(AVCodecContext* ctx, AVPacket* packet, int flags);
+
+  BufferPool buffers_;
+  std::mutex mutex_;
+  std::vector<AVPacket*> shells_;
+};
+
+#endif  // WEBCODECS_NATIVE_PACKET_POOL_H_
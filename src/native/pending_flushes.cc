@@ -0,0 +1,48 @@
+/**
+ * PendingFlushes implementation.
+ */
+
+#include "pending_flushes.h"
+
+#include <utility>
+
+uint32_t PendingFlushes::Add(Napi::Env env, Napi::Value done, Napi::Value* result) {
+  uint32_t id = nextId_++;
+  Pending& pending = pending_[id];
+  if (done.IsFunction()) {
+    pending.callback = Napi::Persistent(done.As<Napi::Function>());
+    *result = env.Undefined();
+  } else {
+    pending.deferred.emplace(Napi::Promise::Deferred::New(env));
+    *result = pending.deferred->Promise();
+  }
+  return id;
+}
+
+void PendingFlushes::Remove(uint32_t id) {
+  pending_.erase(id);
+}
+
+void PendingFlushes::Complete(Napi::Env env, uint32_t id) {
+  auto it = pending_.find(id);
+  if (it == pending_.end()) {
+    return;
+  }
+  Pending pending = std::move(it->second);
+  pending_.erase(it);
+  if (pending.deferred) {
+    pending.deferred->Resolve(env.Undefined());
+  } else {
+    pending.callback.Call({});
+  }
+}
+
+void PendingFlushes::Abort(Napi::Env env, const std::string& message) {
+  std::map<uint32_t, Pending> pending = std::move(pending_);
+  pending_.clear();
+  for (auto& entry : pending) {
+    if (entry.second.deferred) {
+      entry.second.deferred->Reject(Napi::Error::New(env, message).Value());
+    }
+  }
+}
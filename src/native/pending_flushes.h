@@ -0,0 +1,52 @@
+/**
+ * PendingFlushes
+ *
+ * The flush() calls of one codec session that are still draining, keyed by
+ * the flushId their kFlush command carries. A flush either passes a
+ * completion callback or gets a promise back; both settle on the JS thread
+ * when the worker posts kFlushed.
+ *
+ * Output is delivered through the session's TSFN as soon as the codec
+ * produces it, so settling a flush only says that everything queued before
+ * it has come out. Closing the session rejects the promises still pending.
+ *
+ * JS thread only.
+ */
+
+#ifndef WEBCODECS_NATIVE_PENDING_FLUSHES_H_
+#define WEBCODECS_NATIVE_PENDING_FLUSHES_H_
+
+#include <napi.h>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+class PendingFlushes {
+ public:
+  /**
+   * Register a flush. `done` is the callback argument of flush(): a
+   * function to call, or anything else to return a promise from `*result`.
+   */
+  uint32_t Add(Napi::Env env, Napi::Value done, Napi::Value* result);
+
+  // Forget a flush whose command never reached the worker.
+  void Remove(uint32_t id);
+
+  // Call or resolve the flush; unknown ids (already aborted) are ignored.
+  void Complete(Napi::Env env, uint32_t id);
+
+  // Reject every pending promise with `message`; callbacks are dropped.
+  void Abort(Napi::Env env, const std::string& message);
+
+ private:
+  struct Pending {
+    Napi::FunctionReference callback;
+    std::optional<Napi::Promise::Deferred> deferred;
+  };
+
+  std::map<uint32_t, Pending> pending_;
+  uint32_t nextId_ = 1;
+};
+
+#endif  // WEBCODECS_NATIVE_PENDING_FLUSHES_H_
@@ -0,0 +1,173 @@
+/**
+ * Pixel conversion implementation.
+ */
+
+#include "pixel_convert.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#include "frame_pool.h"
+#include "scaler_cache.h"
+
+bool ConvertImage(const uint8_t* const srcData[4], const int srcStride[4], AVPixelFormat srcFormat,
+                  uint8_t* const dstData[4], const int dstStride[4], AVPixelFormat dstFormat,
+                  int width, int height, std::string* error) {
+  return ScaleImage(srcData, srcStride, srcFormat, width, height,
+                    dstData, dstStride, dstFormat, width, height, error);
+}
+
+bool ScaleImage(const uint8_t* const srcData[4], const int srcStride[4], AVPixelFormat srcFormat,
+                int srcWidth, int srcHeight,
+                uint8_t* const dstData[4], const int dstStride[4], AVPixelFormat dstFormat,
+                int dstWidth, int dstHeight, std::string* error) {
+  if (srcFormat == dstFormat && srcWidth == dstWidth && srcHeight == dstHeight) {
+    av_image_copy(const_cast<uint8_t**>(dstData), const_cast<int*>(dstStride),
+                  const_cast<const uint8_t**>(srcData), srcStride, srcFormat, srcWidth, srcHeight);
+    return true;
+  }
+
+  // Area averaging keeps large reductions (thumbnails) from aliasing
+  int flags = (dstWidth < srcWidth || dstHeight < srcHeight) ? SWS_AREA : SWS_BILINEAR;
+  ScalerCache::Lease scaler = ScalerCache::Shared().Acquire(
+    {srcWidth, srcHeight, srcFormat, dstWidth, dstHeight, dstFormat, flags});
+  if (!scaler) {
+    *error = "Failed to create swscale context";
+    return false;
+  }
+  sws_scale(scaler.get(), srcData, srcStride, 0, srcHeight, dstData, dstStride);
+  return true;
+}
+
+bool CropPlanes(const uint8_t* const data[4], const int stride[4], AVPixelFormat format,
+                int x, int y, const uint8_t* cropped[4], std::string* error) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+  if (!desc || (desc->flags & AV_PIX_FMT_FLAG_BITSTREAM)) {
+    *error = "Cannot crop this pixel format";
+    return false;
+  }
+  int alignX = 1 << desc->log2_chroma_w;
+  int alignY = 1 << desc->log2_chroma_h;
+  if (x % alignX != 0 || y % alignY != 0) {
+    *error = "rect must be aligned to the format's chroma subsampling";
+    return false;
+  }
+
+  int pixelSteps[4];
+  av_image_fill_max_pixsteps(pixelSteps, nullptr, desc);
+  for (int i = 0; i < 4; i++) {
+    if (!data[i]) {
+      cropped[i] = nullptr;
+      continue;
+    }
+    // Planes 1 and 2 of a YUV format are chroma; alpha is full resolution
+    bool chroma = (i == 1 || i == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+    int planeX = chroma ? x >> desc->log2_chroma_w : x;
+    int planeY = chroma ? y >> desc->log2_chroma_h : y;
+    cropped[i] = data[i] + static_cast<ptrdiff_t>(planeY) * stride[i] + planeX * pixelSteps[i];
+  }
+  return true;
+}
+
+AVFrame* ConvertFrameFormat(const AVFrame* source, AVPixelFormat format, std::string* error,
+                            FramePool* pool) {
+  AVFrame* converted = nullptr;
+  if (pool && pool->Matches(format, source->width, source->height)) {
+    converted = pool->Acquire(error);
+    if (!converted) {
+      return nullptr;
+    }
+  } else {
+    converted = av_frame_alloc();
+    if (!converted) {
+      *error = "Failed to allocate frame";
+      return nullptr;
+    }
+    converted->format = format;
+    converted->width = source->width;
+    converted->height = source->height;
+    if (av_frame_get_buffer(converted, 0) < 0) {
+      av_frame_free(&converted);
+      *error = "Failed to allocate frame buffer";
+      return nullptr;
+    }
+  }
+
+  if (!ConvertImage(source->data, source->linesize, static_cast<AVPixelFormat>(source->format),
+                    converted->data, converted->linesize, format,
+                    source->width, source->height, error)) {
+    av_frame_free(&converted);
+    return nullptr;
+  }
+  return converted;
+}
+
+bool ResolveLayout(Napi::Value layout, AVPixelFormat format, int width, int height,
+                   size_t byteLength, std::vector<PlaneLayout>* planes, std::string* error) {
+  PlaneSize sizes[4];
+  int planeCount = PlaneSizes(format, width, height, sizes);
+  if (planeCount == 0) {
+    *error = "Unsupported pixel format";
+    return false;
+  }
+
+  planes->clear();
+  if (layout.IsArray()) {
+    Napi::Array entries = layout.As<Napi::Array>();
+    if (entries.Length() != static_cast<uint32_t>(planeCount)) {
+      *error = "layout must have one entry per plane";
+      return false;
+    }
+    for (uint32_t i = 0; i < entries.Length(); i++) {
+      Napi::Value entry = entries.Get(i);
+      if (!entry.IsObject()) {
+        *error = "layout entries must be {offset, stride}";
+        return false;
+      }
+      Napi::Object plane = entry.As<Napi::Object>();
+      int64_t offset = plane.Get("offset").ToNumber().Int64Value();
+      int64_t stride = plane.Get("stride").ToNumber().Int64Value();
+      if (offset < 0 || stride < static_cast<int64_t>(sizes[i].rowBytes)) {
+        *error = "layout stride is smaller than a row";
+        return false;
+      }
+      planes->push_back({static_cast<size_t>(offset), static_cast<size_t>(stride)});
+    }
+  } else if (layout.IsUndefined() || layout.IsNull()) {
+    PackedLayout(format, width, height, planes);
+  } else {
+    *error = "layout must be an array";
+    return false;
+  }
+
+  for (int i = 0; i < planeCount; i++) {
+    const PlaneLayout& plane = (*planes)[i];
+    if (plane.offset + plane.stride * (sizes[i].rows - 1) + sizes[i].rowBytes > byteLength) {
+      *error = "Buffer is too small for the frame layout";
+      return false;
+    }
+  }
+  return true;
+}
+
+void ApplyLayout(uint8_t* base, const std::vector<PlaneLayout>& planes,
+                 uint8_t* data[4], int stride[4]) {
+  for (size_t i = 0; i < 4; i++) {
+    data[i] = i < planes.size() ? base + planes[i].offset : nullptr;
+    stride[i] = i < planes.size() ? static_cast<int>(planes[i].stride) : 0;
+  }
+}
+
+Napi::Array LayoutToArray(Napi::Env env, const std::vector<PlaneLayout>& planes) {
+  Napi::Array result = Napi::Array::New(env, planes.size());
+  for (size_t i = 0; i < planes.size(); i++) {
+    Napi::Object plane = Napi::Object::New(env);
+    plane.Set("offset", Napi::Number::New(env, static_cast<double>(planes[i].offset)));
+    plane.Set("stride", Napi::Number::New(env, static_cast<double>(planes[i].stride)));
+    result.Set(static_cast<uint32_t>(i), plane);
+  }
+  return result;
+}
@@ -0,0 +1,79 @@
+/**
+ * Pixel format conversion shared by NativeVideoFrame, the encoder input
+ * path and the addon's convertFrame() entry point.
+ *
+ * Conversions go through libswscale, which picks its SSE/AVX2/NEON kernels
+ * for the running CPU, using contexts leased from ScalerCache::Shared().
+ * Same-format copies skip swscale entirely.
+ */
+
+#ifndef WEBCODECS_NATIVE_PIXEL_CONVERT_H_
+#define WEBCODECS_NATIVE_PIXEL_CONVERT_H_
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include "pixel_format.h"
+
+class FramePool;
+
+/**
+ * Copy or convert a width x height image between two plane layouts.
+ */
+bool ConvertImage(const uint8_t* const srcData[4], const int srcStride[4], AVPixelFormat srcFormat,
+                  uint8_t* const dstData[4], const int dstStride[4], AVPixelFormat dstFormat,
+                  int width, int height, std::string* error);
+
+/**
+ * Scale a srcWidth x srcHeight image to dstWidth x dstHeight and convert
+ * its format in a single sws_scale() pass.
+ */
+bool ScaleImage(const uint8_t* const srcData[4], const int srcStride[4], AVPixelFormat srcFormat,
+                int srcWidth, int srcHeight,
+                uint8_t* const dstData[4], const int dstStride[4], AVPixelFormat dstFormat,
+                int dstWidth, int dstHeight, std::string* error);
+
+/**
+ * Point `cropped` at pixel (x, y) of each plane, so the planes can be
+ * passed on as a smaller image. Fails for bitstream formats and when x or
+ * y is not on the format's chroma sample grid.
+ */
+bool CropPlanes(const uint8_t* const data[4], const int stride[4], AVPixelFormat format,
+                int x, int y, const uint8_t* cropped[4], std::string* error);
+
+/**
+ * Convert `source` into a newly allocated frame of `format` with the same
+ * size, taken from `pool` when it has that shape. Returns nullptr and fills
+ * `error` on failure.
+ */
+AVFrame* ConvertFrameFormat(const AVFrame* source, AVPixelFormat format, std::string* error,
+                            FramePool* pool = nullptr);
+
+/**
+ * Resolve a WebCodecs `layout` option for a buffer of `byteLength` bytes.
+ * An undefined layout means tightly packed planes. Fails if the layout
+ * has the wrong plane count, a stride shorter than a row, or does not fit.
+ */
+bool ResolveLayout(Napi::Value layout, AVPixelFormat format, int width, int height,
+                   size_t byteLength, std::vector<PlaneLayout>* planes, std::string* error);
+
+/**
+ * Point `data`/`stride` at the planes of `base` described by `planes`.
+ */
+void ApplyLayout(uint8_t* base, const std::vector<PlaneLayout>& planes,
+                 uint8_t* data[4], int stride[4]);
+
+/**
+ * [{ offset, stride }, ...] as returned by copyTo().
+ */
+Napi::Array LayoutToArray(Napi::Env env, const std::vector<PlaneLayout>& planes);
+
+#endif  // WEBCODECS_NATIVE_PIXEL_CONVERT_H_
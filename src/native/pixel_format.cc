@@ -0,0 +1,83 @@
+/**
+ * Pixel format helpers.
+ */
+
+#include "pixel_format.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+struct FormatName {
+  const char* name;
+  AVPixelFormat format;
+};
+
+// WebCodecs names first so PixelFormatName() finds them before the aliases.
+constexpr FormatName kFormatNames[] = {
+  {"I420", AV_PIX_FMT_YUV420P},
+  {"I420A", AV_PIX_FMT_YUVA420P},
+  {"I422", AV_PIX_FMT_YUV422P},
+  {"I444", AV_PIX_FMT_YUV444P},
+  {"NV12", AV_PIX_FMT_NV12},
+  {"RGBA", AV_PIX_FMT_RGBA},
+  {"RGBX", AV_PIX_FMT_RGB0},
+  {"BGRA", AV_PIX_FMT_BGRA},
+  {"BGRX", AV_PIX_FMT_BGR0},
+  {"RGB24", AV_PIX_FMT_RGB24},
+  {"YUV420P", AV_PIX_FMT_YUV420P},
+  {"RGB", AV_PIX_FMT_RGB24},
+};
+
+}  // namespace
+
+AVPixelFormat PixelFormatFromString(const std::string& name) {
+  for (const FormatName& entry : kFormatNames) {
+    if (name == entry.name) {
+      return entry.format;
+    }
+  }
+  return AV_PIX_FMT_NONE;
+}
+
+const char* PixelFormatName(AVPixelFormat format) {
+  for (const FormatName& entry : kFormatNames) {
+    if (entry.format == format) {
+      return entry.name;
+    }
+  }
+  return nullptr;
+}
+
+int PlaneSizes(AVPixelFormat format, int width, int height, PlaneSize sizes[4]) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+  int linesizes[4];
+  if (!desc || width <= 0 || height <= 0 ||
+      av_image_fill_linesizes(linesizes, format, width) < 0) {
+    return 0;
+  }
+
+  int planeCount = av_pix_fmt_count_planes(format);
+  for (int i = 0; i < planeCount; i++) {
+    // Planes 1 and 2 are the subsampled chroma planes; 0 and 3 (alpha) are full height.
+    int rows = (i == 1 || i == 2) ? -((-height) >> desc->log2_chroma_h) : height;
+    sizes[i] = {static_cast<size_t>(linesizes[i]), static_cast<size_t>(rows)};
+  }
+  return planeCount;
+}
+
+size_t PackedLayout(AVPixelFormat format, int width, int height, std::vector<PlaneLayout>* planes) {
+  PlaneSize sizes[4];
+  int planeCount = PlaneSizes(format, width, height, sizes);
+
+  planes->clear();
+  size_t offset = 0;
+  for (int i = 0; i < planeCount; i++) {
+    planes->push_back({offset, sizes[i].rowBytes});
+    offset += sizes[i].rowBytes * sizes[i].rows;
+  }
+  return offset;
+}
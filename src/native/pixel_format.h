@@ -0,0 +1,53 @@
+/**
+ * Mapping between WebCodecs VideoPixelFormat names and FFmpeg pixel formats,
+ * plus the tightly packed plane layout WebCodecs uses for copyTo().
+ */
+
+#ifndef WEBCODECS_NATIVE_PIXEL_FORMAT_H_
+#define WEBCODECS_NATIVE_PIXEL_FORMAT_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+
+struct PlaneLayout {
+  size_t offset;
+  size_t stride;
+};
+
+// Bytes per row and number of rows of one plane at its own resolution.
+struct PlaneSize {
+  size_t rowBytes;
+  size_t rows;
+};
+
+/**
+ * 'I420', 'NV12', 'RGBA', ... -> AV_PIX_FMT_*. Also accepts the legacy
+ * 'YUV420P', 'RGB' and 'RGB24' names used by the encode helpers.
+ * Returns AV_PIX_FMT_NONE for unknown names.
+ */
+AVPixelFormat PixelFormatFromString(const std::string& name);
+
+/**
+ * AV_PIX_FMT_* -> WebCodecs name, or nullptr if WebCodecs has no name for it.
+ */
+const char* PixelFormatName(AVPixelFormat format);
+
+/**
+ * Fill `sizes` with the geometry of each plane of a width x height image and
+ * return the plane count, or 0 if the format is not supported.
+ */
+int PlaneSizes(AVPixelFormat format, int width, int height, PlaneSize sizes[4]);
+
+/**
+ * Fill `planes` with the tightly packed (stride == row bytes) layout of a
+ * width x height image and return its total size in bytes, or 0 if the
+ * format is not supported.
+ */
+size_t PackedLayout(AVPixelFormat format, int width, int height, std::vector<PlaneLayout>* planes);
+
+#endif  // WEBCODECS_NATIVE_PIXEL_FORMAT_H_
@@ -0,0 +1,111 @@
+/**
+ * ScalerCache implementation.
+ */
+
+#include "scaler_cache.h"
+
+#include <utility>
+
+namespace {
+
+// Distinct (geometry, format) pairs a process typically cycles through:
+// a few renditions times a few copyTo() targets.
+constexpr size_t kSharedScalerCapacity = 32;
+
+}  // namespace
+
+bool ScalerCache::Key::operator==(const Key& other) const {
+  return srcWidth == other.srcWidth && srcHeight == other.srcHeight &&
+         srcFormat == other.srcFormat && dstWidth == other.dstWidth &&
+         dstHeight == other.dstHeight && dstFormat == other.dstFormat &&
+         flags == other.flags;
+}
+
+ScalerCache::Lease::Lease(Lease&& other) noexcept
+    : cache_(other.cache_), key_(other.key_), ctx_(other.ctx_) {
+  other.cache_ = nullptr;
+  other.ctx_ = nullptr;
+}
+
+ScalerCache::Lease& ScalerCache::Lease::operator=(Lease&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    cache_ = other.cache_;
+    key_ = other.key_;
+    ctx_ = other.ctx_;
+    other.cache_ = nullptr;
+    other.ctx_ = nullptr;
+  }
+  return *this;
+}
+
+ScalerCache::Lease::~Lease() {
+  Reset();
+}
+
+void ScalerCache::Lease::Reset() {
+  if (cache_ && ctx_) {
+    cache_->Release(key_, ctx_);
+  }
+  cache_ = nullptr;
+  ctx_ = nullptr;
+}
+
+ScalerCache& ScalerCache::Shared() {
+  // Intentionally leaked: worker threads may still hold leases while
+  // static destructors run at process exit.
+  static ScalerCache* cache = new ScalerCache(kSharedScalerCapacity);
+  return *cache;
+}
+
+ScalerCache::ScalerCache(size_t capacity) : capacity_(capacity) {}
+
+ScalerCache::~ScalerCache() {
+  for (Entry& entry : idle_) {
+    sws_freeContext(entry.ctx);
+  }
+}
+
+ScalerCache::Lease ScalerCache::Acquire(const Key& key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+      if (it->key == key) {
+        SwsContext* ctx = it->ctx;
+        idle_.erase(it);
+        hits_++;
+        return Lease(this, key, ctx);
+      }
+    }
+    misses_++;
+  }
+
+  // Build outside the lock; table setup is the expensive part.
+  SwsContext* ctx = sws_getContext(
+    key.srcWidth, key.srcHeight, key.srcFormat,
+    key.dstWidth, key.dstHeight, key.dstFormat,
+    key.flags, nullptr, nullptr, nullptr
+  );
+  if (!ctx) {
+    return Lease();
+  }
+  return Lease(this, key, ctx);
+}
+
+void ScalerCache::Release(const Key& key, SwsContext* ctx) {
+  SwsContext* evicted = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_front({key, ctx});
+    if (idle_.size() > capacity_) {
+      evicted = idle_.back().ctx;
+      idle_.pop_back();
+    }
+  }
+  sws_freeContext(evicted);
+}
+
+ScalerCache::Stats ScalerCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {hits_, misses_, idle_.size()};
+}
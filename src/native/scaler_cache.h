@@ -0,0 +1,96 @@
+/**
+ * ScalerCache
+ *
+ * Process-wide pool of SwsContexts keyed by geometry, pixel formats and
+ * flags. Building swscale's filter tables costs more than scaling a small
+ * frame, so contexts are reused instead of created per frame.
+ *
+ * An SwsContext must not be used by two threads at once, so callers lease
+ * a context exclusively and hand it back when the Lease goes out of scope.
+ * Idle contexts are kept most-recently-used first and the least recently
+ * used ones are freed once more than `capacity` are idle.
+ */
+
+#ifndef WEBCODECS_NATIVE_SCALER_CACHE_H_
+#define WEBCODECS_NATIVE_SCALER_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+class ScalerCache {
+ public:
+  struct Key {
+    int srcWidth;
+    int srcHeight;
+    AVPixelFormat srcFormat;
+    int dstWidth;
+    int dstHeight;
+    AVPixelFormat dstFormat;
+    int flags;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t idle;
+  };
+
+  // Exclusive use of one SwsContext; returns it to the cache on destruction.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    SwsContext* get() const { return ctx_; }
+    explicit operator bool() const { return ctx_ != nullptr; }
+
+   private:
+    friend class ScalerCache;
+    Lease(ScalerCache* cache, const Key& key, SwsContext* ctx)
+        : cache_(cache), key_(key), ctx_(ctx) {}
+    void Reset();
+
+    ScalerCache* cache_ = nullptr;
+    Key key_ = {};
+    SwsContext* ctx_ = nullptr;
+  };
+
+  // The cache shared by every codec session and copyTo() call.
+  static ScalerCache& Shared();
+
+  explicit ScalerCache(size_t capacity);
+  ~ScalerCache();
+
+  // Reuse an idle context for `key` or build a new one. Empty on failure.
+  Lease Acquire(const Key& key);
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    Key key;
+    SwsContext* ctx;
+  };
+
+  void Release(const Key& key, SwsContext* ctx);
+
+  mutable std::mutex mutex_;
+  std::list<Entry> idle_;  // Most recently used first
+  size_t capacity_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+#endif  // WEBCODECS_NATIVE_SCALER_CACHE_H_
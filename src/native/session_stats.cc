@@ -0,0 +1,124 @@
+/**
+ * SessionStats implementation.
+ */
+
+#include "session_stats.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr std::memory_order kRelaxed = std::memory_order_relaxed;
+
+const char* StageName(SessionStage stage) {
+  switch (stage) {
+    case SessionStage::kQueue: return "queue";
+    case SessionStage::kOpen: return "open";
+    case SessionStage::kCopy: return "copy";
+    case SessionStage::kConvert: return "convert";
+    case SessionStage::kSend: return "send";
+    case SessionStage::kReceive: return "receive";
+    case SessionStage::kCount: break;
+  }
+  return "unknown";
+}
+
+// Smallest i with us <= 2^i, capped at the last bucket.
+size_t BucketIndex(uint64_t us) {
+  size_t index = 0;
+  while (index + 1 < LatencyHistogram::kBuckets && (uint64_t{1} << index) < us) {
+    index++;
+  }
+  return index;
+}
+
+void StoreMax(std::atomic<uint64_t>& max, uint64_t value) {
+  uint64_t current = max.load(kRelaxed);
+  while (value > current && !max.compare_exchange_weak(current, value, kRelaxed)) {
+  }
+}
+
+}  // namespace
+
+void LatencyHistogram::Record(uint64_t us) {
+  buckets_[BucketIndex(us)].fetch_add(1, kRelaxed);
+  sumUs_.fetch_add(us, kRelaxed);
+  StoreMax(maxUs_, us);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Get() const {
+  // Counted from the buckets themselves, so Percentile() ranks agree with
+  // them even while samples are being recorded
+  Snapshot snapshot;
+  snapshot.count = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    snapshot.buckets[i] = buckets_[i].load(kRelaxed);
+    snapshot.count += snapshot.buckets[i];
+  }
+  snapshot.sumUs = sumUs_.load(kRelaxed);
+  snapshot.maxUs = maxUs_.load(kRelaxed);
+  return snapshot;
+}
+
+uint64_t LatencyHistogram::Snapshot::Percentile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    seen += buckets[i];
+    if (seen >= rank && seen > 0) {
+      // The slowest sample is a tighter bound for the top bucket in use
+      uint64_t bound = uint64_t{1} << i;
+      return bound < maxUs ? bound : maxUs;
+    }
+  }
+  return maxUs;
+}
+
+void SessionStats::RecordQueueDepth(size_t depth) {
+  size_t current = maxQueueDepth_.load(kRelaxed);
+  while (depth > current && !maxQueueDepth_.compare_exchange_weak(current, depth, kRelaxed)) {
+  }
+}
+
+void SessionStats::Record(SessionStage stage, Clock::time_point start) {
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  stages_[static_cast<size_t>(stage)].Record(elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0);
+}
+
+Napi::Object SessionStats::ToObject(Napi::Env env, size_t queueDepth) const {
+  auto number = [env](uint64_t value) { return Napi::Number::New(env, static_cast<double>(value)); };
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("framesIn", number(framesIn_.load(kRelaxed)));
+  result.Set("framesOut", number(framesOut_.load(kRelaxed)));
+  result.Set("bytesIn", number(bytesIn_.load(kRelaxed)));
+  result.Set("bytesOut", number(bytesOut_.load(kRelaxed)));
+  result.Set("errors", number(errors_.load(kRelaxed)));
+  result.Set("droppedFrames", number(dropped_.load(kRelaxed)));
+  result.Set("queueDepth", number(queueDepth));
+  result.Set("maxQueueDepth", number(maxQueueDepth_.load(kRelaxed)));
+
+  Napi::Object stages = Napi::Object::New(env);
+  for (size_t s = 0; s < stages_.size(); s++) {
+    LatencyHistogram::Snapshot snapshot = stages_[s].Get();
+    Napi::Object stage = Napi::Object::New(env);
+    stage.Set("count", number(snapshot.count));
+    stage.Set("sumUs", number(snapshot.sumUs));
+    stage.Set("maxUs", number(snapshot.maxUs));
+    stage.Set("p50Us", number(snapshot.Percentile(0.5)));
+    stage.Set("p99Us", number(snapshot.Percentile(0.99)));
+    Napi::Array buckets = Napi::Array::New(env, LatencyHistogram::kBuckets);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::kBuckets; i++) {
+      cumulative += snapshot.buckets[i];
+      buckets.Set(static_cast<uint32_t>(i), number(cumulative));
+    }
+    stage.Set("buckets", buckets);
+    stages.Set(StageName(static_cast<SessionStage>(s)), stage);
+  }
+  result.Set("stages", stages);
+  return result;
+}
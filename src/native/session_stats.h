@@ -0,0 +1,114 @@
+/**
+ * SessionStats
+ *
+ * Performance counters of one codec session: frames and bytes in and out,
+ * errors, dropped frames, the deepest the command queue got, and a latency
+ * histogram per stage of the pipeline (queue wait, codec open, input copy,
+ * pixel conversion, send, receive).
+ *
+ * Everything is a relaxed atomic written by the session's worker lane or
+ * its JS thread, so recording costs a clock read and a few increments and
+ * a snapshot never takes a lock. A snapshot taken mid-command may count a
+ * frame in one field before another.
+ *
+ * Histogram buckets are powers of two in microseconds; bucket i counts
+ * samples of at most 2^i us. Percentiles report the bound of the bucket
+ * they fall in, so they are within a factor of two of the exact value.
+ */
+
+#ifndef WEBCODECS_NATIVE_SESSION_STATS_H_
+#define WEBCODECS_NATIVE_SESSION_STATS_H_
+
+#include <napi.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+enum class SessionStage {
+  kQueue,    // enqueue -> worker picks the command up
+  kOpen,     // codec context open, including reopening after flush
+  kCopy,     // JS buffer -> AVFrame/AVPacket copy on the JS thread
+  kConvert,  // download, pixel format conversion and upload
+  kSend,     // avcodec_send_frame/avcodec_send_packet
+  kReceive,  // avcodec_receive_packet/avcodec_receive_frame until EAGAIN
+  kCount,
+};
+
+class LatencyHistogram {
+ public:
+  // 2^26 us is about 67 s; anything slower lands in the last bucket.
+  static constexpr size_t kBuckets = 27;
+
+  struct Snapshot {
+    uint64_t count;
+    uint64_t sumUs;
+    uint64_t maxUs;
+    std::array<uint64_t, kBuckets> buckets;
+
+    // Upper bound of the bucket the q-th quantile (0..1) falls in; 0 if empty.
+    uint64_t Percentile(double q) const;
+  };
+
+  void Record(uint64_t us);
+  Snapshot Get() const;
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  std::atomic<uint64_t> sumUs_{0};
+  std::atomic<uint64_t> maxUs_{0};
+};
+
+class SessionStats {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Times the enclosing scope into one stage.
+  class StageTimer {
+   public:
+    StageTimer(SessionStats* stats, SessionStage stage)
+        : stats_(stats), stage_(stage), start_(Clock::now()) {}
+    ~StageTimer() { stats_->Record(stage_, start_); }
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+   private:
+    SessionStats* stats_;
+    SessionStage stage_;
+    Clock::time_point start_;
+  };
+
+  void CountInput(size_t bytes) { framesIn_.fetch_add(1, kRelaxed); bytesIn_.fetch_add(bytes, kRelaxed); }
+  void CountOutput(size_t bytes) { framesOut_.fetch_add(1, kRelaxed); bytesOut_.fetch_add(bytes, kRelaxed); }
+  void CountError() { errors_.fetch_add(1, kRelaxed); }
+  void CountDrop() { dropped_.fetch_add(1, kRelaxed); }
+  uint64_t Dropped() const { return dropped_.load(kRelaxed); }
+
+  // Queue size right after an enqueue; keeps the high-water mark.
+  void RecordQueueDepth(size_t depth);
+
+  void Record(SessionStage stage, Clock::time_point start);
+
+  /**
+   * { framesIn, framesOut, bytesIn, bytesOut, errors, droppedFrames,
+   *   queueDepth, maxQueueDepth,
+   *   stages: { [stage]: { count, sumUs, maxUs, p50Us, p99Us, buckets } } }
+   * where buckets[i] is the cumulative count of samples <= 2^i us.
+   */
+  Napi::Object ToObject(Napi::Env env, size_t queueDepth) const;
+
+ private:
+  static constexpr std::memory_order kRelaxed = std::memory_order_relaxed;
+
+  std::atomic<uint64_t> framesIn_{0};
+  std::atomic<uint64_t> framesOut_{0};
+  std::atomic<uint64_t> bytesIn_{0};
+  std::atomic<uint64_t> bytesOut_{0};
+  std::atomic<uint64_t> errors_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<size_t> maxQueueDepth_{0};
+  std::array<LatencyHistogram, static_cast<size_t>(SessionStage::kCount)> stages_;
+};
+
+#endif  // WEBCODECS_NATIVE_SESSION_STATS_H_
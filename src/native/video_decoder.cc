@@ -0,0 +1,603 @@
+/**
+ * NativeVideoDecoder implementation.
+ *
+ * new NativeVideoDecoder({ codec, description?, hardwareAcceleration?, keyframesOnly?,
+ *                          lowres?, poolMemoryLimit? },
+ *                        { output(frame), error(err), dequeue() })
+ *   hardwareAccelerated -> whether the decoder got a hardware device
+ *   lowres -> the downscale the decoder actually applies (0 if unsupported)
+ *   poolStats -> input packet pool counters, as on NativeVideoEncoder
+ *   getStats() -> counters and per-stage latency histograms, as on NativeVideoEncoder
+ *   decode(data: Buffer, { timestamp, duration?, keyFrame? }) -> queued
+ *   flush(done?: () => void) -> Promise<void> when no callback is given
+ *   setPipeline(pipeline: NativeVideoPipeline)
+ *   close()
+ *
+ * codec is a WebCodecs codec string ('vp8', 'vp09.*', 'av01.*', 'avc1.*').
+ * description is the codec extradata (an avcC record for H.264 in AVC
+ * format); without it H.264 chunks must be Annex B.
+ * frame is { frame: NativeVideoFrame, width, height, format, timestamp, duration? }
+ * where `frame` references the decoder's own picture buffers (no copy).
+ * Hardware-decoded frames stay in GPU memory until copyTo(); `format` is
+ * their software format (usually NV12).
+ * dequeue() fires once per decode() after the worker has consumed it.
+ * keyframesOnly is a fast mode for scrubbing: chunks decoded with
+ * keyFrame: false are dropped before they are copied (decode() returns
+ * false), the codec discards any other non-key frame and the loop filter
+ * is skipped. lowres asks the decoder for 1/2^lowres sized output.
+ * After setPipeline(), frames go to the pipeline's encoders on the worker
+ * and output() is no longer called. The worker then only takes the next
+ * chunk while every non-realtime encoder has room; one chunk can still
+ * release several frames (a flush releases all of them), so a queue may
+ * briefly go past its maxQueueDepth.
+ */
+
+#include "video_decoder.h"
+
+#include <cstring>
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+}
+
+#include "addon_data.h"
+#include "codec_registry.h"
+#include "ffmpeg_utils.h"
+#include "packet_pool.h"
+#include "hw_device.h"
+#include "pixel_format.h"
+#include "video_frame.h"
+#include "video_pipeline.h"
+
+namespace {
+
+// Encoded chunks waiting for the worker. Only the demuxer thread blocks once
+// this many are queued; decode() never waits for room.
+constexpr size_t kDecodeQueueCapacity = 32;
+
+// Pooled input packet buffer; larger chunks are allocated individually.
+constexpr size_t kPacketBufferSize = 256 * 1024;
+
+// Bytes of the picture once it is in system memory.
+size_t DecodedBytes(const AVFrame* frame) {
+  AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+  if (frame->hw_frames_ctx) {
+    format = reinterpret_cast<const AVHWFramesContext*>(frame->hw_frames_ctx->data)->sw_format;
+  }
+  int bytes = av_image_get_buffer_size(format, frame->width, frame->height, 1);
+  return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+}
+
+}  // namespace
+
+Napi::Object NativeVideoDecoder::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeVideoDecoder", {
+    InstanceMethod("decode", &NativeVideoDecoder::Decode),
+    InstanceAccessor("poolStats", &NativeVideoDecoder::GetPoolStats, nullptr),
+    InstanceAccessor("hardwareAccelerated", &NativeVideoDecoder::GetHardwareAccelerated, nullptr),
+    InstanceAccessor("lowres", &NativeVideoDecoder::GetLowres, nullptr),
+    InstanceMethod("getStats", &NativeVideoDecoder::GetStats),
+    InstanceMethod("flush", &NativeVideoDecoder::Flush),
+    InstanceMethod("setPipeline", &NativeVideoDecoder::SetPipeline),
+    InstanceMethod("close", &NativeVideoDecoder::Close),
+  });
+
+  AddonData::Get(env)->videoDecoder = Napi::Persistent(func);
+
+  exports.Set("NativeVideoDecoder", func);
+  return exports;
+}
+
+NativeVideoDecoder* NativeVideoDecoder::FromValue(Napi::Value value) {
+  if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(AddonData::Get(value.Env())->videoDecoder.Value())) {
+    return nullptr;
+  }
+  return Unwrap(value.As<Napi::Object>());
+}
+
+NativeVideoDecoder::NativeVideoDecoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeVideoDecoder>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected ({codec, description?}, {output, error, dequeue})").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  Napi::Object callbacks = info[1].As<Napi::Object>();
+  if (!callbacks.Get("output").IsFunction() || !callbacks.Get("error").IsFunction() ||
+      !callbacks.Get("dequeue").IsFunction()) {
+    Napi::TypeError::New(env, "Decoder callbacks require output, error and dequeue functions").ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (!config.Get("codec").IsString()) {
+    Napi::TypeError::New(env, "Decoder config requires a codec string").ThrowAsJavaScriptException();
+    return;
+  }
+  std::string error;
+  if (!ParseVideoCodec(config.Get("codec").As<Napi::String>().Utf8Value(), &codec_, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Value description = config.Get("description");
+  if (description.IsTypedArray()) {
+    Napi::TypedArray view = description.As<Napi::TypedArray>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(view.ArrayBuffer().Data()) + view.ByteOffset();
+    description_.assign(bytes, bytes + view.ByteLength());
+  } else if (description.IsArrayBuffer()) {
+    Napi::ArrayBuffer buffer = description.As<Napi::ArrayBuffer>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer.Data());
+    description_.assign(bytes, bytes + buffer.ByteLength());
+  }
+
+  if (config.Get("hardwareAcceleration").IsString() &&
+      !ParseHardwarePreference(config.Get("hardwareAcceleration").As<Napi::String>().Utf8Value(), &hardware_)) {
+    Napi::TypeError::New(env, "Invalid hardwareAcceleration").ThrowAsJavaScriptException();
+    return;
+  }
+
+  fast_.keyframesOnly = config.Get("keyframesOnly").ToBoolean().Value();
+  if (config.Get("lowres").IsNumber()) {
+    fast_.lowres = config.Get("lowres").As<Napi::Number>().Int32Value();
+    if (fast_.lowres < 0 || fast_.lowres > 3) {
+      Napi::RangeError::New(env, "lowres must be between 0 and 3").ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  size_t poolLimit = 0;
+  if (!PoolLimitFromConfig(config, &poolLimit, &error)) {
+    Napi::RangeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  budget_ = std::make_shared<PoolBudget>(poolLimit);
+  packets_ = std::make_unique<PacketPool>(kPacketBufferSize, budget_);
+
+  if (!OpenCodec(&error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  hardwareAccelerated_ = IsHardwareContext(ctx_);
+  lowres_ = ctx_->lowres;
+
+  errorCallback_ = Napi::Persistent(callbacks.Get("error").As<Napi::Function>());
+  dequeueCallback_ = Napi::Persistent(callbacks.Get("dequeue").As<Napi::Function>());
+
+  // Same lifetime scheme as NativeVideoEncoder: self-referenced until the
+  // TSFN finalizer runs, and the event loop is only held while busy.
+  Ref();
+  tsfn_ = Napi::ThreadSafeFunction::New(
+    env, callbacks.Get("output").As<Napi::Function>(), "NativeVideoDecoder", 0, 1,
+    [this](Napi::Env) { Unref(); });
+  tsfn_.Unref(env);
+
+  worker_ = std::make_unique<WorkerThread>(kDecodeQueueCapacity);
+  worker_->Start([this](Command& cmd) { HandleCommand(cmd); });
+}
+
+NativeVideoDecoder::~NativeVideoDecoder() {
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+}
+
+bool NativeVideoDecoder::OpenCodec(std::string* error) {
+  SessionStats::StageTimer timer(&stats_, SessionStage::kOpen);
+  ctx_ = OpenVideoDecoder(codec_, description_.data(), description_.size(), hardware_, error, fast_);
+  if (!ctx_) {
+    return false;
+  }
+
+  frame_ = av_frame_alloc();
+  if (!frame_) {
+    ReleaseCodec();
+    *error = "Failed to allocate frame";
+    return false;
+  }
+
+  return true;
+}
+
+void NativeVideoDecoder::ReleaseCodec() {
+  av_frame_free(&frame_);
+  avcodec_free_context(&ctx_);
+  durations_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// JS thread
+// ---------------------------------------------------------------------------
+
+Napi::Value NativeVideoDecoder::Decode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "Expected (Buffer, {timestamp, duration?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+  Napi::Object options = (info.Length() >= 2 && info[1].IsObject())
+    ? info[1].As<Napi::Object>()
+    : Napi::Object::New(env);
+
+  Command cmd;
+  cmd.type = CommandType::kDecode;
+  if (options.Get("timestamp").IsNumber()) {
+    cmd.timestamp = options.Get("timestamp").As<Napi::Number>().Int64Value();
+  }
+  if (options.Get("duration").IsNumber()) {
+    cmd.duration = options.Get("duration").As<Napi::Number>().Int64Value();
+    cmd.hasDuration = true;
+  }
+  // Only chunks known to be delta frames are dropped; the codec's own
+  // skip_frame catches the rest.
+  if (fast_.keyframesOnly && options.Get("keyFrame").IsBoolean() &&
+      !options.Get("keyFrame").As<Napi::Boolean>().Value()) {
+    stats_.CountDrop();
+    return Napi::Boolean::New(env, false);
+  }
+
+  // Copy the chunk into a pooled packet the worker can own.
+  AVPacket* packet = packets_->Acquire(static_cast<int>(inputBuffer.Length()));
+  if (!packet) {
+    Napi::Error::New(env, "Failed to allocate packet").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  {
+    SessionStats::StageTimer timer(&stats_, SessionStage::kCopy);
+    memcpy(packet->data, inputBuffer.Data(), inputBuffer.Length());
+  }
+  packet->pts = cmd.timestamp;
+  packet->dts = AV_NOPTS_VALUE;
+  cmd.packet = packet;
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    UntrackCommand(env);
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  stats_.CountInput(inputBuffer.Length());
+  stats_.RecordQueueDepth(worker_->QueueSize());
+  return Napi::Boolean::New(env, true);
+}
+
+bool NativeVideoDecoder::EnqueuePacket(AVPacket* packet, int64_t duration, bool hasDuration) {
+  if (!worker_) {
+    av_packet_free(&packet);
+    return false;
+  }
+  if (fast_.keyframesOnly && !(packet->flags & AV_PKT_FLAG_KEY)) {
+    av_packet_free(&packet);
+    stats_.CountDrop();
+    return true;
+  }
+  size_t bytes = static_cast<size_t>(packet->size);
+  Command cmd;
+  cmd.type = CommandType::kDecode;
+  cmd.packet = packet;
+  cmd.timestamp = packet->pts;
+  cmd.duration = duration;
+  cmd.hasDuration = hasDuration;
+  cmd.reportDequeue = false;
+  if (!worker_->Enqueue(cmd)) {
+    return false;
+  }
+  stats_.CountInput(bytes);
+  stats_.RecordQueueDepth(worker_->QueueSize());
+  return true;
+}
+
+Napi::Value NativeVideoDecoder::GetHardwareAccelerated(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), hardwareAccelerated_);
+}
+
+Napi::Value NativeVideoDecoder::GetLowres(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), lowres_);
+}
+
+Napi::Value NativeVideoDecoder::GetPoolStats(const Napi::CallbackInfo& info) {
+  return PoolStatsToObject(info.Env(), budget_->GetStats());
+}
+
+Napi::Value NativeVideoDecoder::GetStats(const Napi::CallbackInfo& info) {
+  size_t queueDepth = worker_ && !closed_ ? worker_->QueueSize() : 0;
+  return stats_.ToObject(info.Env(), queueDepth);
+}
+
+/**
+ * Queue a drain. Once every frame produced by earlier decode() calls has
+ * been delivered to output(), `done` runs on the JS thread or, without a
+ * callback, the returned promise resolves. close() rejects the promise.
+ */
+Napi::Value NativeVideoDecoder::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Value done = info.Length() >= 1 ? info[0] : env.Undefined();
+  if (!done.IsFunction() && !done.IsUndefined()) {
+    Napi::TypeError::New(env, "Expected flush completion callback").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Command cmd;
+  cmd.type = CommandType::kFlush;
+  Napi::Value result;
+  cmd.flushId = flushes_.Add(env, done, &result);
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    flushes_.Remove(cmd.flushId);
+    UntrackCommand(env);
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return result;
+}
+
+/**
+ * Route frames to `pipeline` from now on. A decoder keeps its pipeline for
+ * the rest of the session.
+ */
+Napi::Value NativeVideoDecoder::SetPipeline(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Decoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  NativeVideoPipeline* pipeline = info.Length() >= 1 ? NativeVideoPipeline::FromValue(info[0]) : nullptr;
+  if (!pipeline) {
+    Napi::TypeError::New(env, "Expected a NativeVideoPipeline").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (pipeline_) {
+    Napi::Error::New(env, "Decoder already has a pipeline").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  pipelineRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+  pipeline_ = pipeline;
+  // Pace decoding to the slowest encoder downstream without blocking a
+  // pool thread those encoders need
+  worker_->SetGate([pipeline] { return pipeline->HasRoom(); });
+  return env.Undefined();
+}
+
+void NativeVideoDecoder::Close(const Napi::CallbackInfo& info) {
+  if (!closed_) {
+    flushes_.Abort(info.Env(), "Decoder is closed");
+  }
+  Shutdown();
+}
+
+void NativeVideoDecoder::Shutdown() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+  // The worker is gone, so nothing uses the pipeline any more
+  pipeline_ = nullptr;
+  pipelineRef_.Reset();
+  inFlight_ = 0;
+  tsfn_.Release();
+}
+
+void NativeVideoDecoder::TrackCommand(Napi::Env env) {
+  if (inFlight_++ == 0) {
+    tsfn_.Ref(env);
+  }
+}
+
+void NativeVideoDecoder::UntrackCommand(Napi::Env env) {
+  if (inFlight_ > 0 && --inFlight_ == 0) {
+    tsfn_.Unref(env);
+  }
+}
+
+void NativeVideoDecoder::DeliverEvent(Napi::Env env, Napi::Function output, Event* event) {
+  if (!closed_) {
+    switch (event->kind) {
+      case Event::Kind::kFrame: {
+        const char* format = PixelFormatName(SoftwareFormat(event->frame));
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("frame", NativeVideoFrame::NewInstance(env, event->frame));
+        result.Set("width", Napi::Number::New(env, event->frame->width));
+        result.Set("height", Napi::Number::New(env, event->frame->height));
+        result.Set("format", format ? Napi::Value(Napi::String::New(env, format)) : env.Null());
+        if (event->hasTimestamp) {
+          result.Set("timestamp", Napi::Number::New(env, static_cast<double>(event->timestamp)));
+        }
+        if (event->hasDuration) {
+          result.Set("duration", Napi::Number::New(env, static_cast<double>(event->duration)));
+        }
+        output.Call({result});
+        break;
+      }
+      case Event::Kind::kError:
+        errorCallback_.Call({Napi::Error::New(env, event->message).Value()});
+        break;
+      case Event::Kind::kDequeue:
+        UntrackCommand(env);
+        dequeueCallback_.Call({});
+        break;
+      case Event::Kind::kFlushed: {
+        UntrackCommand(env);
+        flushes_.Complete(env, event->flushId);
+        break;
+      }
+    }
+  }
+
+  av_frame_free(&event->frame);
+  delete event;
+}
+
+// ---------------------------------------------------------------------------
+// Worker thread
+// ---------------------------------------------------------------------------
+
+void NativeVideoDecoder::Post(Event* event) {
+  napi_status status = tsfn_.BlockingCall(event,
+    [this](Napi::Env env, Napi::Function output, Event* ev) { DeliverEvent(env, output, ev); });
+  if (status != napi_ok) {
+    av_frame_free(&event->frame);
+    delete event;
+  }
+}
+
+void NativeVideoDecoder::PostError(const std::string& message) {
+  stats_.CountError();
+  Event* event = new Event();
+  event->kind = Event::Kind::kError;
+  event->message = message;
+  Post(event);
+}
+
+void NativeVideoDecoder::HandleCommand(Command& cmd) {
+  stats_.Record(SessionStage::kQueue, cmd.enqueued);
+  switch (cmd.type) {
+    case CommandType::kDecode: {
+      DecodePacket(cmd);
+      packets_->Release(cmd.packet);
+      cmd.packet = nullptr;
+      if (cmd.reportDequeue) {
+        Event* event = new Event();
+        event->kind = Event::Kind::kDequeue;
+        Post(event);
+      }
+      break;
+    }
+    case CommandType::kFlush: {
+      DrainDecoder();
+      Event* event = new Event();
+      event->kind = Event::Kind::kFlushed;
+      event->flushId = cmd.flushId;
+      Post(event);
+      break;
+    }
+    case CommandType::kEncode:
+    case CommandType::kReconfigure:
+      break;
+  }
+}
+
+void NativeVideoDecoder::DecodePacket(Command& cmd) {
+  if (cmd.hasDuration) {
+    durations_[cmd.timestamp] = cmd.duration;
+  }
+
+  int ret;
+  {
+    SessionStats::StageTimer timer(&stats_, SessionStage::kSend);
+    ret = avcodec_send_packet(ctx_, cmd.packet);
+  }
+  if (ret < 0) {
+    PostError("Failed to send packet: " + AvErrorString(ret));
+    return;
+  }
+
+  std::string error;
+  SessionStats::StageTimer timer(&stats_, SessionStage::kReceive);
+  if (!ReceiveFrames(&error)) {
+    PostError(error);
+  }
+}
+
+/**
+ * Drain the decoder, then reset the codec buffers so decoding can resume
+ * with the next keyframe.
+ */
+void NativeVideoDecoder::DrainDecoder() {
+  int ret = avcodec_send_packet(ctx_, nullptr);
+  if (ret < 0 && ret != AVERROR_EOF) {
+    PostError("Failed to flush decoder: " + AvErrorString(ret));
+  } else {
+    std::string error;
+    SessionStats::StageTimer timer(&stats_, SessionStage::kReceive);
+    if (!ReceiveFrames(&error)) {
+      PostError(error);
+    }
+  }
+  avcodec_flush_buffers(ctx_);
+  durations_.clear();
+}
+
+/**
+ * Pull every frame the decoder has ready and post a reference to it to JS,
+ * or hand it to the attached pipeline.
+ */
+bool NativeVideoDecoder::ReceiveFrames(std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_frame(ctx_, frame_);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive frame: " + AvErrorString(ret);
+      return false;
+    }
+    stats_.CountOutput(DecodedBytes(frame_));
+
+    int64_t timestamp = frame_->best_effort_timestamp;
+    if (timestamp == AV_NOPTS_VALUE) {
+      timestamp = frame_->pts;
+    }
+    int64_t duration = 0;
+    bool hasDuration = false;
+    if (timestamp != AV_NOPTS_VALUE) {
+      auto found = durations_.find(timestamp);
+      if (found != durations_.end()) {
+        duration = found->second;
+        hasDuration = true;
+        durations_.erase(found);
+      }
+    }
+
+    if (NativeVideoPipeline* pipeline = pipeline_.load()) {
+      bool ok = pipeline->PushFrame(frame_, timestamp == AV_NOPTS_VALUE ? 0 : timestamp,
+                                    duration, hasDuration, false, error);
+      av_frame_unref(frame_);
+      if (!ok) {
+        return false;
+      }
+      continue;
+    }
+
+    Event* event = new Event();
+    event->kind = Event::Kind::kFrame;
+    event->frame = av_frame_alloc();
+    if (!event->frame) {
+      av_frame_unref(frame_);
+      delete event;
+      *error = "Failed to allocate frame";
+      return false;
+    }
+    if (timestamp != AV_NOPTS_VALUE) {
+      event->timestamp = timestamp;
+      event->hasTimestamp = true;
+    }
+    event->duration = duration;
+    event->hasDuration = hasDuration;
+
+    av_frame_move_ref(event->frame, frame_);
+    Post(event);
+  }
+}
@@ -0,0 +1,131 @@
+/**
+ * NativeVideoDecoder
+ *
+ * A long-lived decoder session for any codec in the codec registry (VP8,
+ * VP9, AV1, H.264). The AVCodecContext is opened once per configuration and
+ * packets are fed to it in decode order, so delta frames can reference the
+ * frames decoded before them.
+ *
+ * Decoding runs on a per-session WorkerThread. decode() and flush() only
+ * enqueue commands and never wait for room; frames, errors and queue
+ * progress come back to JS through a ThreadSafeFunction. Only
+ * EnqueuePacket(), called from the demuxer thread, blocks on a full queue.
+ */
+
+#ifndef WEBCODECS_NATIVE_VIDEO_DECODER_H_
+#define WEBCODECS_NATIVE_VIDEO_DECODER_H_
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "codec_registry.h"
+#include "buffer_pool.h"
+#include "packet_pool.h"
+#include "pending_flushes.h"
+#include "session_stats.h"
+#include "worker_thread.h"
+
+class NativeVideoPipeline;
+
+class NativeVideoDecoder : public Napi::ObjectWrap<NativeVideoDecoder> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeVideoDecoder(const Napi::CallbackInfo& info);
+  ~NativeVideoDecoder() override;
+
+  /**
+   * The session behind `value` if it is a NativeVideoDecoder, else nullptr.
+   */
+  static NativeVideoDecoder* FromValue(Napi::Value value);
+
+  /**
+   * Queue a packet from native code (NativeDemuxer) on any thread. The
+   * packet's pts must be in microseconds. No dequeue() is reported for it.
+   * In keyframesOnly mode, packets without AV_PKT_FLAG_KEY are dropped here.
+   * Blocks while the queue is full; takes ownership of `packet` and
+   * returns false once the session is closed.
+   */
+  bool EnqueuePacket(AVPacket* packet, int64_t duration, bool hasDuration);
+
+ private:
+  // Worker -> JS notification, delivered through tsfn_.
+  struct Event {
+    enum class Kind { kFrame, kError, kDequeue, kFlushed };
+    Kind kind;
+    AVFrame* frame = nullptr;  // Owned reference to the decoded picture
+    int64_t timestamp = 0;
+    bool hasTimestamp = false;
+    int64_t duration = 0;
+    bool hasDuration = false;
+    std::string message;
+    uint32_t flushId = 0;
+  };
+
+  // JS thread
+  Napi::Value Decode(const Napi::CallbackInfo& info);
+  Napi::Value GetPoolStats(const Napi::CallbackInfo& info);
+  Napi::Value GetHardwareAccelerated(const Napi::CallbackInfo& info);
+  Napi::Value GetLowres(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  Napi::Value Flush(const Napi::CallbackInfo& info);
+  Napi::Value SetPipeline(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  void DeliverEvent(Napi::Env env, Napi::Function output, Event* event);
+  void TrackCommand(Napi::Env env);
+  void UntrackCommand(Napi::Env env);
+  void Shutdown();
+
+  // Worker thread
+  void HandleCommand(Command& cmd);
+  void DecodePacket(Command& cmd);
+  void DrainDecoder();
+  bool ReceiveFrames(std::string* error);
+  void Post(Event* event);
+  void PostError(const std::string& message);
+
+  bool OpenCodec(std::string* error);
+  void ReleaseCodec();
+
+  AVCodecContext* ctx_ = nullptr;
+  AVFrame* frame_ = nullptr;
+  VideoCodecSpec codec_;
+  std::vector<uint8_t> description_;  // Codec extradata, e.g. avcC
+  HardwarePreference hardware_ = HardwarePreference::kNoPreference;
+  FastDecodeOptions fast_;
+  bool hardwareAccelerated_ = false;
+  int lowres_ = 0;
+
+  // Chunk durations keyed by timestamp, restored onto the decoded frames.
+  std::map<int64_t, int64_t> durations_;
+
+  // Written by the worker, the JS thread and EnqueuePacket() callers.
+  SessionStats stats_;
+
+  // Input packets; shells come back after each decode.
+  std::shared_ptr<PoolBudget> budget_;
+  std::unique_ptr<PacketPool> packets_;
+
+  // Set once by setPipeline(); frames then go to its encoders instead of JS.
+  std::atomic<NativeVideoPipeline*> pipeline_{nullptr};
+  Napi::ObjectReference pipelineRef_;
+
+  std::unique_ptr<WorkerThread> worker_;
+  Napi::ThreadSafeFunction tsfn_;
+  Napi::FunctionReference errorCallback_;
+  Napi::FunctionReference dequeueCallback_;
+  PendingFlushes flushes_;
+  uint32_t inFlight_ = 0;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_VIDEO_DECODER_H_
@@ -0,0 +1,888 @@
+/**
+ * NativeVideoEncoder implementation.
+ *
+ * new NativeVideoEncoder({ codec?, width, height, bitrate?, bitrateMode?, framerate?,
+ *                          gopSize?, hardwareAcceleration?, latencyMode?, threads?,
+ *                          maxQueueDepth?, poolMemoryLimit? },
+ *                        { output(packet), error(err), dequeue() })
+ *   hardwareAccelerated -> whether the opened encoder runs on hardware
+ *   poolStats -> { pooledBytes, limit, allocations, reuses, overflows }
+ *   encodeQueueSize -> commands waiting for the worker
+ *   droppedFrames -> frames encode() refused in realtime mode
+ *   getStats() -> counters and per-stage latency histograms; see SessionStats
+ *   encode(frame: NativeVideoFrame | Buffer, { timestamp, duration?, keyFrame?, format?, quantizer? }) -> queued
+ *   flush(done?: () => void) -> Promise<void> when no callback is given
+ *   reconfigure({ bitrate })
+ *   setMuxer(muxer: NativeMuxer)
+ *   close()
+ *
+ * A NativeVideoPipeline feeds frames of any size through EnqueueFrame();
+ * they are cropped, rotated and scaled on the worker.
+ * GPU frames go straight to a surface encoder (VA-API, QSV) on the same or
+ * a mappable device when they need no transform; they are only downloaded
+ * for software encoders, transforms and surfaces that cannot be mapped.
+ *
+ * codec is a WebCodecs codec string and defaults to 'vp8'.
+ * bitrateMode is 'variable' (default), 'constant' or 'quantizer'; in
+ * quantizer mode bitrate is ignored and each encode() may pass the
+ * codec's quantizer (0-63, or 0-51 for H.264). libx264 takes a new
+ * quantizer on any frame; other encoders only between flush() calls, and
+ * encode() throws if it changes mid-stream.
+ * Frames are timed by their timestamps, so rate control follows the real
+ * frame spacing; framerate is only a hint.
+ * reconfigure() changes the bitrate from the next queued frame on. libx264,
+ * NVENC and QSV take it without a new keyframe. libvpx (VP8, VP9), libaom
+ * and the other encoders can only be drained and reopened, so each change
+ * costs a keyframe there. It is ignored in quantizer mode.
+ * latencyMode is 'quality' (default) or 'realtime', which selects the
+ * encoder's real-time speed preset and disables lookahead and frame
+ * threading. threads overrides the thread count picked from the frame size.
+ * packet is { data: Buffer, isKeyframe, size, timestamp, duration? }.
+ * H.264 packets are Annex B with in-band SPS/PPS on keyframes.
+ * A NativeVideoFrame is encoded without copying its pixels. A Buffer is a
+ * tightly packed image; `format` can be 'I420' (default), 'RGB24', 'RGBA', ...
+ * dequeue() fires once per encode() after the worker has consumed it.
+ * encode() never blocks the JS thread; encodeQueueSize and dequeue() carry
+ * the backpressure, as in WebCodecs. maxQueueDepth (default 16) is the depth
+ * past which realtime mode drops a frame that is not a requested keyframe
+ * (encode() then returns false); in quality mode the queue grows past it.
+ * poolMemoryLimit caps the bytes the session's frame and packet pools keep
+ * around (default unlimited); past it, buffers are allocated per frame.
+ * After setMuxer(), packets are written to the muxer on the worker and
+ * output() is no longer called.
+ */
+
+#include "video_encoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/rational.h>
+}
+
+#include "addon_data.h"
+#include "codec_registry.h"
+#include "external_buffer.h"
+#include "ffmpeg_utils.h"
+#include "hw_device.h"
+#include "muxer.h"
+#include "pixel_convert.h"
+#include "pixel_format.h"
+#include "video_frame.h"
+
+namespace {
+
+// Default for maxQueueDepth: raw frames waiting for the worker.
+constexpr size_t kDefaultQueueDepth = 16;
+
+// Smallest pooled packet buffer; larger frames get a quarter of a raw frame.
+constexpr size_t kMinPacketBufferSize = 64 * 1024;
+
+constexpr AVRational kMicroseconds = {1, 1000000};
+
+// Just above AV_NOPTS_VALUE, so any timestamp can be the first PTS.
+constexpr int64_t kFirstPts = INT64_MIN + 1;
+
+}  // namespace
+
+Napi::Object NativeVideoEncoder::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeVideoEncoder", {
+    InstanceMethod("encode", &NativeVideoEncoder::Encode),
+    InstanceAccessor("hardwareAccelerated", &NativeVideoEncoder::GetHardwareAccelerated, nullptr),
+    InstanceAccessor("poolStats", &NativeVideoEncoder::GetPoolStats, nullptr),
+    InstanceAccessor("encodeQueueSize", &NativeVideoEncoder::GetEncodeQueueSize, nullptr),
+    InstanceAccessor("droppedFrames", &NativeVideoEncoder::GetDroppedFrames, nullptr),
+    InstanceMethod("getStats", &NativeVideoEncoder::GetStats),
+    InstanceMethod("flush", &NativeVideoEncoder::Flush),
+    InstanceMethod("reconfigure", &NativeVideoEncoder::Reconfigure),
+    InstanceMethod("setMuxer", &NativeVideoEncoder::SetMuxer),
+    InstanceMethod("close", &NativeVideoEncoder::Close),
+  });
+
+  AddonData::Get(env)->videoEncoder = Napi::Persistent(func);
+
+  exports.Set("NativeVideoEncoder", func);
+  return exports;
+}
+
+NativeVideoEncoder* NativeVideoEncoder::FromValue(Napi::Value value) {
+  if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(AddonData::Get(value.Env())->videoEncoder.Value())) {
+    return nullptr;
+  }
+  return Unwrap(value.As<Napi::Object>());
+}
+
+NativeVideoEncoder::NativeVideoEncoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeVideoEncoder>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected ({codec?, width, height, bitrate?, framerate?}, {output, error, dequeue})").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Object config = info[0].As<Napi::Object>();
+  Napi::Object callbacks = info[1].As<Napi::Object>();
+  if (!callbacks.Get("output").IsFunction() || !callbacks.Get("error").IsFunction() ||
+      !callbacks.Get("dequeue").IsFunction()) {
+    Napi::TypeError::New(env, "Encoder callbacks require output, error and dequeue functions").ThrowAsJavaScriptException();
+    return;
+  }
+  if (!config.Get("width").IsNumber() || !config.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Encoder config requires numeric width and height").ThrowAsJavaScriptException();
+    return;
+  }
+
+  std::string codec = "vp8";
+  if (config.Get("codec").IsString()) {
+    codec = config.Get("codec").As<Napi::String>().Utf8Value();
+  }
+  std::string error;
+  if (!ParseVideoCodec(codec, &codec_, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  width_ = config.Get("width").As<Napi::Number>().Int32Value();
+  height_ = config.Get("height").As<Napi::Number>().Int32Value();
+  if (width_ <= 0 || height_ <= 0) {
+    Napi::RangeError::New(env, "Encoder width and height must be positive").ThrowAsJavaScriptException();
+    return;
+  }
+
+  if (config.Get("bitrate").IsNumber()) {
+    bitrate_ = config.Get("bitrate").As<Napi::Number>().Int64Value();
+  }
+  if (config.Get("bitrateMode").IsString() &&
+      !ParseBitrateMode(config.Get("bitrateMode").As<Napi::String>().Utf8Value(), &bitrateMode_)) {
+    Napi::TypeError::New(env, "Invalid bitrateMode").ThrowAsJavaScriptException();
+    return;
+  }
+  if (config.Get("framerate").IsNumber()) {
+    double fps = config.Get("framerate").As<Napi::Number>().DoubleValue();
+    if (fps > 0) {
+      framerate_ = av_d2q(fps, 1001000);
+    }
+  }
+  if (config.Get("gopSize").IsNumber()) {
+    gopSize_ = config.Get("gopSize").As<Napi::Number>().Int32Value();
+  }
+  if (config.Get("hardwareAcceleration").IsString() &&
+      !ParseHardwarePreference(config.Get("hardwareAcceleration").As<Napi::String>().Utf8Value(), &hardware_)) {
+    Napi::TypeError::New(env, "Invalid hardwareAcceleration").ThrowAsJavaScriptException();
+    return;
+  }
+  if (config.Get("latencyMode").IsString() &&
+      !ParseLatencyMode(config.Get("latencyMode").As<Napi::String>().Utf8Value(), &latencyMode_)) {
+    Napi::TypeError::New(env, "Invalid latencyMode").ThrowAsJavaScriptException();
+    return;
+  }
+  if (config.Get("threads").IsNumber()) {
+    threads_ = config.Get("threads").As<Napi::Number>().Int32Value();
+    if (threads_ < 0) {
+      Napi::RangeError::New(env, "Encoder threads must not be negative").ThrowAsJavaScriptException();
+      return;
+    }
+  }
+  queueDepth_ = kDefaultQueueDepth;
+  if (config.Get("maxQueueDepth").IsNumber()) {
+    int64_t depth = config.Get("maxQueueDepth").As<Napi::Number>().Int64Value();
+    if (depth < 1) {
+      Napi::RangeError::New(env, "maxQueueDepth must be at least 1").ThrowAsJavaScriptException();
+      return;
+    }
+    queueDepth_ = static_cast<size_t>(depth);
+  }
+  size_t poolLimit = 0;
+  if (!PoolLimitFromConfig(config, &poolLimit, &error)) {
+    Napi::RangeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+
+  budget_ = std::make_shared<PoolBudget>(poolLimit);
+  int frameBytes = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, width_, height_, 1);
+  packets_ = std::make_unique<PacketPool>(
+    std::max(static_cast<size_t>(std::max(frameBytes, 0)) / 4, kMinPacketBufferSize), budget_);
+  inputPool_ = std::make_unique<FramePool>(AV_PIX_FMT_YUV420P, width_, height_, budget_);
+
+  // Open synchronously so configuration errors surface from the constructor.
+  if (!OpenCodec(&error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  hardwareAccelerated_ = IsHardwareContext(ctx_);
+  takesSurfaces_ = ctx_->hw_frames_ctx != nullptr;
+  liveQuantizer_ = SupportsLiveQuantizer(ctx_);
+  stagingPool_ = std::make_unique<FramePool>(EncoderInputFormat(ctx_), width_, height_, budget_);
+
+  errorCallback_ = Napi::Persistent(callbacks.Get("error").As<Napi::Function>());
+  dequeueCallback_ = Napi::Persistent(callbacks.Get("dequeue").As<Napi::Function>());
+
+  // The session keeps itself alive until the TSFN has delivered its last
+  // event, so queued callbacks never outlive the object.
+  Ref();
+  tsfn_ = Napi::ThreadSafeFunction::New(
+    env, callbacks.Get("output").As<Napi::Function>(), "NativeVideoEncoder", 0, 1,
+    [this](Napi::Env) { Unref(); });
+  // Only hold the event loop open while work is in flight.
+  tsfn_.Unref(env);
+
+  worker_ = std::make_unique<WorkerThread>(queueDepth_);
+  worker_->Start([this](Command& cmd) { HandleCommand(cmd); });
+}
+
+NativeVideoEncoder::~NativeVideoEncoder() {
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+}
+
+/**
+ * Open the encoder context for the stored configuration.
+ * Called from the constructor and again after a flush, because encoders
+ * cannot accept new frames once they have been drained.
+ */
+bool NativeVideoEncoder::OpenCodec(std::string* error) {
+  SessionStats::StageTimer timer(&stats_, SessionStage::kOpen);
+  VideoEncoderSettings settings;
+  settings.width = width_;
+  settings.height = height_;
+  settings.bitrate = bitrate_;
+  settings.bitrateMode = bitrateMode_;
+  settings.quantizer = quantizer_;
+  settings.framerate = framerate_;
+  settings.timeBase = kMicroseconds;
+  settings.gopSize = gopSize_;
+  settings.hardware = hardware_;
+  settings.latencyMode = latencyMode_;
+  settings.threads = threads_;
+  settings.packets = packets_.get();
+
+  ctx_ = OpenVideoEncoder(codec_, settings, error);
+  if (!ctx_) {
+    return false;
+  }
+
+  packet_ = av_packet_alloc();
+  if (!packet_) {
+    avcodec_free_context(&ctx_);
+    *error = "Failed to allocate packet";
+    return false;
+  }
+
+  nextPts_ = kFirstPts;
+  timings_.clear();
+  return true;
+}
+
+void NativeVideoEncoder::ReleaseCodec() {
+  av_packet_free(&packet_);
+  avcodec_free_context(&ctx_);
+  timings_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// JS thread
+// ---------------------------------------------------------------------------
+
+Napi::Value NativeVideoEncoder::Encode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || (!info[0].IsBuffer() && !NativeVideoFrame::FrameFromValue(info[0]))) {
+    Napi::TypeError::New(env, "Expected (NativeVideoFrame | Buffer, {timestamp, duration?, keyFrame?, format?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object options = (info.Length() >= 2 && info[1].IsObject())
+    ? info[1].As<Napi::Object>()
+    : Napi::Object::New(env);
+
+  Command cmd;
+  cmd.type = CommandType::kEncode;
+  if (options.Get("timestamp").IsNumber()) {
+    cmd.timestamp = options.Get("timestamp").As<Napi::Number>().Int64Value();
+  }
+  if (options.Get("duration").IsNumber()) {
+    cmd.duration = options.Get("duration").As<Napi::Number>().Int64Value();
+    cmd.hasDuration = true;
+  }
+  cmd.keyFrame = options.Get("keyFrame").ToBoolean().Value();
+  if (bitrateMode_ == BitrateMode::kQuantizer && options.Get("quantizer").IsNumber()) {
+    cmd.quantizer = options.Get("quantizer").As<Napi::Number>().Int32Value();
+    if (cmd.quantizer < 0 || cmd.quantizer > MaxQuantizer(codec_.id)) {
+      Napi::RangeError::New(env, "quantizer must be between 0 and " + std::to_string(MaxQuantizer(codec_.id)))
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    // Anywhere but libx264 this would take a reopen and a keyframe
+    if (streamStarted_ && !liveQuantizer_ && cmd.quantizer != streamQuantizer_) {
+      Napi::Error::New(env, "This encoder cannot change the quantizer mid-stream; flush() first")
+        .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  // Only this thread pushes, so a queue below the limit stays below it
+  // until EnqueueNow() below. Dropping here also skips the input copy.
+  if (latencyMode_ == LatencyMode::kRealtime && !cmd.keyFrame &&
+      worker_->QueueSize() >= queueDepth_) {
+    stats_.CountDrop();
+    return Napi::Boolean::New(env, false);
+  }
+
+  size_t inputBytes = 0;
+  if (const AVFrame* source = NativeVideoFrame::FrameFromValue(info[0])) {
+    // Zero-copy: the worker gets its own reference to the frame's buffers.
+    if (source->width != width_ || source->height != height_) {
+      Napi::TypeError::New(env, "Frame size does not match encoder configuration").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    // Negative for GPU frames, whose size is not known here
+    int frameBytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(source->format), width_, height_, 1);
+    inputBytes = frameBytes > 0 ? static_cast<size_t>(frameBytes) : 0;
+    cmd.frame = av_frame_alloc();
+    if (!cmd.frame || av_frame_ref(cmd.frame, source) < 0) {
+      av_frame_free(&cmd.frame);
+      Napi::Error::New(env, "Failed to reference frame").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  } else {
+    // The JS buffer cannot be read from the worker, so copy it into an
+    // AVFrame here. Non-I420 input is converted on the worker.
+    std::string format = "I420";
+    if (options.Get("format").IsString()) {
+      format = options.Get("format").As<Napi::String>().Utf8Value();
+    }
+    AVPixelFormat pixelFormat = PixelFormatFromString(format);
+    if (pixelFormat == AV_PIX_FMT_NONE) {
+      Napi::TypeError::New(env, "Unsupported frame format: " + format).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Buffer<uint8_t> inputBuffer = info[0].As<Napi::Buffer<uint8_t>>();
+    std::vector<PlaneLayout> planes;
+    if (inputBuffer.Length() != PackedLayout(pixelFormat, width_, height_, &planes)) {
+      Napi::TypeError::New(env, format + " buffer size mismatch").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    std::string error;
+    {
+      SessionStats::StageTimer timer(&stats_, SessionStage::kCopy);
+      cmd.frame = NativeVideoFrame::CopyFromBuffer(inputBuffer.Data(), inputBuffer.Length(),
+                                                   pixelFormat, width_, height_, &error,
+                                                   inputPool_.get());
+    }
+    inputBytes = inputBuffer.Length();
+    if (!cmd.frame) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    UntrackCommand(env);
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  streamStarted_ = true;
+  if (cmd.quantizer >= 0) {
+    streamQuantizer_ = cmd.quantizer;
+  }
+  stats_.CountInput(inputBytes);
+  stats_.RecordQueueDepth(worker_->QueueSize());
+  return Napi::Boolean::New(env, true);
+}
+
+NativeVideoEncoder::EnqueueResult NativeVideoEncoder::EnqueueFrame(
+    const AVFrame* frame, const FrameTransform& transform, int64_t timestamp, int64_t duration,
+    bool hasDuration, bool keyFrame) {
+  if (!worker_ ||
+      (latencyMode_ == LatencyMode::kRealtime && !keyFrame && worker_->QueueSize() >= queueDepth_)) {
+    stats_.CountDrop();
+    return EnqueueResult::kDropped;
+  }
+
+  Command cmd;
+  cmd.type = CommandType::kEncode;
+  cmd.timestamp = timestamp;
+  cmd.duration = duration;
+  cmd.hasDuration = hasDuration;
+  cmd.keyFrame = keyFrame;
+  cmd.reportDequeue = false;
+  // Frames that already have the encoder's size only need a format conversion
+  cmd.transformInput = NeedsTransform(frame, transform);
+  cmd.transform = transform;
+  cmd.frame = av_frame_alloc();
+  if (!cmd.frame || av_frame_ref(cmd.frame, frame) < 0) {
+    av_frame_free(&cmd.frame);
+    return EnqueueResult::kFailed;
+  }
+  int frameBytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format),
+                                            frame->width, frame->height, 1);
+  if (!worker_->EnqueueNow(cmd)) {
+    // Closed while the pipeline was still feeding it
+    stats_.CountDrop();
+    return EnqueueResult::kDropped;
+  }
+  stats_.CountInput(frameBytes > 0 ? static_cast<size_t>(frameBytes) : 0);
+  stats_.RecordQueueDepth(worker_->QueueSize());
+  return EnqueueResult::kQueued;
+}
+
+bool NativeVideoEncoder::TakesSurface(const AVFrame* frame, const FrameTransform& transform) const {
+  return takesSurfaces_ && !NeedsTransform(frame, transform);
+}
+
+bool NativeVideoEncoder::NeedsTransform(const AVFrame* frame, const FrameTransform& transform) const {
+  return transform.crop || transform.rotation != 0 || frame->width != width_ || frame->height != height_;
+}
+
+bool NativeVideoEncoder::HasRoom() const {
+  return !worker_ || latencyMode_ == LatencyMode::kRealtime || worker_->QueueSize() < queueDepth_;
+}
+
+Napi::Value NativeVideoEncoder::GetHardwareAccelerated(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(), hardwareAccelerated_);
+}
+
+Napi::Value NativeVideoEncoder::GetPoolStats(const Napi::CallbackInfo& info) {
+  return PoolStatsToObject(info.Env(), budget_->GetStats());
+}
+
+Napi::Value NativeVideoEncoder::GetEncodeQueueSize(const Napi::CallbackInfo& info) {
+  size_t size = worker_ && !closed_ ? worker_->QueueSize() : 0;
+  return Napi::Number::New(info.Env(), static_cast<double>(size));
+}
+
+Napi::Value NativeVideoEncoder::GetDroppedFrames(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), static_cast<double>(stats_.Dropped()));
+}
+
+Napi::Value NativeVideoEncoder::GetStats(const Napi::CallbackInfo& info) {
+  size_t queueDepth = worker_ && !closed_ ? worker_->QueueSize() : 0;
+  return stats_.ToObject(info.Env(), queueDepth);
+}
+
+/**
+ * Queue a drain. Once every packet produced by earlier encode() calls has
+ * been delivered to output(), `done` runs on the JS thread or, without a
+ * callback, the returned promise resolves. close() rejects the promise.
+ */
+Napi::Value NativeVideoEncoder::Flush(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Value done = info.Length() >= 1 ? info[0] : env.Undefined();
+  if (!done.IsFunction() && !done.IsUndefined()) {
+    Napi::TypeError::New(env, "Expected flush completion callback").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Command cmd;
+  cmd.type = CommandType::kFlush;
+  Napi::Value result;
+  cmd.flushId = flushes_.Add(env, done, &result);
+
+  TrackCommand(env);
+  if (!worker_->EnqueueNow(cmd)) {
+    flushes_.Remove(cmd.flushId);
+    UntrackCommand(env);
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  // The codec is reopened after the drain, so the next frame may pick any quantizer
+  streamStarted_ = false;
+  streamQuantizer_ = -1;
+  return result;
+}
+
+/**
+ * Queue a new target bitrate behind the frames already queued. It never
+ * blocks or gets dropped. Only encoders that take it live (libx264, NVENC,
+ * QSV) suit per-second adaptation; the rest restart at a keyframe on every
+ * change. Ignored in quantizer mode.
+ */
+Napi::Value NativeVideoEncoder::Reconfigure(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsObject() || !info[0].As<Napi::Object>().Get("bitrate").IsNumber()) {
+    Napi::TypeError::New(env, "Expected ({bitrate})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Command cmd;
+  cmd.type = CommandType::kReconfigure;
+  cmd.bitrate = info[0].As<Napi::Object>().Get("bitrate").As<Napi::Number>().Int64Value();
+  if (cmd.bitrate <= 0) {
+    Napi::RangeError::New(env, "bitrate must be positive").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (bitrateMode_ == BitrateMode::kQuantizer) {
+    return env.Undefined();
+  }
+  if (!worker_->EnqueueNow(cmd)) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+/**
+ * Route packets to `muxer` from now on. An encoder keeps its muxer for the
+ * rest of the session.
+ */
+Napi::Value NativeVideoEncoder::SetMuxer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (closed_) {
+    Napi::Error::New(env, "Encoder is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  NativeMuxer* muxer = info.Length() >= 1 ? NativeMuxer::FromValue(info[0]) : nullptr;
+  if (!muxer) {
+    Napi::TypeError::New(env, "Expected a NativeMuxer").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (muxer_) {
+    Napi::Error::New(env, "Encoder already has a muxer").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::string error;
+  if (!muxer->AttachTrack(&error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  muxerRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+  muxer_ = muxer;
+  return env.Undefined();
+}
+
+void NativeVideoEncoder::Close(const Napi::CallbackInfo& info) {
+  if (!closed_) {
+    flushes_.Abort(info.Env(), "Encoder is closed");
+  }
+  Shutdown();
+}
+
+/**
+ * Stop the worker and release the codec. Events already queued on the TSFN
+ * are discarded when they arrive; the TSFN finalizer drops our self-reference.
+ */
+void NativeVideoEncoder::Shutdown() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  if (worker_) {
+    worker_->Stop();
+  }
+  ReleaseCodec();
+  // The worker is gone, so nothing uses the muxer any more
+  muxer_ = nullptr;
+  muxerRef_.Reset();
+  inFlight_ = 0;
+  tsfn_.Release();
+}
+
+void NativeVideoEncoder::TrackCommand(Napi::Env env) {
+  if (inFlight_++ == 0) {
+    tsfn_.Ref(env);
+  }
+}
+
+void NativeVideoEncoder::UntrackCommand(Napi::Env env) {
+  if (inFlight_ > 0 && --inFlight_ == 0) {
+    tsfn_.Unref(env);
+  }
+}
+
+void NativeVideoEncoder::DeliverEvent(Napi::Env env, Napi::Function output, Event* event) {
+  if (!closed_) {
+    switch (event->kind) {
+      case Event::Kind::kPacket: {
+        Napi::Object chunk = Napi::Object::New(env);
+        chunk.Set("isKeyframe", Napi::Boolean::New(env, (event->packet->flags & AV_PKT_FLAG_KEY) != 0));
+        chunk.Set("size", Napi::Number::New(env, event->packet->size));
+        // Zero-copy: the Buffer keeps the packet's payload alive
+        chunk.Set("data", PacketToBuffer(env, event->packet));
+        if (event->hasTiming) {
+          chunk.Set("timestamp", Napi::Number::New(env, static_cast<double>(event->timing.timestamp)));
+          if (event->timing.hasDuration) {
+            chunk.Set("duration", Napi::Number::New(env, static_cast<double>(event->timing.duration)));
+          }
+        }
+        output.Call({chunk});
+        break;
+      }
+      case Event::Kind::kError:
+        errorCallback_.Call({Napi::Error::New(env, event->message).Value()});
+        break;
+      case Event::Kind::kDequeue:
+        UntrackCommand(env);
+        dequeueCallback_.Call({});
+        break;
+      case Event::Kind::kFlushed: {
+        UntrackCommand(env);
+        flushes_.Complete(env, event->flushId);
+        break;
+      }
+    }
+  }
+
+  packets_->Release(event->packet);
+  delete event;
+}
+
+// ---------------------------------------------------------------------------
+// Worker thread
+// ---------------------------------------------------------------------------
+
+void NativeVideoEncoder::Post(Event* event) {
+  napi_status status = tsfn_.BlockingCall(event,
+    [this](Napi::Env env, Napi::Function output, Event* ev) { DeliverEvent(env, output, ev); });
+  if (status != napi_ok) {
+    packets_->Release(event->packet);
+    delete event;
+  }
+}
+
+void NativeVideoEncoder::PostError(const std::string& message) {
+  stats_.CountError();
+  Event* event = new Event();
+  event->kind = Event::Kind::kError;
+  event->message = message;
+  Post(event);
+}
+
+void NativeVideoEncoder::HandleCommand(Command& cmd) {
+  stats_.Record(SessionStage::kQueue, cmd.enqueued);
+  switch (cmd.type) {
+    case CommandType::kEncode: {
+      EncodeFrame(cmd);
+      // Keep the input frame's shell for the next encode(Buffer) copy
+      inputPool_->Release(cmd.frame);
+      cmd.frame = nullptr;
+      if (cmd.reportDequeue) {
+        Event* event = new Event();
+        event->kind = Event::Kind::kDequeue;
+        Post(event);
+      }
+      break;
+    }
+    case CommandType::kFlush: {
+      DrainEncoder();
+      Event* event = new Event();
+      event->kind = Event::Kind::kFlushed;
+      event->flushId = cmd.flushId;
+      Post(event);
+      break;
+    }
+    case CommandType::kReconfigure:
+      UpdateRate(cmd.bitrate, quantizer_);
+      break;
+    case CommandType::kDecode:
+      break;
+  }
+}
+
+/**
+ * Switch to new rate targets before the next frame. Encoders that cannot
+ * take them live are drained and reopened with them, unless nothing has
+ * been sent to the open context yet. Encode() refuses quantizer changes
+ * that would need the reopen, so only bitrate changes pay for it.
+ */
+void NativeVideoEncoder::UpdateRate(int64_t bitrate, int quantizer) {
+  if (bitrate == bitrate_ && quantizer == quantizer_) {
+    return;
+  }
+  bitrate_ = bitrate;
+  quantizer_ = quantizer;
+  if (!ctx_ || UpdateRateControl(ctx_, bitrateMode_, bitrate_, quantizer_)) {
+    return;
+  }
+  if (nextPts_ == kFirstPts) {
+    ReleaseCodec();
+  } else {
+    DrainEncoder();
+  }
+}
+
+void NativeVideoEncoder::EncodeFrame(Command& cmd) {
+  std::string error;
+  if (cmd.quantizer >= 0) {
+    UpdateRate(bitrate_, cmd.quantizer);
+  }
+  if (!ctx_ && !OpenCodec(&error)) {
+    PostError(error);
+    return;
+  }
+
+  // Stage the input into what the codec takes. A GPU frame that needs no
+  // transform is mapped onto the encoder's surfaces where it can be; any
+  // other input is downloaded, converted to the encoder's pixel format
+  // (cropping, rotating and scaling pipeline input on the way), then
+  // uploaded for surface-only encoders.
+  AVFrame* frame = cmd.frame;
+  AVFrame* staged = nullptr;
+  auto stage = [&](AVFrame* next) {
+    stagingPool_->Release(staged);
+    staged = frame = next;
+    return next != nullptr;
+  };
+  AVPixelFormat inputFormat = EncoderInputFormat(ctx_);
+  bool ready;
+  {
+    SessionStats::StageTimer timer(&stats_, SessionStage::kConvert);
+    AVFrame* surface = frame->hw_frames_ctx && ctx_->hw_frames_ctx && !cmd.transformInput
+      ? MapFrame(ctx_->hw_frames_ctx, frame)
+      : nullptr;
+    ready = surface
+      ? stage(surface)
+      : (!frame->hw_frames_ctx || stage(DownloadFrame(frame, &error))) &&
+        (cmd.transformInput
+           ? stage(TransformFrame(frame, cmd.transform, inputFormat, width_, height_, stagingPool_.get(), &error))
+           : (frame->format == inputFormat || stage(ConvertFrameFormat(frame, inputFormat, &error, stagingPool_.get())))) &&
+        (!ctx_->hw_frames_ctx || stage(UploadFrame(ctx_->hw_frames_ctx, frame, &error)));
+  }
+  if (!ready) {
+    PostError(error);
+    return;
+  }
+
+  // PTS is the timestamp in microseconds, nudged forward where timestamps
+  // repeat or go back, since encoders need them strictly increasing. The
+  // caller's exact timing is restored from timings_ on the packet.
+  frame->pts = std::max(cmd.timestamp, nextPts_);
+  nextPts_ = frame->pts + 1;
+  frame->pict_type = cmd.keyFrame ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+  timings_[frame->pts] = {cmd.timestamp, cmd.duration, cmd.hasDuration};
+
+  int ret;
+  {
+    SessionStats::StageTimer timer(&stats_, SessionStage::kSend);
+    ret = avcodec_send_frame(ctx_, frame);
+  }
+  stagingPool_->Release(staged);
+  if (ret < 0) {
+    PostError("Failed to send frame: " + AvErrorString(ret));
+    return;
+  }
+
+  SessionStats::StageTimer timer(&stats_, SessionStage::kReceive);
+  if (!ReceivePackets(&error)) {
+    PostError(error);
+  }
+}
+
+/**
+ * Drain the encoder. The context is released afterwards and reopened on the
+ * next encode().
+ */
+void NativeVideoEncoder::DrainEncoder() {
+  if (!ctx_) {
+    return;
+  }
+
+  int ret = avcodec_send_frame(ctx_, nullptr);
+  if (ret < 0 && ret != AVERROR_EOF) {
+    PostError("Failed to flush encoder: " + AvErrorString(ret));
+  } else {
+    std::string error;
+    SessionStats::StageTimer timer(&stats_, SessionStage::kReceive);
+    if (!ReceivePackets(&error)) {
+      PostError(error);
+    }
+  }
+  ReleaseCodec();
+}
+
+/**
+ * Pull every packet the encoder has ready and post it to JS.
+ */
+bool NativeVideoEncoder::ReceivePackets(std::string* error) {
+  while (true) {
+    int ret = avcodec_receive_packet(ctx_, packet_);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+      return true;
+    }
+    if (ret < 0) {
+      *error = "Failed to receive packet: " + AvErrorString(ret);
+      return false;
+    }
+    stats_.CountOutput(static_cast<size_t>(packet_->size));
+
+    if (NativeMuxer* muxer = muxer_.load()) {
+      bool ok = MuxPacket(muxer, error);
+      av_packet_unref(packet_);
+      if (!ok) {
+        return false;
+      }
+      continue;
+    }
+
+    Event* event = new Event();
+    event->kind = Event::Kind::kPacket;
+    event->packet = packets_->Acquire();
+    if (!event->packet) {
+      delete event;
+      *error = "Failed to allocate packet";
+      return false;
+    }
+    av_packet_move_ref(event->packet, packet_);
+
+    auto timing = timings_.find(event->packet->pts);
+    if (timing != timings_.end()) {
+      event->timing = timing->second;
+      event->hasTiming = true;
+      timings_.erase(timing);
+    }
+
+    Post(event);
+  }
+}
+
+/**
+ * Write packet_ to `muxer`, with the caller's timestamps restored and the
+ * codec's reordering delay kept between dts and pts.
+ */
+bool NativeVideoEncoder::MuxPacket(NativeMuxer* muxer, std::string* error) {
+  int64_t codecPts = packet_->pts;
+  int64_t pts = av_rescale_q(codecPts, ctx_->time_base, kMicroseconds);
+  int64_t duration = av_rescale_q(packet_->duration, ctx_->time_base, kMicroseconds);
+  auto timing = timings_.find(codecPts);
+  if (timing != timings_.end()) {
+    pts = timing->second.timestamp;
+    if (timing->second.hasDuration) {
+      duration = timing->second.duration;
+    }
+    timings_.erase(timing);
+  }
+
+  // Keep the encoder's reordering delay, if any, between dts and pts
+  int64_t dts = pts;
+  if (packet_->dts != AV_NOPTS_VALUE && codecPts != AV_NOPTS_VALUE) {
+    dts = pts - av_rescale_q(codecPts - packet_->dts, ctx_->time_base, kMicroseconds);
+  }
+
+  packet_->pts = pts;
+  packet_->dts = dts;
+  packet_->duration = duration;
+  return muxer->WritePacket(ctx_, packet_, error);
+}
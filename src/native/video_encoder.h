@@ -0,0 +1,194 @@
+/**
+ * NativeVideoEncoder
+ *
+ * A long-lived encoder session for any codec in the codec registry (VP8,
+ * VP9, AV1, H.264). The AVCodecContext is opened once per configuration and
+ * every encode() call feeds a frame into the same context, so the codec can
+ * use inter-frame prediction and only emits keyframes on the GOP boundary
+ * or when the caller asks for one.
+ *
+ * Encoding runs on the session's WorkerThread lane of the shared codec
+ * scheduler. encode() and flush() only enqueue commands and never wait for
+ * room; packets, errors and queue progress come back to JS through a
+ * ThreadSafeFunction.
+ *
+ * Input copies, pixel format conversions and output packets are drawn from
+ * per-session pools, so a steady stream of frames reuses the same buffers
+ * instead of allocating per frame.
+ */
+
+#ifndef WEBCODECS_NATIVE_VIDEO_ENCODER_H_
+#define WEBCODECS_NATIVE_VIDEO_ENCODER_H_
+
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#include "buffer_pool.h"
+#include "codec_registry.h"
+#include "frame_pool.h"
+#include "frame_transform.h"
+#include "packet_pool.h"
+#include "pending_flushes.h"
+#include "session_stats.h"
+#include "worker_thread.h"
+
+class NativeMuxer;
+
+class NativeVideoEncoder : public Napi::ObjectWrap<NativeVideoEncoder> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeVideoEncoder(const Napi::CallbackInfo& info);
+  ~NativeVideoEncoder() override;
+
+  /**
+   * The session behind `value` if it is a NativeVideoEncoder, else nullptr.
+   */
+  static NativeVideoEncoder* FromValue(Napi::Value value);
+
+  // What became of a frame given to EnqueueFrame().
+  enum class EnqueueResult {
+    kQueued,
+    kDropped,  // Realtime overflow or closed session; counted in droppedFrames
+    kFailed,   // The frame could not be referenced; the caller reports it
+  };
+
+  /**
+   * Queue a frame from native code (NativeVideoPipeline) on any thread; a
+   * hardware frame only if TakesSurface() says so. The worker applies
+   * `transform` and scales the frame to the encoder's size. Takes its own
+   * reference to `frame`, never blocks and reports no dequeue().
+   */
+  EnqueueResult EnqueueFrame(const AVFrame* frame, const FrameTransform& transform,
+                    int64_t timestamp, int64_t duration, bool hasDuration, bool keyFrame);
+
+  /**
+   * Whether EnqueueFrame() may be given `frame`, a hardware frame, as is:
+   * the encoder reads surfaces and the frame needs no transform. The worker
+   * still downloads it if the surface is not one the codec can map.
+   */
+  bool TakesSurface(const AVFrame* frame, const FrameTransform& transform) const;
+
+  /**
+   * Whether another EnqueueFrame() stays within maxQueueDepth. Always true
+   * in realtime mode, which drops instead. Any thread.
+   */
+  bool HasRoom() const;
+
+ private:
+  // Whether pipeline input has to be cropped, rotated or scaled.
+  bool NeedsTransform(const AVFrame* frame, const FrameTransform& transform) const;
+
+  // Timing of an input frame, looked up again when its packet comes out.
+  struct FrameTiming {
+    int64_t timestamp;
+    int64_t duration;
+    bool hasDuration;
+  };
+
+  // Worker -> JS notification, delivered through tsfn_.
+  struct Event {
+    enum class Kind { kPacket, kError, kDequeue, kFlushed };
+    Kind kind;
+    AVPacket* packet = nullptr;
+    FrameTiming timing = {0, 0, false};
+    bool hasTiming = false;
+    std::string message;
+    uint32_t flushId = 0;
+  };
+
+  // JS thread
+  Napi::Value Encode(const Napi::CallbackInfo& info);
+  Napi::Value GetHardwareAccelerated(const Napi::CallbackInfo& info);
+  Napi::Value GetPoolStats(const Napi::CallbackInfo& info);
+  Napi::Value GetEncodeQueueSize(const Napi::CallbackInfo& info);
+  Napi::Value GetDroppedFrames(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  Napi::Value Flush(const Napi::CallbackInfo& info);
+  Napi::Value Reconfigure(const Napi::CallbackInfo& info);
+  Napi::Value SetMuxer(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+  void DeliverEvent(Napi::Env env, Napi::Function output, Event* event);
+  void TrackCommand(Napi::Env env);
+  void UntrackCommand(Napi::Env env);
+  void Shutdown();
+
+  // Worker thread
+  void HandleCommand(Command& cmd);
+  void EncodeFrame(Command& cmd);
+  void UpdateRate(int64_t bitrate, int quantizer);
+  void DrainEncoder();
+  bool ReceivePackets(std::string* error);
+  bool MuxPacket(NativeMuxer* muxer, std::string* error);
+  void Post(Event* event);
+  void PostError(const std::string& message);
+
+  bool OpenCodec(std::string* error);
+  void ReleaseCodec();
+
+  AVCodecContext* ctx_ = nullptr;
+  AVPacket* packet_ = nullptr;
+  VideoCodecSpec codec_;
+
+  int width_ = 0;
+  int height_ = 0;
+  // The rate targets belong to the worker once it has started.
+  int64_t bitrate_ = 500000;
+  BitrateMode bitrateMode_ = BitrateMode::kVariable;
+  int quantizer_ = -1;
+  AVRational framerate_ = {30, 1};
+  int gopSize_ = 30;
+  HardwarePreference hardware_ = HardwarePreference::kNoPreference;
+  LatencyMode latencyMode_ = LatencyMode::kQuality;
+  int threads_ = 0;
+  size_t queueDepth_ = 0;
+  bool hardwareAccelerated_ = false;
+  // The codec reads hardware surfaces. Set by the constructor's open, which
+  // every reopen repeats; read on any thread.
+  bool takesSurfaces_ = false;
+
+  // JS thread: whether the opened encoder takes a new quantizer live, and
+  // the quantizer of the frames queued since the last flush().
+  bool liveQuantizer_ = false;
+  bool streamStarted_ = false;
+  int streamQuantizer_ = -1;
+
+  // Lowest PTS the next frame may take; kFirstPts until one is sent
+  // to the open context.
+  int64_t nextPts_ = 0;
+  std::map<int64_t, FrameTiming> timings_;
+
+  // Written by both threads; dropped frames are counted here too.
+  SessionStats stats_;
+
+  // inputPool_ backs encode(Buffer) copies on the JS thread, stagingPool_
+  // the worker's format conversions and packets_ the encoder output. They
+  // live as long as the session, because queued events still hold packets
+  // after close().
+  std::shared_ptr<PoolBudget> budget_;
+  std::unique_ptr<FramePool> inputPool_;
+  std::unique_ptr<FramePool> stagingPool_;
+  std::unique_ptr<PacketPool> packets_;
+
+  // Set once by setMuxer(); packets then go to the muxer instead of JS.
+  std::atomic<NativeMuxer*> muxer_{nullptr};
+  Napi::ObjectReference muxerRef_;
+
+  std::unique_ptr<WorkerThread> worker_;
+  Napi::ThreadSafeFunction tsfn_;
+  Napi::FunctionReference errorCallback_;
+  Napi::FunctionReference dequeueCallback_;
+  PendingFlushes flushes_;
+  uint32_t inFlight_ = 0;
+  bool closed_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_VIDEO_ENCODER_H_
@@ -0,0 +1,522 @@
+/**
+ * NativeVideoFrame implementation.
+ *
+ * new NativeVideoFrame(data: Uint8Array, { format, codedWidth, codedHeight, layout?, adopt? })
+ *   format       -> 'I420' | 'NV12' | 'RGBA' | ...
+ *   codedWidth   -> number
+ *   codedHeight  -> number
+ *   copyTo(dest: Uint8Array, { format?, layout?, rect?, resizeWidth?, resizeHeight? })
+ *     -> [{ offset, stride }, ...]
+ *   clone() -> NativeVideoFrame sharing the same buffers
+ *   hash(algorithm = 'MD5') -> [hex digest per plane]
+ *   share() -> token for NativeVideoFrame.fromShared() in any environment
+ *   close()
+ * NativeVideoFrame.fromShared(token) -> NativeVideoFrame
+ *
+ * `data` holds the planes at `layout`'s [{ offset, stride }, ...], tightly
+ * packed by default. It is copied once into the AVFrame, unless `adopt` is
+ * set: the frame then points at `data` itself and keeps it alive, so the
+ * caller must not write to it again (VideoFrame only adopts transferred
+ * ArrayBuffers and SharedArrayBuffers).
+ * copyTo() writes the frame out in its own format unless asked to convert.
+ * hash() reads the planes in place with av_hash ('MD5', 'murmur3',
+ * 'CRC32', 'SHA256', ...), covering only the visible bytes of each row, so
+ * equal pictures hash equal whatever their strides.
+ * Each share() token holds one reference and is claimed by exactly one
+ * fromShared(). An adopted frame is copied once by share(), since its JS
+ * memory dies with its environment.
+ */
+
+#include "video_frame.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <libavutil/hash.h>
+#include <libavutil/imgutils.h>
+}
+
+#include "addon_data.h"
+#include "adopted_buffer.h"
+#include "ffmpeg_utils.h"
+#include "frame_pool.h"
+#include "hw_device.h"
+#include "pixel_convert.h"
+#include "pixel_format.h"
+
+namespace {
+
+struct Rect {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+/**
+ * Read copyTo()'s { x, y, width, height } rect, which defaults to the whole
+ * frame, and check that it lies inside it.
+ */
+bool RectFromValue(Napi::Value value, int frameWidth, int frameHeight, Rect* rect, std::string* error) {
+  *rect = {0, 0, frameWidth, frameHeight};
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
+  }
+  if (!value.IsObject()) {
+    *error = "rect must be {x, y, width, height}";
+    return false;
+  }
+  Napi::Object object = value.As<Napi::Object>();
+  rect->x = object.Get("x").ToNumber().Int32Value();
+  rect->y = object.Get("y").ToNumber().Int32Value();
+  rect->width = object.Get("width").ToNumber().Int32Value();
+  rect->height = object.Get("height").ToNumber().Int32Value();
+  if (rect->x < 0 || rect->y < 0 || rect->width <= 0 || rect->height <= 0 ||
+      rect->x + rect->width > frameWidth || rect->y + rect->height > frameHeight) {
+    *error = "rect is outside the frame";
+    return false;
+  }
+  return true;
+}
+
+// Allocate a frame, from `pool` when it has this shape, and copy the planes in.
+AVFrame* CopyPlanes(const uint8_t* const data[4], const int stride[4], AVPixelFormat format,
+                    int width, int height, std::string* error, FramePool* pool) {
+  AVFrame* frame = nullptr;
+  if (pool && pool->Matches(format, width, height)) {
+    frame = pool->Acquire(error);
+    if (!frame) {
+      return nullptr;
+    }
+  } else {
+    frame = av_frame_alloc();
+    if (!frame) {
+      *error = "Failed to allocate frame";
+      return nullptr;
+    }
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    int ret = av_frame_get_buffer(frame, 0);
+    if (ret < 0) {
+      av_frame_free(&frame);
+      *error = "Failed to allocate frame buffer: " + AvErrorString(ret);
+      return nullptr;
+    }
+  }
+
+  av_image_copy(frame->data, frame->linesize, const_cast<const uint8_t**>(data), stride,
+                format, width, height);
+  return frame;
+}
+
+// A frame whose planes point into `owner`'s memory, kept alive by the frame.
+AVFrame* AdoptPlanes(Napi::Env env, Napi::Uint8Array owner, uint8_t* const data[4], const int stride[4],
+                     AVPixelFormat format, int width, int height, std::string* error) {
+  AVFrame* frame = av_frame_alloc();
+  if (!frame) {
+    *error = "Failed to allocate frame";
+    return nullptr;
+  }
+  frame->buf[0] = AdoptBuffer(env, owner, owner.Data(), owner.ByteLength());
+  if (!frame->buf[0]) {
+    av_frame_free(&frame);
+    *error = "Failed to allocate frame buffer";
+    return nullptr;
+  }
+  frame->format = format;
+  frame->width = width;
+  frame->height = height;
+  for (int i = 0; i < 4; i++) {
+    frame->data[i] = data[i];
+    frame->linesize[i] = stride[i];
+  }
+  frame->extended_data = frame->data;
+  return frame;
+}
+
+// Hex digest of each plane's visible rows, in plane order.
+bool HashPlanes(const AVFrame* frame, const std::string& algorithm,
+                std::vector<std::string>* digests, std::string* error) {
+  PlaneSize sizes[4];
+  int count = PlaneSizes(static_cast<AVPixelFormat>(frame->format), frame->width, frame->height, sizes);
+  if (count == 0) {
+    *error = "Unsupported frame format";
+    return false;
+  }
+  AVHashContext* hash = nullptr;
+  if (av_hash_alloc(&hash, algorithm.c_str()) < 0) {
+    *error = "Unknown hash algorithm: " + algorithm;
+    return false;
+  }
+  uint8_t hex[2 * AV_HASH_MAX_SIZE + 1];
+  for (int i = 0; i < count; i++) {
+    av_hash_init(hash);
+    const uint8_t* row = frame->data[i];
+    for (size_t y = 0; y < sizes[i].rows; y++, row += frame->linesize[i]) {
+      av_hash_update(hash, row, sizes[i].rowBytes);
+    }
+    av_hash_final_hex(hash, hex, sizeof(hex));
+    digests->emplace_back(reinterpret_cast<const char*>(hex));
+  }
+  av_hash_freep(&hash);
+  return true;
+}
+
+// Frames between share() and fromShared(), keyed by token. Process-wide
+// and intentionally leaked, like ScalerCache::Shared().
+struct SharedFrames {
+  std::mutex mutex;
+  std::unordered_map<uint64_t, AVFrame*> frames;
+  uint64_t nextToken = 1;
+};
+
+SharedFrames& Shared() {
+  static SharedFrames* shared = new SharedFrames();
+  return *shared;
+}
+
+}  // namespace
+
+Napi::Object NativeVideoFrame::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeVideoFrame", {
+    InstanceAccessor("format", &NativeVideoFrame::GetFormat, nullptr),
+    InstanceAccessor("codedWidth", &NativeVideoFrame::GetCodedWidth, nullptr),
+    InstanceAccessor("codedHeight", &NativeVideoFrame::GetCodedHeight, nullptr),
+    InstanceMethod("copyTo", &NativeVideoFrame::CopyTo),
+    InstanceMethod("clone", &NativeVideoFrame::Clone),
+    InstanceMethod("hash", &NativeVideoFrame::Hash),
+    InstanceMethod("share", &NativeVideoFrame::Share),
+    InstanceMethod("close", &NativeVideoFrame::Close),
+    StaticMethod("fromShared", &NativeVideoFrame::FromShared),
+  });
+
+  AddonData::Get(env)->videoFrame = Napi::Persistent(func);
+
+  exports.Set("NativeVideoFrame", func);
+  return exports;
+}
+
+Napi::Value NativeVideoFrame::NewInstance(Napi::Env env, const AVFrame* frame) {
+  // The constructor takes its own reference; the External is only a carrier.
+  return AddonData::Get(env)->videoFrame.New({Napi::External<AVFrame>::New(env, const_cast<AVFrame*>(frame))});
+}
+
+const AVFrame* NativeVideoFrame::FrameFromValue(Napi::Value value) {
+  if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(AddonData::Get(value.Env())->videoFrame.Value())) {
+    return nullptr;
+  }
+  NativeVideoFrame* handle = Unwrap(value.As<Napi::Object>());
+  return handle ? handle->frame_ : nullptr;
+}
+
+AVFrame* NativeVideoFrame::CopyFromBuffer(const uint8_t* data, size_t size, AVPixelFormat format,
+                                          int width, int height, std::string* error,
+                                          FramePool* pool) {
+  int required = av_image_get_buffer_size(format, width, height, 1);
+  if (required < 0) {
+    *error = "Unsupported frame format or size";
+    return nullptr;
+  }
+  if (size < static_cast<size_t>(required)) {
+    *error = "Frame buffer is too small for its format and size";
+    return nullptr;
+  }
+
+  uint8_t* srcData[4];
+  int srcLinesize[4];
+  av_image_fill_arrays(srcData, srcLinesize, data, format, width, height, 1);
+  return CopyPlanes(srcData, srcLinesize, format, width, height, error, pool);
+}
+
+NativeVideoFrame::NativeVideoFrame(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeVideoFrame>(info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() >= 1 && info[0].IsExternal()) {
+    const AVFrame* src = info[0].As<Napi::External<AVFrame>>().Data();
+    frame_ = av_frame_alloc();
+    if (!frame_ || av_frame_ref(frame_, src) < 0) {
+      av_frame_free(&frame_);
+      Napi::Error::New(env, "Failed to reference frame").ThrowAsJavaScriptException();
+    }
+    return;
+  }
+
+  if (info.Length() < 2 || !info[0].IsTypedArray() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Expected (Uint8Array, {format, codedWidth, codedHeight, layout?, adopt?})").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Uint8Array data = info[0].As<Napi::Uint8Array>();
+  Napi::Object init = info[1].As<Napi::Object>();
+  if (!init.Get("format").IsString() || !init.Get("codedWidth").IsNumber() ||
+      !init.Get("codedHeight").IsNumber()) {
+    Napi::TypeError::New(env, "Frame init requires format, codedWidth and codedHeight").ThrowAsJavaScriptException();
+    return;
+  }
+
+  AVPixelFormat format = PixelFormatFromString(init.Get("format").As<Napi::String>().Utf8Value());
+  if (format == AV_PIX_FMT_NONE) {
+    Napi::TypeError::New(env, "Unsupported frame format").ThrowAsJavaScriptException();
+    return;
+  }
+
+  int width = init.Get("codedWidth").As<Napi::Number>().Int32Value();
+  int height = init.Get("codedHeight").As<Napi::Number>().Int32Value();
+  std::string error;
+  std::vector<PlaneLayout> planes;
+  if (width <= 0 || height <= 0) {
+    Napi::TypeError::New(env, "Unsupported frame format or size").ThrowAsJavaScriptException();
+    return;
+  }
+  if (!ResolveLayout(init.Get("layout"), format, width, height, data.ByteLength(), &planes, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return;
+  }
+  uint8_t* planeData[4];
+  int planeStride[4];
+  ApplyLayout(data.Data(), planes, planeData, planeStride);
+  // Adopted planes are read in place by copyTo() and the encoders, at
+  // whatever stride the producer wrote them
+  adopted_ = init.Get("adopt").ToBoolean().Value();
+  frame_ = adopted_
+    ? AdoptPlanes(env, data, planeData, planeStride, format, width, height, &error)
+    : CopyPlanes(planeData, planeStride, format, width, height, &error, nullptr);
+  if (!frame_) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+  }
+}
+
+NativeVideoFrame::~NativeVideoFrame() {
+  av_frame_free(&frame_);
+  av_frame_free(&downloaded_);
+}
+
+const AVFrame* NativeVideoFrame::ReadableFrame(std::string* error) {
+  if (!frame_->hw_frames_ctx) {
+    return frame_;
+  }
+  if (!downloaded_) {
+    downloaded_ = DownloadFrame(frame_, error);
+  }
+  return downloaded_;
+}
+
+Napi::Value NativeVideoFrame::GetFormat(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  const char* name = frame_ ? PixelFormatName(SoftwareFormat(frame_)) : nullptr;
+  return name ? Napi::String::New(env, name) : env.Null();
+}
+
+Napi::Value NativeVideoFrame::GetCodedWidth(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), frame_ ? frame_->width : 0);
+}
+
+Napi::Value NativeVideoFrame::GetCodedHeight(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), frame_ ? frame_->height : 0);
+}
+
+/**
+ * copyTo(dest, { format?, layout?, rect?, resizeWidth?, resizeHeight? })
+ *
+ * Without `format` the planes are copied as libavcodec produced them. A
+ * different format (e.g. 'RGBA') is converted with libswscale straight into
+ * `dest`; this is the only place decoded frames are ever converted.
+ * `rect` selects the region to copy and resizeWidth/resizeHeight scale it,
+ * in the same sws_scale() pass as the conversion, so a thumbnail never
+ * exists at full resolution in the destination format.
+ * `layout` gives per-plane { offset, stride } in `dest`; by default planes
+ * are tightly packed at the output size.
+ */
+Napi::Value NativeVideoFrame::CopyTo(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!frame_) {
+    Napi::Error::New(env, "VideoFrame is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsTypedArray()) {
+    Napi::TypeError::New(env, "Expected (Uint8Array, {format?, layout?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Uint8Array dest = info[0].As<Napi::Uint8Array>();
+  Napi::Object options = (info.Length() >= 2 && info[1].IsObject())
+    ? info[1].As<Napi::Object>()
+    : Napi::Object::New(env);
+
+  std::string error;
+  const AVFrame* source = ReadableFrame(&error);
+  if (!source) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  AVPixelFormat srcFormat = static_cast<AVPixelFormat>(source->format);
+  AVPixelFormat dstFormat = srcFormat;
+  if (options.Get("format").IsString()) {
+    dstFormat = PixelFormatFromString(options.Get("format").As<Napi::String>().Utf8Value());
+    if (dstFormat == AV_PIX_FMT_NONE) {
+      Napi::TypeError::New(env, "Unsupported copyTo format").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+
+  Rect rect;
+  if (!RectFromValue(options.Get("rect"), source->width, source->height, &rect, &error)) {
+    Napi::RangeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  int outWidth = rect.width;
+  int outHeight = rect.height;
+  if (options.Get("resizeWidth").IsNumber()) {
+    outWidth = options.Get("resizeWidth").As<Napi::Number>().Int32Value();
+  }
+  if (options.Get("resizeHeight").IsNumber()) {
+    outHeight = options.Get("resizeHeight").As<Napi::Number>().Int32Value();
+  }
+  if (outWidth <= 0 || outHeight <= 0) {
+    Napi::RangeError::New(env, "resizeWidth and resizeHeight must be positive").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const uint8_t* srcData[4];
+  if (!CropPlanes(source->data, source->linesize, srcFormat, rect.x, rect.y, srcData, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<PlaneLayout> planes;
+  if (!ResolveLayout(options.Get("layout"), dstFormat, outWidth, outHeight,
+                     dest.ByteLength(), &planes, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  uint8_t* dstData[4];
+  int dstStride[4];
+  ApplyLayout(dest.Data(), planes, dstData, dstStride);
+  if (!ScaleImage(srcData, source->linesize, srcFormat, rect.width, rect.height,
+                  dstData, dstStride, dstFormat, outWidth, outHeight, &error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  return LayoutToArray(env, planes);
+}
+
+Napi::Value NativeVideoFrame::Clone(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!frame_) {
+    Napi::Error::New(env, "VideoFrame is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Value clone = NewInstance(env, frame_);
+  Unwrap(clone.As<Napi::Object>())->adopted_ = adopted_;
+  return clone;
+}
+
+Napi::Value NativeVideoFrame::Hash(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!frame_) {
+    Napi::Error::New(env, "VideoFrame is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::string algorithm = "MD5";
+  if (info.Length() >= 1 && !info[0].IsUndefined()) {
+    if (!info[0].IsString()) {
+      Napi::TypeError::New(env, "Expected (algorithm?: string)").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    algorithm = info[0].As<Napi::String>().Utf8Value();
+  }
+
+  std::string error;
+  const AVFrame* source = ReadableFrame(&error);
+  if (!source) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::vector<std::string> digests;
+  if (!HashPlanes(source, algorithm, &digests, &error)) {
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array result = Napi::Array::New(env, digests.size());
+  for (size_t i = 0; i < digests.size(); i++) {
+    result.Set(static_cast<uint32_t>(i), Napi::String::New(env, digests[i]));
+  }
+  return result;
+}
+
+Napi::Value NativeVideoFrame::Share(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!frame_) {
+    Napi::Error::New(env, "VideoFrame is closed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  AVFrame* shared = nullptr;
+  if (adopted_) {
+    shared = av_frame_alloc();
+    if (shared) {
+      shared->format = frame_->format;
+      shared->width = frame_->width;
+      shared->height = frame_->height;
+    }
+    if (!shared || av_frame_get_buffer(shared, 0) < 0 || av_frame_copy(shared, frame_) < 0 ||
+        av_frame_copy_props(shared, frame_) < 0) {
+      av_frame_free(&shared);
+    }
+  } else {
+    shared = av_frame_clone(frame_);
+  }
+  if (!shared) {
+    Napi::Error::New(env, "Failed to share frame").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  SharedFrames& registry = Shared();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  uint64_t token = registry.nextToken++;
+  registry.frames[token] = shared;
+  return Napi::Number::New(env, static_cast<double>(token));
+}
+
+Napi::Value NativeVideoFrame::FromShared(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a shared frame token").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  uint64_t token = static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+  AVFrame* frame = nullptr;
+  {
+    SharedFrames& registry = Shared();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.frames.find(token);
+    if (it != registry.frames.end()) {
+      frame = it->second;
+      registry.frames.erase(it);
+    }
+  }
+  if (!frame) {
+    Napi::Error::New(env, "Shared frame was already claimed").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Value result = NewInstance(env, frame);
+  av_frame_free(&frame);
+  return result;
+}
+
+void NativeVideoFrame::Close(const Napi::CallbackInfo& info) {
+  av_frame_free(&frame_);
+  av_frame_free(&downloaded_);
+}
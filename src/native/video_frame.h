@@ -0,0 +1,79 @@
+/**
+ * NativeVideoFrame
+ *
+ * JS handle for a refcounted AVFrame. The pixel buffers are shared with
+ * av_frame_ref, so clone(), decoder output and encoder input all point at
+ * the same memory; the buffers are freed when the last reference goes away.
+ * close() drops this handle's reference immediately instead of waiting for GC.
+ *
+ * Frames from a hardware decoder keep their GPU surface; the first copyTo()
+ * downloads it once and later reads reuse the system-memory copy.
+ *
+ * share() parks a reference in a process-wide registry under a numeric
+ * token that can be posted to another worker_threads Worker, where
+ * NativeVideoFrame.fromShared() claims it: the frame crosses threads by
+ * refcount, not by copying its pixels.
+ */
+
+#ifndef WEBCODECS_NATIVE_VIDEO_FRAME_H_
+#define WEBCODECS_NATIVE_VIDEO_FRAME_H_
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+class FramePool;
+
+class NativeVideoFrame : public Napi::ObjectWrap<NativeVideoFrame> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  /**
+   * Wrap a new reference to `frame` in a JS handle. The caller keeps its own
+   * reference.
+   */
+  static Napi::Value NewInstance(Napi::Env env, const AVFrame* frame);
+
+  /**
+   * The AVFrame behind `value` if it is an open NativeVideoFrame, else nullptr.
+   */
+  static const AVFrame* FrameFromValue(Napi::Value value);
+
+  /**
+   * Allocate a frame, from `pool` when it has this shape, and copy a tightly
+   * packed image into it. Returns nullptr and sets `error` if `size` is too
+   * small.
+   */
+  static AVFrame* CopyFromBuffer(const uint8_t* data, size_t size, AVPixelFormat format,
+                                 int width, int height, std::string* error,
+                                 FramePool* pool = nullptr);
+
+  explicit NativeVideoFrame(const Napi::CallbackInfo& info);
+  ~NativeVideoFrame() override;
+
+ private:
+  Napi::Value GetFormat(const Napi::CallbackInfo& info);
+  Napi::Value GetCodedWidth(const Napi::CallbackInfo& info);
+  Napi::Value GetCodedHeight(const Napi::CallbackInfo& info);
+  Napi::Value CopyTo(const Napi::CallbackInfo& info);
+  Napi::Value Clone(const Napi::CallbackInfo& info);
+  Napi::Value Hash(const Napi::CallbackInfo& info);
+  Napi::Value Share(const Napi::CallbackInfo& info);
+  static Napi::Value FromShared(const Napi::CallbackInfo& info);
+  void Close(const Napi::CallbackInfo& info);
+
+  // frame_ itself, or its downloaded copy if it lives in GPU memory.
+  const AVFrame* ReadableFrame(std::string* error);
+
+  AVFrame* frame_ = nullptr;
+  AVFrame* downloaded_ = nullptr;
+  // Points into JS memory of this environment; see adopted_buffer.h.
+  bool adopted_ = false;
+};
+
+#endif  // WEBCODECS_NATIVE_VIDEO_FRAME_H_
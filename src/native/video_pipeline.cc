@@ -0,0 +1,226 @@
+/**
+ * NativeVideoPipeline implementation.
+ *
+ * new NativeVideoPipeline([{ encoder: NativeVideoEncoder, crop?: { x, y, width, height },
+ *                            rotation? }, ...])
+ *   encode(frame: NativeVideoFrame, { timestamp, duration?, keyFrame? })
+ * decoder.setPipeline(pipeline)   (NativeVideoDecoder)
+ *
+ * crop selects a rectangle of the decoded picture and rotation (0, 90, 180
+ * or 270, clockwise) turns it; the result is scaled to the encoder's
+ * configured size and converted to its pixel format. A crop that does not
+ * fit a frame is reported through that encoder's error().
+ * Once attached, decoded frames skip the decoder's output() and flow into
+ * the encoders, whose output() (or muxer) receives the packets. Flush the
+ * decoder, then the encoders, to drain the pipeline.
+ * A decoder's worker is held off the pool while any non-realtime encoder's
+ * queue is full, so decoding runs at the pace of the slowest rendition.
+ * encode() is the live source: it gives every encoder a reference to the
+ * frame without waiting and reports no dequeue(); a realtime encoder that
+ * is full drops the frame, the others queue it, so a live source paces
+ * itself on their encodeQueueSize. It throws only if a GPU frame cannot be
+ * downloaded.
+ */
+
+#include "video_pipeline.h"
+
+#include <atomic>
+
+#include "addon_data.h"
+#include "codec_registry.h"
+#include "hw_device.h"
+#include "video_encoder.h"
+#include "video_frame.h"
+
+namespace {
+
+bool ReadInt(Napi::Object object, const char* key, int* value) {
+  Napi::Value field = object.Get(key);
+  if (!field.IsNumber()) {
+    return false;
+  }
+  *value = field.As<Napi::Number>().Int32Value();
+  return true;
+}
+
+}  // namespace
+
+struct NativeVideoPipeline::LentSurfaces {
+  std::atomic<int> count{0};
+};
+
+Napi::Object NativeVideoPipeline::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "NativeVideoPipeline", {
+    InstanceMethod("encode", &NativeVideoPipeline::Encode),
+  });
+
+  AddonData::Get(env)->videoPipeline = Napi::Persistent(func);
+
+  exports.Set("NativeVideoPipeline", func);
+  return exports;
+}
+
+NativeVideoPipeline* NativeVideoPipeline::FromValue(Napi::Value value) {
+  if (!value.IsObject() || !value.As<Napi::Object>().InstanceOf(AddonData::Get(value.Env())->videoPipeline.Value())) {
+    return nullptr;
+  }
+  return Unwrap(value.As<Napi::Object>());
+}
+
+NativeVideoPipeline::NativeVideoPipeline(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<NativeVideoPipeline>(info), lent_(std::make_shared<LentSurfaces>()) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsArray() || info[0].As<Napi::Array>().Length() == 0) {
+    Napi::TypeError::New(env, "Expected [{encoder, crop?, rotation?}, ...]").ThrowAsJavaScriptException();
+    return;
+  }
+
+  Napi::Array list = info[0].As<Napi::Array>();
+  for (uint32_t i = 0; i < list.Length(); i++) {
+    Napi::Value entry = list.Get(i);
+    Napi::Object rendition = entry.IsObject() ? entry.As<Napi::Object>() : Napi::Object::New(env);
+    NativeVideoEncoder* encoder = NativeVideoEncoder::FromValue(rendition.Get("encoder"));
+    if (!encoder) {
+      Napi::TypeError::New(env, "Each rendition requires a NativeVideoEncoder").ThrowAsJavaScriptException();
+      return;
+    }
+
+    FrameTransform transform;
+    Napi::Value crop = rendition.Get("crop");
+    if (!crop.IsUndefined()) {
+      Napi::Object rect = crop.IsObject() ? crop.As<Napi::Object>() : Napi::Object::New(env);
+      if (!ReadInt(rect, "x", &transform.cropX) || !ReadInt(rect, "y", &transform.cropY) ||
+          !ReadInt(rect, "width", &transform.cropWidth) || !ReadInt(rect, "height", &transform.cropHeight)) {
+        Napi::TypeError::New(env, "crop requires numeric x, y, width and height").ThrowAsJavaScriptException();
+        return;
+      }
+      if (transform.cropX < 0 || transform.cropY < 0 || transform.cropWidth <= 0 || transform.cropHeight <= 0) {
+        Napi::RangeError::New(env, "crop must have a non-negative origin and a positive size").ThrowAsJavaScriptException();
+        return;
+      }
+      transform.crop = true;
+    }
+    if (!rendition.Get("rotation").IsUndefined()) {
+      if (!ReadInt(rendition, "rotation", &transform.rotation) ||
+          (transform.rotation != 0 && transform.rotation != 90 &&
+           transform.rotation != 180 && transform.rotation != 270)) {
+        Napi::RangeError::New(env, "rotation must be 0, 90, 180 or 270").ThrowAsJavaScriptException();
+        return;
+      }
+    }
+
+    renditions_.push_back({encoder, transform});
+    encoderRefs_.push_back(Napi::Persistent(rendition.Get("encoder").As<Napi::Object>()));
+  }
+}
+
+Napi::Value NativeVideoPipeline::Encode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  const AVFrame* frame = info.Length() >= 1 ? NativeVideoFrame::FrameFromValue(info[0]) : nullptr;
+  if (!frame) {
+    Napi::TypeError::New(env, "Expected (NativeVideoFrame, {timestamp, duration?, keyFrame?})").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object options = (info.Length() >= 2 && info[1].IsObject())
+    ? info[1].As<Napi::Object>()
+    : Napi::Object::New(env);
+  int64_t timestamp = 0;
+  int64_t duration = 0;
+  bool hasDuration = false;
+  if (options.Get("timestamp").IsNumber()) {
+    timestamp = options.Get("timestamp").As<Napi::Number>().Int64Value();
+  }
+  if (options.Get("duration").IsNumber()) {
+    duration = options.Get("duration").As<Napi::Number>().Int64Value();
+    hasDuration = true;
+  }
+
+  std::string error;
+  if (!PushFrame(frame, timestamp, duration, hasDuration, options.Get("keyFrame").ToBoolean().Value(), &error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+bool NativeVideoPipeline::PushFrame(const AVFrame* frame, int64_t timestamp, int64_t duration,
+                                    bool hasDuration, bool keyFrame, std::string* error) {
+  // Surface encoders share one lent reference to the GPU frame; the others,
+  // and all of them once too many surfaces are out, share one download
+  AVFrame* lent = nullptr;
+  bool lendFailed = false;
+  AVFrame* downloaded = nullptr;
+  bool failed = false;
+  for (const Rendition& rendition : renditions_) {
+    const AVFrame* input = frame;
+    if (frame->hw_frames_ctx) {
+      bool surface = rendition.encoder->TakesSurface(frame, rendition.transform);
+      if (surface && !lent && !lendFailed) {
+        lent = LendSurface(frame);
+        lendFailed = !lent;
+      }
+      if (surface && lent) {
+        input = lent;
+      } else {
+        if (!downloaded && !(downloaded = DownloadFrame(frame, error))) {
+          av_frame_free(&lent);
+          return false;
+        }
+        input = downloaded;
+      }
+    }
+    // A closed or dropping encoder counts the frame it misses; the other
+    // renditions still get it when one of them cannot take a reference
+    if (rendition.encoder->EnqueueFrame(input, rendition.transform, timestamp, duration, hasDuration,
+                                        keyFrame) == NativeVideoEncoder::EnqueueResult::kFailed) {
+      failed = true;
+    }
+  }
+  av_frame_free(&lent);
+  av_frame_free(&downloaded);
+  if (failed) {
+    *error = "Failed to reference frame";
+  }
+  return !failed;
+}
+
+AVFrame* NativeVideoPipeline::LendSurface(const AVFrame* frame) {
+  if (lent_->count.fetch_add(1) >= kExtraHardwareFrames) {
+    lent_->count.fetch_sub(1);
+    return nullptr;
+  }
+  // The token rides along in opaque_ref, which every av_frame_ref() and
+  // av_frame_copy_props() of the surface carries on into the encoder
+  auto* owner = new std::shared_ptr<LentSurfaces>(lent_);
+  AVBufferRef* token = av_buffer_create(
+    nullptr, 0,
+    [](void* opaque, uint8_t*) {
+      auto* lent = static_cast<std::shared_ptr<LentSurfaces>*>(opaque);
+      (*lent)->count.fetch_sub(1);
+      delete lent;
+    },
+    owner, 0);
+  if (!token) {
+    delete owner;
+    lent_->count.fetch_sub(1);
+    return nullptr;
+  }
+  AVFrame* lent = av_frame_clone(frame);
+  if (!lent) {
+    av_buffer_unref(&token);
+    return nullptr;
+  }
+  av_buffer_unref(&lent->opaque_ref);
+  lent->opaque_ref = token;
+  return lent;
+}
+
+bool NativeVideoPipeline::HasRoom() const {
+  for (const Rendition& rendition : renditions_) {
+    if (!rendition.encoder->HasRoom()) {
+      return false;
+    }
+  }
+  return true;
+}
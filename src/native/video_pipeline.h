@@ -0,0 +1,84 @@
+/**
+ * NativeVideoPipeline
+ *
+ * Fans frames out to a set of NativeVideoEncoder renditions, each with its
+ * own crop, rotation, output size and bitrate. Frames come from a
+ * NativeVideoDecoder attached with setPipeline(), which hands every picture
+ * to PushFrame() on its worker, or from JS through encode(NativeVideoFrame).
+ * Each encoder gets a reference to the frame, not a copy, and transforms it
+ * on its own lane, so the renditions of one frame are scaled and encoded
+ * in parallel.
+ *
+ * The rendition list is fixed at construction, so the pipeline can be read
+ * from any thread without locking.
+ */
+
+#ifndef WEBCODECS_NATIVE_VIDEO_PIPELINE_H_
+#define WEBCODECS_NATIVE_VIDEO_PIPELINE_H_
+
+#include <napi.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+#include "frame_transform.h"
+
+class NativeVideoEncoder;
+
+class NativeVideoPipeline : public Napi::ObjectWrap<NativeVideoPipeline> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+
+  explicit NativeVideoPipeline(const Napi::CallbackInfo& info);
+
+  /**
+   * The pipeline behind `value` if it is a NativeVideoPipeline, else nullptr.
+   */
+  static NativeVideoPipeline* FromValue(Napi::Value value);
+
+  /**
+   * Queue `frame` on every rendition's encoder. Any thread. A GPU frame goes
+   * as is to the encoders that read surfaces, as long as fewer than
+   * kExtraHardwareFrames surfaces are still queued or held by them, so a
+   * slow rendition cannot drain the decoder's fixed surface pool. It is
+   * downloaded once here for the rest, and for everyone past that cap. The
+   * frame is left for the caller to unref. Realtime and closed renditions
+   * count the frames they drop; fails if the download fails or an encoder
+   * cannot reference the frame.
+   */
+  bool PushFrame(const AVFrame* frame, int64_t timestamp, int64_t duration, bool hasDuration,
+                 bool keyFrame, std::string* error);
+
+  /**
+   * Whether every rendition's encoder has room for another frame. An
+   * attached decoder's lane is gated on it. Any thread.
+   */
+  bool HasRoom() const;
+
+ private:
+  Napi::Value Encode(const Napi::CallbackInfo& info);
+
+  // A reference to hardware `frame` tagged to count as lent until its last
+  // reference goes, or nullptr once the cap is reached.
+  AVFrame* LendSurface(const AVFrame* frame);
+
+  struct Rendition {
+    NativeVideoEncoder* encoder;
+    FrameTransform transform;
+  };
+
+  struct LentSurfaces;
+
+  std::vector<Rendition> renditions_;
+  // Outlives the pipeline while encoders still hold lent surfaces
+  std::shared_ptr<LentSurfaces> lent_;
+  // Keep the encoders alive as long as the pipeline
+  std::vector<Napi::ObjectReference> encoderRefs_;
+};
+
+#endif  // WEBCODECS_NATIVE_VIDEO_PIPELINE_H_
@@ -0,0 +1,47 @@
+/**
+ * WorkerThread implementation.
+ */
+
+#include "worker_thread.h"
+
+#include "codec_scheduler.h"
+
+WorkerThread::WorkerThread(size_t queueCapacity) : queue_(queueCapacity) {}
+
+WorkerThread::~WorkerThread() {
+  Stop();
+}
+
+void WorkerThread::Start(Handler handler) {
+  handler_ = std::move(handler);
+  CodecScheduler::Shared().Register(this);
+}
+
+bool WorkerThread::Enqueue(Command& cmd) {
+  cmd.enqueued = std::chrono::steady_clock::now();
+  if (!queue_.Push(cmd)) {
+    ReleaseCommand(&cmd);
+    return false;
+  }
+  CodecScheduler::Shared().Schedule(this);
+  return true;
+}
+
+bool WorkerThread::EnqueueNow(Command& cmd) {
+  cmd.enqueued = std::chrono::steady_clock::now();
+  if (!queue_.PushNow(cmd)) {
+    ReleaseCommand(&cmd);
+    return false;
+  }
+  CodecScheduler::Shared().Schedule(this);
+  return true;
+}
+
+void WorkerThread::SetGate(Gate gate) {
+  CodecScheduler::Shared().SetGate(this, std::move(gate));
+}
+
+void WorkerThread::Stop() {
+  queue_.Close();
+  CodecScheduler::Shared().Unregister(this);
+}
@@ -0,0 +1,63 @@
+/**
+ * WorkerThread
+ *
+ * The serial lane a codec session runs its AVCodecContext on. Commands
+ * are handled strictly in submission order and never two at once, so the
+ * codec context is only touched by one thread at a time. The threads
+ * themselves belong to the process-wide CodecScheduler, which runs many
+ * lanes on a fixed pool.
+ */
+
+#ifndef WEBCODECS_NATIVE_WORKER_THREAD_H_
+#define WEBCODECS_NATIVE_WORKER_THREAD_H_
+
+#include <cstddef>
+#include <functional>
+
+#include "command_queue.h"
+
+class WorkerThread {
+ public:
+  using Handler = std::function<void(Command& cmd)>;
+  using Gate = std::function<bool()>;
+
+  explicit WorkerThread(size_t queueCapacity);
+  ~WorkerThread();
+
+  void Start(Handler handler);
+
+  // Takes ownership of the command's frame/packet even on failure.
+  bool Enqueue(Command& cmd);
+
+  // As Enqueue(), but never blocks; see CommandQueue::PushNow().
+  bool EnqueueNow(Command& cmd);
+
+  // Hold the lane off the pool while `gate` returns false: commands keep
+  // queueing but none runs. The gate is checked before each command and
+  // again whenever another lane finishes one, with the scheduler locked, so
+  // it must be cheap and must only open through other lanes' progress.
+  void SetGate(Gate gate);
+
+  // Drop pending commands, let the current one finish, and detach from
+  // the scheduler.
+  void Stop();
+
+  size_t QueueSize() const { return queue_.Size(); }
+
+ private:
+  friend class CodecScheduler;
+
+  CommandQueue queue_;
+  Handler handler_;
+
+  // Guarded by the scheduler's mutex.
+  Gate gate_;
+  bool registered_ = false;
+  bool queued_ = false;   // On a ready deque, parked or running
+  bool running_ = false;
+  bool parked_ = false;   // Waiting for its gate to open
+  bool stopped_ = false;
+  size_t affinity_ = 0;   // Pool thread that ran it last
+};
+
+#endif  // WEBCODECS_NATIVE_WORKER_THREAD_H_
@@ -0,0 +1,181 @@
+/**
+ * Native Audio Codec Tests (Node.js only)
+ *
+ * These tests verify the NativeAudioEncoder/NativeAudioDecoder sessions:
+ * sample-format and sample-rate conversion on the way into the encoder,
+ * codec descriptions for decoderConfig, and decode back to AudioData-shaped
+ * buffers. FLAC is lossless, so its round-trip must be bit exact.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+interface Packet {
+  data: Buffer;
+  timestamp: number;
+  duration?: number;
+}
+
+interface DecodedAudio {
+  data: Buffer;
+  format: string;
+  sampleRate: number;
+  numberOfFrames: number;
+  numberOfChannels: number;
+  timestamp: number;
+}
+
+// `frames` samples of a 440 Hz tone as f32-planar
+function createTone(sampleRate: number, channels: number, frames: number, startFrame = 0): Buffer {
+  const samples = new Float32Array(frames * channels);
+  for (let c = 0; c < channels; c++) {
+    for (let i = 0; i < frames; i++) {
+      samples[c * frames + i] = 0.5 * Math.sin((2 * Math.PI * 440 * (startFrame + i)) / sampleRate);
+    }
+  }
+  return Buffer.from(samples.buffer);
+}
+
+describe('Native Audio Codecs', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  function encodeAll(config: object, inputs: Array<{ data: Buffer; options: object }>) {
+    const packets: Packet[] = [];
+    const encoder = new native.NativeAudioEncoder(config, {
+      output: (packet: Packet) => packets.push(packet),
+      error: (err: Error) => { throw err; },
+      dequeue: () => {},
+    });
+    for (const { data, options } of inputs) {
+      encoder.encode(data, options);
+    }
+    return new Promise<{ packets: Packet[]; sampleRate: number; description?: Buffer }>((resolve) => {
+      encoder.flush(() => {
+        const result = { packets, sampleRate: encoder.sampleRate, description: encoder.description };
+        encoder.close();
+        resolve(result);
+      });
+    });
+  }
+
+  function decodeAll(config: object, packets: Packet[]) {
+    const outputs: DecodedAudio[] = [];
+    const decoder = new native.NativeAudioDecoder(config, {
+      output: (data: DecodedAudio) => outputs.push(data),
+      error: (err: Error) => { throw err; },
+      dequeue: () => {},
+    });
+    for (const packet of packets) {
+      decoder.decode(packet.data, { timestamp: packet.timestamp });
+    }
+    return new Promise<DecodedAudio[]>((resolve) => {
+      decoder.flush(() => {
+        decoder.close();
+        resolve(outputs);
+      });
+    });
+  }
+
+  it('should round-trip a tone through Opus', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+    if (!native.hasCodec('libopus').encoder && !native.hasCodec('opus').encoder) {
+      console.log('Opus encoder not available, skipping');
+      return;
+    }
+
+    // 10 ms AudioData chunks, which the encoder regroups into 20 ms Opus frames
+    const inputs = Array.from({ length: 50 }, (_, i) => ({
+      data: createTone(48000, 2, 480, i * 480),
+      options: { format: 'f32-planar', sampleRate: 48000, numberOfFrames: 480, numberOfChannels: 2, timestamp: i * 10000 },
+    }));
+    const { packets, sampleRate, description } = await encodeAll(
+      { codec: 'opus', sampleRate: 48000, numberOfChannels: 2, bitrate: 64000 }, inputs);
+
+    expect(sampleRate).toBe(48000);
+    expect(description?.subarray(0, 8).toString('latin1')).toBe('OpusHead');
+    expect(packets.length).toBeGreaterThanOrEqual(25);
+    for (let i = 1; i < packets.length; i++) {
+      expect(packets[i].timestamp).toBeGreaterThan(packets[i - 1].timestamp);
+    }
+
+    const decoded = await decodeAll({ codec: 'opus', sampleRate: 48000, numberOfChannels: 2, description }, packets);
+    const totalFrames = decoded.reduce((sum, d) => sum + d.numberOfFrames, 0);
+    expect(decoded[0].numberOfChannels).toBe(2);
+    expect(decoded[0].data.length).toBeGreaterThan(0);
+    expect(Math.abs(totalFrames - 50 * 480)).toBeLessThanOrEqual(960);
+  });
+
+  it('should resample 44.1 kHz s16 input for Opus', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+    if (!native.hasCodec('libopus').encoder && !native.hasCodec('opus').encoder) {
+      console.log('Opus encoder not available, skipping');
+      return;
+    }
+
+    const frames = 4410;
+    const samples = new Int16Array(frames);
+    for (let i = 0; i < frames; i++) {
+      samples[i] = Math.round(16000 * Math.sin((2 * Math.PI * 440 * i) / 44100));
+    }
+    const { packets, sampleRate } = await encodeAll({ codec: 'opus', sampleRate: 44100, numberOfChannels: 1 }, [{
+      data: Buffer.from(samples.buffer),
+      options: { format: 's16', sampleRate: 44100, numberOfFrames: frames, numberOfChannels: 1, timestamp: 0 },
+    }]);
+
+    // Opus has no 44.1 kHz mode; the session runs at 48 kHz instead
+    expect(sampleRate).toBe(48000);
+    expect(packets.length).toBeGreaterThanOrEqual(5);
+  });
+
+  it('should round-trip s16 samples through FLAC bit exactly', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frames = 10000;
+    const samples = new Int16Array(frames * 2);
+    for (let i = 0; i < samples.length; i++) {
+      samples[i] = ((i * 7919) % 65536) - 32768;
+    }
+    const input = Buffer.from(samples.buffer);
+    const { packets, description } = await encodeAll({ codec: 'flac', sampleRate: 44100, numberOfChannels: 2 }, [{
+      data: input,
+      options: { format: 's16', sampleRate: 44100, numberOfFrames: frames, numberOfChannels: 2, timestamp: 0 },
+    }]);
+
+    expect(description?.subarray(0, 4).toString('latin1')).toBe('fLaC');
+
+    const decoded = await decodeAll({ codec: 'flac', sampleRate: 44100, numberOfChannels: 2, description }, packets);
+    expect(decoded.every(d => d.format === 's16' && d.sampleRate === 44100)).toBe(true);
+    expect(Buffer.concat(decoded.map(d => d.data))).toEqual(input);
+  });
+
+  it('should reject unsupported audio codec strings', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const callbacks = { output: () => {}, error: () => {}, dequeue: () => {} };
+    expect(() => new native.NativeAudioEncoder({ codec: 'mp4a.40.5', sampleRate: 48000, numberOfChannels: 2 }, callbacks)).toThrow(TypeError);
+    expect(() => new native.NativeAudioDecoder({ codec: 'vorbis', sampleRate: 48000, numberOfChannels: 2 }, callbacks)).toThrow(TypeError);
+  });
+});
@@ -0,0 +1,75 @@
+/**
+ * Native Benchmark Tests (Node.js only)
+ *
+ * These tests verify the addon's benchmark() entry point that bench/run.ts
+ * builds on: every stage runs the requested number of iterations and
+ * reports consistent timings, and bad configs are rejected.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+describe('Native Benchmark', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should time conversions, scaled or not', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const same = native.benchmark({ stage: 'convert', width: 64, height: 64, frames: 5 });
+    expect(same.stage).toBe('convert');
+    expect(same.iterations).toBe(5);
+    // RGBA -> I420 at 64x64
+    expect(same.bytes).toBe(5 * 64 * 64 * 3 / 2);
+
+    const scaled = native.benchmark({
+      stage: 'convert', width: 128, height: 128, frames: 3, format: 'I420', outputFormat: 'RGBA',
+      outputWidth: 32, outputHeight: 32,
+    });
+    expect(scaled.bytes).toBe(3 * 32 * 32 * 4);
+  });
+
+  it('should report encode and decode timings', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    for (const stage of ['encode', 'decode']) {
+      const result = native.benchmark({ stage, codec: 'vp8', width: 64, height: 64, frames: 10 });
+      expect(result.iterations).toBe(10);
+      expect(result.bytes).toBeGreaterThan(0);
+      expect(result.fps).toBeGreaterThan(0);
+      expect(result.minMs).toBeLessThanOrEqual(result.p50Ms);
+      expect(result.p50Ms).toBeLessThanOrEqual(result.p99Ms);
+      expect(result.p99Ms).toBeLessThanOrEqual(result.maxMs);
+      expect(result.totalMs).toBeGreaterThanOrEqual(result.maxMs);
+    }
+  });
+
+  it('should reject bad configs', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(() => native.benchmark({ stage: 'mux', width: 64, height: 64 })).toThrow(TypeError);
+    expect(() => native.benchmark({ stage: 'encode', codec: 'invalid-codec', width: 64, height: 64 })).toThrow(TypeError);
+    expect(() => native.benchmark({ stage: 'convert', width: 0, height: 64 })).toThrow(RangeError);
+    expect(() => native.benchmark({ stage: 'convert', width: 64, height: 64, frames: 0 })).toThrow(RangeError);
+  });
+});
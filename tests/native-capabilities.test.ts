@@ -0,0 +1,116 @@
+/**
+ * Native Codec Capability Tests (Node.js only)
+ *
+ * These tests verify the capability table the addon builds once per
+ * process: hasCodec()/listCodecs() answer from it, and
+ * isVideoConfigSupported() checks codec strings, H.264 levels and
+ * picture sizes against what the FFmpeg build can actually open.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { VideoDecoder, VideoEncoder } from '../src/index.js';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+describe('Native Codec Capabilities', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should list the same codecs hasCodec() reports', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const vp = native.listCodecs('vp');
+    expect(vp.length).toBeGreaterThan(0);
+    for (const codec of vp as Array<{ name: string; isEncoder: boolean; isDecoder: boolean; type: string }>) {
+      expect(codec.name).toContain('vp');
+      const found = native.hasCodec(codec.name);
+      if (codec.isEncoder) {
+        expect(found.encoder).toBe(true);
+      }
+      if (codec.isDecoder) {
+        expect(found.decoder).toBe(true);
+      }
+    }
+    expect(native.hasCodec('no-such-codec')).toEqual({ decoder: false, encoder: false });
+  });
+
+  it('should accept configs a session can open', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(native.isVideoConfigSupported({ codec: 'vp8', width: 640, height: 480 }, 'encoder')).toBe(true);
+    expect(native.isVideoConfigSupported({ codec: 'vp8' }, 'decoder')).toBe(true);
+    expect(native.isVideoConfigSupported({ codec: 'vp09.00.10.08', width: 1920, height: 1080 }, 'decoder')).toBe(true);
+  });
+
+  it('should reject unknown codecs, unsupported profiles and oversized pictures', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(native.isVideoConfigSupported({ codec: 'invalid-codec' }, 'encoder')).toBe(false);
+    // 10-bit VP9 and High 4:4:4 H.264 are outside the registry
+    expect(native.isVideoConfigSupported({ codec: 'vp09.02.10.10' }, 'decoder')).toBe(false);
+    expect(native.isVideoConfigSupported({ codec: 'avc1.f4001f' }, 'decoder')).toBe(false);
+    expect(native.isVideoConfigSupported({ codec: 'vp8', width: 20000, height: 480 }, 'encoder')).toBe(false);
+    expect(native.isVideoConfigSupported({ codec: 'vp8', width: 64, height: 64, hardwareAcceleration: 'bogus' }, 'encoder')).toBe(false);
+  });
+
+  it('should enforce the H.264 level picture size', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Level 3.0 allows 1620 macroblocks: 720x576 fits, 1280x720 does not
+    expect(native.isVideoConfigSupported({ codec: 'avc1.42001e', width: 720, height: 576 }, 'decoder')).toBe(true);
+    expect(native.isVideoConfigSupported({ codec: 'avc1.42001e', width: 1280, height: 720 }, 'decoder')).toBe(false);
+    // Level 4.0 takes 1080p
+    expect(native.isVideoConfigSupported({ codec: 'avc1.640028', width: 1920, height: 1080 }, 'decoder')).toBe(true);
+  });
+
+  it('should back VideoEncoder and VideoDecoder isConfigSupported()', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const encoderSupport = await VideoEncoder.isConfigSupported({ codec: 'vp8', width: 320, height: 240, bitrate: 500000 });
+    expect(encoderSupport.supported).toBe(true);
+    expect(encoderSupport.config).toEqual({ codec: 'vp8', width: 320, height: 240, bitrate: 500000 });
+
+    const decoderSupport = await VideoDecoder.isConfigSupported({ codec: 'avc1.42001e', codedWidth: 1280, codedHeight: 720 });
+    expect(decoderSupport.supported).toBe(false);
+    expect(decoderSupport.config).toBeUndefined();
+  });
+
+  it('should reject scalability modes other than L1T1', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const config = { codec: 'vp8', width: 320, height: 240, bitrate: 500000 };
+    expect((await VideoEncoder.isConfigSupported({ ...config, scalabilityMode: 'L1T1' })).supported).toBe(true);
+    expect((await VideoEncoder.isConfigSupported({ ...config, scalabilityMode: 'L1T3' })).supported).toBe(false);
+
+    const errors: Error[] = [];
+    const encoder = new VideoEncoder({ output: () => {}, error: e => errors.push(e) });
+    encoder.configure({ ...config, scalabilityMode: 'L1T2' });
+    expect(errors.map(e => e.name)).toEqual(['NotSupportedError']);
+    expect(encoder.state).toBe('closed');
+  });
+});
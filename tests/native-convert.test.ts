@@ -0,0 +1,127 @@
+/**
+ * Native Pixel Conversion Tests (Node.js only)
+ *
+ * These tests verify convertFrame() and frameAllocationSize(), the native
+ * entry points VideoFrame.copyTo() and allocationSize() use for pixel
+ * format conversion, and validateFrameLayout(), which the VideoFrame
+ * constructor runs before it detaches a transferred buffer.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+function solidRgba(width: number, height: number, r: number, g: number, b: number): Uint8Array {
+  const data = new Uint8Array(width * height * 4);
+  for (let i = 0; i < width * height; i++) {
+    data.set([r, g, b, 255], i * 4);
+  }
+  return data;
+}
+
+describe('Native Pixel Conversion', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should report allocation sizes for every supported format', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(native.frameAllocationSize('I420', 64, 48)).toBe(64 * 48 * 3 / 2);
+    expect(native.frameAllocationSize('NV12', 64, 48)).toBe(64 * 48 * 3 / 2);
+    expect(native.frameAllocationSize('RGBA', 64, 48)).toBe(64 * 48 * 4);
+    expect(native.frameAllocationSize('BGRA', 64, 48)).toBe(64 * 48 * 4);
+    expect(native.frameAllocationSize('RGB24', 64, 48)).toBe(64 * 48 * 3);
+    // Odd sizes round the chroma planes up
+    expect(native.frameAllocationSize('I420', 3, 3)).toBe(9 + 4 + 4);
+    expect(native.frameAllocationSize('XYZ', 64, 48)).toBe(0);
+  });
+
+  it('should validate frame layouts without building a frame', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const init = { format: 'I420', codedWidth: 32, codedHeight: 16 };
+    expect(native.validateFrameLayout(32 * 16 * 3 / 2, init)).toBeUndefined();
+    expect(() => native.validateFrameLayout(32 * 16, init)).toThrow(TypeError);
+    expect(() => native.validateFrameLayout(1024, { ...init, format: 'XYZ' })).toThrow(TypeError);
+    expect(() => native.validateFrameLayout(1024, { ...init, codedWidth: 0 })).toThrow(TypeError);
+    expect(() => native.validateFrameLayout(32 * 16 * 3 / 2, {
+      ...init, layout: [{ offset: 0, stride: 16 }, { offset: 512, stride: 16 }, { offset: 640, stride: 16 }],
+    })).toThrow(TypeError);
+  });
+
+  it('should round-trip RGBA through I420 and NV12', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const width = 32;
+    const height = 16;
+    const rgba = solidRgba(width, height, 0xDE, 0xAD, 0xBE);
+    const init = { codedWidth: width, codedHeight: height };
+
+    const i420 = new Uint8Array(native.frameAllocationSize('I420', width, height));
+    native.convertFrame(rgba, { format: 'RGBA', ...init }, i420, { format: 'I420' });
+
+    const nv12 = new Uint8Array(native.frameAllocationSize('NV12', width, height));
+    const nv12Layout = native.convertFrame(i420, { format: 'I420', ...init }, nv12, { format: 'NV12' });
+    expect(nv12Layout).toEqual([{ offset: 0, stride: width }, { offset: width * height, stride: width }]);
+
+    const bgra = new Uint8Array(width * height * 4);
+    native.convertFrame(nv12, { format: 'NV12', ...init }, bgra, { format: 'BGRA' });
+
+    expect(Math.abs(bgra[0] - 0xBE)).toBeLessThanOrEqual(8);
+    expect(Math.abs(bgra[1] - 0xAD)).toBeLessThanOrEqual(8);
+    expect(Math.abs(bgra[2] - 0xDE)).toBeLessThanOrEqual(8);
+  });
+
+  it('should reuse cached scalers for repeated conversions', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const width = 40;
+    const height = 24;
+    const rgba = solidRgba(width, height, 10, 20, 30);
+    const i420 = new Uint8Array(native.frameAllocationSize('I420', width, height));
+    const before = native.getScalerCacheStats();
+
+    const iterations = 10;
+    for (let i = 0; i < iterations; i++) {
+      native.convertFrame(rgba, { format: 'RGBA', codedWidth: width, codedHeight: height }, i420, { format: 'I420' });
+    }
+
+    const after = native.getScalerCacheStats();
+    expect(after.misses - before.misses).toBeLessThanOrEqual(1);
+    expect(after.hits - before.hits).toBeGreaterThanOrEqual(iterations - 1);
+    expect(after.idle).toBeGreaterThanOrEqual(1);
+  });
+
+  it('should reject destinations that are too small', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const rgba = solidRgba(16, 16, 1, 2, 3);
+    expect(() => native.convertFrame(
+      rgba, { format: 'RGBA', codedWidth: 16, codedHeight: 16 },
+      new Uint8Array(10), { format: 'I420' },
+    )).toThrow(TypeError);
+  });
+});
@@ -57,6 +57,15 @@ function colorsMatch(
   );
 }
 
+// BT.601 limited-range RGB -> YUV, as libswscale converts encoder input
+function rgbToYuv({ r, g, b }: { r: number; g: number; b: number }): { y: number; u: number; v: number } {
+  return {
+    y: 16 + (65.481 * r + 128.553 * g + 24.966 * b) / 255,
+    u: 128 + (-37.797 * r - 74.203 * g + 112 * b) / 255,
+    v: 128 + (112 * r - 93.786 * g - 18.214 * b) / 255,
+  };
+}
+
 describe('Native Addon Loading', () => {
   it('should load the native addon', () => {
     const native = tryLoadNative();
@@ -221,6 +230,84 @@ describe('VP8 Decode with Secret Color Verification', () => {
   });
 });
 
+describe('VP9 Decode with Secret Color Verification', () => {
+  const fixturesDir = join(__dirname, '..', 'fixtures', 'vp9');
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  const cases = [
+    { file: 'vp9-red-64x64.ivf', color: SECRET_COLORS.RED },
+    { file: 'vp9-secret1-64x64.ivf', color: SECRET_COLORS.SECRET_1 },
+    { file: 'vp9-secret1-64x64-lossless.ivf', color: SECRET_COLORS.SECRET_1 },
+  ];
+
+  for (const { file, color } of cases) {
+    it(`should decode ${file} and verify color`, () => {
+      if (!native) {
+        expect.fail('Native addon not available');
+      }
+
+      const ivfPath = join(fixturesDir, file);
+      if (!existsSync(ivfPath)) {
+        expect.fail('Test fixtures not found - run npm run generate:fixtures');
+      }
+
+      // IVF framing is codec-independent
+      const frameData = extractVP8Frame(ivfPath);
+      const result = native.decodeFrame(frameData, { codec: 'vp09.00.10.08' });
+
+      expect(result.width).toBe(64);
+      expect(result.height).toBe(64);
+
+      const actualColor = { r: result.firstPixelR, g: result.firstPixelG, b: result.firstPixelB };
+      expect(colorsMatch(actualColor, color, COLOR_TOLERANCE)).toBe(true);
+    });
+  }
+
+  it('should decode VP9 fixtures through a NativeVideoDecoder session', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const ivfPath = join(fixturesDir, 'vp9-secret1-64x64.ivf');
+    if (!existsSync(ivfPath)) {
+      expect.fail('Test fixtures not found - run npm run generate:fixtures');
+    }
+
+    const frames: Array<{ width: number; height: number; format: string | null; timestamp?: number }> = [];
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp09.00.10.08' }, {
+      output: (result: { frame: { close(): void }; width: number; height: number; format: string | null; timestamp?: number }) => {
+        frames.push(result);
+        result.frame.close();
+      },
+      error: (err: Error) => { throw err; },
+      dequeue: () => {},
+    });
+
+    decoder.decode(extractVP8Frame(ivfPath), { timestamp: 0 });
+    await new Promise<void>((resolve) => decoder.flush(resolve));
+    decoder.close();
+
+    expect(frames).toHaveLength(1);
+    expect(frames[0].width).toBe(64);
+    expect(frames[0].format).toBe('I420');
+    expect(frames[0].timestamp).toBe(0);
+  });
+
+  it('should reject unsupported codec strings', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // VP9 profile 2 is 10-bit
+    expect(() => native.decodeFrame(Buffer.alloc(16), { codec: 'vp09.02.10.10' })).toThrow(TypeError);
+    expect(() => native.decodeFrame(Buffer.alloc(16), { codec: 'theora' })).toThrow(TypeError);
+  });
+});
+
 describe('Negative Tests - Verify We Detect Failures', () => {
   it('should fail if we check for wrong color (sanity check)', () => {
     const native = tryLoadNative();
@@ -252,3 +339,143 @@ describe('Negative Tests - Verify We Detect Failures', () => {
     console.log('Sanity check passed: Red frame does not match green expectation');
   });
 });
+
+describe('NativeVideoDecoder Session', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should decode a keyframe followed by delta frames', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const { r, g, b } = SECRET_COLORS.SECRET_1;
+    const rgbData = Buffer.alloc(64 * 64 * 3);
+    for (let i = 0; i < 64 * 64; i++) {
+      rgbData[i * 3] = r;
+      rgbData[i * 3 + 1] = g;
+      rgbData[i * 3 + 2] = b;
+    }
+
+    const packets: Array<{ data: Buffer; isKeyframe: boolean; timestamp: number }> = [];
+    await new Promise<void>((resolve, reject) => {
+      const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 1000000 }, {
+        output: (packet: { data: Buffer; isKeyframe: boolean; timestamp: number }) => packets.push(packet),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (let i = 0; i < 5; i++) {
+        encoder.encode(rgbData, { timestamp: i * 33333, format: 'RGB24' });
+      }
+      encoder.flush(() => {
+        encoder.close();
+        resolve();
+      });
+    });
+    expect(packets.filter(p => !p.isKeyframe).length).toBeGreaterThan(0);
+
+    type DecodedFrame = {
+      frame: { copyTo(dest: Uint8Array): Array<{ offset: number; stride: number }>; close(): void };
+      width: number;
+      height: number;
+      format: string;
+      timestamp: number;
+    };
+    const frames: DecodedFrame[] = [];
+    await new Promise<void>((resolve, reject) => {
+      const decoder = new native.NativeVideoDecoder({ codec: 'vp8' }, {
+        output: (frame: DecodedFrame) => frames.push(frame),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (const packet of packets) {
+        decoder.decode(packet.data, { timestamp: packet.timestamp });
+      }
+      decoder.flush(() => {
+        decoder.close();
+        resolve();
+      });
+    });
+
+    expect(frames.length).toBe(5);
+    const expected = rgbToYuv(SECRET_COLORS.SECRET_1);
+    for (let i = 0; i < frames.length; i++) {
+      expect(frames[i].timestamp).toBe(i * 33333);
+      expect(frames[i].format).toBe('I420');
+
+      // Output is the decoder's own I420 picture, not an RGB conversion
+      const i420 = new Uint8Array(64 * 64 * 3 / 2);
+      const layout = frames[i].frame.copyTo(i420);
+      expect(layout).toEqual([
+        { offset: 0, stride: 64 },
+        { offset: 64 * 64, stride: 32 },
+        { offset: 64 * 64 + 32 * 32, stride: 32 },
+      ]);
+      expect(Math.abs(i420[0] - expected.y)).toBeLessThanOrEqual(COLOR_TOLERANCE);
+      expect(Math.abs(i420[layout[1].offset] - expected.u)).toBeLessThanOrEqual(COLOR_TOLERANCE);
+      expect(Math.abs(i420[layout[2].offset] - expected.v)).toBeLessThanOrEqual(COLOR_TOLERANCE);
+      frames[i].frame.close();
+    }
+  });
+
+  it('should only decode keyframes in keyframesOnly mode', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Array<{ data: Buffer; isKeyframe: boolean; timestamp: number }> = [];
+    await new Promise<void>((resolve, reject) => {
+      const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 500000, gopSize: 4 }, {
+        output: (packet: { data: Buffer; isKeyframe: boolean; timestamp: number }) => packets.push(packet),
+        error: reject,
+        dequeue: () => {},
+      });
+      const frame = Buffer.alloc(64 * 64 * 3, 90);
+      for (let i = 0; i < 12; i++) {
+        encoder.encode(frame, { timestamp: i, format: 'RGB24' });
+      }
+      encoder.flush(() => {
+        encoder.close();
+        resolve();
+      });
+    });
+    const keyframes = packets.filter(p => p.isKeyframe).map(p => p.timestamp);
+    expect(keyframes.length).toBeGreaterThan(1);
+    expect(keyframes.length).toBeLessThan(packets.length);
+
+    const timestamps: number[] = [];
+    let dequeues = 0;
+    const queued: boolean[] = [];
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp8', keyframesOnly: true, lowres: 1 }, {
+      output: (frame: { frame: { close(): void }; width: number; timestamp: number }) => {
+        // lowres is clamped to what the decoder supports
+        expect(frame.width).toBe(64 >> decoder.lowres);
+        timestamps.push(frame.timestamp);
+        frame.frame.close();
+      },
+      error: (e: Error) => { throw e; },
+      dequeue: () => dequeues++,
+    });
+    for (const packet of packets) {
+      queued.push(decoder.decode(packet.data, { timestamp: packet.timestamp, keyFrame: packet.isKeyframe }));
+    }
+    await new Promise<void>(resolve => decoder.flush(resolve));
+    decoder.close();
+
+    expect(queued).toEqual(packets.map(p => p.isKeyframe));
+    expect(dequeues).toBe(keyframes.length);
+    expect(timestamps).toEqual(keyframes);
+  });
+
+  it('should reject an out-of-range lowres', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const callbacks = { output: () => {}, error: () => {}, dequeue: () => {} };
+    expect(() => new native.NativeVideoDecoder({ codec: 'vp8', lowres: 4 }, callbacks)).toThrow(RangeError);
+  });
+});
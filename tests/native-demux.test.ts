@@ -0,0 +1,213 @@
+/**
+ * Native Demuxer Tests (Node.js only)
+ *
+ * Encodes a short VP8 sequence, wraps it in an IVF container and checks
+ * that NativeDemuxer reports the track and yields the original packets,
+ * from a file, from written bytes, and straight into a decoder session.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { writeFileSync, mkdtempSync, rmSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+type Packet = { data: Buffer; isKeyframe: boolean; timestamp: number };
+type Chunk = { data: Buffer; type: 'key' | 'delta'; timestamp: number; duration?: number };
+type Track = { codec: string; codedWidth: number; codedHeight: number };
+
+const WIDTH = 64;
+const HEIGHT = 64;
+const FRAME_COUNT = 5;
+
+// IVF with a microsecond timebase, so frame pts are the packet timestamps
+function buildIvf(packets: Packet[]): Buffer {
+  const header = Buffer.alloc(32);
+  header.write('DKIF', 0, 'ascii');
+  header.writeUInt16LE(0, 4);
+  header.writeUInt16LE(32, 6);
+  header.write('VP80', 8, 'ascii');
+  header.writeUInt16LE(WIDTH, 12);
+  header.writeUInt16LE(HEIGHT, 14);
+  header.writeUInt32LE(1000000, 16);
+  header.writeUInt32LE(1, 20);
+  header.writeUInt32LE(packets.length, 24);
+
+  const parts = [header];
+  for (const packet of packets) {
+    const frameHeader = Buffer.alloc(12);
+    frameHeader.writeUInt32LE(packet.data.length, 0);
+    frameHeader.writeBigUInt64LE(BigInt(packet.timestamp), 4);
+    parts.push(frameHeader, packet.data);
+  }
+  return Buffer.concat(parts);
+}
+
+function demux(native: NonNullable<ReturnType<typeof tryLoadNative>>, source: { path?: string },
+               feed?: (demuxer: { write(data: Buffer): void; end(): void }) => void) {
+  return new Promise<{ track: Track; chunks: Chunk[] }>((resolve, reject) => {
+    let track: Track | null = null;
+    const chunks: Chunk[] = [];
+    const demuxer = new native.NativeDemuxer(source, {
+      config: (t: Track) => {
+        track = t;
+        demuxer.start();
+      },
+      chunk: (chunk: Chunk) => chunks.push(chunk),
+      end: () => {
+        demuxer.close();
+        resolve({ track: track!, chunks });
+      },
+      error: reject,
+    });
+    feed?.(demuxer);
+  });
+}
+
+describe('NativeDemuxer', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+  let packets: Packet[] = [];
+  let ivf: Buffer;
+
+  beforeAll(async () => {
+    native = tryLoadNative();
+    if (!native) {
+      return;
+    }
+
+    const rgbData = Buffer.alloc(WIDTH * HEIGHT * 3);
+    for (let i = 0; i < rgbData.length; i++) {
+      rgbData[i] = (i * 7) & 0xff;
+    }
+    await new Promise<void>((resolve, reject) => {
+      const encoder = new native.NativeVideoEncoder({ width: WIDTH, height: HEIGHT, bitrate: 1000000 }, {
+        output: (packet: Packet) => packets.push(packet),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (let i = 0; i < FRAME_COUNT; i++) {
+        encoder.encode(rgbData, { timestamp: i * 33333, format: 'RGB24' });
+      }
+      encoder.flush(() => {
+        encoder.close();
+        resolve();
+      });
+    });
+    ivf = buildIvf(packets);
+  });
+
+  it('should demux an IVF file into the encoded packets', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const dir = mkdtempSync(join(tmpdir(), 'webcodecs-demux-'));
+    try {
+      const path = join(dir, 'clip.ivf');
+      writeFileSync(path, ivf);
+      const { track, chunks } = await demux(native, { path });
+
+      expect(track).toMatchObject({ codec: 'vp8', codedWidth: WIDTH, codedHeight: HEIGHT });
+      expect(chunks.length).toBe(packets.length);
+      expect(chunks[0].type).toBe('key');
+      for (let i = 0; i < chunks.length; i++) {
+        expect(chunks[i].timestamp).toBe(packets[i].timestamp);
+        expect(chunks[i].data.equals(packets[i].data)).toBe(true);
+      }
+    } finally {
+      rmSync(dir, { recursive: true, force: true });
+    }
+  });
+
+  it('should demux container bytes written in pieces', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const { track, chunks } = await demux(native, {}, (demuxer) => {
+      for (let offset = 0; offset < ivf.length; offset += 100) {
+        demuxer.write(ivf.subarray(offset, offset + 100));
+      }
+      demuxer.end();
+    });
+
+    expect(track.codec).toBe('vp8');
+    expect(chunks.map(c => c.timestamp)).toEqual(packets.map(p => p.timestamp));
+  });
+
+  it('should report input that is not a container', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const result = demux(native, {}, (demuxer) => {
+      demuxer.write(Buffer.alloc(4096, 0x5a));
+      demuxer.end();
+    });
+    await expect(result).rejects.toThrow();
+  });
+
+  it('should feed a decoder session without surfacing chunks in JS', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const timestamps: number[] = [];
+    let dequeues = 0;
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp8' }, {
+      output: (frame: { frame: { close(): void }; timestamp: number }) => {
+        timestamps.push(frame.timestamp);
+        frame.frame.close();
+      },
+      error: (e: Error) => expect.fail(e.message),
+      dequeue: () => dequeues++,
+    });
+
+    let chunks = 0;
+    await new Promise<void>((resolve, reject) => {
+      const demuxer = new native.NativeDemuxer({}, {
+        config: (track: Track) => {
+          expect(track.codec).toBe('vp8');
+          demuxer.start(decoder);
+        },
+        chunk: () => chunks++,
+        end: () => {
+          demuxer.close();
+          resolve();
+        },
+        error: reject,
+      });
+      demuxer.write(ivf);
+      demuxer.end();
+    });
+    await new Promise<void>((resolve) => decoder.flush(resolve));
+    decoder.close();
+
+    expect(chunks).toBe(0);
+    expect(dequeues).toBe(0);
+    expect(timestamps).toEqual(packets.map(p => p.timestamp));
+  });
+
+  it('should reject a start target that is not a decoder', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const demuxer = new native.NativeDemuxer({}, {
+      config: () => {},
+      chunk: () => {},
+      end: () => {},
+      error: () => {},
+    });
+    expect(() => demuxer.start({})).toThrow(TypeError);
+    demuxer.close();
+  });
+});
@@ -237,3 +237,490 @@ describe('VP8 Encode → Decode Round-Trip', () => {
     }
   });
 });
+
+describe('NativeVideoEncoder Session', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  // Encode frames on a session and resolve with every packet once flushed
+  function encodeAll(
+    config: Record<string, number>,
+    frames: Array<{ data: Buffer; timestamp: number; keyFrame?: boolean }>
+  ): Promise<Array<{ data: Buffer; isKeyframe: boolean; timestamp: number }>> {
+    return new Promise((resolve, reject) => {
+      const packets: Array<{ data: Buffer; isKeyframe: boolean; timestamp: number }> = [];
+      const encoder = new native.NativeVideoEncoder(config, {
+        output: (packet: { data: Buffer; isKeyframe: boolean; timestamp: number }) => packets.push(packet),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (const frame of frames) {
+        encoder.encode(frame.data, { timestamp: frame.timestamp, keyFrame: frame.keyFrame, format: 'RGB24' });
+      }
+      encoder.flush(() => {
+        encoder.close();
+        resolve(packets);
+      });
+    });
+  }
+
+  it('should emit delta frames between keyframes', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frames = Array.from({ length: 10 }, (_, i) => ({
+      data: createSolidColorFrame(64, 64, { r: 20 * i, g: 0, b: 0 }),
+      timestamp: i * 33333,
+    }));
+    const packets = await encodeAll({ width: 64, height: 64, bitrate: 500000, framerate: 30 }, frames);
+
+    expect(packets.length).toBe(10);
+    expect(packets[0].isKeyframe).toBe(true);
+    expect(packets.slice(1).some(p => !p.isKeyframe)).toBe(true);
+
+    // Timestamps come back in order on the matching packets
+    expect(packets.map(p => p.timestamp)).toEqual(frames.map(f => f.timestamp));
+  });
+
+  it('should force a keyframe when keyFrame is requested', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frames = Array.from({ length: 6 }, (_, i) => ({
+      data: createSolidColorFrame(64, 64, SECRET_COLORS.SECRET_1),
+      timestamp: i,
+      keyFrame: i === 4,
+    }));
+    const packets = await encodeAll({ width: 64, height: 64, bitrate: 500000 }, frames);
+
+    expect(packets[0].isKeyframe).toBe(true);
+    expect(packets[4].isKeyframe).toBe(true);
+    expect(packets[3].isKeyframe).toBe(false);
+  });
+
+  it('should hand out packet data that outlives the encoder', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Noise keeps the keyframe large enough to be passed without a copy
+    const width = 320;
+    const height = 240;
+    const noise = Buffer.alloc(width * height * 3 / 2);
+    for (let i = 0; i < noise.length; i++) {
+      noise[i] = (i * 2654435761) >>> 24;
+    }
+    const packets = await new Promise<Array<{ data: Buffer; size: number }>>((resolve, reject) => {
+      const out: Array<{ data: Buffer; size: number }> = [];
+      const encoder = new native.NativeVideoEncoder({ width, height, bitrate: 8000000 }, {
+        output: (packet: { data: Buffer; size: number }) => out.push(packet),
+        error: reject,
+        dequeue: () => {},
+      });
+      encoder.encode(noise, { timestamp: 0 });
+      encoder.flush(() => {
+        encoder.close();
+        resolve(out);
+      });
+    });
+
+    expect(packets.length).toBe(1);
+    expect(packets[0].size).toBeGreaterThan(4096);
+    expect(packets[0].data.length).toBe(packets[0].size);
+    const decoded = native.decodeFrame(packets[0].data, { codec: 'vp8' });
+    expect(decoded.width).toBe(width);
+    expect(decoded.height).toBe(height);
+  });
+
+  it('should keep packet slots pooled while JS retains the chunks', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Noise keeps every chunk past the copy threshold, yet far below the
+    // packet slot, which is sized for a quarter of a raw frame
+    const width = 640;
+    const height = 480;
+    const count = 300;
+    const slotBytes = width * height * 3 / 2 / 4;
+    const noise = Buffer.alloc(width * height * 3 / 2);
+    for (let i = 0; i < noise.length; i++) {
+      noise[i] = (i * 2654435761) >>> 24;
+    }
+    const before = process.memoryUsage();
+    const retained: Buffer[] = [];
+    const stats = await new Promise<{ allocations: number; reuses: number; overflows: number }>((resolve, reject) => {
+      const encoder = new native.NativeVideoEncoder({ width, height, bitrate: 4000000, maxQueueDepth: 4, poolMemoryLimit: 8 * 1024 * 1024 }, {
+        output: (packet: { data: Buffer }) => retained.push(packet.data),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (let i = 0; i < count; i++) {
+        encoder.encode(noise, { timestamp: i * 33333 });
+      }
+      encoder.flush(() => {
+        const poolStats = encoder.poolStats;
+        encoder.close();
+        resolve(poolStats);
+      });
+    });
+    const after = process.memoryUsage();
+    const payload = retained.reduce((sum, data) => sum + data.length, 0);
+
+    expect(retained.length).toBe(count);
+    // Retained chunks are exact-size copies, so the slots go back to the pool
+    // and the session stays within its 8 MB budget
+    expect(stats.overflows).toBe(0);
+    expect(stats.reuses).toBeGreaterThan(stats.allocations);
+    expect(after.external - before.external).toBeLessThan(payload * 2 + 4 * 1024 * 1024);
+    // Pinning a slot per chunk would cost count * slotBytes
+    expect(after.rss - before.rss).toBeLessThan(count * slotBytes);
+  });
+
+  // Encode `count` gray I420 frames and resolve with the session's pool stats
+  function encodePooled(config: Record<string, number>, count: number) {
+    return new Promise<{ pooledBytes: number; limit: number; allocations: number; reuses: number; overflows: number }>((resolve, reject) => {
+      const encoder = new native.NativeVideoEncoder(config, { output: () => {}, error: reject, dequeue: () => {} });
+      const frame = Buffer.alloc(64 * 64 * 3 / 2, 128);
+      for (let i = 0; i < count; i++) {
+        encoder.encode(frame, { timestamp: i * 33333 });
+      }
+      encoder.flush(() => {
+        const stats = encoder.poolStats;
+        encoder.close();
+        resolve(stats);
+      });
+    });
+  }
+
+  it('should reuse pooled frame and packet buffers across encodes', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const stats = await encodePooled({ width: 64, height: 64, bitrate: 500000 }, 60);
+
+    expect(stats.limit).toBe(0);
+    expect(stats.overflows).toBe(0);
+    // At most a queue's worth of input buffers is ever live, so later
+    // encodes are served from the pool
+    expect(stats.allocations).toBeGreaterThan(0);
+    expect(stats.reuses).toBeGreaterThan(stats.allocations);
+    expect(stats.pooledBytes).toBeGreaterThan(0);
+  });
+
+  it('should stop pooling past poolMemoryLimit', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const stats = await encodePooled({ width: 64, height: 64, bitrate: 500000, poolMemoryLimit: 1 }, 10);
+
+    expect(stats.limit).toBe(1);
+    expect(stats.allocations).toBe(0);
+    expect(stats.pooledBytes).toBe(0);
+    expect(stats.overflows).toBeGreaterThanOrEqual(10);
+  });
+
+  it('should emit each packet as its frame is consumed in realtime mode', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Packets are posted ahead of the dequeue for the same frame, so without
+    // lookahead every frame's packet has arrived by its dequeue()
+    const outputsAtDequeue = await new Promise<number[]>((resolve, reject) => {
+      let outputs = 0;
+      const counts: number[] = [];
+      const encoder = new native.NativeVideoEncoder(
+        { width: 64, height: 64, bitrate: 500000, latencyMode: 'realtime', threads: 2 }, {
+          output: () => outputs++,
+          error: reject,
+          dequeue: () => {
+            counts.push(outputs);
+            if (counts.length === 5) {
+              encoder.close();
+              resolve(counts);
+            }
+          },
+        });
+      for (let i = 0; i < 5; i++) {
+        encoder.encode(createSolidColorFrame(64, 64, { r: 40 * i, g: 0, b: 0 }), { timestamp: i, format: 'RGB24' });
+      }
+    });
+
+    expect(outputsAtDequeue).toEqual([1, 2, 3, 4, 5]);
+  });
+
+  it('should reject invalid latencyMode and threads', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const callbacks = { output: () => {}, error: () => {}, dequeue: () => {} };
+    expect(() => new native.NativeVideoEncoder({ width: 64, height: 64, latencyMode: 'fast' }, callbacks)).toThrow(TypeError);
+    expect(() => new native.NativeVideoEncoder({ width: 64, height: 64, threads: -1 }, callbacks)).toThrow(RangeError);
+  });
+
+  it('should deliver packets before flush and resolve the flush promise after the last', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Array<{ timestamp: number }> = [];
+    let firstPacket: () => void;
+    const streamed = new Promise<void>(resolve => { firstPacket = resolve; });
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 500000, latencyMode: 'realtime' }, {
+      output: (packet: { timestamp: number }) => { packets.push(packet); firstPacket(); },
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    const frame = Buffer.alloc(64 * 64 * 3 / 2, 128);
+    for (let i = 0; i < 10; i++) {
+      encoder.encode(frame, { timestamp: i * 33333 });
+    }
+
+    // Output does not wait for a flush
+    await streamed;
+    expect(packets.length).toBeGreaterThan(0);
+
+    const done = encoder.flush();
+    expect(done).toBeInstanceOf(Promise);
+    await done;
+    expect(packets.length).toBe(10);
+    encoder.close();
+  });
+
+  // Encode I420 noise, varied per frame so every packet carries real bits
+  async function encodeNoise(
+    config: Record<string, unknown>,
+    frames: Array<{ timestamp: number; quantizer?: number; bitrate?: number }>
+  ): Promise<Array<{ size: number; isKeyframe: boolean; timestamp: number }>> {
+    const packets: Array<{ size: number; isKeyframe: boolean; timestamp: number }> = [];
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, ...config }, {
+      output: (packet: { size: number; isKeyframe: boolean; timestamp: number }) => packets.push(packet),
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    const noise = Buffer.alloc(64 * 64 * 3 / 2);
+    frames.forEach((frame, f) => {
+      if (frame.bitrate) {
+        encoder.reconfigure({ bitrate: frame.bitrate });
+      }
+      for (let i = 0; i < noise.length; i++) {
+        noise[i] = ((i + f * 7919) * 2654435761) >>> 24;
+      }
+      encoder.encode(noise, { timestamp: frame.timestamp, quantizer: frame.quantizer });
+    });
+    await encoder.flush();
+    encoder.close();
+    return packets;
+  }
+
+  it('should restore irregular timestamps on the packets', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const timestamps = [0, 0, 5, 1000000, 999999, 2000000];
+    const packets = await encodeNoise({ bitrate: 500000 }, timestamps.map(timestamp => ({ timestamp })));
+    expect(packets.map(p => p.timestamp)).toEqual(timestamps);
+  });
+
+  it('should switch bitrate mid-stream with reconfigure()', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frames = Array.from({ length: 40 }, (_, i) => ({
+      timestamp: i * 33333,
+      bitrate: i === 20 ? 4000000 : undefined,
+    }));
+    const packets = await encodeNoise({ bitrate: 100000, bitrateMode: 'constant', latencyMode: 'realtime' }, frames);
+    expect(packets.map(p => p.timestamp)).toEqual(frames.map(f => f.timestamp));
+
+    const bytes = (from: number, to: number) => packets.slice(from, to).reduce((sum, p) => sum + p.size, 0);
+    // Skip the keyframes around the switch; the higher target must show
+    expect(bytes(25, 40)).toBeGreaterThan(bytes(5, 20) * 2);
+  });
+
+  it('should encode at the requested quantizer in quantizer mode', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const encodeAt = async (quantizer: number) => {
+      const packets = await encodeNoise({ bitrateMode: 'quantizer' },
+        Array.from({ length: 5 }, (_, i) => ({ timestamp: i * 33333, quantizer })));
+      return packets.reduce((sum, p) => sum + p.size, 0);
+    };
+    expect(await encodeAt(4)).toBeGreaterThan(await encodeAt(60));
+
+    const callbacks = { output: () => {}, error: () => {}, dequeue: () => {} };
+    expect(() => new native.NativeVideoEncoder({ width: 64, height: 64, bitrateMode: 'average' }, callbacks)).toThrow(TypeError);
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrateMode: 'quantizer' }, callbacks);
+    expect(() => encoder.encode(Buffer.alloc(64 * 64 * 3 / 2), { timestamp: 0, quantizer: 64 })).toThrow(RangeError);
+    expect(() => encoder.reconfigure({ bitrate: 0 })).toThrow(RangeError);
+    encoder.close();
+  });
+
+  it('should vary the quantizer per frame without restarting libx264', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+    if (!native.hasCodec('libx264').encoder) {
+      console.log('libx264 not available, skipping');
+      return;
+    }
+
+    const frames = Array.from({ length: 12 }, (_, i) => ({ timestamp: i * 33333, quantizer: 20 + (i % 4) * 8 }));
+    const packets = await encodeNoise({ codec: 'avc1.42001f', bitrateMode: 'quantizer', latencyMode: 'realtime' }, frames);
+    expect(packets).toHaveLength(12);
+    expect(packets[0].isKeyframe).toBe(true);
+    expect(packets.slice(1).every(p => !p.isKeyframe)).toBe(true);
+  });
+
+  it('should refuse a mid-stream quantizer change the encoder cannot take live', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrateMode: 'quantizer' },
+      { output: () => {}, error: () => {}, dequeue: () => {} });
+    const frame = Buffer.alloc(64 * 64 * 3 / 2, 128);
+    encoder.encode(frame, { timestamp: 0, quantizer: 10 });
+    encoder.encode(frame, { timestamp: 1, quantizer: 10 });
+    expect(() => encoder.encode(frame, { timestamp: 2, quantizer: 40 })).toThrow('mid-stream');
+
+    // A flush ends the stream, so the next one may start at another quantizer
+    await encoder.flush();
+    encoder.encode(frame, { timestamp: 3, quantizer: 40 });
+    await encoder.flush();
+    // Quantizer mode has no bitrate to reconfigure
+    encoder.reconfigure({ bitrate: 1000000 });
+    encoder.close();
+  });
+
+  it('should reject a pending flush promise on close', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64 }, { output: () => {}, error: () => {}, dequeue: () => {} });
+    encoder.encode(Buffer.alloc(64 * 64 * 3 / 2, 128), { timestamp: 0 });
+    const done = encoder.flush();
+    encoder.close();
+    await expect(done).rejects.toThrow('Encoder is closed');
+    expect(() => encoder.flush()).toThrow('Encoder is closed');
+  });
+});
+
+describe('Codec Engine Round-Trip', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  // FFmpeg encoder each codec string resolves to first; builds without it skip the case
+  const codecs = [
+    { codec: 'vp8', encoder: 'libvpx' },
+    { codec: 'vp09.00.10.08', encoder: 'libvpx-vp9' },
+    { codec: 'av01.0.04M.08', encoder: 'libaom-av1' },
+    { codec: 'avc1.42001f', encoder: 'libx264' },
+  ];
+
+  for (const { codec, encoder } of codecs) {
+    it(`should round-trip secret color 0xDEADBE through ${codec}`, () => {
+      if (!native) {
+        expect.fail('Native addon not available');
+      }
+      if (!native.hasCodec(encoder).encoder) {
+        console.log(`${encoder} not available, skipping ${codec}`);
+        return;
+      }
+
+      const originalColor = SECRET_COLORS.SECRET_1;
+      const rgbData = createSolidColorFrame(64, 64, originalColor);
+
+      const encoded = native.encodeFrame(rgbData, { codec, width: 64, height: 64, bitrate: 1000000 });
+      expect(encoded.isKeyframe).toBe(true);
+
+      const decoded = native.decodeFrame(encoded.data, { codec });
+      expect(decoded.width).toBe(64);
+      expect(decoded.height).toBe(64);
+
+      const actualColor = { r: decoded.firstPixelR, g: decoded.firstPixelG, b: decoded.firstPixelB };
+      console.log(`${codec}: ${encoded.data.length} bytes, decoded R=${actualColor.r}, G=${actualColor.g}, B=${actualColor.b}`);
+      expect(colorsMatch(actualColor, originalColor, COLOR_TOLERANCE)).toBe(true);
+    });
+  }
+});
+
+describe('Batch Encoding', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should encode many frames from one packed buffer', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const count = 60;
+    const frame = createSolidColorFrame(32, 32, SECRET_COLORS.SECRET_1);
+    const packed = Buffer.concat(Array.from({ length: count }, () => frame));
+
+    const batch = await native.encodeBatch(packed, { codec: 'vp8', width: 32, height: 32, format: 'RGB24', framerate: 30 });
+    expect(batch.count).toBe(count);
+    expect(batch.index).toHaveLength(count * 4);
+
+    // Packets are back to back in `data`, in timestamp order
+    let end = 0;
+    for (let i = 0; i < batch.count; i++) {
+      const [offset, size, timestamp] = batch.index.subarray(i * 4, i * 4 + 3);
+      expect(offset).toBe(end);
+      expect(timestamp).toBe(Math.round(i * 1e6 / 30));
+      end = offset + size;
+    }
+    expect(end).toBe(batch.data.length);
+    expect(batch.index[3]).toBe(1);
+
+    const first = batch.data.subarray(batch.index[0], batch.index[0] + batch.index[1]);
+    const decoded = native.decodeFrame(first, { codec: 'vp8' });
+    const actualColor = { r: decoded.firstPixelR, g: decoded.firstPixelG, b: decoded.firstPixelB };
+    expect(colorsMatch(actualColor, SECRET_COLORS.SECRET_1, COLOR_TOLERANCE)).toBe(true);
+  });
+
+  it('should encode an array of NativeVideoFrames with explicit timestamps', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frames = [0, 1, 2].map(() => new native.NativeVideoFrame(createSolidColorFrame(32, 32, SECRET_COLORS.SECRET_2), {
+      format: 'RGB24', codedWidth: 32, codedHeight: 32,
+    }));
+    const pending = native.encodeBatch(frames, { codec: 'vp8', width: 32, height: 32, timestamps: [0, 40000, 80000] });
+    // The job holds its own references
+    frames.forEach((frame) => frame.close());
+    const batch = await pending;
+
+    expect(batch.count).toBe(3);
+    expect(Array.from({ length: 3 }, (_, i) => batch.index[i * 4 + 2])).toEqual([0, 40000, 80000]);
+  });
+
+  it('should reject a buffer that is not a whole number of frames', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(() => native.encodeBatch(Buffer.alloc(100), { codec: 'vp8', width: 32, height: 32 })).toThrow(TypeError);
+  });
+});
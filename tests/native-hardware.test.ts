@@ -0,0 +1,194 @@
+/**
+ * Native Hardware Acceleration Tests (Node.js only)
+ *
+ * These tests verify the `hardwareAcceleration` option of the native codec
+ * sessions. 'prefer-hardware' must work on machines without a GPU by
+ * falling back to software, and frames from a hardware decoder must read
+ * back correctly through copyTo() (which downloads them from the GPU).
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { readFileSync, existsSync } from 'fs';
+import { join } from 'path';
+
+const SECRET_1 = { r: 0xDE, g: 0xAD, b: 0xBE };
+const COLOR_TOLERANCE = 8;
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+// First frame of an IVF file
+function extractIvfFrame(ivfPath: string): Buffer {
+  const data = readFileSync(ivfPath);
+  const frameSize = data.readUInt32LE(32);
+  return data.subarray(44, 44 + frameSize);
+}
+
+interface DecodedFrame {
+  frame: { format: string | null; copyTo(dest: Uint8Array, options?: { format?: string }): unknown; close(): void };
+  width: number;
+  height: number;
+  format: string | null;
+}
+
+describe('Native Hardware Acceleration', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should decode with prefer-hardware and read pixels back through copyTo', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const ivfPath = join(__dirname, '..', 'fixtures', 'vp9', 'vp9-secret1-64x64.ivf');
+    if (!existsSync(ivfPath)) {
+      expect.fail('Test fixtures not found - run npm run generate:fixtures');
+    }
+
+    const frames: DecodedFrame[] = [];
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp09.00.10.08', hardwareAcceleration: 'prefer-hardware' }, {
+      output: (result: DecodedFrame) => frames.push(result),
+      error: (err: Error) => { throw err; },
+      dequeue: () => {},
+    });
+    console.log(`VP9 decoder hardware accelerated: ${decoder.hardwareAccelerated}`);
+
+    decoder.decode(extractIvfFrame(ivfPath), { timestamp: 0 });
+    await new Promise<void>((resolve) => decoder.flush(resolve));
+    decoder.close();
+
+    expect(frames).toHaveLength(1);
+    const { frame, width, height, format } = frames[0];
+    // Hardware frames report their software layout, never the GPU surface type
+    expect(format).not.toBeNull();
+    expect(frame.format).toBe(format);
+
+    const rgba = new Uint8Array(width * height * 4);
+    frame.copyTo(rgba, { format: 'RGBA' });
+    // A second read reuses the downloaded copy
+    const again = new Uint8Array(width * height * 4);
+    frame.copyTo(again, { format: 'RGBA' });
+    frame.close();
+
+    expect(Math.abs(rgba[0] - SECRET_1.r)).toBeLessThanOrEqual(COLOR_TOLERANCE);
+    expect(Math.abs(rgba[1] - SECRET_1.g)).toBeLessThanOrEqual(COLOR_TOLERANCE);
+    expect(Math.abs(rgba[2] - SECRET_1.b)).toBeLessThanOrEqual(COLOR_TOLERANCE);
+    expect(again).toEqual(rgba);
+  });
+
+  it('should encode with prefer-hardware, falling back to software', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Array<{ data: Buffer; isKeyframe: boolean }> = [];
+    const encoder = new native.NativeVideoEncoder(
+      { codec: 'vp8', width: 64, height: 64, bitrate: 500000, hardwareAcceleration: 'prefer-hardware' },
+      {
+        output: (packet: { data: Buffer; isKeyframe: boolean }) => packets.push(packet),
+        error: (err: Error) => { throw err; },
+        dequeue: () => {},
+      },
+    );
+    expect(typeof encoder.hardwareAccelerated).toBe('boolean');
+
+    const size = native.frameAllocationSize('I420', 64, 64);
+    encoder.encode(Buffer.alloc(size, 128), { timestamp: 0, format: 'I420' });
+    await new Promise<void>((resolve) => encoder.flush(resolve));
+    encoder.close();
+
+    expect(packets.length).toBeGreaterThan(0);
+    expect(packets[0].isKeyframe).toBe(true);
+  });
+
+  it('should keep a slow surface rendition from draining the hardware decoder', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // A VP9 clip long enough to outrun the decoder's spare surfaces many times
+    const width = 256;
+    const height = 144;
+    const count = 96;
+    const source: Array<{ data: Buffer; timestamp: number }> = [];
+    const sourceEncoder = new native.NativeVideoEncoder({ codec: 'vp09.00.10.08', width, height, bitrate: 1000000 }, {
+      output: (packet: { data: Buffer; timestamp: number }) => source.push(packet),
+      error: (err: Error) => { throw err; },
+      dequeue: () => {},
+    });
+    const frame = Buffer.alloc(native.frameAllocationSize('I420', width, height));
+    for (let i = 0; i < count; i++) {
+      frame.fill(i * 2, 0, width * height);
+      sourceEncoder.encode(frame, { timestamp: i * 33333 });
+    }
+    await new Promise<void>((resolve) => sourceEncoder.flush(resolve));
+    sourceEncoder.close();
+
+    // A deep quality-mode queue would hold far more decoder surfaces than
+    // the pool has to spare, were every queued frame a surface
+    const errors: Error[] = [];
+    const packets: number[] = [];
+    const encoder = new native.NativeVideoEncoder(
+      { codec: 'vp09.00.10.08', width, height, bitrate: 500000, hardwareAcceleration: 'prefer-hardware', maxQueueDepth: 64 }, {
+        output: (packet: { timestamp: number }) => packets.push(packet.timestamp),
+        error: (err: Error) => errors.push(err),
+        dequeue: () => {},
+      });
+    const pipeline = new native.NativeVideoPipeline([{ encoder }]);
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp09.00.10.08', hardwareAcceleration: 'prefer-hardware' }, {
+      output: () => {},
+      error: (err: Error) => errors.push(err),
+      dequeue: () => {},
+    });
+    console.log(`Surface passthrough: decoder ${decoder.hardwareAccelerated}, encoder ${encoder.hardwareAccelerated}`);
+    decoder.setPipeline(pipeline);
+    for (const packet of source) {
+      decoder.decode(packet.data, { timestamp: packet.timestamp });
+    }
+    await new Promise<void>((resolve) => decoder.flush(resolve));
+    decoder.close();
+    await new Promise<void>((resolve) => encoder.flush(resolve));
+    encoder.close();
+
+    expect(errors).toEqual([]);
+    expect(packets).toHaveLength(count);
+  });
+
+  it('should decode in software with prefer-software', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp8', hardwareAcceleration: 'prefer-software' }, {
+      output: () => {},
+      error: () => {},
+      dequeue: () => {},
+    });
+    expect(decoder.hardwareAccelerated).toBe(false);
+    decoder.close();
+  });
+
+  it('should reject unknown hardwareAcceleration values', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(() => new native.NativeVideoDecoder({ codec: 'vp8', hardwareAcceleration: 'gpu' }, {
+      output: () => {},
+      error: () => {},
+      dequeue: () => {},
+    })).toThrow(TypeError);
+  });
+});
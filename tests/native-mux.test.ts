@@ -0,0 +1,157 @@
+/**
+ * Native Muxer Tests (Node.js only)
+ *
+ * Attaches a NativeVideoEncoder to a NativeMuxer, then reads the written
+ * container back with NativeDemuxer to check every packet made it in with
+ * its timestamp, without the encoder's output() ever firing.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { mkdtempSync, rmSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+type Chunk = { data: Buffer; type: 'key' | 'delta'; timestamp: number };
+type Track = { codec: string; codedWidth: number; codedHeight: number };
+
+const WIDTH = 64;
+const HEIGHT = 64;
+const FRAME_COUNT = 10;
+// Whole milliseconds, so WebM's 1/1000 time base keeps them exact
+const FRAME_INTERVAL = 40000;
+
+describe('NativeMuxer', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+  const rgbData = Buffer.alloc(WIDTH * HEIGHT * 3);
+
+  beforeAll(() => {
+    native = tryLoadNative();
+    for (let i = 0; i < rgbData.length; i++) {
+      rgbData[i] = (i * 13) & 0xff;
+    }
+  });
+
+  // Encode FRAME_COUNT frames into `muxer`; resolves with the output() count
+  function encodeInto(muxer: unknown) {
+    return new Promise<number>((resolve, reject) => {
+      let outputs = 0;
+      const encoder = new native.NativeVideoEncoder({ width: WIDTH, height: HEIGHT, bitrate: 1000000 }, {
+        output: () => outputs++,
+        error: reject,
+        dequeue: () => {},
+      });
+      encoder.setMuxer(muxer);
+      for (let i = 0; i < FRAME_COUNT; i++) {
+        encoder.encode(rgbData, { timestamp: i * FRAME_INTERVAL, format: 'RGB24' });
+      }
+      encoder.flush(() => {
+        encoder.close();
+        resolve(outputs);
+      });
+    });
+  }
+
+  function demux(source: { path?: string }, bytes?: Buffer) {
+    return new Promise<{ track: Track; chunks: Chunk[] }>((resolve, reject) => {
+      let track: Track | null = null;
+      const chunks: Chunk[] = [];
+      const demuxer = new native.NativeDemuxer(source, {
+        config: (t: Track) => {
+          track = t;
+          demuxer.start();
+        },
+        chunk: (chunk: Chunk) => chunks.push(chunk),
+        end: () => {
+          demuxer.close();
+          resolve({ track: track!, chunks });
+        },
+        error: reject,
+      });
+      if (bytes) {
+        demuxer.write(bytes);
+        demuxer.end();
+      }
+    });
+  }
+
+  it('should write encoder output to a WebM file', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const dir = mkdtempSync(join(tmpdir(), 'webcodecs-mux-'));
+    try {
+      const path = join(dir, 'clip.webm');
+      const muxer = new native.NativeMuxer({ format: 'webm', path });
+      const outputs = await encodeInto(muxer);
+      await new Promise<void>((resolve) => muxer.finish(resolve));
+      expect(outputs).toBe(0);
+
+      const { track, chunks } = await demux({ path });
+      expect(track).toMatchObject({ codec: 'vp8', codedWidth: WIDTH, codedHeight: HEIGHT });
+      expect(chunks.length).toBe(FRAME_COUNT);
+      expect(chunks[0].type).toBe('key');
+      expect(chunks.map(c => c.timestamp)).toEqual(
+        Array.from({ length: FRAME_COUNT }, (_, i) => i * FRAME_INTERVAL));
+    } finally {
+      rmSync(dir, { recursive: true, force: true });
+    }
+  });
+
+  it('should hand container bytes to a data callback', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const parts: Buffer[] = [];
+    let finishedAfterData = false;
+    const muxer = new native.NativeMuxer({ format: 'ivf' }, { data: (chunk: Buffer) => parts.push(chunk) });
+    await encodeInto(muxer);
+    await new Promise<void>((resolve) => muxer.finish(() => {
+      finishedAfterData = parts.length > 0;
+      resolve();
+    }));
+    expect(finishedAfterData).toBe(true);
+
+    const bytes = Buffer.concat(parts);
+    expect(bytes.subarray(0, 4).toString('ascii')).toBe('DKIF');
+    const { chunks } = await demux({}, bytes);
+    expect(chunks.length).toBe(FRAME_COUNT);
+  });
+
+  it('should give a muxer track to a single encoder', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const muxer = new native.NativeMuxer({ format: 'webm' }, { data: () => {} });
+    const callbacks = { output: () => {}, error: () => {}, dequeue: () => {} };
+    const first = new native.NativeVideoEncoder({ width: WIDTH, height: HEIGHT }, callbacks);
+    const second = new native.NativeVideoEncoder({ width: WIDTH, height: HEIGHT }, callbacks);
+
+    expect(() => first.setMuxer({})).toThrow(TypeError);
+    first.setMuxer(muxer);
+    expect(() => second.setMuxer(muxer)).toThrow(/already has an encoder/);
+
+    first.close();
+    second.close();
+    muxer.close();
+  });
+
+  it('should reject unknown container formats', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(() => new native.NativeMuxer({ format: 'avi' }, { data: () => {} })).toThrow(TypeError);
+  });
+});
@@ -0,0 +1,278 @@
+/**
+ * Native Pipeline Tests (Node.js only)
+ *
+ * Decodes a clip through a NativeVideoPipeline into several encoders with
+ * their own crop, rotation and size, then decodes each rendition again to
+ * check every frame came through with its timestamp and the rendition's
+ * dimensions, without the source decoder's output() ever firing.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+type Packet = { data: Buffer; isKeyframe: boolean; timestamp?: number };
+type Decoded = { frame: { close(): void }; width: number; height: number; timestamp?: number };
+
+const WIDTH = 128;
+const HEIGHT = 96;
+const FRAME_COUNT = 8;
+const FRAME_INTERVAL = 33333;
+
+describe('NativeVideoPipeline', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+  let source: Packet[] = [];
+
+  function createEncoder(width: number, height: number, packets: Packet[], reject: (e: Error) => void) {
+    return new native.NativeVideoEncoder({ width, height, bitrate: 500000 }, {
+      output: (packet: Packet) => packets.push(packet),
+      error: reject,
+      dequeue: () => {},
+    });
+  }
+
+  function flushEncoder(encoder: { flush(done: () => void): void; close(): void }) {
+    return new Promise<void>((resolve) => encoder.flush(() => {
+      encoder.close();
+      resolve();
+    }));
+  }
+
+  function decodeAll(packets: Packet[]) {
+    return new Promise<Decoded[]>((resolve, reject) => {
+      const frames: Decoded[] = [];
+      const decoder = new native.NativeVideoDecoder({ codec: 'vp8' }, {
+        output: (frame: Decoded) => frames.push(frame),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (const packet of packets) {
+        decoder.decode(packet.data, { timestamp: packet.timestamp ?? 0 });
+      }
+      decoder.flush(() => {
+        decoder.close();
+        resolve(frames);
+      });
+    });
+  }
+
+  beforeAll(async () => {
+    native = tryLoadNative();
+    if (!native) {
+      return;
+    }
+    const rgb = Buffer.alloc(WIDTH * HEIGHT * 3);
+    for (let i = 0; i < rgb.length; i++) {
+      rgb[i] = (i * 7) & 0xff;
+    }
+    const packets: Packet[] = [];
+    const encoder = createEncoder(WIDTH, HEIGHT, packets, (e) => { throw e; });
+    for (let i = 0; i < FRAME_COUNT; i++) {
+      encoder.encode(rgb, { timestamp: i * FRAME_INTERVAL, format: 'RGB24' });
+    }
+    await flushEncoder(encoder);
+    source = packets;
+  });
+
+  it('should fan decoded frames out to every rendition', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const errors: Error[] = [];
+    const fail = (e: Error) => errors.push(e);
+    const half: Packet[] = [];
+    const rotated: Packet[] = [];
+    const halfEncoder = createEncoder(WIDTH / 2, HEIGHT / 2, half, fail);
+    // The right half, turned on its side
+    const rotatedEncoder = createEncoder(HEIGHT, WIDTH / 2, rotated, fail);
+    const pipeline = new native.NativeVideoPipeline([
+      { encoder: halfEncoder },
+      { encoder: rotatedEncoder, crop: { x: WIDTH / 2, y: 0, width: WIDTH / 2, height: HEIGHT }, rotation: 90 },
+    ]);
+
+    let outputs = 0;
+    await new Promise<void>((resolve, reject) => {
+      const decoder = new native.NativeVideoDecoder({ codec: 'vp8' }, {
+        output: () => outputs++,
+        error: reject,
+        dequeue: () => {},
+      });
+      decoder.setPipeline(pipeline);
+      for (const packet of source) {
+        decoder.decode(packet.data, { timestamp: packet.timestamp });
+      }
+      decoder.flush(() => {
+        decoder.close();
+        resolve();
+      });
+    });
+    await Promise.all([flushEncoder(halfEncoder), flushEncoder(rotatedEncoder)]);
+
+    expect(errors).toEqual([]);
+    expect(outputs).toBe(0);
+    for (const [packets, width, height] of [[half, WIDTH / 2, HEIGHT / 2], [rotated, HEIGHT, WIDTH / 2]] as const) {
+      expect(packets.length).toBe(FRAME_COUNT);
+      expect(packets.map(p => p.timestamp)).toEqual(source.map(p => p.timestamp));
+      const frames = await decodeAll(packets);
+      expect(frames.length).toBe(FRAME_COUNT);
+      for (const frame of frames) {
+        expect(frame.width).toBe(width);
+        expect(frame.height).toBe(height);
+        frame.frame.close();
+      }
+    }
+  });
+
+  it('should encode one native frame into every rendition', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const errors: Error[] = [];
+    const ladder = [[WIDTH, HEIGHT, 800000], [WIDTH / 2, HEIGHT / 2, 300000], [WIDTH / 4, HEIGHT / 4, 100000]];
+    const outputs = ladder.map(() => [] as Packet[]);
+    const encoders = ladder.map(([width, height, bitrate], i) =>
+      new native.NativeVideoEncoder({ width, height, bitrate }, {
+        output: (packet: Packet) => outputs[i].push(packet),
+        error: (e: Error) => errors.push(e),
+        dequeue: () => {},
+      }));
+    const pipeline = new native.NativeVideoPipeline(encoders.map(encoder => ({ encoder })));
+
+    const i420 = Buffer.alloc(WIDTH * HEIGHT * 3 / 2, 128);
+    for (let i = 0; i < FRAME_COUNT; i++) {
+      i420.fill(i * 16, 0, WIDTH * HEIGHT);
+      const frame = new native.NativeVideoFrame(i420, { format: 'I420', codedWidth: WIDTH, codedHeight: HEIGHT });
+      pipeline.encode(frame, { timestamp: i * FRAME_INTERVAL, keyFrame: i === 4 });
+      // Each encoder holds its own reference
+      frame.close();
+    }
+    await Promise.all(encoders.map(flushEncoder));
+
+    expect(errors).toEqual([]);
+    for (const [i, packets] of outputs.entries()) {
+      expect(packets.map(p => p.timestamp)).toEqual(Array.from({ length: FRAME_COUNT }, (_, n) => n * FRAME_INTERVAL));
+      expect(packets[4].isKeyframe).toBe(true);
+      const frames = await decodeAll(packets);
+      expect(frames[0].width).toBe(ladder[i][0]);
+      expect(frames[0].height).toBe(ladder[i][1]);
+      frames.forEach(frame => frame.frame.close());
+    }
+    expect(() => pipeline.encode(Buffer.alloc(4), { timestamp: 0 })).toThrow(TypeError);
+  });
+
+  it('should hold the decoder while a rendition queue is full', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Packet[] = [];
+    const encoder = new native.NativeVideoEncoder({ width: WIDTH, height: HEIGHT, bitrate: 500000, maxQueueDepth: 1 }, {
+      output: (packet: Packet) => packets.push(packet),
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    const pipeline = new native.NativeVideoPipeline([{ encoder }]);
+    await new Promise<void>((resolve, reject) => {
+      const decoder = new native.NativeVideoDecoder({ codec: 'vp8' }, {
+        output: () => {},
+        error: reject,
+        dequeue: () => {},
+      });
+      decoder.setPipeline(pipeline);
+      // None of these wait, however far ahead of the encoder they get
+      for (const packet of source) {
+        expect(decoder.decode(packet.data, { timestamp: packet.timestamp })).toBe(true);
+      }
+      decoder.flush(() => {
+        decoder.close();
+        resolve();
+      });
+    });
+    // VP8 releases one frame per chunk, so the gate keeps the queue at one
+    expect(encoder.getStats().maxQueueDepth).toBeLessThanOrEqual(1);
+    await flushEncoder(encoder);
+
+    expect(encoder.droppedFrames).toBe(0);
+    expect(packets.map(p => p.timestamp)).toEqual(source.map(p => p.timestamp));
+  });
+
+  it('should count the frames a closed rendition misses', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Packet[] = [];
+    const open = createEncoder(WIDTH, HEIGHT, packets, (e) => { throw e; });
+    const closed = createEncoder(WIDTH, HEIGHT, [], (e) => { throw e; });
+    const pipeline = new native.NativeVideoPipeline([{ encoder: open }, { encoder: closed }]);
+    closed.close();
+
+    const i420 = Buffer.alloc(WIDTH * HEIGHT * 3 / 2, 128);
+    for (let i = 0; i < FRAME_COUNT; i++) {
+      const frame = new native.NativeVideoFrame(i420, { format: 'I420', codedWidth: WIDTH, codedHeight: HEIGHT });
+      pipeline.encode(frame, { timestamp: i * FRAME_INTERVAL });
+      frame.close();
+    }
+    await flushEncoder(open);
+
+    expect(closed.droppedFrames).toBe(FRAME_COUNT);
+    expect(open.droppedFrames).toBe(0);
+    expect(packets).toHaveLength(FRAME_COUNT);
+  });
+
+  it('should report a crop outside the frame through the encoder', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const errors: Error[] = [];
+    const packets: Packet[] = [];
+    const encoder = createEncoder(32, 32, packets, (e) => errors.push(e));
+    const pipeline = new native.NativeVideoPipeline([
+      { encoder, crop: { x: WIDTH - 16, y: 0, width: 32, height: 32 } },
+    ]);
+    await new Promise<void>((resolve, reject) => {
+      const decoder = new native.NativeVideoDecoder({ codec: 'vp8' }, {
+        output: () => {},
+        error: reject,
+        dequeue: () => {},
+      });
+      decoder.setPipeline(pipeline);
+      decoder.decode(source[0].data, { timestamp: 0 });
+      decoder.flush(() => {
+        decoder.close();
+        resolve();
+      });
+    });
+    await flushEncoder(encoder);
+
+    expect(packets.length).toBe(0);
+    expect(errors.length).toBe(1);
+    expect(errors[0].message).toContain('crop');
+  });
+
+  it('should reject bad renditions', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const encoder = createEncoder(32, 32, [], () => {});
+    expect(() => new native.NativeVideoPipeline([])).toThrow(TypeError);
+    expect(() => new native.NativeVideoPipeline([{ encoder: {} }])).toThrow(TypeError);
+    expect(() => new native.NativeVideoPipeline([{ encoder, crop: { x: 0 } }])).toThrow(TypeError);
+    expect(() => new native.NativeVideoPipeline([{ encoder, crop: { x: 0, y: 0, width: 0, height: 8 } }])).toThrow(RangeError);
+    expect(() => new native.NativeVideoPipeline([{ encoder, rotation: 45 }])).toThrow(RangeError);
+    encoder.close();
+  });
+});
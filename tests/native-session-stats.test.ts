@@ -0,0 +1,156 @@
+/**
+ * Native Session Stats Tests (Node.js only)
+ *
+ * These tests verify the counters and stage latency histograms codec
+ * sessions keep: frames and bytes in and out, queue depth, and p50/p99
+ * per stage, as returned by getStats().
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+function createI420Frame(width: number, height: number, luma: number): Buffer {
+  const ySize = width * height;
+  const buffer = Buffer.alloc(ySize + (width / 2) * (height / 2) * 2, 128);
+  buffer.fill(luma, 0, ySize);
+  return buffer;
+}
+
+interface StageStats {
+  count: number;
+  sumUs: number;
+  maxUs: number;
+  p50Us: number;
+  p99Us: number;
+  buckets: number[];
+}
+
+describe('Native Session Stats', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should count encoder frames, bytes and stages', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Array<{ data: Buffer; isKeyframe: boolean; timestamp: number }> = [];
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 200000 }, {
+      output: (packet: { data: Buffer; isKeyframe: boolean; timestamp: number }) => packets.push(packet),
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+
+    const frame = createI420Frame(64, 64, 90);
+    for (let i = 0; i < 10; i++) {
+      encoder.encode(frame, { timestamp: i * 1000 });
+    }
+    await new Promise<void>(resolve => encoder.flush(resolve));
+    const stats = encoder.getStats();
+    encoder.close();
+
+    expect(stats.framesIn).toBe(10);
+    expect(stats.bytesIn).toBe(10 * frame.length);
+    expect(stats.framesOut).toBe(packets.length);
+    expect(stats.bytesOut).toBe(packets.reduce((sum, p) => sum + p.data.length, 0));
+    expect(stats.errors).toBe(0);
+    expect(stats.queueDepth).toBe(0);
+    expect(stats.maxQueueDepth).toBeGreaterThanOrEqual(1);
+
+    // 10 encodes and a flush went through the queue; every encode was copied, sent and received
+    expect(stats.stages.queue.count).toBe(11);
+    expect(stats.stages.open.count).toBe(1);
+    for (const name of ['copy', 'send'] as const) {
+      expect(stats.stages[name].count).toBe(10);
+    }
+    expect(stats.stages.receive.count).toBe(11);
+  });
+
+  it('should report percentiles consistent with the histogram', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const encoder = new native.NativeVideoEncoder({ width: 320, height: 240, bitrate: 500000 }, {
+      output: () => {},
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    // RGBA input exercises the conversion stage
+    const rgba = Buffer.alloc(320 * 240 * 4, 200);
+    for (let i = 0; i < 20; i++) {
+      encoder.encode(rgba, { timestamp: i, format: 'RGBA' });
+    }
+    await new Promise<void>(resolve => encoder.flush(resolve));
+    const send: StageStats = encoder.getStats().stages.send;
+    const convert: StageStats = encoder.getStats().stages.convert;
+    encoder.close();
+
+    expect(convert.count).toBe(20);
+    expect(send.count).toBe(20);
+    expect(send.p50Us).toBeLessThanOrEqual(send.p99Us);
+    expect(send.p99Us).toBeLessThanOrEqual(send.maxUs);
+    expect(send.sumUs).toBeGreaterThanOrEqual(send.maxUs);
+    // Cumulative buckets end at the sample count
+    expect(send.buckets.length).toBe(27);
+    expect(send.buckets[send.buckets.length - 1]).toBe(20);
+    for (let i = 1; i < send.buckets.length; i++) {
+      expect(send.buckets[i]).toBeGreaterThanOrEqual(send.buckets[i - 1]);
+    }
+  });
+
+  it('should count decoder frames and dropped chunks', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const chunks: Array<{ data: Buffer; isKeyframe: boolean; timestamp: number }> = [];
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 200000, gopSize: 4 }, {
+      output: (packet: { data: Buffer; isKeyframe: boolean; timestamp: number }) => chunks.push(packet),
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    for (let i = 0; i < 8; i++) {
+      encoder.encode(createI420Frame(64, 64, 30 * i), { timestamp: i * 1000 });
+    }
+    await new Promise<void>(resolve => encoder.flush(resolve));
+    encoder.close();
+
+    let frames = 0;
+    const decoder = new native.NativeVideoDecoder({ codec: 'vp8', keyframesOnly: true }, {
+      output: (result: { frame: { close(): void } }) => { frames++; result.frame.close(); },
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    for (const chunk of chunks) {
+      decoder.decode(chunk.data, { timestamp: chunk.timestamp, keyFrame: chunk.isKeyframe });
+    }
+    await new Promise<void>(resolve => decoder.flush(resolve));
+    const stats = decoder.getStats();
+    decoder.close();
+
+    const keys = chunks.filter(c => c.isKeyframe);
+    expect(stats.framesIn).toBe(keys.length);
+    expect(stats.bytesIn).toBe(keys.reduce((sum, c) => sum + c.data.length, 0));
+    expect(stats.droppedFrames).toBe(chunks.length - keys.length);
+    expect(stats.framesOut).toBe(frames);
+    // 64x64 I420
+    expect(stats.bytesOut).toBe(frames * 64 * 64 * 3 / 2);
+    expect(stats.stages.send.count).toBe(keys.length);
+    expect(stats.stages.convert.count).toBe(0);
+  });
+});
@@ -0,0 +1,229 @@
+/**
+ * Native Threading Tests (Node.js only)
+ *
+ * These tests verify that native codec sessions run off the JS thread, on
+ * the shared codec scheduler pool: encode() returns before any output
+ * exists, results arrive through the output callback, and flush()
+ * completes only after every queued frame has been delivered.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { monitorEventLoopDelay } from 'perf_hooks';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+function createI420Frame(width: number, height: number, luma: number): Buffer {
+  const ySize = width * height;
+  const buffer = Buffer.alloc(ySize + (width / 2) * (height / 2) * 2, 128);
+  buffer.fill(luma, 0, ySize);
+  return buffer;
+}
+
+describe('Native Worker Thread', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should return from encode() before output is delivered', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const outputs: number[] = [];
+    let dequeued = 0;
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 200000 }, {
+      output: (packet: { timestamp: number }) => outputs.push(packet.timestamp),
+      error: (e: Error) => { throw e; },
+      dequeue: () => { dequeued++; },
+    });
+
+    for (let i = 0; i < 8; i++) {
+      encoder.encode(createI420Frame(64, 64, 16 + i * 20), { timestamp: i * 1000 });
+    }
+
+    // Outputs are delivered on a later turn of the event loop
+    expect(outputs.length).toBe(0);
+
+    await new Promise<void>(resolve => encoder.flush(resolve));
+    encoder.close();
+
+    expect(dequeued).toBe(8);
+    expect(outputs).toEqual([0, 1000, 2000, 3000, 4000, 5000, 6000, 7000]);
+  });
+
+  it('should keep the event loop responsive during a large encode batch', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const histogram = monitorEventLoopDelay({ resolution: 5 });
+    histogram.enable();
+
+    const encoder = new native.NativeVideoEncoder({ width: 640, height: 480, bitrate: 1000000 }, {
+      output: () => {},
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    const frame = createI420Frame(640, 480, 100);
+    for (let i = 0; i < 60; i++) {
+      encoder.encode(frame, { timestamp: i * 33333 });
+      // Yield so the loop delay monitor can sample between submissions
+      await new Promise(resolve => setImmediate(resolve));
+    }
+    await new Promise<void>(resolve => encoder.flush(resolve));
+    encoder.close();
+
+    histogram.disable();
+    console.log(`Event loop delay p99: ${(histogram.percentile(99) / 1e6).toFixed(1)}ms`);
+    expect(histogram.percentile(99) / 1e6).toBeLessThan(100);
+  });
+
+  it('should drop queued output after close()', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const outputs: number[] = [];
+    const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 200000 }, {
+      output: (packet: { timestamp: number }) => outputs.push(packet.timestamp),
+      error: () => {},
+      dequeue: () => {},
+    });
+    for (let i = 0; i < 8; i++) {
+      encoder.encode(createI420Frame(64, 64, 50), { timestamp: i });
+    }
+    encoder.close();
+
+    await new Promise(resolve => setTimeout(resolve, 50));
+    const countAfterClose = outputs.length;
+    await new Promise(resolve => setTimeout(resolve, 50));
+    expect(outputs.length).toBe(countAfterClose);
+    expect(() => encoder.encode(createI420Frame(64, 64, 50), { timestamp: 9 })).toThrow();
+  });
+
+  it('should run many sessions on a small shared pool', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const configured = native.configureScheduler({ threads: 2, codecThreads: 1 });
+    expect(configured.threads).toBe(2);
+    expect(configured.codecThreads).toBe(1);
+    const executedBefore = native.getSchedulerStats().executed;
+
+    try {
+      const outputs: number[][] = [];
+      const encoders = Array.from({ length: 12 }, (_, s) => {
+        outputs.push([]);
+        return new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 100000 }, {
+          output: (packet: { timestamp: number }) => outputs[s].push(packet.timestamp),
+          error: (e: Error) => { throw e; },
+          dequeue: () => {},
+        });
+      });
+      expect(native.getSchedulerStats().sessions).toBeGreaterThanOrEqual(12);
+
+      for (let i = 0; i < 4; i++) {
+        for (const encoder of encoders) {
+          encoder.encode(createI420Frame(64, 64, 40 + i * 30), { timestamp: i });
+        }
+      }
+      await Promise.all(encoders.map(encoder => new Promise<void>(resolve => encoder.flush(resolve))));
+      encoders.forEach(encoder => encoder.close());
+
+      for (const timestamps of outputs) {
+        expect(timestamps).toEqual([0, 1, 2, 3]);
+      }
+      const stats = native.getSchedulerStats();
+      expect(stats.threads).toBe(2);
+      expect(stats.executed - executedBefore).toBeGreaterThanOrEqual(12 * 5);
+    } finally {
+      native.configureScheduler({ threads: 0, codecThreads: 0 });
+    }
+  });
+
+  it('should reject a negative thread budget', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    expect(() => native.configureScheduler({ threads: -1 })).toThrow(RangeError);
+  });
+
+  it('should drop frames past maxQueueDepth in realtime mode', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const outputs: number[] = [];
+    const encoder = new native.NativeVideoEncoder(
+      { width: 1280, height: 720, bitrate: 2000000, latencyMode: 'realtime', maxQueueDepth: 1 }, {
+        output: (packet: { timestamp: number }) => outputs.push(packet.timestamp),
+        error: (e: Error) => { throw e; },
+        dequeue: () => {},
+      });
+
+    // Submitted far faster than a 720p frame encodes
+    const frame = createI420Frame(1280, 720, 90);
+    const queued: number[] = [];
+    for (let i = 0; i < 20; i++) {
+      if (encoder.encode(frame, { timestamp: i, keyFrame: i === 10 })) {
+        queued.push(i);
+      }
+      expect(encoder.encodeQueueSize).toBeLessThanOrEqual(1);
+    }
+    await new Promise<void>(resolve => encoder.flush(resolve));
+
+    expect(encoder.droppedFrames).toBeGreaterThan(0);
+    expect(encoder.droppedFrames + queued.length).toBe(20);
+    // Requested keyframes are never dropped
+    expect(queued).toContain(10);
+    expect(outputs).toEqual(queued);
+    encoder.close();
+  });
+
+  it('should queue past maxQueueDepth without blocking in quality mode', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const outputs: number[] = [];
+    const encoder = new native.NativeVideoEncoder({ width: 320, height: 240, bitrate: 500000, maxQueueDepth: 2 }, {
+      output: (packet: { timestamp: number }) => outputs.push(packet.timestamp),
+      error: (e: Error) => { throw e; },
+      dequeue: () => {},
+    });
+    const frame = createI420Frame(320, 240, 90);
+    for (let i = 0; i < 10; i++) {
+      expect(encoder.encode(frame, { timestamp: i })).toBe(true);
+    }
+    // Nothing waited for the worker, so the queue holds whatever it has not taken yet
+    expect(encoder.encodeQueueSize).toBeLessThanOrEqual(10);
+    await new Promise<void>(resolve => encoder.flush(resolve));
+    encoder.close();
+
+    expect(encoder.droppedFrames).toBe(0);
+    expect(outputs).toEqual([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]);
+  });
+
+  it('should reject a maxQueueDepth below 1', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const callbacks = { output: () => {}, error: () => {}, dequeue: () => {} };
+    expect(() => new native.NativeVideoEncoder({ width: 64, height: 64, maxQueueDepth: 0 }, callbacks)).toThrow(RangeError);
+  });
+});
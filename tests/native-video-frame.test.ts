@@ -0,0 +1,344 @@
+/**
+ * Native VideoFrame Tests (Node.js only)
+ *
+ * These tests verify the NativeVideoFrame handle: pixels are copied once
+ * into a refcounted AVFrame, clone() shares that AVFrame instead of copying
+ * it, encoders accept the handle directly, and hash() digests the planes
+ * in place.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { createHash } from 'crypto';
+import { VideoFrame } from '../src/index.js';
+
+// Helper to check if native addon is available
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require('../build/Release/webcodecs_native.node');
+  } catch {
+    return null;
+  }
+}
+
+function createI420Frame(width: number, height: number, luma: number): Uint8Array {
+  const ySize = width * height;
+  const data = new Uint8Array(ySize + (width / 2) * (height / 2) * 2).fill(128);
+  data.fill(luma, 0, ySize);
+  return data;
+}
+
+describe('NativeVideoFrame', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should round-trip I420 data through copyTo()', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const source = createI420Frame(32, 16, 77);
+    const frame = new native.NativeVideoFrame(source, { format: 'I420', codedWidth: 32, codedHeight: 16 });
+    expect(frame.format).toBe('I420');
+    expect(frame.codedWidth).toBe(32);
+    expect(frame.codedHeight).toBe(16);
+
+    const dest = new Uint8Array(source.length);
+    const layout = frame.copyTo(dest);
+    expect(layout).toEqual([
+      { offset: 0, stride: 32 },
+      { offset: 512, stride: 16 },
+      { offset: 640, stride: 16 },
+    ]);
+    expect(dest).toEqual(source);
+    frame.close();
+  });
+
+  it('should keep clone() data alive after the original is closed', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const source = createI420Frame(32, 16, 200);
+    const frame = new native.NativeVideoFrame(source, { format: 'I420', codedWidth: 32, codedHeight: 16 });
+    const clone = frame.clone();
+    frame.close();
+
+    expect(() => frame.copyTo(new Uint8Array(source.length))).toThrow();
+    const dest = new Uint8Array(source.length);
+    clone.copyTo(dest);
+    expect(dest).toEqual(source);
+    clone.close();
+  });
+
+  it('should convert to RGBA only when copyTo() asks for it', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Mid-grey in BT.601 limited range
+    const frame = new native.NativeVideoFrame(createI420Frame(32, 16, 126), {
+      format: 'I420',
+      codedWidth: 32,
+      codedHeight: 16,
+    });
+    const rgba = new Uint8Array(32 * 16 * 4);
+    expect(frame.copyTo(rgba, { format: 'RGBA' })).toEqual([{ offset: 0, stride: 128 }]);
+    for (const channel of [rgba[0], rgba[1], rgba[2]]) {
+      expect(Math.abs(channel - 128)).toBeLessThanOrEqual(4);
+    }
+    expect(rgba[3]).toBe(255);
+    frame.close();
+  });
+
+  it('should honour a caller-provided plane layout', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const source = createI420Frame(32, 16, 90);
+    const frame = new native.NativeVideoFrame(source, { format: 'I420', codedWidth: 32, codedHeight: 16 });
+
+    // 64-byte aligned rows, as a GPU upload buffer might require
+    const layout = [
+      { offset: 0, stride: 64 },
+      { offset: 64 * 16, stride: 64 },
+      { offset: 64 * 16 + 64 * 8, stride: 64 },
+    ];
+    const dest = new Uint8Array(64 * 16 + 64 * 8 * 2).fill(0xFF);
+    expect(frame.copyTo(dest, { layout })).toEqual(layout);
+    expect(dest[0]).toBe(90);
+    expect(dest[31]).toBe(90);
+    expect(dest[32]).toBe(0xFF);
+    expect(dest[64]).toBe(90);
+    expect(dest[layout[1].offset]).toBe(128);
+
+    expect(() => frame.copyTo(new Uint8Array(16), { layout })).toThrow();
+    frame.close();
+  });
+
+  it('should be accepted by NativeVideoEncoder without a Buffer copy', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packets: Array<{ isKeyframe: boolean; timestamp: number }> = [];
+    await new Promise<void>((resolve, reject) => {
+      const encoder = new native.NativeVideoEncoder({ width: 64, height: 64, bitrate: 200000 }, {
+        output: (packet: { isKeyframe: boolean; timestamp: number }) => packets.push(packet),
+        error: reject,
+        dequeue: () => {},
+      });
+      for (let i = 0; i < 3; i++) {
+        const frame = new native.NativeVideoFrame(createI420Frame(64, 64, 40 + i * 40), {
+          format: 'I420',
+          codedWidth: 64,
+          codedHeight: 64,
+        });
+        encoder.encode(frame, { timestamp: i * 1000 });
+        // The encoder holds its own reference
+        frame.close();
+      }
+      encoder.flush(() => {
+        encoder.close();
+        resolve();
+      });
+    });
+
+    expect(packets.map(p => p.timestamp)).toEqual([0, 1000, 2000]);
+    expect(packets[0].isKeyframe).toBe(true);
+  });
+
+  it('should back VideoFrame and its clones', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const source = createI420Frame(32, 16, 123);
+    const frame = new VideoFrame(source, { format: 'I420', codedWidth: 32, codedHeight: 16, timestamp: 5 });
+    expect(frame._native).not.toBeNull();
+
+    const clone = frame.clone();
+    frame.close();
+    expect(frame._native).toBeNull();
+
+    const dest = new Uint8Array(clone.allocationSize());
+    await clone.copyTo(dest);
+    expect(dest).toEqual(source);
+    expect(clone.timestamp).toBe(5);
+    clone.close();
+  });
+
+  it('should crop, scale and convert in one copyTo()', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Dark left half, bright right half
+    const width = 1920;
+    const height = 1080;
+    const source = createI420Frame(width, height, 16);
+    for (let y = 0; y < height; y++) {
+      source.fill(235, y * width + width / 2, (y + 1) * width);
+    }
+    const frame = new native.NativeVideoFrame(source, { format: 'I420', codedWidth: width, codedHeight: height });
+
+    const thumb = new Uint8Array(160 * 90 * 4);
+    const layout = frame.copyTo(thumb, { format: 'RGBA', resizeWidth: 160, resizeHeight: 90 });
+    expect(layout).toEqual([{ offset: 0, stride: 640 }]);
+    expect(thumb[0]).toBeLessThan(30);
+    expect(thumb[159 * 4]).toBeGreaterThan(225);
+
+    // Only the bright half, scaled down
+    const right = new Uint8Array(80 * 90 * 4);
+    frame.copyTo(right, { format: 'RGBA', rect: { x: 960, y: 0, width: 960, height: 1080 }, resizeWidth: 80, resizeHeight: 90 });
+    expect(Math.min(...right.filter((_, i) => i % 4 === 0))).toBeGreaterThan(225);
+
+    // A crop without scaling stays in the source format
+    const crop = new Uint8Array(64 * 32 + 32 * 16 * 2);
+    frame.copyTo(crop, { rect: { x: 944, y: 10, width: 64, height: 32 } });
+    expect(crop[0]).toBe(16);
+    expect(crop[63]).toBe(235);
+    frame.close();
+  });
+
+  it('should reject a rect outside the frame or off the chroma grid', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frame = new native.NativeVideoFrame(createI420Frame(32, 16, 50), { format: 'I420', codedWidth: 32, codedHeight: 16 });
+    const dest = new Uint8Array(32 * 16 * 4);
+    expect(() => frame.copyTo(dest, { rect: { x: 16, y: 0, width: 32, height: 16 } })).toThrow(RangeError);
+    expect(() => frame.copyTo(dest, { rect: { x: 1, y: 0, width: 8, height: 8 } })).toThrow(TypeError);
+    expect(() => frame.copyTo(dest, { resizeWidth: 0 })).toThrow(RangeError);
+    frame.close();
+  });
+
+  it('should size allocations for the rect and resize', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const frame = new VideoFrame(createI420Frame(64, 32, 90), { format: 'I420', codedWidth: 64, codedHeight: 32, timestamp: 0 });
+    const options = { format: 'RGBA', rect: { x: 0, y: 0, width: 32, height: 32 }, resizeWidth: 16, resizeHeight: 16 };
+    expect(frame.allocationSize(options)).toBe(16 * 16 * 4);
+    const dest = new Uint8Array(frame.allocationSize(options));
+    expect(await frame.copyTo(dest, options)).toEqual([{ offset: 0, stride: 64 }]);
+    frame.close();
+  });
+
+  it('should read planes at the given layout strides', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // 32x16 I420 with 8 bytes of padding per row, as a capture device might write it
+    const padded = new Uint8Array(40 * 16 + 24 * 8 * 2).fill(128);
+    for (let y = 0; y < 16; y++) {
+      padded.fill(60, y * 40, y * 40 + 32);
+      padded.fill(0, y * 40 + 32, y * 40 + 40);
+    }
+    const layout = [{ offset: 0, stride: 40 }, { offset: 640, stride: 24 }, { offset: 832, stride: 24 }];
+    for (const adopt of [false, true]) {
+      const frame = new native.NativeVideoFrame(padded, { format: 'I420', codedWidth: 32, codedHeight: 16, layout, adopt });
+      const dest = new Uint8Array(32 * 16 * 3 / 2);
+      frame.copyTo(dest);
+      expect(dest).toEqual(createI420Frame(32, 16, 60));
+      frame.close();
+    }
+    expect(() => new native.NativeVideoFrame(padded, {
+      format: 'I420', codedWidth: 32, codedHeight: 16, layout: [{ offset: 0, stride: 16 }, layout[1], layout[2]],
+    })).toThrow(TypeError);
+  });
+
+  it('should adopt transferred and shared buffers without copying', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const transferred = createI420Frame(32, 16, 40);
+    const frame = new VideoFrame(transferred, {
+      format: 'I420', codedWidth: 32, codedHeight: 16, timestamp: 0, transfer: [transferred.buffer],
+    });
+    // Detached, as the spec requires
+    expect(transferred.byteLength).toBe(0);
+    const dest = new Uint8Array(32 * 16 * 3 / 2);
+    await frame.copyTo(dest);
+    expect(dest).toEqual(createI420Frame(32, 16, 40));
+    frame.close();
+
+    // A layout the addon rejects throws before anything is detached
+    const rejected = createI420Frame(32, 16, 40);
+    expect(() => new VideoFrame(rejected, {
+      format: 'I420', codedWidth: 32, codedHeight: 16, timestamp: 0,
+      layout: [{ offset: 0, stride: 16 }, { offset: 512, stride: 16 }, { offset: 640, stride: 16 }],
+      transfer: [rejected.buffer],
+    })).toThrow(TypeError);
+    expect(rejected.byteLength).toBe(32 * 16 * 3 / 2);
+
+    // A SharedArrayBuffer stays shared: later writes show through
+    const shared = new Uint8Array(new SharedArrayBuffer(dest.length));
+    shared.set(createI420Frame(32, 16, 10));
+    const sharedFrame = new VideoFrame(shared, {
+      format: 'I420', codedWidth: 32, codedHeight: 16, timestamp: 0, transfer: [shared.buffer],
+    });
+    shared[0] = 99;
+    await sharedFrame.copyTo(dest);
+    expect(dest[0]).toBe(99);
+    expect(dest[1]).toBe(10);
+    sharedFrame.close();
+
+    // Without transfer the constructor still copies
+    const copied = createI420Frame(32, 16, 20);
+    const copyFrame = new VideoFrame(copied, { format: 'I420', codedWidth: 32, codedHeight: 16, timestamp: 0 });
+    copied[0] = 99;
+    await copyFrame.copyTo(dest);
+    expect(dest[0]).toBe(20);
+    copyFrame.close();
+  });
+
+  it('should hash each plane in place, independent of strides', () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const packed = createI420Frame(32, 16, 60);
+    const md5 = (bytes: Uint8Array) => createHash('md5').update(bytes).digest('hex');
+    const expected = [md5(packed.subarray(0, 512)), md5(packed.subarray(512, 640)), md5(packed.subarray(640, 768))];
+
+    const frame = new native.NativeVideoFrame(packed, { format: 'I420', codedWidth: 32, codedHeight: 16 });
+    expect(frame.hash()).toEqual(expected);
+    expect(frame.hash('sha256')).toHaveLength(3);
+    expect(frame.hash('sha256')[0]).toBe(createHash('sha256').update(packed.subarray(0, 512)).digest('hex'));
+    expect(() => frame.hash('no-such-hash')).toThrow(TypeError);
+
+    // The same picture with padded rows hashes the same
+    const padded = new Uint8Array(40 * 16 + 24 * 8 * 2).fill(128);
+    for (let y = 0; y < 16; y++) {
+      padded.fill(60, y * 40, y * 40 + 32);
+      padded.fill(7, y * 40 + 32, y * 40 + 40);
+    }
+    const layout = [{ offset: 0, stride: 40 }, { offset: 640, stride: 24 }, { offset: 832, stride: 24 }];
+    const paddedFrame = new native.NativeVideoFrame(padded, { format: 'I420', codedWidth: 32, codedHeight: 16, layout });
+    expect(paddedFrame.hash()).toEqual(expected);
+    paddedFrame.close();
+
+    // One luma value off changes only the luma digest
+    packed[100] = 61;
+    const changed = new VideoFrame(packed, { format: 'I420', codedWidth: 32, codedHeight: 16, timestamp: 0 });
+    const digests = changed.hash();
+    expect(digests[0]).not.toBe(expected[0]);
+    expect(digests.slice(1)).toEqual(expected.slice(1));
+    changed.close();
+    expect(() => changed.hash()).toThrow('VideoFrame is closed');
+
+    frame.close();
+    expect(() => frame.hash()).toThrow('VideoFrame is closed');
+  });
+});
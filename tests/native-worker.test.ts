@@ -0,0 +1,120 @@
+/**
+ * Native Worker Tests (Node.js only)
+ *
+ * These tests load the addon in several worker_threads Workers at once,
+ * each with its own codec sessions, and hand native frames between
+ * threads with share()/fromShared() instead of copying their pixels.
+ *
+ * NOTE: These tests only run in Node.js since they test our N-API addon.
+ */
+
+import { describe, it, expect, beforeAll } from 'vitest';
+import { Worker } from 'worker_threads';
+import { resolve } from 'path';
+
+const ADDON_PATH = resolve(__dirname, '../build/Release/webcodecs_native.node');
+
+function tryLoadNative() {
+  try {
+    // eslint-disable-next-line @typescript-eslint/no-require-imports
+    return require(ADDON_PATH);
+  } catch {
+    return null;
+  }
+}
+
+function createI420Frame(width: number, height: number, luma: number): Uint8Array {
+  const ySize = width * height;
+  const data = new Uint8Array(ySize + (width / 2) * (height / 2) * 2).fill(128);
+  data.fill(luma, 0, ySize);
+  return data;
+}
+
+// Run `source` in a Worker with `native` bound to the addon; resolves with
+// the first message it posts.
+function runWorker(source: string, workerData?: unknown): Promise<any> {
+  return new Promise((resolvePromise, reject) => {
+    const worker = new Worker(`
+      const { parentPort, workerData } = require('worker_threads');
+      const native = require(${JSON.stringify(ADDON_PATH)});
+      (async () => { ${source} })().catch((e) => parentPort.postMessage({ error: String(e) }));
+    `, { eval: true, workerData });
+    worker.once('message', (message) => {
+      worker.terminate();
+      if (message && message.error) {
+        reject(new Error(message.error));
+      } else {
+        resolvePromise(message);
+      }
+    });
+    worker.once('error', reject);
+  });
+}
+
+describe('Native addon in worker_threads', () => {
+  let native: ReturnType<typeof tryLoadNative>;
+
+  beforeAll(() => {
+    native = tryLoadNative();
+  });
+
+  it('should run codec sessions in several workers at once', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    const results = await Promise.all([0, 1, 2, 3].map(() => runWorker(`
+      const frame = Buffer.alloc(32 * 32 * 3 / 2, 100);
+      const packets = [];
+      const encoder = new native.NativeVideoEncoder({ width: 32, height: 32 }, {
+        output: (packet) => packets.push(packet),
+        error: (e) => parentPort.postMessage({ error: String(e) }),
+        dequeue: () => {},
+      });
+      for (let i = 0; i < 5; i++) {
+        encoder.encode(frame, { timestamp: i });
+      }
+      await new Promise((done) => encoder.flush(done));
+      encoder.close();
+      parentPort.postMessage({ packets: packets.length });
+    `)));
+    for (const result of results) {
+      expect(result.packets).toBe(5);
+    }
+  });
+
+  it('should move frames between threads by reference', async () => {
+    if (!native) {
+      expect.fail('Native addon not available');
+    }
+
+    // Worker -> main
+    const { token } = await runWorker(`
+      const data = new Uint8Array(32 * 16 * 3 / 2).fill(128);
+      data.fill(33, 0, 32 * 16);
+      const frame = new native.NativeVideoFrame(data, { format: 'I420', codedWidth: 32, codedHeight: 16 });
+      parentPort.postMessage({ token: frame.share() });
+      frame.close();
+    `);
+    const received = native.NativeVideoFrame.fromShared(token);
+    const dest = new Uint8Array(32 * 16 * 3 / 2);
+    received.copyTo(dest);
+    expect(dest).toEqual(createI420Frame(32, 16, 33));
+    expect(() => native.NativeVideoFrame.fromShared(token)).toThrow();
+
+    // Main -> worker, of a frame adopting this thread's memory
+    const adopted = new native.NativeVideoFrame(createI420Frame(32, 16, 66), {
+      format: 'I420', codedWidth: 32, codedHeight: 16, adopt: true,
+    });
+    const luma = await runWorker(`
+      const frame = native.NativeVideoFrame.fromShared(workerData);
+      const dest = new Uint8Array(32 * 16 * 3 / 2);
+      frame.copyTo(dest);
+      frame.close();
+      parentPort.postMessage(dest[0]);
+    `, adopted.share());
+    expect(luma).toBe(66);
+    adopted.close();
+    received.close();
+  });
+});
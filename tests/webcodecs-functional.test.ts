@@ -514,6 +514,34 @@ describe('VideoEncoder Functional Tests', () => {
       expect(chunk.byteLength).toBeGreaterThan(0);
     }
   });
+
+  it('should fire dequeue events as the encode queue drains', async () => {
+    if (!isWebCodecsAvailable()) {
+      expect.fail('WebCodecs API not available');
+    }
+
+    encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+    let handlerEvents = 0;
+    let listenerEvents = 0;
+    encoder.ondequeue = () => handlerEvents++;
+    encoder.addEventListener('dequeue', () => listenerEvents++);
+    encoder.configure({ codec: 'vp8', width: 32, height: 32, bitrate: 50000, framerate: 30 });
+
+    for (let frameIndex = 0; frameIndex < 3; frameIndex++) {
+      const frame = createRGBAVideoFrame(32, 32, frameIndex * 33333);
+      encoder.encode(frame);
+      frame.close();
+    }
+    expect(encoder.encodeQueueSize).toBeGreaterThan(0);
+
+    await encoder.flush();
+    // Let the last dequeue event be dispatched
+    await new Promise(resolve => setTimeout(resolve, 0));
+
+    expect(encoder.encodeQueueSize).toBe(0);
+    expect(handlerEvents).toBeGreaterThan(0);
+    expect(listenerEvents).toBe(handlerEvents);
+  });
 });
 
 describe('VideoDecoder Functional Tests', () => {